@@ -36,6 +36,7 @@
 #include <simgear/debug/logstream.hxx>
 #include <simgear/misc/sg_path.hxx>
 #include <simgear/props/props.hxx>
+#include <simgear/props/props_io.hxx>
 #include <simgear/scene/model/modellib.hxx>
 #include <simgear/scene/util/SGNodeMasks.hxx>
 
@@ -254,6 +255,12 @@ void FGAIBase::setScenarioPath(const std::string& scenarioPath)
     _scenarioPath = scenarioPath;
 }
 
+void FGAIBase::setDefinition(const SGPropertyNode* definition)
+{
+    _definition = new SGPropertyNode;
+    copyProperties(definition, _definition);
+}
+
 void FGAIBase::readFromScenario(SGPropertyNode* scFileNode)
 {
     if (!scFileNode)
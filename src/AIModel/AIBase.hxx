@@ -151,6 +151,13 @@ public:
 
     void setScenarioPath(const std::string& scenarioPath);
 
+    /**
+     * the scenario entry or add-aimodel arguments this object was created
+     * from, so it can be recreated; null for other objects
+     */
+    void setDefinition(const SGPropertyNode* definition);
+    const SGPropertyNode* getDefinition() const { return _definition; }
+
 protected:
     double _elevation_m;
 
@@ -172,6 +179,7 @@ protected:
     std::string _name;
     std::string _parent;
     std::string _scenarioPath;
+    SGPropertyNode_ptr _definition;
 
     /**
      * Tied-properties helper, record nodes which are tied for easy un-tie-ing
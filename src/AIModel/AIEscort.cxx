@@ -85,7 +85,7 @@ void FGAIEscort::readFromScenario(SGPropertyNode* scFileNode) {
     setCallSign(scFileNode->getStringValue("callsign", ""));
 
     if(_patrol)
-        sg_srandom_time();
+        fgSeedRandom();
 
 }
 
@@ -20,6 +20,10 @@
 
 #include <cstring>
 #include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
 
 #include <simgear/debug/ErrorReportingCallback.hxx>
 #include <simgear/math/sg_geodesy.hxx>
@@ -32,6 +36,8 @@
 #include <Add-ons/AddonManager.hxx>
 #include <Airports/airport.hxx>
 #include <Main/fg_props.hxx>
+#include <Main/PropertyTreeCache.hxx>
+#include <Main/StartupTasks.hxx>
 #include <Main/globals.hxx>
 #include <Main/sentryIntegration.hxx>
 #include <Scripting/NasalSys.hxx>
@@ -52,6 +58,48 @@
 
 static bool static_haveRegisteredScenarios = false;
 
+namespace {
+
+// scenario files parsed by the startup tasks, keyed by path; entries are
+// removed once registered
+std::mutex static_prefetchLock;
+std::map<std::string, SGPropertyNode_ptr> static_prefetchedScenarios;
+
+PathList scenarioSearchPaths()
+{
+    PathList paths;
+    paths.push_back(globals->get_fg_root() / "AI");
+    paths.push_back(globals->get_fg_home() / "Scenarios");
+    paths.push_back(SGPath(fgGetString("/sim/aircraft-dir")) / "Scenarios");
+
+    // add-on scenario directories
+    const auto& addonsManager = flightgear::addons::AddonManager::instance();
+    if (addonsManager) {
+        for (auto a : addonsManager->registeredAddons()) {
+            paths.push_back(a->getBasePath() / "Scenarios");
+        }
+    }
+
+    return paths;
+}
+
+SGPropertyNode_ptr takePrefetchedScenario(const SGPath& xmlPath)
+{
+    flightgear::StartupTasks::instance()->wait("ai-scenario-parse");
+
+    std::lock_guard<std::mutex> g(static_prefetchLock);
+    auto it = static_prefetchedScenarios.find(xmlPath.utf8Str());
+    if (it == static_prefetchedScenarios.end()) {
+        return {};
+    }
+
+    SGPropertyNode_ptr result = it->second;
+    static_prefetchedScenarios.erase(it);
+    return result;
+}
+
+} // of anonymous namespace
+
 class FGAIManager::Scenario
 {
 public:
@@ -107,6 +155,27 @@ public:
 
         nasalSys->deleteModule(moduleName.c_str());
     }
+
+    bool contains(const FGAIBase* ai) const
+    {
+        return std::any_of(_objects.begin(), _objects.end(),
+                           [ai](const FGAIBasePtr& o) { return o.get() == ai; });
+    }
+
+    /// objects recreated from a state snapshot
+    void adopt(FGAIBasePtr ai)
+    {
+        _objects.push_back(ai);
+    }
+
+    /// remove the objects, without unloading the scenario
+    void killObjects()
+    {
+        for (auto& ai : _objects) {
+            ai->setDie(true);
+        }
+        _objects.clear();
+    }
 private:
     std::vector<FGAIBasePtr> _objects;
     std::string _internalName;
@@ -189,21 +258,8 @@ void FGAIManager::registerScenarios(SGPropertyNode_ptr root)
     }
     
     // find all scenarios at standard locations (for driving the GUI)
-    std::vector<SGPath> scenarioSearchPaths;
-    scenarioSearchPaths.push_back(globals->get_fg_root() / "AI");
-    scenarioSearchPaths.push_back(globals->get_fg_home() / "Scenarios");
-    scenarioSearchPaths.push_back(SGPath(fgGetString("/sim/aircraft-dir")) / "Scenarios");
-    
-    // add-on scenario directories
-    const auto& addonsManager = flightgear::addons::AddonManager::instance();
-    if (addonsManager) {
-        for (auto a : addonsManager->registeredAddons()) {
-            scenarioSearchPaths.push_back(a->getBasePath() / "Scenarios");
-        }
-    }
-
     SGPropertyNode_ptr scenariosNode = root->getNode("/sim/ai/scenarios", true);
-    for (auto p : scenarioSearchPaths) {
+    for (auto p : scenarioSearchPaths()) {
         if (!p.exists())
             continue;
         
@@ -214,6 +270,42 @@ void FGAIManager::registerScenarios(SGPropertyNode_ptr root)
     } // of scenario dirs iteration
 }
 
+void FGAIManager::prefetchScenarios()
+{
+    // directory scanning and XML parsing don't need the main thread, so
+    // run them as startup tasks; registerScenarioFile picks up the results
+    auto files = std::make_shared<PathList>();
+    const PathList dirs = scenarioSearchPaths();
+    auto tasks = flightgear::StartupTasks::instance();
+
+    tasks->add("ai-scenario-scan", [dirs, files]() {
+        for (const auto& p : dirs) {
+            if (!p.exists())
+                continue;
+
+            simgear::Dir dir(p);
+            for (const auto& xmlPath : dir.children(simgear::Dir::TYPE_FILE, ".xml")) {
+                files->push_back(xmlPath);
+            }
+        }
+    });
+
+    tasks->add("ai-scenario-parse", [files]() {
+        for (const auto& xmlPath : *files) {
+            SGPropertyNode_ptr scenarioProps(new SGPropertyNode);
+            try {
+                readProperties(xmlPath, scenarioProps);
+            } catch (sg_exception&) {
+                // parse again on the main thread, so the failure is reported
+                continue;
+            }
+
+            std::lock_guard<std::mutex> g(static_prefetchLock);
+            static_prefetchedScenarios[xmlPath.utf8Str()] = scenarioProps;
+        }
+    }, {"ai-scenario-scan"});
+}
+
 SGPropertyNode_ptr FGAIManager::registerScenarioFile(SGPropertyNode_ptr root, const SGPath& xmlPath)
 {
     if (!xmlPath.exists()) return {};
@@ -227,8 +319,11 @@ SGPropertyNode_ptr FGAIManager::registerScenarioFile(SGPropertyNode_ptr root, co
     flightgear::SentryXMLErrorSupression xml;
 
     try {
-        SGPropertyNode_ptr scenarioProps(new SGPropertyNode);
-        readProperties(xmlPath, scenarioProps);
+        SGPropertyNode_ptr scenarioProps = takePrefetchedScenario(xmlPath);
+        if (!scenarioProps) {
+            scenarioProps = new SGPropertyNode;
+            readProperties(xmlPath, scenarioProps);
+        }
         
         for (auto xs : scenarioProps->getChildren("scenario")) {
             if (!xs->hasChild("name") || !xs->hasChild("description")) {
@@ -556,6 +651,7 @@ FGAIBasePtr FGAIManager::addObject(const SGPropertyNode* definition)
     }
 
     ai->readFromScenario(const_cast<SGPropertyNode*>(definition));
+    ai->setDefinition(definition);
 	if((ai->isValid())){
 		attach(ai);
         SG_LOG(SG_AI, SG_DEBUG, "attached scenario " << ai->_getName());
@@ -567,6 +663,94 @@ FGAIBasePtr FGAIManager::addObject(const SGPropertyNode* definition)
     return ai;
 }
 
+std::string FGAIManager::scenarioOf(const FGAIBase* ai) const
+{
+    for (const auto& s : _scenarios) {
+        if (s.second->contains(ai)) {
+            return s.first;
+        }
+    }
+
+    return {};
+}
+
+void FGAIManager::saveSnapshot(std::ostream& os)
+{
+    std::vector<std::pair<std::string, std::string>> objects;
+    for (FGAIBase* ai : ai_list) {
+        const SGPropertyNode* definition = ai->getDefinition();
+        if (!definition || ai->getDie()) {
+            continue;
+        }
+
+        // the definition, with the current position and motion
+        SGPropertyNode_ptr state(new SGPropertyNode);
+        copyProperties(definition, state);
+        state->setDoubleValue("latitude", ai->_getLatitude());
+        state->setDoubleValue("longitude", ai->_getLongitude());
+        state->setDoubleValue("altitude", ai->_getAltitude());
+        state->setDoubleValue("heading", ai->_getHeading());
+        state->setDoubleValue("speed", ai->_getSpeed());
+        state->setDoubleValue("roll", ai->_getRoll());
+        state->setDoubleValue("pitch", ai->_getPitch());
+
+        std::ostringstream data;
+        if (!flightgear::PropertyTreeCache::write(data, state)) {
+            SG_LOG(SG_AI, SG_WARN, "Can't save " << ai->_getName() << " in a state snapshot");
+            continue;
+        }
+
+        objects.emplace_back(scenarioOf(ai), data.str());
+    }
+
+    flightgear::snapshot::writeValue(os, static_cast<uint32_t>(objects.size()));
+    for (const auto& o : objects) {
+        flightgear::snapshot::writeString(os, o.first);
+        flightgear::snapshot::writeString(os, o.second);
+    }
+}
+
+bool FGAIManager::restoreSnapshot(std::istream& is)
+{
+    // read everything before touching the objects
+    std::vector<std::pair<std::string, SGPropertyNode_ptr>> objects;
+    const uint32_t count = flightgear::snapshot::readValue<uint32_t>(is);
+    for (uint32_t i = 0; is && (i < count); ++i) {
+        const std::string scenario = flightgear::snapshot::readString(is);
+        std::istringstream data(flightgear::snapshot::readString(is));
+        SGPropertyNode_ptr definition(new SGPropertyNode);
+        if (!flightgear::PropertyTreeCache::read(data, definition)) {
+            return false;
+        }
+
+        objects.emplace_back(scenario, definition);
+    }
+
+    if (!is) {
+        return false;
+    }
+
+    for (auto& s : _scenarios) {
+        s.second->killObjects();
+    }
+
+    for (FGAIBase* ai : ai_list) {
+        if (ai->getDefinition()) {
+            ai->setDie(true);
+        }
+    }
+
+    for (const auto& o : objects) {
+        FGAIBasePtr ai = addObject(o.second);
+        auto it = _scenarios.find(o.first);
+        if (ai && !ai->getDie() && (it != _scenarios.end())) {
+            it->second->adopt(ai);
+        }
+    }
+
+    return true;
+}
+
 bool FGAIManager::removeObjectCommand(const SGPropertyNode* arg, const SGPropertyNode* root)
 {
     SG_UNUSED(root);
@@ -29,13 +29,16 @@
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/structure/SGSharedPtr.hxx>
 
+#include <Main/StateSnapshot.hxx>
+
 class FGAIBase;
 class FGAIThermal;
 class FGAIAircraft;
 
 typedef SGSharedPtr<FGAIBase> FGAIBasePtr;
 
-class FGAIManager : public SGSubsystem
+class FGAIManager : public SGSubsystem,
+                    public flightgear::StateSnapshotParticipant
 {
 public:
     FGAIManager();
@@ -53,6 +56,15 @@ public:
     // Subsystem identification.
     static const char* staticSubsystemClassId() { return "ai-model"; }
 
+    /**
+     * StateSnapshotParticipant API: objects created from a scenario entry
+     * or by add-aimodel are saved with their position and motion, and
+     * recreated (with any route restarted) on restore. Traffic,
+     * multiplayer and submodel objects are left to their owners.
+     */
+    void saveSnapshot(std::ostream& os) override;
+    bool restoreSnapshot(std::istream& is) override;
+
     void updateLOD(SGPropertyNode* node);
     void attach(FGAIBase *model);
 
@@ -74,6 +86,12 @@ public:
      * carrier start.
      */
     static void registerScenarios(SGPropertyNode_ptr root = {});
+
+    /**
+     * Start scanning and parsing the scenario files as background startup
+     * tasks, so registerScenarios() only has to copy the results.
+     */
+    static void prefetchScenarios();
     static SGPropertyNode_ptr registerScenarioFile(SGPropertyNode_ptr root, const SGPath& p);
     static SGPropertyNode_ptr loadScenarioFile(const std::string& id, SGPath& outPath);
 
@@ -122,6 +140,9 @@ private:
 
     void removeDeadItem(FGAIBase* base);
 
+    /// the name of the loaded scenario an object belongs to, if any
+    std::string scenarioOf(const FGAIBase* ai) const;
+
     // Returns true on success, e.g. returns false if scenario is already loaded.
     bool loadScenarioCommand(const SGPropertyNode* args, SGPropertyNode* root);
     
@@ -105,7 +105,6 @@ void FGAIStorm::Run(double dt) {
    // **************************************************
 
    if (timer > random_delay) {
-     srand((unsigned)time(0));
      random_delay = delay + (rand()%3) - 1.0;
      //cout << "random_delay = " << random_delay << endl;
      timer = 0.0;
@@ -10,14 +10,29 @@
 #include <simgear/props/props_io.hxx>
 #include <simgear/structure/exception.hxx>
 
+#include <Main/StartupTasks.hxx>
 #include <Main/globals.hxx>
 #include <cstring>
 #include <iostream>
+#include <mutex>
 
 #include "performancedata.hxx"
 
 using std::string;
 
+// database parsed by the startup task added in prefetch()
+static std::mutex static_prefetchLock;
+static SGPath static_prefetchedPath;
+static SGPropertyNode_ptr static_prefetchedRoot;
+
+static SGPath defaultDatabasePath()
+{
+    SGPath dbpath( globals->get_fg_root() );
+    dbpath.append( "/AI/Aircraft/" );
+    dbpath.append( "performancedb.xml");
+    return dbpath;
+}
+
 PerformanceDB::PerformanceDB()
 {
 }
@@ -27,12 +42,26 @@ PerformanceDB::~PerformanceDB()
 {
 }
 
+void PerformanceDB::prefetch()
+{
+    const SGPath dbpath = defaultDatabasePath();
+    flightgear::StartupTasks::instance()->add("ai-performance-db", [dbpath]() {
+        SGPropertyNode_ptr root(new SGPropertyNode);
+        try {
+            readProperties(dbpath, root);
+        } catch (const sg_exception &) {
+            return; // load() will report the error
+        }
+
+        std::lock_guard<std::mutex> g(static_prefetchLock);
+        static_prefetchedPath = dbpath;
+        static_prefetchedRoot = root;
+    });
+}
+
 void PerformanceDB::init()
 {
-    SGPath dbpath( globals->get_fg_root() );
-    dbpath.append( "/AI/Aircraft/" );
-    dbpath.append( "performancedb.xml");
-    load(dbpath);
+    load(defaultDatabasePath());
 
     if (getDefaultPerformance() == 0) {
         SG_LOG(SG_AI, SG_WARN, "PerformanceDB: no default performance data found/loaded");
@@ -106,16 +135,28 @@ bool PerformanceDB::havePerformanceDataForAircraftType(const std::string& acType
 
 void PerformanceDB::load(const SGPath& filename)
 {
-    SGPropertyNode root;
-    try {
-        readProperties(filename, &root);
-    } catch (const sg_exception &) {
-        SG_LOG(SG_AI, SG_ALERT,
-            "Error reading AI aircraft performance database: " << filename);
-        return;
+    SGPropertyNode_ptr root;
+    flightgear::StartupTasks::instance()->wait("ai-performance-db");
+    {
+        std::lock_guard<std::mutex> g(static_prefetchLock);
+        if (static_prefetchedRoot && (static_prefetchedPath == filename)) {
+            root = static_prefetchedRoot;
+        }
+        static_prefetchedRoot.reset();
+    }
+
+    if (!root) {
+        root = new SGPropertyNode;
+        try {
+            readProperties(filename, root);
+        } catch (const sg_exception &) {
+            SG_LOG(SG_AI, SG_ALERT,
+                "Error reading AI aircraft performance database: " << filename);
+            return;
+        }
     }
 
-    SGPropertyNode * node = root.getNode("performancedb");
+    SGPropertyNode * node = root->getNode("performancedb");
     for (int i = 0; i < node->nChildren(); i++) {
         SGPropertyNode * db_node = node->getChild(i);
         if (!strcmp(db_node->getName(), "aircraft")) {
@@ -33,6 +33,12 @@ public:
     // Subsystem identification.
     static const char* staticSubsystemClassId() { return "aircraft-performance-db"; }
 
+    /**
+     * parse the default database as a background startup task, ahead of
+     * init()
+     */
+    static void prefetch();
+
     bool havePerformanceDataForAircraftType(const std::string& acType) const;
 
     /**
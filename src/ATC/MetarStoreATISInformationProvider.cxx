@@ -0,0 +1,117 @@
+/*
+Provide Data for the ATIS Encoder from the decoded METAR store
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MetarStoreATISInformationProvider.hxx"
+#include <Environment/metarstore.hxx>
+#include <simgear/constants.h>
+
+using std::string;
+
+MetarStoreATISInformationProvider::MetarStoreATISInformationProvider( const Environment::MetarReport & report ) :
+  _report( report )
+{
+}
+
+MetarStoreATISInformationProvider::~MetarStoreATISInformationProvider()
+{
+}
+
+bool MetarStoreATISInformationProvider::isValid()
+{
+  return true;
+}
+
+string MetarStoreATISInformationProvider::airportId()
+{
+  return _report.stationId;
+}
+
+long MetarStoreATISInformationProvider::getTime()
+{
+  return makeAtisTime( 0, _report.hour % 24, _report.minute % 60 );
+}
+
+int MetarStoreATISInformationProvider::getWindDeg()
+{
+  return _report.windDeg;
+}
+
+int MetarStoreATISInformationProvider::getWindMinDeg()
+{
+  return _report.windRangeFrom;
+}
+
+int MetarStoreATISInformationProvider::getWindMaxDeg()
+{
+  return _report.windRangeTo;
+}
+
+int MetarStoreATISInformationProvider::getWindSpeedKt()
+{
+  return _report.windSpeedKt;
+}
+
+int MetarStoreATISInformationProvider::getGustsKt()
+{
+  return _report.gustSpeedKt;
+}
+
+int MetarStoreATISInformationProvider::getQnh()
+{
+  return _report.pressureInHg * SG_INHG_TO_PA / 100.0;
+}
+
+double MetarStoreATISInformationProvider::getQnhInHg()
+{
+  return _report.pressureInHg;
+}
+
+bool MetarStoreATISInformationProvider::isCavok()
+{
+  return _report.cavok;
+}
+
+int MetarStoreATISInformationProvider::getVisibilityMeters()
+{
+  return _report.minVisibilityM;
+}
+
+string MetarStoreATISInformationProvider::getPhenomena()
+{
+  return _report.phenomena;
+}
+
+ATISInformationProvider::CloudEntries MetarStoreATISInformationProvider::getClouds()
+{
+  return _report.clouds;
+}
+
+int MetarStoreATISInformationProvider::getTemperatureDeg()
+{
+  return _report.temperatureDegC;
+}
+
+int MetarStoreATISInformationProvider::getDewpointDeg()
+{
+  return _report.dewpointDegC;
+}
+
+string MetarStoreATISInformationProvider::getTrend()
+{
+  return "nosig";
+}
@@ -52,6 +52,7 @@
 #include <Navaids/navrecord.hxx>
 #include <Navaids/positioned.hxx>
 #include <Airports/groundnetwork.hxx>
+#include <Airports/groundnetloader.hxx>
 #include <Airports/xmlloader.hxx>
 
 using std::vector;
@@ -997,14 +998,35 @@ FGAirportDynamicsRef FGAirport::getDynamics() const
 FGGroundNetwork *FGAirport::groundNetwork() const
 {
     if (!_groundNetwork.get()) {
-        _groundNetwork.reset(new FGGroundNetwork(const_cast<FGAirport*>(this)));
-        XMLLoader::load(_groundNetwork.get());
-        _groundNetwork->init();
+        if (_groundNetworkLoad.valid()) {
+            _groundNetwork = _groundNetworkLoad.get();
+        } else {
+            _groundNetwork = flightgear::GroundNetLoader::loadGroundNetworkNow(const_cast<FGAirport*>(this));
+        }
     }
 
     return _groundNetwork.get();
 }
 
+void FGAirport::prefetchGroundNetwork() const
+{
+    if (_groundNetwork.get() || _groundNetworkLoad.valid()) {
+        return;
+    }
+
+    _groundNetworkLoad = flightgear::GroundNetLoader::loadGroundNetwork(const_cast<FGAirport*>(this));
+}
+
+bool FGAirport::isGroundNetworkReady() const
+{
+    if (_groundNetwork.get()) {
+        return true;
+    }
+
+    return _groundNetworkLoad.valid() &&
+           (_groundNetworkLoad.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+}
+
 flightgear::Transition* FGAirport::selectSIDByEnrouteTransition(FGPositioned* enroute) const
 {
     loadProcedures();
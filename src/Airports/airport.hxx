@@ -31,6 +31,7 @@
 
 #include <string>
 #include <vector>
+#include <future>
 #include <map>
 #include <memory>
 
@@ -97,6 +98,15 @@ class FGAirport : public FGPositioned
 
     FGGroundNetwork* groundNetwork() const;
 
+    /**
+     * start loading the ground network in the background, if it is not
+     * loaded already. groundNetwork() waits for the load to finish.
+     */
+    void prefetchGroundNetwork() const;
+
+    /// is the ground network loaded, so groundNetwork() will not block?
+    bool isGroundNetworkReady() const;
+
     unsigned int numRunways() const;
     unsigned int numHelipads() const;
     FGRunwayRef getRunwayByIndex(unsigned int aIndex) const;
@@ -386,6 +396,7 @@ private:
     std::vector<ApproachRef> mApproaches;
 
     mutable std::unique_ptr<FGGroundNetwork> _groundNetwork;
+    mutable std::future<std::unique_ptr<FGGroundNetwork>> _groundNetworkLoad;
   };
 
 // find basic airport location info from airport database
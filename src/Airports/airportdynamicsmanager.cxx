@@ -54,6 +54,8 @@ void AirportDynamicsManager::init()
 void AirportDynamicsManager::shutdown()
 {
     m_dynamics.clear();
+    m_pendingRunwayPrefs.clear();
+    GroundNetLoader::shutdown();
 }
 
 void AirportDynamicsManager::update(double dt)
@@ -81,9 +83,15 @@ FGAirportDynamicsRef AirportDynamicsManager::dynamicsForICAO(const std::string &
     FGAirportDynamicsRef d(new FGAirportDynamics(apt));
     d->init();
 
-    FGRunwayPreference rwyPrefs(apt);
-    XMLLoader::load(&rwyPrefs);
-    d->setRwyUse(rwyPrefs);
+    auto pending = m_pendingRunwayPrefs.find(icao);
+    if (pending != m_pendingRunwayPrefs.end()) {
+        d->setRwyUse(*pending->second.get());
+        m_pendingRunwayPrefs.erase(pending);
+    } else {
+        FGRunwayPreference rwyPrefs(apt);
+        XMLLoader::load(&rwyPrefs);
+        d->setRwyUse(rwyPrefs);
+    }
 
     m_dynamics[icao] = d;
     return d;
@@ -109,6 +117,32 @@ FGAirportDynamicsRef AirportDynamicsManager::find(const FGAirportRef& apt)
     return find(apt->ident());
 }
 
+bool AirportDynamicsManager::prefetch(const FGAirportRef& apt)
+{
+    if (!apt)
+        return false;
+
+    apt->prefetchGroundNetwork();
+
+    AirportDynamicsManager* instance = globals->get_subsystem<AirportDynamicsManager>();
+    if (!instance)
+        return apt->isGroundNetworkReady();
+
+    const std::string icao = apt->ident();
+    if (instance->m_dynamics.find(icao) != instance->m_dynamics.end()) {
+        return apt->isGroundNetworkReady();
+    }
+
+    auto pending = instance->m_pendingRunwayPrefs.find(icao);
+    if (pending == instance->m_pendingRunwayPrefs.end()) {
+        pending = instance->m_pendingRunwayPrefs.insert(
+            std::make_pair(icao, GroundNetLoader::loadRunwayPreference(apt))).first;
+    }
+
+    const bool prefsReady = pending->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    return prefsReady && apt->isGroundNetworkReady();
+}
+
 // Register the subsystem.
 SGSubsystemMgr::Registrant<AirportDynamicsManager> registrantAirportDynamicsManager;
 
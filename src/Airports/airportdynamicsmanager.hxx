@@ -28,6 +28,7 @@
 #include <map>
 
 #include "airports_fwd.hxx"
+#include "groundnetloader.hxx"
 
 namespace flightgear
 {
@@ -53,9 +54,19 @@ public:
 
     FGAirportDynamicsRef dynamicsForICAO(const std::string& icao);
 
+    /**
+     * start loading the ground network and runway preferences of an
+     * airport in the background, so creating its dynamics later does not
+     * block on parsing them. Returns true once both are loaded.
+     */
+    static bool prefetch(const FGAirportRef& apt);
+
 private:
     typedef std::map<std::string, FGAirportDynamicsRef> ICAODynamicsDict;
     ICAODynamicsDict m_dynamics;
+
+    typedef std::map<std::string, std::future<GroundNetLoader::RunwayPreferencePtr>> ICAORunwayPrefsDict;
+    ICAORunwayPrefsDict m_pendingRunwayPrefs;
 };
 
 } // of namespace
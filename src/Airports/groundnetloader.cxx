@@ -0,0 +1,414 @@
+// groundnetloader.cxx - background loading and caching of airport
+// ground networks and runway preferences
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "groundnetloader.hxx"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/misc/sg_dir.hxx>
+#include <simgear/structure/exception.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Main/BinaryIO.hxx>
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+
+#include "airport.hxx"
+#include "groundnetwork.hxx"
+#include "parking.hxx"
+#include "runwayprefs.hxx"
+#include "xmlloader.hxx"
+
+namespace flightgear
+{
+
+namespace
+{
+
+const char CACHE_MAGIC[8] = {'F', 'G', 'G', 'N', 'D', 'N', 'E', 'T'};
+const uint32_t CACHE_VERSION = 1;
+
+/**
+ * The worker thread. Jobs run in the order they were queued.
+ */
+class LoaderThread
+{
+public:
+    static LoaderThread& instance()
+    {
+        static LoaderThread static_instance;
+        return static_instance;
+    }
+
+    ~LoaderThread()
+    {
+        stop();
+    }
+
+    template <class T>
+    std::future<T> add(std::function<T()> work)
+    {
+        auto task = std::make_shared<std::packaged_task<T()>>(std::move(work));
+        std::future<T> result = task->get_future();
+
+        std::lock_guard<std::mutex> g(_lock);
+        _jobs.push_back([task]() { (*task)(); });
+        if (!_thread.joinable()) {
+            _stopping = false;
+            _thread = std::thread(&LoaderThread::run, this);
+        }
+
+        _jobAdded.notify_one();
+        return result;
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> g(_lock);
+            if (!_thread.joinable()) {
+                return;
+            }
+
+            _stopping = true;
+            _jobAdded.notify_one();
+        }
+
+        _thread.join();
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> g(_lock);
+        for (;;) {
+            _jobAdded.wait(g, [this]() { return _stopping || !_jobs.empty(); });
+            // queued jobs are finished even when stopping: callers may
+            // be waiting for their futures
+            if (_jobs.empty()) {
+                return;
+            }
+
+            auto job = std::move(_jobs.front());
+            _jobs.pop_front();
+            g.unlock();
+            job();
+            g.lock();
+        }
+    }
+
+    std::mutex _lock;
+    std::condition_variable _jobAdded;
+    std::deque<std::function<void()>> _jobs;
+    std::thread _thread;
+    bool _stopping = false;
+};
+
+// parse or read the ground network; no main thread state may be used here
+GroundNetLoader::GroundNetworkPtr buildGroundNetwork(FGAirport* apt, const SGPath& source,
+                                                     const SGPath& cacheFile, bool writeCache)
+{
+    GroundNetLoader::GroundNetworkPtr net(new FGGroundNetwork(apt));
+    if (!source.isNull()) {
+        SGTimeStamp st;
+        st.stamp();
+        if (GroundNetLoader::readCache(net.get(), cacheFile, source)) {
+            SG_LOG(SG_NAVAID, SG_DEBUG, "reading cached groundnet for " << apt->ident()
+                   << " took " << st.elapsedMSec());
+        } else {
+            SG_LOG(SG_NAVAID, SG_DEBUG, "reading groundnet data from " << source);
+            XMLLoader::loadFromPath(net.get(), source);
+            SG_LOG(SG_NAVAID, SG_DEBUG, "parsing groundnet XML took " << st.elapsedMSec());
+            if (writeCache) {
+                GroundNetLoader::writeCache(net.get(), cacheFile, source);
+            }
+        }
+    }
+
+    net->init();
+    return net;
+}
+
+using binary::readString;
+using binary::readValue;
+using binary::writeString;
+using binary::writeValue;
+
+} // of anonymous namespace
+
+std::future<GroundNetLoader::GroundNetworkPtr>
+GroundNetLoader::loadGroundNetwork(const FGAirportRef& apt)
+{
+    SGPath source;
+    XMLLoader::findAirportData(apt->ident(), "groundnet", source);
+    const SGPath cacheFile = cachePathFor(apt->ident());
+    const bool writeCache = !fgGetBool("/sim/fghome-readonly", false);
+
+    // the reference keeps the airport alive until the job has run
+    FGAirportRef ref(apt);
+    return LoaderThread::instance().add<GroundNetworkPtr>([ref, source, cacheFile, writeCache]() {
+        return buildGroundNetwork(ref.ptr(), source, cacheFile, writeCache);
+    });
+}
+
+std::future<GroundNetLoader::RunwayPreferencePtr>
+GroundNetLoader::loadRunwayPreference(const FGAirportRef& apt)
+{
+    SGPath source;
+    XMLLoader::findAirportData(apt->ident(), "rwyuse", source);
+
+    FGAirportRef ref(apt);
+    return LoaderThread::instance().add<RunwayPreferencePtr>([ref, source]() {
+        RunwayPreferencePtr prefs(new FGRunwayPreference(ref.ptr()));
+        if (!source.isNull()) {
+            XMLLoader::loadFromPath(prefs.get(), source);
+        }
+        return prefs;
+    });
+}
+
+GroundNetLoader::GroundNetworkPtr GroundNetLoader::loadGroundNetworkNow(FGAirport* apt)
+{
+    SGPath source;
+    XMLLoader::findAirportData(apt->ident(), "groundnet", source);
+    return buildGroundNetwork(apt, source, cachePathFor(apt->ident()),
+                              !fgGetBool("/sim/fghome-readonly", false));
+}
+
+void GroundNetLoader::shutdown()
+{
+    LoaderThread::instance().stop();
+}
+
+SGPath GroundNetLoader::cachePathFor(const std::string& icao)
+{
+    return globals->get_fg_home() / "GroundNets" / (icao + ".gnc");
+}
+
+bool GroundNetLoader::readCache(FGGroundNetwork* net, const SGPath& cacheFile, const SGPath& source)
+{
+    if (!cacheFile.exists()) {
+        return false;
+    }
+
+    sg_ifstream is(cacheFile, std::ios::in | std::ios::binary);
+    char magic[8];
+    is.read(magic, sizeof(magic));
+    if (!is || memcmp(magic, CACHE_MAGIC, sizeof(magic)) ||
+        (readValue<uint32_t>(is) != CACHE_VERSION))
+    {
+        return false;
+    }
+
+    // the key: the XML file it was written from
+    const std::string path = readString(is);
+    const int64_t modTime = readValue<int64_t>(is);
+    const uint64_t size = readValue<uint64_t>(is);
+    if (!is || (path != source.utf8Str()) || (modTime != source.modTime()) ||
+        (size != source.sizeInBytes()))
+    {
+        SG_LOG(SG_NAVAID, SG_DEBUG, "groundnet cache " << cacheFile << " is out of date");
+        return false;
+    }
+
+    // read everything before modifying the network, so a bad cache
+    // leaves it untouched
+    const int version = readValue<int32_t>(is);
+    intVec freqs[6];
+    for (auto& f : freqs) {
+        const uint32_t count = readValue<uint32_t>(is);
+        for (uint32_t i = 0; is && (i < count); ++i) {
+            f.push_back(readValue<int32_t>(is));
+        }
+    }
+
+    const uint32_t nodeCount = readValue<uint32_t>(is);
+    const uint32_t networkNodeCount = readValue<uint32_t>(is);
+    if (!is || (networkNodeCount > nodeCount)) {
+        return false;
+    }
+
+    FGTaxiNodeVector nodes;
+    std::vector<std::pair<FGParkingRef, int32_t>> pushBacks;
+    for (uint32_t i = 0; is && (i < nodeCount); ++i) {
+        const bool isParking = readValue<uint8_t>(is) != 0;
+        const int index = readValue<int32_t>(is);
+        const double lon = readValue<double>(is);
+        const double lat = readValue<double>(is);
+        const SGGeod pos = SGGeod::fromDeg(lon, lat);
+        if (isParking) {
+            const double heading = readValue<double>(is);
+            const double radius = readValue<double>(is);
+            const std::string name = readString(is);
+            const std::string type = readString(is);
+            const std::string codes = readString(is);
+            const int32_t pushBack = readValue<int32_t>(is);
+            FGParkingRef parking(new FGParking(index, pos, heading, radius, name, type, codes));
+            if (pushBack >= 0) {
+                pushBacks.push_back(std::make_pair(parking, pushBack));
+            }
+            nodes.push_back(parking.ptr());
+        } else {
+            const bool onRunway = readValue<uint8_t>(is) != 0;
+            const int holdType = readValue<int32_t>(is);
+            nodes.push_back(new FGTaxiNode(FGPositioned::TAXI_NODE, index, pos, onRunway, holdType));
+        }
+    }
+
+    FGParkingList parkings;
+    const uint32_t parkingCount = readValue<uint32_t>(is);
+    for (uint32_t i = 0; is && (i < parkingCount); ++i) {
+        const uint32_t n = readValue<uint32_t>(is);
+        FGParking* parking = (n < nodes.size()) ? fgpositioned_cast<FGParking>(nodes[n].ptr()) : nullptr;
+        if (!parking) {
+            return false;
+        }
+        parkings.push_back(parking);
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> arcs;
+    const uint32_t segmentCount = readValue<uint32_t>(is);
+    for (uint32_t i = 0; is && (i < segmentCount); ++i) {
+        const uint32_t from = readValue<uint32_t>(is);
+        const uint32_t to = readValue<uint32_t>(is);
+        if ((from >= nodes.size()) || (to >= nodes.size())) {
+            return false;
+        }
+        arcs.push_back(std::make_pair(from, to));
+    }
+
+    if (!is) {
+        SG_LOG(SG_NAVAID, SG_WARN, "groundnet cache " << cacheFile << " is corrupt");
+        return false;
+    }
+
+    for (const auto& p : pushBacks) {
+        if (static_cast<size_t>(p.second) >= nodes.size()) {
+            return false;
+        }
+        p.first->setPushBackPoint(nodes[p.second]);
+    }
+
+    net->version = version;
+    net->freqAwos = freqs[0];
+    net->freqUnicom = freqs[1];
+    net->freqClearance = freqs[2];
+    net->freqGround = freqs[3];
+    net->freqTower = freqs[4];
+    net->freqApproach = freqs[5];
+    net->m_nodes.assign(nodes.begin(), nodes.begin() + networkNodeCount);
+    net->m_parkings = parkings;
+    for (const auto& a : arcs) {
+        net->segments.push_back(new FGTaxiSegment(nodes[a.first].ptr(), nodes[a.second].ptr()));
+    }
+
+    return true;
+}
+
+bool GroundNetLoader::writeCache(FGGroundNetwork* net, const SGPath& cacheFile, const SGPath& source)
+{
+    // the nodes of the network, then push-back nodes not used otherwise
+    FGTaxiNodeVector nodes(net->m_nodes);
+    std::unordered_map<const FGTaxiNode*, uint32_t> nodeIndex;
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        nodeIndex[nodes[i].ptr()] = i;
+    }
+
+    for (const auto& parking : net->m_parkings) {
+        FGTaxiNodeRef pushBack = parking->getPushBackPoint();
+        if (pushBack && (nodeIndex.find(pushBack.ptr()) == nodeIndex.end())) {
+            nodeIndex[pushBack.ptr()] = nodes.size();
+            nodes.push_back(pushBack);
+        }
+    }
+
+    simgear::Dir dir(cacheFile.dirPath());
+    if (!dir.exists() && !dir.create(0755)) {
+        return false;
+    }
+
+    const bool ok = binary::writeFileReplacing(cacheFile, [&](std::ostream& os) {
+        os.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        writeValue(os, CACHE_VERSION);
+        writeString(os, source.utf8Str());
+        writeValue(os, static_cast<int64_t>(source.modTime()));
+        writeValue(os, static_cast<uint64_t>(source.sizeInBytes()));
+
+        writeValue(os, static_cast<int32_t>(net->version));
+        for (const intVec* f : {&net->freqAwos, &net->freqUnicom, &net->freqClearance,
+                                &net->freqGround, &net->freqTower, &net->freqApproach}) {
+            writeValue(os, static_cast<uint32_t>(f->size()));
+            for (int freq : *f) {
+                writeValue(os, static_cast<int32_t>(freq));
+            }
+        }
+
+        writeValue(os, static_cast<uint32_t>(nodes.size()));
+        writeValue(os, static_cast<uint32_t>(net->m_nodes.size()));
+        for (const auto& node : nodes) {
+            FGParking* parking = fgpositioned_cast<FGParking>(node.ptr());
+            writeValue(os, static_cast<uint8_t>(parking ? 1 : 0));
+            writeValue(os, static_cast<int32_t>(node->getIndex()));
+            writeValue(os, node->longitude());
+            writeValue(os, node->latitude());
+            if (parking) {
+                writeValue(os, parking->getHeading());
+                writeValue(os, parking->getRadius());
+                writeString(os, parking->getName());
+                writeString(os, parking->getType());
+                writeString(os, parking->getCodes());
+                FGTaxiNodeRef pushBack = parking->getPushBackPoint();
+                writeValue(os, pushBack ? static_cast<int32_t>(nodeIndex[pushBack.ptr()]) : int32_t(-1));
+            } else {
+                writeValue(os, static_cast<uint8_t>(node->getIsOnRunway() ? 1 : 0));
+                writeValue(os, static_cast<int32_t>(node->getHoldPointType()));
+            }
+        }
+
+        writeValue(os, static_cast<uint32_t>(net->m_parkings.size()));
+        for (const auto& parking : net->m_parkings) {
+            writeValue(os, nodeIndex[parking.ptr()]);
+        }
+
+        writeValue(os, static_cast<uint32_t>(net->segments.size()));
+        for (const FGTaxiSegment* seg : net->segments) {
+            writeValue(os, nodeIndex[seg->getStart().ptr()]);
+            writeValue(os, nodeIndex[seg->getEnd().ptr()]);
+        }
+    });
+
+    if (!ok) {
+        SG_LOG(SG_NAVAID, SG_WARN, "unable to write groundnet cache " << cacheFile);
+    }
+
+    return ok;
+}
+
+} // of namespace flightgear
@@ -0,0 +1,82 @@
+// groundnetloader.hxx - background loading and caching of airport
+// ground networks and runway preferences
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef _GROUNDNET_LOADER_HXX_
+#define _GROUNDNET_LOADER_HXX_
+
+#include <future>
+#include <memory>
+
+#include <simgear/misc/sg_path.hxx>
+
+#include "airports_fwd.hxx"
+
+namespace flightgear
+{
+
+/**
+ * Loads the ground network and runway preferences XML of airports on a
+ * worker thread, so AI traffic and ATC spawning at an airport do not stall
+ * the main loop.
+ *
+ * Parsed ground networks are cached in binary form below
+ * $FG_HOME/GroundNets, keyed by the path, modification time and size of
+ * the groundnet XML; loading from the cache skips parsing the XML.
+ *
+ * The scenery search for the XML files happens on the calling (main)
+ * thread; the worker only reads and parses files, and builds objects
+ * private to the load.
+ */
+class GroundNetLoader
+{
+public:
+    using GroundNetworkPtr = std::unique_ptr<FGGroundNetwork>;
+    using RunwayPreferencePtr = std::unique_ptr<FGRunwayPreference>;
+
+    /**
+     * load the ground network of an airport, initialised and ready for use.
+     * Airports without a groundnet get an empty network, as before.
+     */
+    static std::future<GroundNetworkPtr> loadGroundNetwork(const FGAirportRef& apt);
+
+    static std::future<RunwayPreferencePtr> loadRunwayPreference(const FGAirportRef& apt);
+
+    /// load the ground network on the calling thread, using the cache
+    static GroundNetworkPtr loadGroundNetworkNow(FGAirport* apt);
+
+    /**
+     * finish the queued loads, and stop the worker thread. It is started
+     * again by the next load.
+     */
+    static void shutdown();
+
+    /// the cache file for a groundnet XML file
+    static SGPath cachePathFor(const std::string& icao);
+
+    /**
+     * read a ground network from the cache, if it is current for the
+     * source XML. The network is not initialised.
+     */
+    static bool readCache(FGGroundNetwork* net, const SGPath& cacheFile, const SGPath& source);
+
+    /// write the (uninitialised) ground network to the cache
+    static bool writeCache(FGGroundNetwork* net, const SGPath& cacheFile, const SGPath& source);
+};
+
+} // of namespace flightgear
+
+#endif // of _GROUNDNET_LOADER_HXX_
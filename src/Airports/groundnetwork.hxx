@@ -33,6 +33,10 @@
 
 class FGAirportDynamicsXMLLoader;
 
+namespace flightgear {
+class GroundNetLoader;
+}
+
 typedef std::vector<int> intVec;
 typedef std::vector<int>::iterator intVecIterator;
 
@@ -178,6 +182,7 @@ class FGGroundNetwork
 {
 private:
     friend class FGGroundNetXMLLoader;
+    friend class flightgear::GroundNetLoader;
 
     bool hasNetwork;
     bool networkInitialized;
@@ -94,6 +94,18 @@ void XMLLoader::load(FGRunwayPreference* p) {
   loadAirportXMLDataIntoVisitor(p->getId(), "rwyuse", visitor);
 }
 
+void XMLLoader::loadFromPath(FGRunwayPreference* p, const SGPath& path)
+{
+  try {
+      flightgear::sentryThreadReportXMLErrors(false);
+      FGRunwayPreferenceXMLLoader visitor(p);
+      readXML(path, visitor);
+  } catch (sg_exception& e) {
+    SG_LOG(SG_NAVAID, SG_WARN, "XML errors trying to read:" << path);
+  }
+  flightgear::sentryThreadReportXMLErrors(true);
+}
+
 bool XMLLoader::findAirportData(const std::string& aICAO, 
     const std::string& aFileName, SGPath& aPath)
 {
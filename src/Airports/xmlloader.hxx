@@ -32,6 +32,7 @@ public:
   
   static void loadFromStream(FGGroundNetwork* net, std::istream& inData);
   static void loadFromPath(FGGroundNetwork* net, const SGPath& path);
+  static void loadFromPath(FGRunwayPreference* p, const SGPath& path);
 
   /**
    * Search the scenery for a file name of the form:
@@ -32,6 +32,13 @@ AnalogComponent::AnalogComponent() :
   _feedback_if_disabled(false),
   _passive_mode( fgGetNode("/autopilot/locks/passive-mode", true) )
 {
+  InputDependencies::addProperty(_passive_mode);
+}
+
+bool AnalogComponent::collectOutputs( std::set<const SGPropertyNode*>& outputs ) const
+{
+  outputs.insert(_output_list.begin(), _output_list.end());
+  return true;
 }
 
 double AnalogComponent::clamp( double value ) const
@@ -58,6 +65,9 @@ bool AnalogComponent::configure( SGPropertyNode& cfg_node,
   if( cfg_name == "feedback-if-disabled" )
   {
     _feedback_if_disabled = cfg_node.getBoolValue();
+    // this writes to the inputs, so don't let it move
+    if( _feedback_if_disabled )
+      InputDependencies::markIncomplete();
     return true;
   } 
 
@@ -139,6 +139,8 @@ protected:
 
 public:
     const PeriodicalValue * getPeriodicalValue() const { return _periodical; }
+
+    bool collectOutputs( std::set<const SGPropertyNode*>& outputs ) const override;
 };
 
 inline void AnalogComponent::disabled( double dt )
@@ -27,6 +27,12 @@
 
 #include "autopilot.hxx"
 
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
+#include <sstream>
+
 #include <simgear/structure/StateMachine.hxx>
 #include <simgear/sg_inlines.h>
 
@@ -38,8 +44,10 @@
 #include "pidcontroller.hxx"
 #include "logic.hxx"
 #include "flipflop.hxx"
+#include "inputvalue.hxx"
 
 #include "Main/fg_props.hxx"
+#include "Main/StateSnapshot.hxx"
 
 using std::map;
 using std::string;
@@ -124,6 +132,101 @@ void readInterfaceProperties( SGPropertyNode_ptr prop_root,
 
 static ComponentForge componentForge;
 
+namespace {
+
+struct ParsedComponent {
+  Component* component;
+  double updateInterval;
+  InputDependencies inputs;
+  std::set<const SGPropertyNode*> outputs;
+  bool outputsKnown;
+};
+
+/*
+ * Sort the components of [begin, end) so that writers of a property run
+ * before its readers, keeping the file order where there's no
+ * dependency. Writers of the same property keep their relative order.
+ * Returns false (leaving the order alone) if the dependencies form a
+ * cycle.
+ */
+bool sortSegment( std::vector<ParsedComponent>& components,
+                  size_t begin, size_t end )
+{
+  const size_t count = end - begin;
+  std::vector<std::vector<size_t> > successors(count);
+  std::vector<unsigned int> predecessors(count, 0);
+
+  std::map<const SGPropertyNode*, std::vector<size_t> > writers;
+  for( size_t i = 0; i < count; ++i )
+  {
+    for( auto prop : components[begin + i].outputs )
+      writers[prop].push_back(i);
+  }
+
+  auto addEdge = [&successors, &predecessors]( size_t from, size_t to )
+  {
+    successors[from].push_back(to);
+    ++predecessors[to];
+  };
+
+  for( const auto& w : writers )
+  {
+    for( size_t j = 1; j < w.second.size(); ++j )
+      addEdge(w.second[j - 1], w.second[j]);
+  }
+
+  for( size_t i = 0; i < count; ++i )
+  {
+    for( auto prop : components[begin + i].inputs.properties )
+    {
+      auto it = writers.find(prop);
+      if( it == writers.end() )
+        continue;
+
+      for( auto w : it->second )
+      {
+        // reading your own output is just state
+        if( w != i )
+          addEdge(w, i);
+      }
+    }
+  }
+
+  // Kahn's algorithm, always picking the earliest ready component
+  std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t> > ready;
+  for( size_t i = 0; i < count; ++i )
+  {
+    if( predecessors[i] == 0 )
+      ready.push(i);
+  }
+
+  std::vector<size_t> order;
+  order.reserve(count);
+  while( !ready.empty() )
+  {
+    const size_t i = ready.top();
+    ready.pop();
+    order.push_back(i);
+    for( auto s : successors[i] )
+    {
+      if( --predecessors[s] == 0 )
+        ready.push(s);
+    }
+  }
+
+  if( order.size() != count )
+    return false;
+
+  std::vector<ParsedComponent> sorted;
+  sorted.reserve(count);
+  for( auto i : order )
+    sorted.push_back(std::move(components[begin + i]));
+  std::move(sorted.begin(), sorted.end(), components.begin() + begin);
+  return true;
+}
+
+} // of anonymous namespace
+
 Autopilot::Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode ) :
   _name("unnamed autopilot"),
   _serviceable(true),
@@ -163,13 +266,24 @@ Autopilot::Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode
   // just different "parameter" values.
   readInterfaceProperties(prop_root, rootNode);
 
+  // the evaluation order can be overridden in the local system node, too
+  SGPropertyNode_ptr order_node = rootNode->getChild("evaluation-order");
+  if( !order_node )
+    order_node = configNode->getChild("evaluation-order");
+
+  const string order = order_node ? order_node->getStringValue() : "file";
+  if( order != "file" && order != "dependency" )
+    SG_LOG( SG_AUTOPILOT, SG_DEV_WARN, "unknown evaluation-order '" << order << "', using file order" );
+
+  std::vector<ParsedComponent> components;
   int count = configNode->nChildren();
   for( int i = 0; i < count; ++i )
   {
     SGPropertyNode_ptr node = configNode->getChild(i);
     string childName = node->getName();
     if(    childName == "property"
-        || childName == "property-root" )
+        || childName == "property-root"
+        || childName == "evaluation-order" )
       continue;
     if( componentForge.count(childName) == 0 )
     {
@@ -177,17 +291,45 @@ Autopilot::Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode
       continue;
     }
 
-    Component * component = (*componentForge[childName])(*prop_root, *node);
-    if( component->subsystemId().length() == 0 ) {
+    ParsedComponent parsed;
+    {
+      InputDependencies::Scope scope(parsed.inputs);
+      parsed.component = (*componentForge[childName])(*prop_root, *node);
+    }
+    if( parsed.component->subsystemId().length() == 0 ) {
       std::ostringstream buf;
       buf <<  "unnamed_component_" << i;
     }
 
-    double updateInterval = node->getDoubleValue( "update-interval-secs", 0.0 );
+    parsed.updateInterval = node->getDoubleValue( "update-interval-secs", 0.0 );
+    parsed.outputsKnown = parsed.component->collectOutputs(parsed.outputs);
+
+    SG_LOG( SG_AUTOPILOT, SG_DEBUG, "adding  autopilot component \"" << childName << "\" as \"" << parsed.component->subsystemId() << "\" with interval=" << parsed.updateInterval );
+    components.push_back(std::move(parsed));
+  }
 
-    SG_LOG( SG_AUTOPILOT, SG_DEBUG, "adding  autopilot component \"" << childName << "\" as \"" << component->subsystemId() << "\" with interval=" << updateInterval );
-    add_component(component,updateInterval);
+  if( order == "dependency" )
+  {
+    // components we can't see through split the list into segments,
+    // which are sorted independently
+    size_t begin = 0;
+    for( size_t i = 0; i <= components.size(); ++i )
+    {
+      const bool barrier = (i == components.size()) ||
+                           !components[i].inputs.complete ||
+                           !components[i].outputsKnown;
+      if( !barrier )
+        continue;
+
+      if( i > begin + 1 && !sortSegment(components, begin, i) )
+        SG_LOG( SG_AUTOPILOT, SG_DEV_WARN, "autopilot " << configNode->getPath() << ": cyclic dependency between components "
+                << components[begin].component->subsystemId() << " .. " << components[i - 1].component->subsystemId() << ", keeping file order" );
+      begin = i + 1;
+    }
   }
+
+  for( auto& c : components )
+    add_component(c.component, c.updateInterval);
 }
 
 Autopilot::~Autopilot() 
@@ -229,11 +371,78 @@ void Autopilot::add_component( Component * component, double updateInterval )
   }
 
   set_subsystem( name, component, updateInterval );
+
+  PlanEntry entry;
+  entry.component = component;
+  entry.name = name;
+  entry.interval = updateInterval;
+  entry.elapsed = 0.0;
+  _plan.push_back(entry);
+}
+
+string_list Autopilot::get_evaluation_order() const
+{
+  string_list names;
+  for( const auto& entry : _plan )
+    names.push_back(entry.name);
+  return names;
+}
+
+void Autopilot::writeState( std::ostream& os ) const
+{
+  flightgear::snapshot::writeValue(os, static_cast<uint32_t>(_plan.size()));
+  for( const auto& entry : _plan ) {
+    std::ostringstream state;
+    entry.component->writeState(state);
+
+    flightgear::snapshot::writeString(os, entry.name);
+    flightgear::snapshot::writeValue(os, entry.elapsed);
+    flightgear::snapshot::writeString(os, state.str());
+  }
+}
+
+bool Autopilot::readState( std::istream& is )
+{
+  const uint32_t count = flightgear::snapshot::readValue<uint32_t>(is);
+  for( uint32_t i = 0; is && i < count; ++i ) {
+    const std::string name = flightgear::snapshot::readString(is);
+    const double elapsed = flightgear::snapshot::readValue<double>(is);
+    std::istringstream state(flightgear::snapshot::readString(is));
+
+    auto it = std::find_if(_plan.begin(), _plan.end(),
+                           [&name](const PlanEntry& e) { return e.name == name; });
+    if( it == _plan.end() ) {
+      SG_LOG( SG_AUTOPILOT, SG_WARN, "autopilot " << _name << ": no component " << name << " to restore" );
+      continue;
+    }
+
+    it->elapsed = elapsed;
+    if( !it->component->readState(state) ) {
+      SG_LOG( SG_AUTOPILOT, SG_WARN, "autopilot " << _name << ": failed to restore " << name );
+      return false;
+    }
+  }
+
+  return !is.fail();
 }
 
 void Autopilot::update( double dt ) 
 {
   if( !_serviceable || dt <= SGLimitsd::min() )
     return;
-  SGSubsystemGroup::update( dt );
+
+  // the same as SGSubsystemGroup::update, without the per member
+  // bookkeeping
+  for( auto& entry : _plan )
+  {
+    entry.elapsed += dt;
+    if( entry.elapsed < entry.interval )
+      continue;
+
+    if( entry.component->is_suspended() )
+      continue;
+
+    entry.component->update(entry.elapsed);
+    entry.elapsed = 0.0;
+  }
 }
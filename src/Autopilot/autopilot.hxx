@@ -23,6 +23,9 @@
 #ifndef __AUTOPILOT_HXX
 #define __AUTOPILOT_HXX 1
 
+#include <iosfwd>
+#include <vector>
+
 #include <simgear/props/props.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
 
@@ -33,6 +36,14 @@ class Component;
 /**
  * @brief A SGSubsystemGroup implementation to serve as a collection
  * of Components
+ *
+ * The components are updated from a flat list instead of through the
+ * generic group update. By default they run in the order of the
+ * configuration file; with &lt;evaluation-order&gt;dependency&lt;/evaluation-order&gt;
+ * components are sorted so that each one runs after the components
+ * writing the properties it reads. Components with inputs which can't
+ * be tracked (conditions, expressions) keep their position, and nothing
+ * is moved across them.
  */
 class Autopilot : public SGSubsystemGroup
 {
@@ -56,12 +67,32 @@ public:
 
     void add_component( Component * component, double updateInterval );
 
+    /**
+     * @brief the names of the components in the order they are updated
+     */
+    string_list get_evaluation_order() const;
+
+    /**
+     * @brief save the internal state of all components, for a state
+     *        snapshot. Components are matched by name when restoring.
+     */
+    void writeState( std::ostream& os ) const;
+    bool readState( std::istream& is );
+
 protected:
 
 private:
+    struct PlanEntry {
+        SGSharedPtr<Component> component;
+        std::string name;
+        double interval;
+        double elapsed;
+    };
+
     std::string _name;
     bool _serviceable;
     SGPropertyNode_ptr _rootNode;
+    std::vector<PlanEntry> _plan;
 };
 
 }
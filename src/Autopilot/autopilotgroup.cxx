@@ -28,6 +28,7 @@
 #include "autopilot.hxx"
 #include "autopilotgroup.hxx"
 
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -37,13 +38,16 @@
 #include <simgear/structure/subsystem_mgr.hxx>
 
 #include <Main/fg_props.hxx>
+#include <Main/PropertyTreeCache.hxx>
+#include <Main/StateSnapshot.hxx>
 #include <Main/sentryIntegration.hxx>
 
 using std::vector;
 using simgear::PropertyList;
 using FGXMLAutopilot::Autopilot;
 
-class FGXMLAutopilotGroupImplementation : public FGXMLAutopilotGroup
+class FGXMLAutopilotGroupImplementation : public FGXMLAutopilotGroup,
+                                          public flightgear::StateSnapshotParticipant
 {
 public:
     FGXMLAutopilotGroupImplementation(const std::string& nodeName):
@@ -64,6 +68,10 @@ public:
                                SGPropertyNode_ptr config );
     virtual void removeAutopilot( const std::string & name );
 
+    // StateSnapshotParticipant API.
+    void saveSnapshot( std::ostream& os ) override;
+    bool restoreSnapshot( std::istream& is ) override;
+
 private:
     void initFrom( SGPropertyNode_ptr rootNode, const char * childName );
     std::string _nodeName;
@@ -104,6 +112,44 @@ void FGXMLAutopilotGroupImplementation::removeAutopilot(const std::string& name)
   remove_subsystem(name);
 }
 
+//------------------------------------------------------------------------------
+void FGXMLAutopilotGroupImplementation::saveSnapshot( std::ostream& os )
+{
+  const string_list names = member_names();
+  flightgear::snapshot::writeValue(os, static_cast<uint32_t>(names.size()));
+  for( const auto& name : names )
+  {
+    std::ostringstream state;
+    static_cast<Autopilot*>(get_subsystem(name))->writeState(state);
+
+    flightgear::snapshot::writeString(os, name);
+    flightgear::snapshot::writeString(os, state.str());
+  }
+}
+
+//------------------------------------------------------------------------------
+bool FGXMLAutopilotGroupImplementation::restoreSnapshot( std::istream& is )
+{
+  const uint32_t count = flightgear::snapshot::readValue<uint32_t>(is);
+  bool ok = true;
+  for( uint32_t i = 0; is && i < count; ++i )
+  {
+    const std::string name = flightgear::snapshot::readString(is);
+    std::istringstream state(flightgear::snapshot::readString(is));
+
+    Autopilot* ap = static_cast<Autopilot*>(get_subsystem(name));
+    if( !ap )
+    {
+      SG_LOG( SG_AUTOPILOT, SG_WARN, "no " << _nodeName << " '" << name << "' to restore" );
+      continue;
+    }
+
+    ok &= ap->readState(state);
+  }
+
+  return ok && !is.fail();
+}
+
 //------------------------------------------------------------------------------
 void FGXMLAutopilotGroupImplementation::reinit()
 {
@@ -212,7 +258,7 @@ void FGXMLAutopilotGroup::addAutopilotFromFile( const std::string& name,
       flightgear::SentryXMLErrorSupression xmlc;
 
       SGPropertyNode_ptr configNode = new SGPropertyNode();
-      readProperties(config, configNode);
+      flightgear::PropertyTreeCache::readProperties(config, configNode);
 
       SG_LOG(SG_AUTOPILOT, SG_INFO, "adding  property-rule subsystem " << name);
       addAutopilot(name, apNode, configNode);
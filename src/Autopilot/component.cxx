@@ -21,7 +21,9 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 //
 #include "component.hxx"
+#include "inputvalue.hxx"
 #include <Main/fg_props.hxx>
+#include <Main/StateSnapshot.hxx>
 #include <simgear/structure/exception.hxx>
 #include <simgear/props/condition.hxx>
 
@@ -90,16 +92,19 @@ bool Component::configure( SGPropertyNode& cfg_node,
 
     if( (prop = cfg_node.getChild("condition")) != NULL ) {
       _condition = sgReadCondition(fgGetNode("/"), prop);
+      InputDependencies::markIncomplete();
       return true;
     } 
     if ( (prop = cfg_node.getChild( "property" )) != NULL ) {
       _enable_prop = fgGetNode( prop->getStringValue(), true );
     }
-       
+
     if ( (prop = cfg_node.getChild( "prop" )) != NULL ) {
       _enable_prop = fgGetNode( prop->getStringValue(), true );
     }
 
+    InputDependencies::addProperty(_enable_prop);
+
     if ( (prop = cfg_node.getChild( "value" )) != NULL ) {
       delete _enable_value;
       _enable_value = new std::string(prop->getStringValue());
@@ -144,3 +149,14 @@ void Component::update( double dt )
   if( _enabled ) update( firstTime, dt );
   else disabled( dt );
 }
+
+void Component::writeState( std::ostream& os ) const
+{
+  flightgear::snapshot::writeValue(os, _enabled);
+}
+
+bool Component::readState( std::istream& is )
+{
+  _enabled = flightgear::snapshot::readValue<bool>(is);
+  return !is.fail();
+}
@@ -27,6 +27,9 @@
 #  include <config.h>
 #endif
 
+#include <iosfwd>
+#include <set>
+
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/props/propsfwd.hxx>
 
@@ -120,6 +123,27 @@ public:
      * Returns true, if neither &lt;condition&gt; nor &lt;prop&gt; exists
      */
     bool isPropertyEnabled();
+
+    /**
+     * @brief collect the properties this component writes to
+     * @return false if the outputs are not known, in which case the
+     *         component keeps its position in the evaluation order
+     */
+    virtual bool collectOutputs( std::set<const SGPropertyNode*>& outputs ) const
+    { return false; }
+
+    /**
+     * @brief save the internal state (integrators, filter history) which
+     *        is not in the property tree, for a state snapshot. Derived
+     *        classes with state extend this.
+     */
+    virtual void writeState( std::ostream& os ) const;
+
+    /**
+     * @brief restore the state written by writeState
+     * @return false if the data is truncated
+     */
+    virtual bool readState( std::istream& is );
 };
 
 }
@@ -22,6 +22,7 @@
 //
 
 #include "digitalcomponent.hxx"
+#include "inputvalue.hxx"
 #include <Main/fg_props.hxx>
 
 #include <simgear/misc/strutils.hxx>
@@ -73,6 +74,7 @@ bool DigitalComponent::configure( SGPropertyNode& cfg_node,
       name = buf.str();
     }
     _input[name] = sgReadCondition(&prop_root, &cfg_node);
+    InputDependencies::markIncomplete();
     return true;
   } 
 
@@ -113,3 +115,13 @@ bool DigitalComponent::configure( SGPropertyNode& cfg_node,
   
   return Component::configure(cfg_node, cfg_name, prop_root);
 }
+
+bool DigitalComponent::collectOutputs( std::set<const SGPropertyNode*>& outputs ) const
+{
+  for( OutputMap::const_iterator it = _output.begin(); it != _output.end(); ++it )
+  {
+    if( it->second->getProperty() )
+      outputs.insert(it->second->getProperty());
+  }
+  return true;
+}
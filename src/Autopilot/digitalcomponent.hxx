@@ -54,6 +54,8 @@ public:
 
   bool getValue() const;
   void setValue( bool value );
+
+  const SGPropertyNode* getProperty() const { return _node; }
 };
 
 inline DigitalOutput::DigitalOutput() : _inverted(false) 
@@ -132,6 +134,9 @@ protected:
     virtual bool configure( SGPropertyNode& cfg_node,
                             const std::string& cfg_name,
                             SGPropertyNode& prop_root );
+
+public:
+    bool collectOutputs( std::set<const SGPropertyNode*>& outputs ) const override;
 };
 
 }
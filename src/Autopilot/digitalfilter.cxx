@@ -32,6 +32,8 @@
 
 #include <simgear/misc/strutils.hxx>
 
+#include <Main/StateSnapshot.hxx>
+
 namespace FGXMLAutopilot
 {
 
@@ -51,6 +53,10 @@ class DigitalFilterImplementation:
                             const std::string& cfg_name,
                             SGPropertyNode& prop_root ) = 0;
 
+    // the filter history, for state snapshots
+    virtual void writeState( std::ostream& os ) const {}
+    virtual bool readState( std::istream& is ) { return true; }
+
     void setDigitalFilter( DigitalFilter * digitalFilter ) { _digitalFilter = digitalFilter; }
 
   protected:
@@ -85,6 +91,13 @@ public:
   DerivativeFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  void writeState( std::ostream& os ) const {
+    flightgear::snapshot::writeValue(os, _input_1);
+  }
+  bool readState( std::istream& is ) {
+    _input_1 = flightgear::snapshot::readValue<double>(is);
+    return !is.fail();
+  }
 };
 
 class ExponentialFilterImplementation : public GainFilterImplementation {
@@ -99,6 +112,15 @@ public:
   ExponentialFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  void writeState( std::ostream& os ) const {
+    flightgear::snapshot::writeValue(os, _output_1);
+    flightgear::snapshot::writeValue(os, _output_2);
+  }
+  bool readState( std::istream& is ) {
+    _output_1 = flightgear::snapshot::readValue<double>(is);
+    _output_2 = flightgear::snapshot::readValue<double>(is);
+    return !is.fail();
+  }
 };
 
 class MovingAverageFilterImplementation : public DigitalFilterImplementation {
@@ -113,6 +135,23 @@ public:
   MovingAverageFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  void writeState( std::ostream& os ) const {
+    flightgear::snapshot::writeValue(os, _output_1);
+    flightgear::snapshot::writeValue(os, static_cast<uint32_t>(_inputQueue.size()));
+    for( double v : _inputQueue )
+      flightgear::snapshot::writeValue(os, v);
+  }
+  bool readState( std::istream& is ) {
+    _output_1 = flightgear::snapshot::readValue<double>(is);
+    const uint32_t size = flightgear::snapshot::readValue<uint32_t>(is);
+    if( !is || size > 1000000 )
+      return false;
+
+    _inputQueue.clear();
+    for( uint32_t i = 0; i < size; ++i )
+      _inputQueue.push_back(flightgear::snapshot::readValue<double>(is));
+    return !is.fail();
+  }
 };
 
 class NoiseSpikeFilterImplementation : public DigitalFilterImplementation {
@@ -126,6 +165,13 @@ public:
   NoiseSpikeFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  void writeState( std::ostream& os ) const {
+    flightgear::snapshot::writeValue(os, _output_1);
+  }
+  bool readState( std::istream& is ) {
+    _output_1 = flightgear::snapshot::readValue<double>(is);
+    return !is.fail();
+  }
 };
 
 class RateLimitFilterImplementation : public DigitalFilterImplementation {
@@ -140,6 +186,13 @@ public:
   RateLimitFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  void writeState( std::ostream& os ) const {
+    flightgear::snapshot::writeValue(os, _output_1);
+  }
+  bool readState( std::istream& is ) {
+    _output_1 = flightgear::snapshot::readValue<double>(is);
+    return !is.fail();
+  }
 };
 
 class IntegratorFilterImplementation : public GainFilterImplementation {
@@ -156,6 +209,15 @@ public:
   IntegratorFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  void writeState( std::ostream& os ) const {
+    flightgear::snapshot::writeValue(os, _input_1);
+    flightgear::snapshot::writeValue(os, _output_1);
+  }
+  bool readState( std::istream& is ) {
+    _input_1 = flightgear::snapshot::readValue<double>(is);
+    _output_1 = flightgear::snapshot::readValue<double>(is);
+    return !is.fail();
+  }
 };
 
 // integrates x" + ax' + bx + c = 0
@@ -174,6 +236,17 @@ public:
   DampedOscillationFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  void writeState( std::ostream& os ) const {
+    flightgear::snapshot::writeValue(os, _x0);
+    flightgear::snapshot::writeValue(os, _x1);
+    flightgear::snapshot::writeValue(os, _x2);
+  }
+  bool readState( std::istream& is ) {
+    _x0 = flightgear::snapshot::readValue<double>(is);
+    _x1 = flightgear::snapshot::readValue<double>(is);
+    _x2 = flightgear::snapshot::readValue<double>(is);
+    return !is.fail();
+  }
 };
 
 class HighPassFilterImplementation : public GainFilterImplementation {
@@ -188,6 +261,15 @@ public:
   HighPassFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  void writeState( std::ostream& os ) const {
+    flightgear::snapshot::writeValue(os, _input_1);
+    flightgear::snapshot::writeValue(os, _output_1);
+  }
+  bool readState( std::istream& is ) {
+    _input_1 = flightgear::snapshot::readValue<double>(is);
+    _output_1 = flightgear::snapshot::readValue<double>(is);
+    return !is.fail();
+  }
 };
 class LeadLagFilterImplementation : public GainFilterImplementation {
 protected:
@@ -202,6 +284,15 @@ public:
   LeadLagFilterImplementation();
   double compute(  double dt, double input );
   virtual void initialize( double initvalue );
+  void writeState( std::ostream& os ) const {
+    flightgear::snapshot::writeValue(os, _input_1);
+    flightgear::snapshot::writeValue(os, _output_1);
+  }
+  bool readState( std::istream& is ) {
+    _input_1 = flightgear::snapshot::readValue<double>(is);
+    _output_1 = flightgear::snapshot::readValue<double>(is);
+    return !is.fail();
+  }
 };
 
 class CoherentNoiseFilterImplementation : public DigitalFilterImplementation
@@ -927,6 +1018,21 @@ void DigitalFilter::update( bool firstTime, double dt)
   }
 }
 
+void DigitalFilter::writeState( std::ostream& os ) const
+{
+  AnalogComponent::writeState(os);
+  if( _implementation )
+    _implementation->writeState(os);
+}
+
+bool DigitalFilter::readState( std::istream& is )
+{
+  if( !AnalogComponent::readState(is) )
+    return false;
+
+  return _implementation ? _implementation->readState(is) : true;
+}
+
 
 // Register the subsystem.
 SGSubsystemMgr::Registrant<DigitalFilter> registrantDigitalFilter;
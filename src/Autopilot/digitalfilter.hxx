@@ -67,6 +67,9 @@ public:
 
     virtual bool configure( SGPropertyNode& prop_root,
                             SGPropertyNode& cfg );
+
+    void writeState( std::ostream& os ) const override;
+    bool readState( std::istream& is ) override;
 };
 
 } // namespace FGXMLAutopilot
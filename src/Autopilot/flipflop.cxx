@@ -429,31 +429,37 @@ bool FlipFlop::configure( SGPropertyNode& cfg_node,
 
   if (cfg_name == "set"||cfg_name == "S") {
     _input["S"] = sgReadCondition(&prop_root, &cfg_node);
+    InputDependencies::markIncomplete();
     return true;
   }
 
   if (cfg_name == "reset" || cfg_name == "R" ) {
     _input["R"] = sgReadCondition(&prop_root, &cfg_node);
+    InputDependencies::markIncomplete();
     return true;
   } 
 
   if (cfg_name == "J") {
     _input["J"] = sgReadCondition(&prop_root, &cfg_node);
+    InputDependencies::markIncomplete();
     return true;
   } 
 
   if (cfg_name == "K") {
     _input["K"] = sgReadCondition(&prop_root, &cfg_node);
+    InputDependencies::markIncomplete();
     return true;
   } 
 
   if (cfg_name == "D") {
     _input["D"] = sgReadCondition(&prop_root, &cfg_node);
+    InputDependencies::markIncomplete();
     return true;
   } 
 
   if (cfg_name == "clock") {
     _input["clock"] = sgReadCondition(&prop_root, &cfg_node);
+    InputDependencies::markIncomplete();
     return true;
   }
 
@@ -26,6 +26,35 @@
 
 using namespace FGXMLAutopilot;
 
+InputDependencies* InputDependencies::_current = nullptr;
+
+//------------------------------------------------------------------------------
+void InputDependencies::addProperty( const SGPropertyNode* node )
+{
+  if( _current && node )
+    _current->properties.insert(node);
+}
+
+//------------------------------------------------------------------------------
+void InputDependencies::markIncomplete()
+{
+  if( _current )
+    _current->complete = false;
+}
+
+//------------------------------------------------------------------------------
+InputDependencies::Scope::Scope( InputDependencies& deps ) :
+  _previous(_current)
+{
+  _current = &deps;
+}
+
+//------------------------------------------------------------------------------
+InputDependencies::Scope::~Scope()
+{
+  _current = _previous;
+}
+
 //------------------------------------------------------------------------------
 PeriodicalValue::PeriodicalValue( SGPropertyNode& prop_root,
                                   SGPropertyNode& cfg )
@@ -67,6 +96,13 @@ double PeriodicalValue::normalizeSymmetric( double value ) const
   return value > width_2 ? width_2 - value : value;
 }
 
+//------------------------------------------------------------------------------
+bool PeriodicalValue::is_constant() const
+{
+  return minPeriod && maxPeriod &&
+         minPeriod->is_constant() && maxPeriod->is_constant();
+}
+
 //------------------------------------------------------------------------------
 InputValue::InputValue( SGPropertyNode& prop_root,
                         SGPropertyNode& cfg,
@@ -74,7 +110,17 @@ InputValue::InputValue( SGPropertyNode& prop_root,
                         double offset,
                         double scale ):
   _value(0.0),
-  _abs(false)
+  _abs(false),
+  _plan(PLAN_GENERAL),
+  _constant(0.0),
+  _hasScale(false),
+  _hasOffset(false),
+  _hasMin(false),
+  _hasMax(false),
+  _scaleValue(1.0),
+  _offsetValue(0.0),
+  _minValue(0.0),
+  _maxValue(0.0)
 {
   parse(prop_root, cfg, value, offset, scale);
 }
@@ -85,6 +131,22 @@ void InputValue::parse( SGPropertyNode& prop_root,
                         double aValue,
                         double aOffset,
                         double aScale )
+{
+  parseConfig(prop_root, cfg, aValue, aOffset, aScale);
+  compile();
+
+  if( _property )
+    InputDependencies::addProperty(_property);
+  if( _condition || _expression )
+    InputDependencies::markIncomplete();
+}
+
+//------------------------------------------------------------------------------
+void InputValue::parseConfig( SGPropertyNode& prop_root,
+                              SGPropertyNode& cfg,
+                              double aValue,
+                              double aOffset,
+                              double aScale )
 {
   _value = aValue;
   _property = NULL;
@@ -93,6 +155,8 @@ void InputValue::parse( SGPropertyNode& prop_root,
   _min = NULL;
   _max = NULL;
   _periodical = NULL;
+  _condition = NULL;
+  _expression = NULL;
 
   SGPropertyNode * n;
 
@@ -177,7 +241,45 @@ void InputValue::set_value( double aValue )
         _property->setDoubleValue( 0 ); // if scale is zero, value*scale is zero
 }
 
-double InputValue::get_value() const
+//------------------------------------------------------------------------------
+void InputValue::compile()
+{
+  _plan = PLAN_GENERAL;
+
+  auto constant = [](const InputValue_ptr& v) { return !v || v->is_constant(); };
+  const bool constantModifiers = constant(_scale) && constant(_offset) &&
+                                 constant(_min) && constant(_max);
+
+  if( !_expression && !_property && constantModifiers &&
+      (!_periodical || _periodical->is_constant()) )
+  {
+    // fold the whole input, unless it's NaN: then evaluate() has to keep
+    // complaining about it
+    const double value = evaluate();
+    if( !SGMiscd::isNaN(value) )
+    {
+      _constant = value;
+      _plan = PLAN_CONSTANT;
+    }
+    return;
+  }
+
+  if( !_expression && _property && constantModifiers && !_periodical )
+  {
+    _hasScale = _scale;
+    _hasOffset = _offset;
+    _hasMin = _min;
+    _hasMax = _max;
+    _scaleValue = _hasScale ? _scale->get_value() : 1.0;
+    _offsetValue = _hasOffset ? _offset->get_value() : 0.0;
+    _minValue = _hasMin ? _min->get_value() : 0.0;
+    _maxValue = _hasMax ? _max->get_value() : 0.0;
+    _plan = PLAN_PROPERTY;
+  }
+}
+
+//------------------------------------------------------------------------------
+double InputValue::evaluate() const
 {
     double value = _value;
 
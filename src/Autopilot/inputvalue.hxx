@@ -26,6 +26,9 @@
 #endif
 
 
+#include <cmath>
+#include <set>
+
 #include <simgear/structure/SGExpression.hxx>
 
 namespace FGXMLAutopilot {
@@ -48,6 +51,41 @@ public:
                       SGPropertyNode& cfg );
      double normalize( double value ) const;
      double normalizeSymmetric( double value ) const;
+
+     /* true if both ends of the period are constants */
+     bool is_constant() const;
+};
+
+/**
+ * @brief The properties read by a component, collected while it is
+ * configured.
+ *
+ * Autopilot sets up a collector around the creation of each component;
+ * InputValues and the other inputs report the properties they read to
+ * it. Inputs which can't be tracked (conditions and expressions) mark
+ * the collection as incomplete.
+ */
+class InputDependencies {
+public:
+     std::set<const SGPropertyNode*> properties;
+     bool complete = true;
+
+     static void addProperty( const SGPropertyNode* node );
+     static void markIncomplete();
+
+     /**
+      * @brief collect into the given object for the lifetime of the scope
+      */
+     class Scope {
+     public:
+          explicit Scope( InputDependencies& deps );
+          ~Scope();
+     private:
+          InputDependencies* _previous;
+     };
+
+private:
+     static InputDependencies* _current;
 };
 
 /**
@@ -69,7 +107,31 @@ private:
      PeriodicalValue_ptr  _periodical; //
      SGSharedPtr<const SGCondition> _condition;
      SGSharedPtr<SGExpressiond> _expression;  ///< expression to generate the value
-     
+
+     /*
+      * How get_value() evaluates this input, decided once it's parsed:
+      * constants are folded to a single value, property inputs with
+      * constant modifiers are read without the nested InputValues, and
+      * everything else takes the general path.
+      */
+     enum Plan {
+          PLAN_GENERAL,
+          PLAN_CONSTANT,
+          PLAN_PROPERTY
+     };
+     Plan   _plan;
+     double _constant;
+     bool   _hasScale, _hasOffset, _hasMin, _hasMax;
+     double _scaleValue, _offsetValue, _minValue, _maxValue;
+
+     void parseConfig( SGPropertyNode& prop_root,
+                       SGPropertyNode& cfg,
+                       double value,
+                       double offset,
+                       double scale );
+     void compile();
+     double evaluate() const;
+
 public:
     InputValue( SGPropertyNode& prop_root,
                 SGPropertyNode& node,
@@ -92,7 +154,10 @@ public:
                 double scale = 1.0 );
 
     /* get the value of this input, apply scale and offset and clipping */
-    double get_value() const;
+    inline double get_value() const;
+
+    /* true if the value can't change after parsing */
+    bool is_constant() const { return _plan == PLAN_CONSTANT; }
 
     /* set the input value after applying offset and scale */
     void set_value( double value );
@@ -131,8 +196,13 @@ class InputValueList : public std::vector<InputValue_ptr> {
     }
 
     double get_value() const {
-      InputValue_ptr input = get_active();
-      return input == NULL ? _def : input->get_value();
+      // avoid the reference counting of get_active(), this is called
+      // for most inputs, every frame
+      for (const_iterator it = begin(); it != end(); ++it) {
+        if( (*it)->is_enabled() )
+          return (*it)->get_value();
+      }
+      return _def;
     }
   private:
 
@@ -140,6 +210,34 @@ class InputValueList : public std::vector<InputValue_ptr> {
 
 };
 
+inline double InputValue::get_value() const
+{
+    if( _plan == PLAN_CONSTANT )
+        return _constant;
+
+    if( _plan == PLAN_GENERAL )
+        return evaluate();
+
+    double value = _property->getDoubleValue();
+    if (SGMiscd::isNaN(value)) {
+        SG_LOG(SG_AUTOPILOT, SG_DEV_ALERT, "AP input: read NaN from:" << _property->getPath() );
+    }
+
+    if( _hasScale )
+        value *= _scaleValue;
+
+    if( _hasOffset )
+        value += _offsetValue;
+
+    if( _hasMin && value < _minValue )
+        value = _minValue;
+
+    if( _hasMax && value > _maxValue )
+        value = _maxValue;
+
+    return _abs ? fabs(value) : value;
+}
+
 }
 
 #endif
@@ -23,6 +23,8 @@
 
 #include "pidcontroller.hxx"
 
+#include <Main/StateSnapshot.hxx>
+
 using namespace FGXMLAutopilot;
 
 using std::endl;
@@ -242,5 +244,29 @@ bool PIDController::configure( SGPropertyNode& cfg_node,
 }
 
 
+void PIDController::writeState( std::ostream& os ) const
+{
+  AnalogComponent::writeState(os);
+  flightgear::snapshot::writeValue(os, ep_n_1);
+  flightgear::snapshot::writeValue(os, edf_n_1);
+  flightgear::snapshot::writeValue(os, edf_n_2);
+  flightgear::snapshot::writeValue(os, u_n_1);
+  flightgear::snapshot::writeValue(os, elapsedTime);
+}
+
+bool PIDController::readState( std::istream& is )
+{
+  if( !AnalogComponent::readState(is) )
+    return false;
+
+  ep_n_1 = flightgear::snapshot::readValue<double>(is);
+  edf_n_1 = flightgear::snapshot::readValue<double>(is);
+  edf_n_2 = flightgear::snapshot::readValue<double>(is);
+  u_n_1 = flightgear::snapshot::readValue<double>(is);
+  elapsedTime = flightgear::snapshot::readValue<double>(is);
+  return !is.fail();
+}
+
+
 // Register the subsystem.
 SGSubsystemMgr::Registrant<PIDController> registrantPIDController;
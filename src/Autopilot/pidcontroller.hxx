@@ -74,6 +74,9 @@ public:
     static const char* staticSubsystemClassId() { return "pid-controller"; }
 
     void update( bool firstTime, double dt );
+
+    void writeState( std::ostream& os ) const override;
+    bool readState( std::istream& is ) override;
 };
 
 }
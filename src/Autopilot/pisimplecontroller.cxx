@@ -23,6 +23,8 @@
 
 #include "pisimplecontroller.hxx"
 
+#include <Main/StateSnapshot.hxx>
+
 using namespace FGXMLAutopilot;
 
 //------------------------------------------------------------------------------
@@ -89,5 +91,21 @@ void PISimpleController::update( bool firstTime, double dt )
 }
 
 
+void PISimpleController::writeState( std::ostream& os ) const
+{
+  AnalogComponent::writeState(os);
+  flightgear::snapshot::writeValue(os, _int_sum);
+}
+
+bool PISimpleController::readState( std::istream& is )
+{
+  if( !AnalogComponent::readState(is) )
+    return false;
+
+  _int_sum = flightgear::snapshot::readValue<double>(is);
+  return !is.fail();
+}
+
+
 // Register the subsystem.
 SGSubsystemMgr::Registrant<PISimpleController> registrantPISimpleController;
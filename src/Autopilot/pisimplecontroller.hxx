@@ -61,6 +61,9 @@ public:
     static const char* staticSubsystemClassId() { return "pi-simple-controller"; }
 
     void update( bool firstTime, double dt );
+
+    void writeState( std::ostream& os ) const override;
+    bool readState( std::istream& is ) override;
 };
 
 }
@@ -23,6 +23,8 @@
 
 #include "predictor.hxx"
 
+#include <Main/StateSnapshot.hxx>
+
 using namespace FGXMLAutopilot;
 
 //------------------------------------------------------------------------------
@@ -79,5 +81,23 @@ void Predictor::update( bool firstTime, double dt )
 }
 
 
+void Predictor::writeState( std::ostream& os ) const
+{
+  AnalogComponent::writeState(os);
+  flightgear::snapshot::writeValue(os, _last_value);
+  flightgear::snapshot::writeValue(os, _average);
+}
+
+bool Predictor::readState( std::istream& is )
+{
+  if( !AnalogComponent::readState(is) )
+    return false;
+
+  _last_value = flightgear::snapshot::readValue<double>(is);
+  _average = flightgear::snapshot::readValue<double>(is);
+  return !is.fail();
+}
+
+
 // Register the subsystem.
 SGSubsystemMgr::Registrant<Predictor> registrantPredictor;
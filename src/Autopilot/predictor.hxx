@@ -65,6 +65,9 @@ public:
     static const char* staticSubsystemClassId() { return "predict-simple"; }
 
     void update( bool firstTime, double dt );
+
+    void writeState( std::ostream& os ) const override;
+    bool readState( std::istream& is ) override;
 };
 
 } // namespace FGXMLAutopilot
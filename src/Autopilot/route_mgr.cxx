@@ -538,8 +538,7 @@ void FGRouteMgr::update( double dt )
   }
   
   // use RoutePath to compute location of active WP
-  RoutePath path(_plan);
-  SGGeod wpPos = path.positionForIndex(_plan->currentIndex());
+  SGGeod wpPos = _plan->routePath().positionForIndex(_plan->currentIndex());
   double courseDeg, az2, distanceM;
   SGGeodesy::inverse(currentPos, wpPos, courseDeg, az2, distanceM);
 
@@ -1021,7 +1021,7 @@ void NavDisplay::processRoute()
 {
     _routeSources.clear();
     flightgear::FlightPlan* fp = _route->flightPlan();
-    RoutePath path(fp);
+    const RoutePath& path = fp->routePath();
     int current = _route->currentIndex();
     
     for (int l=0; l<fp->numLegs(); ++l) {
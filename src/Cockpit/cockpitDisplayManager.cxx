@@ -30,6 +30,7 @@
 
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
+#include <Main/PropertyTreeCache.hxx>
 
 #include "agradar.hxx"
 #include "NavDisplay.hxx"
@@ -71,7 +72,7 @@ void CockpitDisplayManager::init()
   SG_LOG( SG_COCKPIT, SG_INFO, "Reading cockpit displays from " << config );
 
   try {
-    readProperties( config, config_props );
+    flightgear::PropertyTreeCache::readProperties( config, config_props );
     if (!build(config_props)) {
       throw sg_exception(
                     "Detected an internal inconsistency in the instrumentation\n"
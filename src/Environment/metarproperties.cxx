@@ -31,6 +31,7 @@
 #include "environment.hxx"
 #include "atmosphere.hxx"
 #include "metarairportfilter.hxx"
+#include "metarstore.hxx"
 #include <simgear/scene/sky/cloud.hxx>
 #include <simgear/structure/exception.hxx>
 #include <simgear/misc/strutils.hxx>
@@ -232,6 +233,10 @@ void MetarProperties::set_metar( const char * metarString )
     }
     
     setMetar(m);
+
+    // keep the decoded report for ATIS and other per-station consumers, live
+    // reports get there through the real weather controller
+    MetarStore::instance()->insert( m, _station_elevation );
 }
     
 void MetarProperties::setMetar( SGSharedPtr<FGMetar> m )
@@ -0,0 +1,161 @@
+// metarstore.cxx -- typed in-memory store of decoded METAR reports
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "metarstore.hxx"
+#include "fgmetar.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/misc/strutils.hxx>
+#include <simgear/scene/sky/cloud.hxx>
+#include <simgear/structure/exception.hxx>
+
+#include <Airports/airport.hxx>
+
+using std::string;
+using std::vector;
+
+namespace Environment {
+
+MetarStore * MetarStore::instance()
+{
+    static MetarStore store;
+    return &store;
+}
+
+static const char * coverageString( SGMetarCloud::Coverage coverage )
+{
+    switch( coverage ) {
+        case SGMetarCloud::COVERAGE_FEW: return SGCloudLayer::SG_CLOUD_FEW_STRING;
+        case SGMetarCloud::COVERAGE_SCATTERED: return SGCloudLayer::SG_CLOUD_SCATTERED_STRING;
+        case SGMetarCloud::COVERAGE_BROKEN: return SGCloudLayer::SG_CLOUD_BROKEN_STRING;
+        case SGMetarCloud::COVERAGE_OVERCAST: return SGCloudLayer::SG_CLOUD_OVERCAST_STRING;
+        default: return SGCloudLayer::SG_CLOUD_CLEAR_STRING;
+    }
+}
+
+void MetarStore::insert( SGSharedPtr<FGMetar> m, double stationElevationFt )
+{
+    if( !m ) return;
+
+    const string id = simgear::strutils::uppercase( m->getId() );
+    auto it = _reports.find( id );
+    if( it != _reports.end() && it->second.time > m->getTime() ) {
+        return; // keep the newer report
+    }
+
+    if( stationElevationFt < -9000.0 ) {
+        FGAirport * a = FGAirport::findByIdent( id );
+        stationElevationFt = a ? a->getElevation() : 0.0;
+    }
+
+    MetarReport & r = _reports[id];
+    r = MetarReport();
+    r.stationId = id;
+    r.time = m->getTime();
+    r.day = m->getDay();
+    r.hour = m->getHour();
+    r.minute = m->getMinute();
+    r.windDeg = m->getWindDir();
+    r.windRangeFrom = m->getWindRangeFrom();
+    r.windRangeTo = m->getWindRangeTo();
+    r.windSpeedKt = m->getWindSpeed_kt();
+    r.gustSpeedKt = m->getGustSpeed_kt();
+    r.pressureInHg = m->getPressure_inHg();
+    r.cavok = m->getCAVOK();
+    r.minVisibilityM = m->getMinVisibility().getVisibility_m();
+    r.temperatureDegC = m->getTemperature_C();
+    r.dewpointDegC = m->getDewpoint_C();
+    r.stationElevationFt = stationElevationFt;
+    r.raw = m->getData();
+
+    for( const string & w : m->getWeather() ) {
+        if( false == r.phenomena.empty() ) r.phenomena.append(", ");
+        r.phenomena.append( w );
+    }
+
+    for( const SGMetarCloud & cloud : m->getClouds() ) {
+        if( cloud.getCoverage() == SGMetarCloud::COVERAGE_CLEAR ||
+            cloud.getCoverage() == SGMetarCloud::COVERAGE_NIL ) continue;
+        int elevation = cloud.getAltitude_ft() + stationElevationFt;
+        if( elevation > 0 ) r.clouds[elevation] = coverageString( cloud.getCoverage() );
+    }
+}
+
+vector<SGSharedPtr<FGMetar> > MetarStore::decode( const vector<string> & metars, unsigned threads )
+{
+    vector<SGSharedPtr<FGMetar> > result( metars.size() );
+    if( threads == 0 ) threads = std::max( 1u, std::thread::hardware_concurrency() );
+    threads = std::min<size_t>( threads, std::max<size_t>( 1, metars.size() / 64 ) );
+
+    // each worker grabs the next report; FGMetar parsing touches neither
+    // the property tree nor the navdata cache
+    std::atomic<size_t> next( 0 );
+    auto worker = [&]() {
+        for( size_t i = next++; i < metars.size(); i = next++ ) {
+            try {
+                result[i] = new FGMetar( simgear::strutils::strip( metars[i] ) );
+            }
+            catch( sg_exception & ) {
+                // leave empty
+            }
+        }
+    };
+
+    vector<std::thread> workers;
+    for( unsigned t = 1; t < threads; ++t ) {
+        workers.emplace_back( worker );
+    }
+    worker();
+    for( auto & t : workers ) {
+        t.join();
+    }
+    return result;
+}
+
+size_t MetarStore::insertBatch( const vector<string> & metars,
+                                vector<SGSharedPtr<FGMetar> > * decoded,
+                                unsigned threads )
+{
+    vector<SGSharedPtr<FGMetar> > result = decode( metars, threads );
+
+    size_t count = 0;
+    for( auto & m : result ) {
+        if( !m ) continue;
+        insert( m );
+        ++count;
+    }
+
+    SG_LOG( SG_ENVIRONMENT, SG_DEBUG, "MetarStore: added " << count << " of " << metars.size() << " reports" );
+    if( decoded ) decoded->swap( result );
+    return count;
+}
+
+const MetarReport * MetarStore::find( const string & stationId ) const
+{
+    auto it = _reports.find( simgear::strutils::uppercase( stationId ) );
+    return it == _reports.end() ? NULL : &it->second;
+}
+
+} // namespace Environment
@@ -0,0 +1,111 @@
+// metarstore.hxx -- typed in-memory store of decoded METAR reports
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifndef __METARSTORE_HXX
+#define __METARSTORE_HXX
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <simgear/structure/SGSharedPtr.hxx>
+
+class FGMetar;
+
+namespace Environment {
+
+/**
+ * A METAR report decoded once into plain values, as needed by the ATIS
+ * generators. Cloud layers are keyed by their elevation above MSL in feet.
+ */
+struct MetarReport
+{
+    std::string stationId;
+    time_t time = 0;
+    int day = 0;
+    int hour = 0;
+    int minute = 0;
+    int windDeg = 0;
+    int windRangeFrom = 0;
+    int windRangeTo = 0;
+    double windSpeedKt = 0.0;
+    double gustSpeedKt = 0.0;
+    double pressureInHg = 0.0;
+    bool cavok = false;
+    double minVisibilityM = 0.0;
+    std::string phenomena;
+    std::map<int, std::string> clouds;
+    double temperatureDegC = 0.0;
+    double dewpointDegC = 0.0;
+    double stationElevationFt = 0.0;
+    std::string raw;
+};
+
+/**
+ * Decoded METAR reports keyed by station, shared by everything that needs
+ * the weather at an airport. Reports are added as the real weather
+ * controller receives them, decoding everything that arrived in a frame as
+ * one batch, or from a METAR set through the property tree.
+ *
+ * Access is from the main thread only.
+ */
+class MetarStore
+{
+public:
+    static MetarStore * instance();
+
+    /**
+     * Add a decoded report, replacing an older report of the same station.
+     * The station elevation is looked up in the airport database unless
+     * given.
+     */
+    void insert( SGSharedPtr<FGMetar> metar, double stationElevationFt = -9999.0 );
+
+    /**
+     * Decode a batch of METAR strings in parallel and add them. Undecodable
+     * reports are skipped.
+     * @param decoded if given, receives the decoded reports in the order of
+     *        metars, with a null pointer for each report that failed
+     * @param threads number of decoder threads, 0 for one per core
+     * @return number of reports added
+     */
+    size_t insertBatch( const std::vector<std::string> & metars,
+                        std::vector<SGSharedPtr<FGMetar> > * decoded = nullptr,
+                        unsigned threads = 0 );
+
+    /**
+     * Decode METAR strings in parallel, without touching the property tree
+     * or the airport database. Failed reports yield a null pointer.
+     */
+    static std::vector<SGSharedPtr<FGMetar> > decode( const std::vector<std::string> & metars, unsigned threads = 0 );
+
+    /// @return the report for the given station, or NULL
+    const MetarReport * find( const std::string & stationId ) const;
+
+    size_t size() const { return _reports.size(); }
+    void clear() { _reports.clear(); }
+
+private:
+    MetarStore() {}
+
+    std::unordered_map<std::string, MetarReport> _reports;
+};
+
+} // namespace Environment
+
+#endif // __METARSTORE_HXX
@@ -40,6 +40,7 @@
 #include "metarproperties.hxx"
 #include "metarairportfilter.hxx"
 #include "fgmetar.hxx"
+#include "metarstore.hxx"
 #include <Network/HTTPClient.hxx>
 #include <Main/fg_props.hxx>
 #include <Main/sentryIntegration.hxx>
@@ -66,6 +67,15 @@ public:
     // implementation of MetarDataHandler
     virtual void handleMetarData( const std::string & data );
     virtual void handleMetarFailure();
+
+    /**
+     * Hand over the METAR received since the last call, if any. The
+     * controller decodes the data of all stations in one batch.
+     */
+    bool takeReceivedData( std::string & data );
+
+    /// Apply a decoded METAR, or flag a failure if it could not be decoded
+    void applyMetar( SGSharedPtr<FGMetar> m, const std::string & data );
   
     static const unsigned MAX_POLLING_INTERVAL_SECONDS = 10;
     static const unsigned DEFAULT_TIME_TO_LIVE_SECONDS = 900;
@@ -76,6 +86,7 @@ private:
     MetarRequester * _metarRequester;
     int _maxAge;
     bool _failure;
+    std::string _receivedData;
 };
 
 typedef SGSharedPtr<LiveMetarProperties> LiveMetarProperties_ptr;
@@ -122,12 +133,20 @@ void LiveMetarProperties::handleMetarData( const std::string & data )
 {
     SG_LOG( SG_ENVIRONMENT, SG_DEBUG, "LiveMetarProperties::handleMetarData() received METAR for " << getStationId() << ": " << data );
     _timeToLive = DEFAULT_TIME_TO_LIVE_SECONDS;
-    
-    SGSharedPtr<FGMetar> m;
-    try {
-        m = new FGMetar(data.c_str());
-    }
-    catch( sg_io_exception  &) {
+    _receivedData = data;
+}
+
+bool LiveMetarProperties::takeReceivedData( std::string & data )
+{
+    if( _receivedData.empty() ) return false;
+    data.swap( _receivedData );
+    _receivedData.clear();
+    return true;
+}
+
+void LiveMetarProperties::applyMetar( SGSharedPtr<FGMetar> m, const std::string & data )
+{
+    if( !m ) {
         SG_LOG( SG_ENVIRONMENT, SG_WARN, "Can't parse metar: " << data );
         flightgear::sentryReportException("Failed to parse live METAR", data);
         _failure = true;
@@ -180,6 +199,7 @@ public:
 
 protected:
     void checkNearbyMetar();
+    void applyReceivedMetars();
 
     long getMetarMaxAgeMin() const { return _max_age_n == NULL ? 0 : _max_age_n->getLongValue(); }
 
@@ -317,6 +337,30 @@ void BasicRealWxController::update( double dt )
   } else {
     _wasEnabled = false;
   }
+
+  applyReceivedMetars();
+}
+
+void BasicRealWxController::applyReceivedMetars()
+{
+  // decode all reports received since the last frame in one go, this also
+  // keeps them in the METAR store
+  std::vector<LiveMetarProperties_ptr> receivers;
+  std::vector<std::string> metars;
+  for( auto p : _metarProperties ) {
+    std::string data;
+    if( p->takeReceivedData( data ) ) {
+      receivers.push_back( p );
+      metars.push_back( data );
+    }
+  }
+  if( metars.empty() ) return;
+
+  std::vector<SGSharedPtr<FGMetar> > decoded;
+  MetarStore::instance()->insertBatch( metars, &decoded );
+  for( size_t i = 0; i < receivers.size(); ++i ) {
+    receivers[i]->applyMetar( decoded[i], metars[i] );
+  }
 }
 
 void BasicRealWxController::addMetarAtPath(const string& propPath, const string& icao)
@@ -43,6 +43,7 @@
 #include <Aircraft/controls.hxx>
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
+#include <Main/StateSnapshot.hxx>
 
 #include "JSBSim.hxx"
 #include <FDM/JSBSim/FGFDMExec.h>
@@ -410,6 +411,11 @@ void FGJSBsim::init()
 
     fgic->SetWindNEDFpsIC(0.0, 0.0, 0.0);
 
+    if (fgGetBool("/sim/time/lock-step/enabled")) {
+      // turbulence and sensor noise repeat exactly between runs
+      fdmex->SRand(fgGetInt("/sim/time/lock-step/seed", 1));
+    }
+
     SG_LOG(SG_FLIGHT,SG_INFO,"T,p,rho: " << Atmosphere->GetTemperature()
      << ", " << Atmosphere->GetPressure()
      << ", " << Atmosphere->GetDensity() );
@@ -1038,6 +1044,69 @@ bool FGJSBsim::ToggleDataLogging(bool state)
     }
 }
 
+namespace {
+
+void writeVector(std::ostream& os, const JSBSim::FGColumnVector3& v)
+{
+    for (unsigned int i = 1; i <= 3; ++i) {
+        flightgear::snapshot::writeValue(os, v(i));
+    }
+}
+
+JSBSim::FGColumnVector3 readVector(std::istream& is)
+{
+    JSBSim::FGColumnVector3 v;
+    for (unsigned int i = 1; i <= 3; ++i) {
+        v(i) = flightgear::snapshot::readValue<double>(is);
+    }
+    return v;
+}
+
+} // of anonymous namespace
+
+void FGJSBsim::saveSnapshot(std::ostream& os)
+{
+    FGInterface::saveSnapshot(os);
+
+    const JSBSim::FGPropagate::VehicleState& state = Propagate->GetVState();
+    flightgear::snapshot::writeValue(os, fdmex->GetSimTime());
+    writeVector(os, state.vLocation);
+    writeVector(os, state.vUVW);
+    writeVector(os, state.vPQR);
+    for (unsigned int i = 1; i <= 4; ++i) {
+        flightgear::snapshot::writeValue(os, state.qAttitudeECI(i));
+    }
+    writeVector(os, state.vInertialPosition);
+}
+
+bool FGJSBsim::restoreSnapshot(std::istream& is)
+{
+    if (!restoreFlightState(is)) {
+        return false;
+    }
+
+    JSBSim::FGPropagate::VehicleState state = Propagate->GetVState();
+    const double simTime = flightgear::snapshot::readValue<double>(is);
+    state.vLocation = readVector(is);
+    state.vUVW = readVector(is);
+    state.vPQR = readVector(is);
+    for (unsigned int i = 1; i <= 4; ++i) {
+        state.qAttitudeECI(i) = flightgear::snapshot::readValue<double>(is);
+    }
+    state.vInertialPosition = readVector(is);
+    if (!is) {
+        return false;
+    }
+
+    // the multi-step integrator history is not part of the snapshot: it
+    // restarts from the restored state, as after a reposition
+    fdmex->Setsim_time(simTime);
+    Propagate->SetVState(state);
+    Propagate->InitializeDerivatives();
+    copy_from_JSBsim();
+    return true;
+}
+
 
 //Positions
 void FGJSBsim::set_Latitude(double lat)
@@ -212,6 +212,9 @@ public:
     bool ToggleDataLogging(bool state);
     bool ToggleDataLogging(void);
 
+    void saveSnapshot(std::ostream& os) override;
+    bool restoreSnapshot(std::istream& is) override;
+
     double get_agl_ft(double t, const JSBSim::FGColumnVector3& loc,
                       double alt_off, double contact[3], double normal[3],
                       double vel[3], double angularVel[3]);
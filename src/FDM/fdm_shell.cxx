@@ -33,6 +33,7 @@
 #include <Aircraft/replay.hxx>
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
+#include <Main/FrameProfiler.hxx>
 #include <Scenery/scenery.hxx>
 #include "AIModel/AIManager.hxx"
 #include "AIModel/AIAircraft.hxx"
@@ -260,10 +261,13 @@ void FDMShell::update(double dt)
 
   switch(_replay_master->getIntValue())
   {
-      case 0:
+      case 0: {
           // normal FDM operation
+          static const int fdmScope = flightgear::FrameProfiler::scopeId("flight/fdm");
+          flightgear::FrameProfiler::Scope profile(fdmScope);
           _impl->update(dt);
           break;
+      }
       case 3:
           // resume FDM operation at current replay position
           _impl->reinit();
@@ -281,6 +285,35 @@ FGInterface* FDMShell::getInterface() const
     return _impl;
 }
 
+void FDMShell::saveSnapshot(std::ostream& os)
+{
+    const bool haveState = _impl && _impl->get_inited();
+    flightgear::snapshot::writeValue(os, haveState);
+    if (haveState) {
+        _impl->saveSnapshot(os);
+    }
+}
+
+bool FDMShell::restoreSnapshot(std::istream& is)
+{
+    const bool haveState = flightgear::snapshot::readValue<bool>(is);
+    if (!haveState) {
+        return true;
+    }
+
+    if (!_impl || !_impl->get_inited()) {
+        SG_LOG(SG_FLIGHT, SG_WARN, "FDM not initialised, can't restore its state");
+        return false;
+    }
+
+    if (!_impl->restoreSnapshot(is)) {
+        return false;
+    }
+
+    _lastValidPos = _impl->getPosition();
+    return true;
+}
+
 void FDMShell::createImplementation()
 {
   assert(!_impl);
@@ -26,6 +26,8 @@
 #include <simgear/math/SGGeod.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
 
+#include <Main/StateSnapshot.hxx>
+
 #include "TankProperties.hxx"
 
 // forward decls
@@ -40,7 +42,8 @@ class FGAIManager;
  * This class also provides the factory method which creates the
  * specific FDM class (createImplementation)
  */
-class FDMShell : public SGSubsystem
+class FDMShell : public SGSubsystem,
+                 public flightgear::StateSnapshotParticipant
 {
 public:
     FDMShell();
@@ -60,6 +63,10 @@ public:
 
     FGInterface* getInterface() const;
 
+    // StateSnapshotParticipant API.
+    void saveSnapshot(std::ostream& os) override;
+    bool restoreSnapshot(std::istream& is) override;
+
 private:
     void createImplementation();
 
@@ -26,6 +26,9 @@
 
 #include "flight.hxx"
 
+#include <istream>
+#include <ostream>
+
 #include <simgear/constants.h>
 #include <simgear/debug/logstream.hxx>
 #include <simgear/timing/timestamp.hxx>
@@ -483,6 +486,40 @@ bool FGInterface::writeState(SGIOChannel* io)
     return true;
 }
 
+void FGInterface::saveSnapshot(std::ostream& os)
+{
+    // the raw state, so record its size: snapshots saved by a build with
+    // a different layout are refused
+    const uint32_t size = sizeof(FlightState);
+    os.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    os.write(reinterpret_cast<const char*>(&_state), sizeof(FlightState));
+}
+
+bool FGInterface::restoreSnapshot(std::istream& is)
+{
+    SG_LOG(SG_FLIGHT, SG_WARN, "This FDM does not support restoring state snapshots");
+    return false;
+}
+
+bool FGInterface::restoreFlightState(std::istream& is)
+{
+    uint32_t size = 0;
+    is.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (!is || (size != sizeof(FlightState))) {
+        SG_LOG(SG_FLIGHT, SG_WARN, "State snapshot flight state has a different layout ("
+               << size << " bytes instead of " << sizeof(FlightState) << ")");
+        return false;
+    }
+
+    FlightState buf;
+    if (!is.read(reinterpret_cast<char*>(&buf), sizeof(FlightState))) {
+        return false;
+    }
+
+    _state = buf;
+    return true;
+}
+
 void FGInterface::_updatePositionM(const SGVec3d& cartPos)
 {
     TrackComputer tracker( _state.track, _state.path, _state.geodetic_position_v );
@@ -74,6 +74,7 @@
 
 
 #include <cmath>
+#include <iosfwd>
 
 #include <simgear/compiler.h>
 #include <simgear/constants.h>
@@ -401,6 +402,21 @@ public:
 
     bool readState(SGIOChannel* io);
     bool writeState(SGIOChannel* io);
+
+    /**
+     * save and restore the complete state, for state snapshots. The base
+     * class saves the common flight state, but can't restore from it: the
+     * next update would overwrite it from the FDM's own model. FDMs which
+     * support snapshots override both, and use restoreFlightState().
+     */
+    virtual void saveSnapshot(std::ostream& os);
+    virtual bool restoreSnapshot(std::istream& is);
+
+protected:
+    /// the common flight state, as written by FGInterface::saveSnapshot
+    bool restoreFlightState(std::istream& is);
+
+public:
     
     // Define the various supported flight models (many not yet implemented)
     enum {
@@ -20,7 +20,9 @@
 
 #include "LocalAircraftCache.hxx"
 
+#include <atomic>
 #include <cassert>
+#include <thread>
 
 #include <QDir>
 #include <QThread>
@@ -39,7 +41,7 @@
 #include <simgear/props/props_io.hxx>
 #include <simgear/structure/exception.hxx>
 
-static quint32 CACHE_VERSION = 13;
+static quint32 CACHE_VERSION = 14;
 
 const std::vector<QByteArray> static_localizedStringTags = {"name", "desc"};
 
@@ -68,7 +70,9 @@ bool AircraftItem::initFromFile(QDir dir, QString filePath)
     SGPropertyNode_ptr sim = root.getNode("sim");
 
     path = filePath;
-    pathModTime = QFileInfo(path).lastModified();
+    const QFileInfo info(path);
+    pathModTime = info.lastModified();
+    pathSize = info.size();
     if (sim->getBoolValue("exclude-from-gui", false)) {
         excluded = true;
         return false;
@@ -215,7 +219,7 @@ QString AircraftItem::baseName() const
 
 void AircraftItem::fromDataStream(QDataStream& ds)
 {
-    ds >> path >> pathModTime >> excluded;
+    ds >> path >> pathModTime >> pathSize >> excluded;
     if (excluded) {
         return;
     }
@@ -235,7 +239,7 @@ void AircraftItem::fromDataStream(QDataStream& ds)
 
 void AircraftItem::toDataStream(QDataStream& ds) const
 {
-    ds << path << pathModTime << excluded;
+    ds << path << pathModTime << pathSize << excluded;
     if (excluded) {
         return;
     }
@@ -299,7 +303,7 @@ public:
     {
         Q_UNUSED(aContext)
 
-        SGPath ap = _currentAircraftPath / aResource;
+        SGPath ap = static_currentAircraftPath / aResource;
         if (ap.exists())
             return ap;
 
@@ -321,16 +325,19 @@ public:
         _currentScanPath = p;
     }
 
-    void setCurrentAircraftPath(const SGPath& p)
+    // per thread, since -set.xml files are parsed in parallel
+    static void setCurrentAircraftPath(const SGPath& p)
     {
-        _currentAircraftPath = p;
+        static_currentAircraftPath = p;
     }
 
 private:
     SGPath _currentScanPath;
-    SGPath _currentAircraftPath;
+    static thread_local SGPath static_currentAircraftPath;
 };
 
+thread_local SGPath ScanDirProvider::static_currentAircraftPath;
+
 class OtherAircraftDirsProvider : public simgear::ResourceProvider
 {
 public:
@@ -439,7 +446,8 @@ private:
                 item->fromDataStream(ds);
 
                 QFileInfo finfo(item->path);
-                if (finfo.exists() && (finfo.lastModified() == item->pathModTime)) {
+                if (finfo.exists() && (finfo.lastModified() == item->pathModTime) &&
+                    (finfo.size() == item->pathSize)) {
                     // corresponding -set.xml file still exists and is
                     // unmodified
                     m_cachedItems[item->path] = item;
@@ -465,6 +473,51 @@ private:
         settings.setValue("aircraft-cache", cacheData);
     }
 
+    struct ParseJob
+    {
+        QDir dir;
+        QString path;
+        SGPath aircraftPath;
+        AircraftItemPtr item;
+    };
+
+    // parse -set.xml files which were not in the cache, in parallel: on
+    // large aircraft collections this dominates the scan
+    void parseSetFiles(std::vector<ParseJob>& jobs)
+    {
+        unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min<size_t>(threads, jobs.size());
+
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            flightgear::sentryThreadReportXMLErrors(false);
+            for (size_t i = next++; (i < jobs.size()) && !m_done; i = next++) {
+                ParseJob& job = jobs[i];
+                // ensure aircraft dir is available to simgear::ResourceProvider
+                // otherwise some aircraft -set.xml includes fail
+                ScanDirProvider::setCurrentAircraftPath(job.aircraftPath);
+                try {
+                    AircraftItemPtr item(new AircraftItem);
+                    if (item->initFromFile(job.dir, job.path)) {
+                        job.item = item;
+                    }
+                } catch (sg_exception& e) {
+                    qWarning() << "Problems occurred while parsing" << job.path << "(skipping)"
+                               << "\n\t" << QString::fromStdString(e.what());
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned int t = 1; t < threads; ++t) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : workers) {
+            t.join();
+        }
+    }
+
     void scanAircraftDir(QDir path)
     {
         //QTime t;
@@ -472,53 +525,65 @@ private:
 
         QStringList filters;
         filters << "*-set.xml";
+
+        // list the -set.xml files, and collect the ones needing a parse
+        QVector<QPair<QFileInfo, QFileInfoList>> aircraftDirs;
+        std::vector<ParseJob> jobs;
         Q_FOREACH(QFileInfo child, path.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
             QDir childDir(child.absoluteFilePath());
-            QMap<QString, AircraftItemPtr> baseAircraft;
-            QList<AircraftItemPtr> variants;
+            const QFileInfoList setFiles = childDir.entryInfoList(filters, QDir::Files);
+            aircraftDirs.append(qMakePair(child, setFiles));
 
-            // ensure aircraft dir is available to simgear::ResourceProvider
-            // otherwise some aircraft -set.xml includes fail
             const auto p = SGPath::fromUtf8(child.absoluteFilePath().toUtf8().toStdString());
-            m_currentScanDir->setCurrentAircraftPath(p);
+            Q_FOREACH(QFileInfo xmlChild, setFiles) {
+                // should we re-stat here? But we already did so when loading
+                // the cache and dropped any non-valid entries
+                if (!m_cachedItems.contains(xmlChild.absoluteFilePath())) {
+                    jobs.push_back({childDir, xmlChild.absoluteFilePath(), p, {}});
+                }
+            }
 
-            Q_FOREACH(QFileInfo xmlChild, childDir.entryInfoList(filters, QDir::Files)) {
-                try {
-                    QString absolutePath = xmlChild.absoluteFilePath();
-                    AircraftItemPtr item;
-
-                    // should we re-stat here? But we already did so when loading
-                    // the cache and dropped any non-valid entries
-                    if (m_cachedItems.contains(absolutePath)) {
-                        item = m_cachedItems.value(absolutePath);
-                    } else {
-                        // scan the cached item
-                        item = AircraftItemPtr(new AircraftItem);
-                        bool ok = item->initFromFile(childDir, absolutePath);
-                        if (!ok) {
-                            continue;
-                        }
-                    }
+            if (m_done) { // thread termination bail-out
+                return;
+            }
+        }
 
-                    m_nextCache[absolutePath] = item;
+        parseSetFiles(jobs);
+        if (m_done) {
+            return;
+        }
 
-                    if (item->excluded) {
-                        continue;
-                    }
+        QMap<QString, AircraftItemPtr> parsedItems;
+        for (const auto& job : jobs) {
+            if (job.item) {
+                parsedItems.insert(job.path, job.item);
+            }
+        }
 
-                    if (item->isPrimary) {
-                        baseAircraft.insert(item->baseName(), item);
-                    } else {
-                        variants.append(item);
+        for (const auto& aircraftDir : aircraftDirs) {
+            QMap<QString, AircraftItemPtr> baseAircraft;
+            QList<AircraftItemPtr> variants;
+
+            Q_FOREACH(QFileInfo xmlChild, aircraftDir.second) {
+                QString absolutePath = xmlChild.absoluteFilePath();
+                AircraftItemPtr item = m_cachedItems.value(absolutePath);
+                if (!item) {
+                    item = parsedItems.value(absolutePath);
+                    if (!item) {
+                        continue; // failed to parse, or excluded
                     }
-                } catch (sg_exception& e) {
-                    qWarning() << "Problems occurred while parsing" << xmlChild.absoluteFilePath() << "(skipping)"
-                               << "\n\t" << QString::fromStdString(e.what());
+                }
+
+                m_nextCache[absolutePath] = item;
+
+                if (item->excluded) {
                     continue;
                 }
 
-                if (m_done) { // thread termination bail-out
-                    return;
+                if (item->isPrimary) {
+                    baseAircraft.insert(item->baseName(), item);
+                } else {
+                    variants.append(item);
                 }
             } // of set.xml iteration
 
@@ -555,7 +620,7 @@ private:
     QMap<QString, AircraftItemPtr > m_cachedItems;
     QMap<QString, AircraftItemPtr > m_nextCache;
 
-    bool m_done;
+    std::atomic<bool> m_done;
     std::unique_ptr<ScanDirProvider> m_currentScanDir;
 };
 
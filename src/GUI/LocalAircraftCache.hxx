@@ -63,6 +63,7 @@ struct AircraftItem
     int ratings[4] = {0, 0, 0, 0};
     QString variantOf;
     QDateTime pathModTime;
+    qint64 pathSize = 0;
     QList<AircraftItemPtr> variants;
     bool usesHeliports = false;
     bool usesSeaports = false;
@@ -33,8 +33,10 @@
 
 #include <ATC/CommStation.hxx>
 #include <ATC/MetarPropertiesATISInformationProvider.hxx>
+#include <ATC/MetarStoreATISInformationProvider.hxx>
 #include <ATC/CurrentWeatherATISInformationProvider.hxx>
 #include <Airports/airport.hxx>
+#include <Environment/metarstore.hxx>
 #include <Main/fg_props.hxx>
 #include <Navaids/navlist.hxx>
 
@@ -81,6 +83,8 @@ private:
 AtisSpeaker::AtisSpeaker()
 {
   _synthesizeRequest.listener = this;
+  // ATIS is long and repeated in a loop, let ATC instructions go first
+  _synthesizeRequest.priority = SynthesizeRequest::PRIORITY_ATIS;
   if (!fgHasNode("/sim/atis/speed"))    fgSetDouble("/sim/atis/speed", 1);
   if (!fgHasNode("/sim/atis/pitch"))    fgSetDouble("/sim/atis/pitch", 1);
   if (!fgHasNode("/sim/atis/enabled"))  fgSetBool("/sim/atis/enabled", true);
@@ -339,8 +343,20 @@ void MetarBridge::valueChanged(SGPropertyNode * node)
   if (responseId != _requestedId) return;
 
   if ( NULL != _atisNode) {
-    MetarPropertiesATISInformationProvider provider(_metarPropertiesNode);
-    _atisNode->setStringValue(_atisEncoder.encodeATIS(&provider));
+    // prefer the report as decoded by the metar store over reading it back
+    // from the properties, unless the properties replaced the visibility
+    // by that above a fog/mist/haze ground layer, which the store doesn't
+    const bool groundLayer = _metarPropertiesNode->getBoolValue("set-ground-cloud-layer", false) &&
+                             !fgGetBool("/sim/rendering/clouds3d-enable", false);
+    const Environment::MetarReport * report = groundLayer ? NULL :
+        Environment::MetarStore::instance()->find(responseId);
+    if (report) {
+      MetarStoreATISInformationProvider provider(*report);
+      _atisNode->setStringValue(_atisEncoder.encodeATIS(&provider));
+    } else {
+      MetarPropertiesATISInformationProvider provider(_metarPropertiesNode);
+      _atisNode->setStringValue(_atisEncoder.encodeATIS(&provider));
+    }
   }
 }
 
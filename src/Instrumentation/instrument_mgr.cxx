@@ -18,6 +18,7 @@
 
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
+#include <Main/PropertyTreeCache.hxx>
 #include <Main/util.hxx>
 
 #include "instrument_mgr.hxx"
@@ -81,7 +82,7 @@ void FGInstrumentMgr::init()
   SG_LOG( SG_COCKPIT, SG_INFO, "Reading instruments from " << config );
 
   try {
-    readProperties( config, config_props );
+    flightgear::PropertyTreeCache::readProperties( config, config_props );
     if (!build(config_props)) {
       throw sg_exception(
                     "Detected an internal inconsistency in the instrumentation\n"
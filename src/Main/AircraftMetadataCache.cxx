@@ -0,0 +1,353 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "AircraftMetadataCache.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/props/props.hxx>
+#include <simgear/props/props_io.hxx>
+#include <simgear/structure/exception.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Main/AircraftDirVisitorBase.hxx>
+#include <Main/BinaryIO.hxx>
+#include <Main/globals.hxx>
+#include <Main/sentryIntegration.hxx>
+
+namespace flightgear {
+
+namespace {
+
+const char CACHE_MAGIC[8] = {'F', 'G', 'A', 'C', 'M', 'E', 'T', 'A'};
+const uint32_t CACHE_VERSION = 3;
+
+class SetFileCollector : public AircraftDirVistorBase
+{
+public:
+    simgear::PathList collect(const simgear::PathList& dirs)
+    {
+        for (const auto& d : dirs) {
+            visitDir(d, 0);
+        }
+
+        return _setFiles;
+    }
+
+private:
+    VisitResult visit(const SGPath& path) override
+    {
+        _setFiles.push_back(path);
+        return VISIT_CONTINUE;
+    }
+
+    simgear::PathList _setFiles;
+};
+
+// the prefix of all paths under an aircraft directory
+std::string dirPrefix(const SGPath& dir)
+{
+    std::string prefix = dir.utf8Str();
+    if (!prefix.empty() && (prefix.back() != '/')) {
+        prefix += '/';
+    }
+
+    return prefix;
+}
+
+bool isCurrent(const AircraftMetadata& m, const SGPath& path)
+{
+    return (m.modTime == path.modTime()) && (m.size == path.sizeInBytes());
+}
+
+using binary::readString;
+using binary::readValue;
+using binary::writeString;
+using binary::writeValue;
+
+} // of anonymous namespace
+
+AircraftMetadataCache::AircraftMetadataCache(const SGPath& cacheFile) :
+    _cacheFile(cacheFile)
+{
+    load();
+}
+
+SGPath AircraftMetadataCache::defaultCachePath()
+{
+    return globals->get_fg_home() / "aircraft-metadata.cache";
+}
+
+simgear::PathList AircraftMetadataCache::findSetFiles(const simgear::PathList& dirs)
+{
+    return SetFileCollector().collect(dirs);
+}
+
+std::vector<AircraftMetadata> AircraftMetadataCache::update(const simgear::PathList& setFiles, unsigned threads)
+{
+    std::vector<AircraftMetadata> result(setFiles.size());
+    std::vector<size_t> toParse;
+    for (size_t i = 0; i < setFiles.size(); ++i) {
+        const SGPath& p = setFiles.at(i);
+        auto it = _entries.find(p.utf8Str());
+        if ((it != _entries.end()) && p.exists() && isCurrent(it->second, p)) {
+            result[i] = it->second;
+        } else {
+            toParse.push_back(i);
+        }
+    }
+
+    if (toParse.empty()) {
+        return result;
+    }
+
+    SGTimeStamp st;
+    st.stamp();
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<size_t>(threads, toParse.size());
+
+    // each worker grabs the next file; parsing only builds a property tree
+    // private to the worker
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        flightgear::sentryThreadReportXMLErrors(false);
+        for (size_t i = next++; i < toParse.size(); i = next++) {
+            result[toParse[i]] = parse(setFiles.at(toParse[i]));
+        }
+        flightgear::sentryThreadReportXMLErrors(true);
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    for (size_t i : toParse) {
+        const std::string key = setFiles.at(i).utf8Str();
+        if (result[i].size == 0) {
+            // no such file
+            _entries.erase(key);
+        } else {
+            _entries[key] = result[i];
+        }
+    }
+
+    _modified = true;
+    SG_LOG(SG_GENERAL, SG_INFO, "AircraftMetadataCache: parsed " << toParse.size() << " of "
+           << setFiles.size() << " -set.xml files in " << st.elapsedMSec() << "msec");
+    return result;
+}
+
+void AircraftMetadataCache::markScanned(const simgear::PathList& dirs)
+{
+    for (const auto& d : dirs) {
+        _modified |= _scannedDirs.insert(dirPrefix(d)).second;
+    }
+}
+
+SGPath AircraftMetadataCache::findSetFile(const std::string& fileName, const simgear::PathList& dirs) const
+{
+    for (const auto& d : dirs) {
+        const std::string prefix = dirPrefix(d);
+        if (_scannedDirs.find(prefix) == _scannedDirs.end()) {
+            // an uncached -set.xml here would take priority over any
+            // match further down
+            return {};
+        }
+
+        for (auto it = _entries.lower_bound(prefix); it != _entries.end(); ++it) {
+            if (!simgear::strutils::starts_with(it->first, prefix)) {
+                break;
+            }
+
+            const AircraftMetadata& m = it->second;
+            // like the directory scan, this does not require a <sim> element
+            if (!m.parsed || !simgear::strutils::iequals(m.path.file(), fileName)) {
+                continue;
+            }
+
+            if (m.path.exists() && isCurrent(m, m.path)) {
+                return m.path;
+            }
+        }
+    }
+
+    return {};
+}
+
+AircraftMetadata AircraftMetadataCache::parse(const SGPath& path)
+{
+    AircraftMetadata m;
+    m.path = path;
+    if (!path.exists()) {
+        return m;
+    }
+
+    m.modTime = path.modTime();
+    m.size = path.sizeInBytes();
+
+    SGPropertyNode root;
+    try {
+        readProperties(path, &root);
+    } catch (sg_exception& e) {
+        SG_LOG(SG_GENERAL, SG_WARN, "Problems occurred while parsing " << path << " (skipping): "
+               << e.getFormattedMessage());
+        return m;
+    }
+
+    m.parsed = true;
+    const SGPropertyNode* sim = root.getNode("sim");
+    if (!sim) {
+        SG_LOG(SG_GENERAL, SG_WARN, "-set.xml has no <sim> element: " << path);
+        return m;
+    }
+
+    m.valid = true;
+    m.excluded = sim->getBoolValue("exclude-from-gui", false);
+    m.isPrimary = sim->getBoolValue("primary-set", !sim->hasChild("variant-of"));
+    m.description = simgear::strutils::strip(sim->getStringValue("description"));
+    m.longDescription = simgear::strutils::strip(sim->getStringValue("long-description"));
+    m.author = sim->getStringValue("author");
+    m.status = sim->getStringValue("status");
+    m.variantOf = sim->getStringValue("variant-of");
+    m.minimumFGVersion = sim->getStringValue("minimum-fg-version");
+
+    const SGPropertyNode* tags = sim->getChild("tags");
+    if (tags) {
+        for (const auto& t : tags->getChildren("tag")) {
+            m.tags.push_back(t->getStringValue());
+        }
+    }
+
+    return m;
+}
+
+void AircraftMetadataCache::load()
+{
+    if (!_cacheFile.exists()) {
+        return;
+    }
+
+    sg_ifstream is(_cacheFile, std::ios::in | std::ios::binary);
+    char magic[8];
+    is.read(magic, sizeof(magic));
+    if (!is || memcmp(magic, CACHE_MAGIC, sizeof(magic)) ||
+        (readValue<uint32_t>(is) != CACHE_VERSION))
+    {
+        SG_LOG(SG_GENERAL, SG_INFO, "AircraftMetadataCache: ignoring incompatible cache " << _cacheFile);
+        return;
+    }
+
+    std::set<std::string> scannedDirs;
+    const uint32_t dirCount = readValue<uint32_t>(is);
+    for (uint32_t i = 0; is && (i < dirCount); ++i) {
+        scannedDirs.insert(readString(is));
+    }
+
+    std::map<std::string, AircraftMetadata> entries;
+    const uint32_t count = readValue<uint32_t>(is);
+    for (uint32_t i = 0; is && (i < count); ++i) {
+        AircraftMetadata m;
+        m.path = SGPath::fromUtf8(readString(is));
+        m.modTime = readValue<int64_t>(is);
+        m.size = readValue<uint64_t>(is);
+        const uint8_t flags = readValue<uint8_t>(is);
+        m.valid = flags & 1;
+        m.excluded = flags & 2;
+        m.isPrimary = flags & 4;
+        m.parsed = flags & 8;
+        m.description = readString(is);
+        m.longDescription = readString(is);
+        m.author = readString(is);
+        m.status = readString(is);
+        m.variantOf = readString(is);
+        m.minimumFGVersion = readString(is);
+        const uint32_t tagCount = readValue<uint32_t>(is);
+        for (uint32_t t = 0; is && (t < tagCount); ++t) {
+            m.tags.push_back(readString(is));
+        }
+
+        entries[m.path.utf8Str()] = m;
+    }
+
+    if (!is) {
+        SG_LOG(SG_GENERAL, SG_WARN, "AircraftMetadataCache: corrupt cache " << _cacheFile);
+        return;
+    }
+
+    _entries.swap(entries);
+    _scannedDirs.swap(scannedDirs);
+}
+
+bool AircraftMetadataCache::save()
+{
+    if (!_modified) {
+        return true;
+    }
+
+    const bool ok = binary::writeFileReplacing(_cacheFile, [this](std::ostream& os) {
+        os.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        writeValue(os, CACHE_VERSION);
+        writeValue(os, static_cast<uint32_t>(_scannedDirs.size()));
+        for (const auto& d : _scannedDirs) {
+            writeString(os, d);
+        }
+
+        writeValue(os, static_cast<uint32_t>(_entries.size()));
+        for (const auto& e : _entries) {
+            const AircraftMetadata& m = e.second;
+            writeString(os, e.first);
+            writeValue(os, m.modTime);
+            writeValue(os, m.size);
+            const uint8_t flags = (m.valid ? 1 : 0) | (m.excluded ? 2 : 0) | (m.isPrimary ? 4 : 0) |
+                                  (m.parsed ? 8 : 0);
+            writeValue(os, flags);
+            writeString(os, m.description);
+            writeString(os, m.longDescription);
+            writeString(os, m.author);
+            writeString(os, m.status);
+            writeString(os, m.variantOf);
+            writeString(os, m.minimumFGVersion);
+            writeValue(os, static_cast<uint32_t>(m.tags.size()));
+            for (const auto& t : m.tags) {
+                writeString(os, t);
+            }
+        }
+    });
+
+    if (!ok) {
+        SG_LOG(SG_GENERAL, SG_WARN, "AircraftMetadataCache: unable to write " << _cacheFile);
+        return false;
+    }
+
+    _modified = false;
+    return true;
+}
+
+} // namespace flightgear
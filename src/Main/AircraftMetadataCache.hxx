@@ -0,0 +1,115 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <simgear/misc/sg_path.hxx>
+#include <simgear/misc/strutils.hxx>
+
+namespace flightgear {
+
+/**
+ * What we need to know about an aircraft -set.xml without loading it:
+ * enough to list aircraft, and to resolve --aircraft.
+ */
+struct AircraftMetadata
+{
+    SGPath path;            ///< the -set.xml file
+    int64_t modTime = 0;
+    uint64_t size = 0;
+
+    bool parsed = false;    ///< read as a property list
+    bool valid = false;     ///< parsed, and has a <sim> element
+    bool excluded = false;  ///< /sim/exclude-from-gui
+    bool isPrimary = true;
+    std::string description;
+    std::string longDescription;
+    std::string author;
+    std::string status;
+    std::string variantOf;
+    std::string minimumFGVersion;
+    string_list tags;
+};
+
+/**
+ * A persistent cache of aircraft metadata, in FG_HOME. Entries are keyed
+ * by the path, modification time and size of the -set.xml file, so on
+ * large (or remote) aircraft collections only new and changed files are
+ * parsed; those are parsed in parallel.
+ *
+ * This has no dependency on Qt, so it is used for --show-aircraft and to
+ * resolve --aircraft without scanning the aircraft directories.
+ */
+class AircraftMetadataCache
+{
+public:
+    explicit AircraftMetadataCache(const SGPath& cacheFile = defaultCachePath());
+
+    static SGPath defaultCachePath();
+
+    /**
+     * the -set.xml files in some aircraft directories, found in the
+     * same way as when loading an aircraft
+     */
+    static simgear::PathList findSetFiles(const simgear::PathList& dirs);
+
+    /**
+     * the metadata of some -set.xml files, in the same order. Entries which
+     * are missing from the cache or out of date are parsed, using up to
+     * threads threads (0 means one per CPU core), and replace the cached
+     * entries. Entries of files which no longer exist are dropped.
+     */
+    std::vector<AircraftMetadata> update(const simgear::PathList& setFiles, unsigned threads = 0);
+
+    /**
+     * record that all -set.xml files in these directories have been
+     * passed to update(), so a lookup can rely on the cache for them
+     */
+    void markScanned(const simgear::PathList& dirs);
+
+    /**
+     * find a cached, unchanged -set.xml by its file name (ignoring case),
+     * searching the directories in order. Returns an empty path if there
+     * is none, or if a directory searched before the match was never
+     * scanned completely, since it might hold an uncached match.
+     */
+    SGPath findSetFile(const std::string& fileName, const simgear::PathList& dirs) const;
+
+    /// write the cache, if it changed
+    bool save();
+
+    size_t size() const { return _entries.size(); }
+
+    /// parse the metadata from a -set.xml file
+    static AircraftMetadata parse(const SGPath& path);
+
+private:
+    void load();
+
+    const SGPath _cacheFile;
+    std::map<std::string, AircraftMetadata> _entries;  ///< keyed by path
+    std::set<std::string> _scannedDirs;
+    bool _modified = false;
+};
+
+} // namespace flightgear
@@ -0,0 +1,83 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "BinaryIO.hxx"
+
+#include <memory>
+
+#include <simgear/io/iostreams/sgstream.hxx>
+
+namespace flightgear {
+
+namespace binary {
+
+void writeString(std::ostream& os, const std::string& s)
+{
+    writeValue(os, static_cast<uint32_t>(s.size()));
+    os.write(s.data(), s.size());
+}
+
+std::string readString(std::istream& is, uint32_t maxLength)
+{
+    const uint32_t length = readValue<uint32_t>(is);
+    if (!is || (length > maxLength)) {
+        is.setstate(std::ios::failbit);
+        return {};
+    }
+
+    std::string s(length, '\0');
+    is.read(&s[0], length);
+    return s;
+}
+
+bool writeFileReplacing(const SGPath& path, const std::function<void(std::ostream&)>& write,
+                        bool compress)
+{
+    SGPath tempFile = SGPath::fromUtf8(path.utf8Str() + ".tmp");
+    {
+        std::unique_ptr<std::ostream> os;
+        if (compress) {
+            os.reset(new sg_gzofstream(tempFile));
+        } else {
+            os.reset(new sg_ofstream(tempFile, std::ios::out | std::ios::trunc | std::ios::binary));
+        }
+
+        if (os->good()) {
+            write(*os);
+            os->flush();
+        }
+
+        if (os->fail()) {
+            os.reset();
+            tempFile.remove();
+            return false;
+        }
+    }
+
+    if (!tempFile.rename(path)) {
+        tempFile.remove();
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace binary
+
+} // namespace flightgear
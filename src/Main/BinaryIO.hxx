@@ -0,0 +1,74 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include <simgear/misc/sg_path.hxx>
+
+namespace flightgear {
+
+/**
+ * Helpers for the binary caches and snapshot files: values in host byte
+ * order, strings prefixed with their length. The files are only read back
+ * on the machine which wrote them.
+ */
+namespace binary {
+
+template <class T>
+void writeValue(std::ostream& os, const T& v)
+{
+    os.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <class T>
+T readValue(std::istream& is)
+{
+    T v{};
+    is.read(reinterpret_cast<char*>(&v), sizeof(T));
+    return v;
+}
+
+void writeString(std::ostream& os, const std::string& s);
+
+/**
+ * Read a string written by writeString(). A length above maxLength marks
+ * the stream as failed instead of allocating it, since it can only come
+ * from a corrupt file.
+ */
+std::string readString(std::istream& is, uint32_t maxLength = 1u << 24);
+
+/**
+ * Write a file through a temporary file next to it, which is renamed into
+ * place once complete, so other readers never see a partial file.
+ * @param write writes the contents; if it leaves the stream failed, the
+ *        file is not replaced
+ * @param compress write the file gzip-compressed
+ * @return false if the file could not be written, which the caller
+ *         reports as appropriate
+ */
+bool writeFileReplacing(const SGPath& path, const std::function<void(std::ostream&)>& write,
+                        bool compress = false);
+
+} // namespace binary
+
+} // namespace flightgear
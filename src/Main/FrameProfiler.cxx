@@ -0,0 +1,654 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "FrameProfiler.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/misc/sg_path.hxx>
+#include <simgear/props/props.hxx>
+#include <simgear/structure/SGSmplstat.hxx>
+#include <simgear/structure/subsystem_mgr.hxx>
+
+namespace flightgear {
+
+std::atomic<bool> FrameProfiler::static_active{false};
+
+namespace {
+
+// four buckets per power of two, from 1us up to about 16s
+const int BUCKETS_PER_OCTAVE = 4;
+const int NUM_BUCKETS = 100;
+
+const double SLICE_USEC = 1e6;
+
+// Chrome trace tracks: scopes as they happen, and the subsystem run times
+// as reported after the fact by the subsystem manager
+const int TRACE_TRACK_SCOPES = 1;
+const int TRACE_TRACK_SUBSYSTEMS = 2;
+const size_t MAX_TRACE_EVENTS = 1000000;
+
+double nowUSec()
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+int bucketFor(double usec)
+{
+    if (usec < 1.0) {
+        return 0;
+    }
+
+    const int b = 1 + static_cast<int>(std::log2(usec) * BUCKETS_PER_OCTAVE);
+    return std::min(b, NUM_BUCKETS - 1);
+}
+
+// bucket b counts values in [bucketLower(b), bucketUpper(b))
+double bucketLower(int b)
+{
+    return (b == 0) ? 0.0 : std::exp2((b - 1) / static_cast<double>(BUCKETS_PER_OCTAVE));
+}
+
+double bucketUpper(int b)
+{
+    return std::exp2(b / static_cast<double>(BUCKETS_PER_OCTAVE));
+}
+
+struct Slice {
+    std::array<uint32_t, NUM_BUCKETS> counts;
+    uint32_t samples;
+    double sum;
+    double max;
+
+    Slice() { reset(); }
+
+    void reset()
+    {
+        counts.fill(0);
+        samples = 0;
+        sum = 0.0;
+        max = 0.0;
+    }
+
+    void add(double usec)
+    {
+        ++counts[bucketFor(usec)];
+        ++samples;
+        sum += usec;
+        max = std::max(max, usec);
+    }
+};
+
+struct Node {
+    int component = -1;
+    int parent = -1;
+    std::string label;
+    std::string path;
+    std::vector<int> children;
+    std::array<Slice, FrameProfiler::WINDOW_SLICES> slices;
+    SGPropertyNode_ptr prop;
+};
+
+struct TraceEvent {
+    int node;
+    double start;
+    double duration;
+    int track;
+};
+
+struct OpenScope {
+    int node;
+    double start;
+};
+
+struct State {
+    // the name registry may be used from any thread
+    std::mutex registryLock;
+    std::unordered_map<std::string, int> componentIds;
+    std::vector<std::string> components;
+    std::unordered_map<std::string, int> scopeIds;
+    std::deque<std::vector<int>> scopes; // component ids; elements never move
+
+    std::atomic<std::thread::id> mainThread{std::thread::id()};
+
+    // everything else belongs to the main thread
+    bool enabled = false;
+    std::vector<const std::vector<int>*> scopeCache; // avoids the lock
+    std::vector<Node> nodes = std::vector<Node>(1); // the root, never sampled
+    std::vector<OpenScope> stack;
+    int slice = 0;
+    double sliceStart = -1.0;
+    double lastFrameStart = -1.0;
+    SGPropertyNode_ptr root;
+    SGSubsystemMgr* hookedMgr = nullptr;
+    double reportCursor = 0.0;
+
+    int traceFrames = 0;
+    SGPath tracePath;
+    std::vector<TraceEvent> trace;
+};
+
+State& state()
+{
+    static State s;
+    return s;
+}
+
+// property names: letters, digits, '_', '-' and '.', not starting with a
+// digit or punctuation
+std::string sanitize(const std::string& name)
+{
+    std::string r;
+    for (char c : name) {
+        const bool ok = isalnum(static_cast<unsigned char>(c)) || (c == '_') || (c == '-') || (c == '.');
+        r.push_back(ok ? c : '-');
+    }
+
+    if (r.empty()) {
+        return "unnamed";
+    }
+
+    if (!isalpha(static_cast<unsigned char>(r.front())) && (r.front() != '_')) {
+        r.insert(r.begin(), '_');
+    }
+    return r;
+}
+
+// must be called with the registry lock held
+int componentId(State& s, const std::string& label)
+{
+    auto it = s.componentIds.find(label);
+    if (it != s.componentIds.end()) {
+        return it->second;
+    }
+
+    const int id = static_cast<int>(s.components.size());
+    s.components.push_back(label);
+    s.componentIds.insert(std::make_pair(label, id));
+    return id;
+}
+
+// main thread only
+const std::vector<int>& scopePath(State& s, int id)
+{
+    if ((id < static_cast<int>(s.scopeCache.size())) && s.scopeCache[id]) {
+        return *s.scopeCache[id];
+    }
+
+    std::lock_guard<std::mutex> g(s.registryLock);
+    if (id >= static_cast<int>(s.scopeCache.size())) {
+        s.scopeCache.resize(id + 1, nullptr);
+    }
+    s.scopeCache[id] = &s.scopes.at(id);
+    return *s.scopeCache[id];
+}
+
+int childNode(State& s, int parent, int component)
+{
+    for (int c : s.nodes[parent].children) {
+        if (s.nodes[c].component == component) {
+            return c;
+        }
+    }
+
+    Node n;
+    n.component = component;
+    n.parent = parent;
+    {
+        std::lock_guard<std::mutex> g(s.registryLock);
+        n.label = s.components[component];
+    }
+    n.path = (parent == 0) ? n.label : s.nodes[parent].path + "/" + n.label;
+
+    const int index = static_cast<int>(s.nodes.size());
+    s.nodes.push_back(std::move(n));
+    s.nodes[parent].children.push_back(index);
+    return index;
+}
+
+int nodeFor(State& s, int parent, int id)
+{
+    int node = parent;
+    for (int c : scopePath(s, id)) {
+        node = childNode(s, node, c);
+    }
+    return node;
+}
+
+bool isMainThread(const State& s)
+{
+    return std::this_thread::get_id() == s.mainThread.load(std::memory_order_relaxed);
+}
+
+void record(State& s, int node, double start, double usec, int track)
+{
+    s.nodes[node].slices[s.slice].add(usec);
+    if ((track > 0) && (s.traceFrames > 0) && (s.trace.size() < MAX_TRACE_EVENTS)) {
+        s.trace.push_back(TraceEvent{node, start, usec, track});
+    }
+}
+
+void clearSlices(State& s)
+{
+    for (auto& n : s.nodes) {
+        for (auto& slice : n.slices) {
+            slice.reset();
+        }
+    }
+}
+
+FrameProfiler::Stats computeStats(const Node& n)
+{
+    std::array<uint64_t, NUM_BUCKETS> counts;
+    counts.fill(0);
+
+    FrameProfiler::Stats r;
+    double sum = 0.0, max = 0.0;
+    for (const auto& slice : n.slices) {
+        for (int b = 0; b < NUM_BUCKETS; ++b) {
+            counts[b] += slice.counts[b];
+        }
+        r.samples += slice.samples;
+        sum += slice.sum;
+        max = std::max(max, slice.max);
+    }
+
+    if (r.samples == 0) {
+        return r;
+    }
+
+    // interpolate within the bucket holding the requested rank
+    auto percentile = [&](double q) {
+        const double rank = q * r.samples;
+        uint64_t below = 0;
+        for (int b = 0; b < NUM_BUCKETS; ++b) {
+            if ((counts[b] > 0) && (below + counts[b] >= rank)) {
+                const double f = (rank - below) / counts[b];
+                const double v = bucketLower(b) + (bucketUpper(b) - bucketLower(b)) * f;
+                return std::min(v, max);
+            }
+            below += counts[b];
+        }
+        return max;
+    };
+
+    r.meanMSec = sum / r.samples / 1000.0;
+    r.p50MSec = percentile(0.50) / 1000.0;
+    r.p95MSec = percentile(0.95) / 1000.0;
+    r.p99MSec = percentile(0.99) / 1000.0;
+    r.maxMSec = max / 1000.0;
+    return r;
+}
+
+void publish(State& s)
+{
+    if (!s.root) {
+        return;
+    }
+
+    s.root->setIntValue("window-sec", FrameProfiler::WINDOW_SLICES);
+
+    // parents always precede their children
+    for (size_t i = 1; i < s.nodes.size(); ++i) {
+        Node& n = s.nodes[i];
+        if (!n.prop) {
+            SGPropertyNode* parent = (n.parent == 0) ? s.root.get() : s.nodes[n.parent].prop.get();
+            n.prop = parent->getNode(n.label, true);
+        }
+
+        const auto stats = computeStats(n);
+        n.prop->setLongValue("samples", static_cast<long>(stats.samples));
+        n.prop->setDoubleValue("mean-ms", stats.meanMSec);
+        n.prop->setDoubleValue("p50-ms", stats.p50MSec);
+        n.prop->setDoubleValue("p95-ms", stats.p95MSec);
+        n.prop->setDoubleValue("p99-ms", stats.p99MSec);
+        n.prop->setDoubleValue("max-ms", stats.maxMSec);
+    }
+}
+
+void rotate(State& s)
+{
+    s.slice = (s.slice + 1) % FrameProfiler::WINDOW_SLICES;
+    for (auto& n : s.nodes) {
+        n.slices[s.slice].reset();
+    }
+}
+
+void writeTrace(State& s)
+{
+    sg_ofstream f(s.tracePath, std::ios::out | std::ios::trunc);
+    if (!f.is_open()) {
+        SG_LOG(SG_GENERAL, SG_WARN, "Unable to write frame trace to " << s.tracePath);
+        s.trace.clear();
+        return;
+    }
+
+    // labels and paths are sanitized, so need no escaping
+    f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    f << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << TRACE_TRACK_SCOPES
+      << ",\"args\":{\"name\":\"main loop\"}},\n";
+    f << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << TRACE_TRACK_SUBSYSTEMS
+      << ",\"args\":{\"name\":\"subsystems (reported)\"}}";
+
+    f << std::fixed << std::setprecision(3);
+    for (const auto& e : s.trace) {
+        const Node& n = s.nodes[e.node];
+        f << ",\n{\"name\":\"" << n.label << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.track
+          << ",\"ts\":" << e.start << ",\"dur\":" << e.duration
+          << ",\"args\":{\"path\":\"" << n.path << "\"}}";
+    }
+    f << "\n]}\n";
+
+    SG_LOG(SG_GENERAL, SG_INFO, "Wrote frame trace (" << s.trace.size() << " events) to " << s.tracePath);
+    s.trace.clear();
+    s.trace.shrink_to_fit();
+}
+
+void writeNodeJSON(std::ostream& os, const State& s, const Node& n)
+{
+    const auto stats = computeStats(n);
+    os << "{\"name\":\"" << n.label << "\",\"path\":\"" << n.path << "\""
+       << ",\"samples\":" << stats.samples
+       << ",\"mean-ms\":" << stats.meanMSec
+       << ",\"p50-ms\":" << stats.p50MSec
+       << ",\"p95-ms\":" << stats.p95MSec
+       << ",\"p99-ms\":" << stats.p99MSec
+       << ",\"max-ms\":" << stats.maxMSec
+       << ",\"children\":[";
+    for (size_t i = 0; i < n.children.size(); ++i) {
+        if (i > 0) {
+            os << ",";
+        }
+        writeNodeJSON(os, s, s.nodes[n.children[i]]);
+    }
+    os << "]}";
+}
+
+void subsystemTimingHook(void* userData, const std::string& name, SampleStatistic* timeStat)
+{
+    State& s = *static_cast<State*>(userData);
+    if (s.stack.empty() || (timeStat->samples() == 0)) {
+        return;
+    }
+
+    // the manager records microseconds, once for each time a subsystem
+    // ran; report the total for this frame
+    const double usec = timeStat->mean() * timeStat->samples();
+    const int node = nodeFor(s, s.stack.back().node, FrameProfiler::scopeId(name));
+    record(s, node, s.reportCursor, usec, TRACE_TRACK_SUBSYSTEMS);
+    s.reportCursor += usec;
+}
+
+} // of anonymous namespace
+
+void FrameProfiler::setEnabled(bool enabled)
+{
+    State& s = state();
+    if (enabled && !s.enabled) {
+        // don't mix in whatever was recorded last time
+        clearSlices(s);
+        s.sliceStart = -1.0;
+        s.lastFrameStart = -1.0;
+    }
+    s.enabled = enabled;
+}
+
+bool FrameProfiler::isEnabled()
+{
+    return state().enabled;
+}
+
+int FrameProfiler::scopeId(const std::string& name)
+{
+    State& s = state();
+    std::lock_guard<std::mutex> g(s.registryLock);
+    auto it = s.scopeIds.find(name);
+    if (it != s.scopeIds.end()) {
+        return it->second;
+    }
+
+    std::vector<int> path;
+    size_t pos = 0;
+    while (pos <= name.size()) {
+        size_t slash = name.find('/', pos);
+        if (slash == std::string::npos) {
+            slash = name.size();
+        }
+
+        if (slash > pos) {
+            path.push_back(componentId(s, sanitize(name.substr(pos, slash - pos))));
+        }
+        pos = slash + 1;
+    }
+
+    if (path.empty()) {
+        path.push_back(componentId(s, sanitize(std::string())));
+    }
+
+    const int id = static_cast<int>(s.scopes.size());
+    s.scopes.push_back(path);
+    s.scopeIds.insert(std::make_pair(name, id));
+    return id;
+}
+
+void FrameProfiler::beginFrame()
+{
+    static const int frameId = scopeId("frame");
+    static const int intervalId = scopeId("frame-interval");
+
+    State& s = state();
+    s.mainThread = std::this_thread::get_id();
+    s.stack.clear();
+
+    const bool active = s.enabled || (s.traceFrames > 0);
+    if (!active) {
+        s.lastFrameStart = -1.0;
+        static_active = false;
+        return;
+    }
+
+    const double now = nowUSec();
+    if (s.sliceStart < 0.0) {
+        s.sliceStart = now;
+    }
+
+    // the time from one frame to the next, including rendering
+    if (s.lastFrameStart >= 0.0) {
+        record(s, nodeFor(s, 0, intervalId), s.lastFrameStart, now - s.lastFrameStart, 0);
+    }
+    s.lastFrameStart = now;
+
+    s.stack.push_back(OpenScope{nodeFor(s, 0, frameId), now});
+    static_active = true;
+}
+
+void FrameProfiler::endFrame()
+{
+    if (!isActive()) {
+        return;
+    }
+
+    State& s = state();
+    static_active = false;
+
+    const double now = nowUSec();
+    if (!s.stack.empty()) {
+        const OpenScope frame = s.stack.front();
+        record(s, frame.node, frame.start, now - frame.start, TRACE_TRACK_SCOPES);
+        s.stack.clear();
+    }
+
+    if ((s.traceFrames > 0) && (--s.traceFrames == 0)) {
+        writeTrace(s);
+    }
+
+    const double elapsed = now - s.sliceStart;
+    if (elapsed >= SLICE_USEC) {
+        const int slices = static_cast<int>(elapsed / SLICE_USEC);
+        for (int i = 0; i < std::min(slices, WINDOW_SLICES); ++i) {
+            rotate(s);
+        }
+        s.sliceStart += slices * SLICE_USEC;
+        publish(s);
+    }
+}
+
+void FrameProfiler::collectSubsystemTimes(SGSubsystemMgr* mgr, bool hookAvailable)
+{
+    State& s = state();
+    if (!hookAvailable) {
+        // someone else owns the hook
+        s.hookedMgr = nullptr;
+        return;
+    }
+
+    if (!isActive()) {
+        if (s.hookedMgr == mgr) {
+            // stop the manager from timing every subsystem
+            mgr->setReportTimingCb(nullptr, nullptr);
+        }
+        s.hookedMgr = nullptr;
+        return;
+    }
+
+    // installed every frame: SGPerformanceMonitor clears the hook when it
+    // is switched off. The first frame after installing has no timings.
+    mgr->setReportTimingCb(&s, &subsystemTimingHook);
+    s.hookedMgr = mgr;
+
+    // the reported times are laid out back to back in the trace, from the
+    // start of the current scope
+    s.reportCursor = s.stack.empty() ? nowUSec() : s.stack.back().start;
+    mgr->reportTiming();
+}
+
+void FrameProfiler::addSample(int id, double usec)
+{
+    State& s = state();
+    if (!isActive() || !isMainThread(s) || s.stack.empty()) {
+        return;
+    }
+
+    const int node = nodeFor(s, s.stack.back().node, id);
+    record(s, node, nowUSec() - usec, usec, TRACE_TRACK_SCOPES);
+}
+
+void FrameProfiler::setPropertyRoot(SGPropertyNode* root)
+{
+    State& s = state();
+    s.root = root;
+    for (auto& n : s.nodes) {
+        n.prop.clear();
+    }
+}
+
+void FrameProfiler::advanceWindow()
+{
+    State& s = state();
+    rotate(s);
+    s.sliceStart = nowUSec();
+    publish(s);
+}
+
+bool FrameProfiler::getStats(const std::string& path, Stats& stats)
+{
+    const State& s = state();
+    for (size_t i = 1; i < s.nodes.size(); ++i) {
+        if (s.nodes[i].path == path) {
+            stats = computeStats(s.nodes[i]);
+            return true;
+        }
+    }
+    return false;
+}
+
+void FrameProfiler::writeJSON(std::ostream& os)
+{
+    const State& s = state();
+    const Node& root = s.nodes.front();
+    os << "{\"enabled\":" << (s.enabled ? "true" : "false")
+       << ",\"window-sec\":" << WINDOW_SLICES << ",\"scopes\":[";
+    for (size_t i = 0; i < root.children.size(); ++i) {
+        if (i > 0) {
+            os << ",";
+        }
+        writeNodeJSON(os, s, s.nodes[root.children[i]]);
+    }
+    os << "]}";
+}
+
+void FrameProfiler::requestTrace(const SGPath& path, int frames)
+{
+    State& s = state();
+    s.tracePath = path;
+    s.traceFrames = std::max(frames, 1);
+    s.trace.clear();
+    SG_LOG(SG_GENERAL, SG_INFO, "Recording frame trace of " << s.traceFrames << " frames to " << path);
+}
+
+bool FrameProfiler::isTracing()
+{
+    return state().traceFrames > 0;
+}
+
+void FrameProfiler::clear()
+{
+    State& s = state();
+    clearSlices(s);
+    s.lastFrameStart = -1.0;
+}
+
+int FrameProfiler::begin(int id)
+{
+    State& s = state();
+    if (!isMainThread(s) || s.stack.empty()) {
+        return -1;
+    }
+
+    const int node = nodeFor(s, s.stack.back().node, id);
+    s.stack.push_back(OpenScope{node, nowUSec()});
+    return node;
+}
+
+void FrameProfiler::end(int node)
+{
+    State& s = state();
+    if (s.stack.empty() || (s.stack.back().node != node)) {
+        return; // the frame ended underneath us
+    }
+
+    const OpenScope scope = s.stack.back();
+    s.stack.pop_back();
+    record(s, node, scope.start, nowUSec() - scope.start, TRACE_TRACK_SCOPES);
+}
+
+} // namespace flightgear
@@ -0,0 +1,150 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+class SGPath;
+class SGPropertyNode;
+class SGSubsystemMgr;
+
+namespace flightgear {
+
+/**
+ * Hierarchical profiler for the main loop.
+ *
+ * Each main loop iteration is a 'frame' scope; code run within it can
+ * open nested scopes (see Scope), and the run times of the subsystems are
+ * added from the subsystem manager's timing hook. Durations are kept in
+ * log-scaled histograms (four buckets per power of two), over a rolling
+ * window of WINDOW_SLICES one-second slices, so percentiles are cheap to
+ * record and to compute.
+ *
+ * Once per second the statistics (samples, mean, p50, p95, p99 and max,
+ * in milliseconds) are published below the property root, mirroring the
+ * scope hierarchy, e.g. /sim/performance/profile/frame/subsystems/flight.
+ * They are also available as JSON, and a number of frames can be written
+ * as a Chrome trace.
+ *
+ * Only the main thread is profiled; scopes opened on other threads, or
+ * outside a frame, are ignored. When disabled, a scope costs a single
+ * atomic load.
+ */
+class FrameProfiler
+{
+public:
+    static constexpr int WINDOW_SLICES = 10;
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /// true while a profiled (or traced) frame is running
+    static bool isActive() { return static_active.load(std::memory_order_relaxed); }
+
+    /**
+     * Register a scope name; '/' separates nested levels, e.g.
+     * "flight/fdm". Names are reduced to property name characters.
+     * Thread safe; the same name always gives the same id.
+     */
+    static int scopeId(const std::string& name);
+
+    static void beginFrame();
+    static void endFrame();
+
+    /**
+     * Add the run times of the subsystems, as recorded by the subsystem
+     * manager during this frame, as children of the current scope.
+     * The manager has a single timing hook, shared with
+     * SGPerformanceMonitor: pass hookAvailable = false while that is
+     * running. The hook is released again when profiling is disabled.
+     */
+    static void collectSubsystemTimes(SGSubsystemMgr* mgr, bool hookAvailable);
+
+    /// record a duration, measured elsewhere, as a child of the current scope
+    static void addSample(int id, double usec);
+
+    /// where the statistics are published; nullptr to stop publishing
+    static void setPropertyRoot(SGPropertyNode* root);
+
+    /**
+     * start a new one second slice, dropping the oldest, and publish.
+     * Called from endFrame().
+     */
+    static void advanceWindow();
+
+    struct Stats {
+        uint64_t samples = 0;
+        double meanMSec = 0.0;
+        double p50MSec = 0.0;
+        double p95MSec = 0.0;
+        double p99MSec = 0.0;
+        double maxMSec = 0.0;
+    };
+
+    /**
+     * statistics over the window for a scope, by its full path, e.g.
+     * "frame/subsystems". Returns false for an unknown path.
+     */
+    static bool getStats(const std::string& path, Stats& stats);
+
+    static void writeJSON(std::ostream& os);
+
+    /**
+     * Record the next frames and write them as a Chrome trace (viewable
+     * in chrome://tracing or Perfetto). Profiling is active while a trace
+     * is recorded, even if disabled otherwise.
+     */
+    static void requestTrace(const SGPath& path, int frames);
+    static bool isTracing();
+
+    /// forget all samples (but keep the scope ids)
+    static void clear();
+
+    /**
+     * RAII helper timing a nested scope. A negative id times nothing.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(int id) : _node(((id >= 0) && isActive()) ? begin(id) : -1) {}
+
+        ~Scope()
+        {
+            if (_node >= 0) {
+                end(_node);
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const int _node;
+    };
+
+private:
+    static int begin(int id);
+    static void end(int node);
+
+    static std::atomic<bool> static_active;
+};
+
+} // namespace flightgear
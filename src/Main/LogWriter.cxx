@@ -0,0 +1,324 @@
+// LogWriter.cxx - background writer for FGLogger
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "LogWriter.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+#include <simgear/debug/logstream.hxx>
+
+using namespace simgear;
+
+namespace {
+
+// records per binary block, at most
+const size_t MAX_BLOCK_RECORDS = 1024;
+
+size_t roundUpToPowerOfTwo(size_t n)
+{
+    size_t result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+void appendU8(std::string& out, uint8_t v)
+{
+    out.push_back(static_cast<char>(v));
+}
+
+void appendU32(std::string& out, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+}
+
+void appendDouble(std::string& out, double d)
+{
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+    }
+}
+
+void appendString(std::string& out, const std::string& s)
+{
+    appendU32(out, static_cast<uint32_t>(s.size()));
+    out.append(s);
+}
+
+} // of anonymous namespace
+
+const char FGLogWriter::BINARY_MAGIC[8] = {'F', 'G', 'L', 'O', 'G', 'B', 'I', 'N'};
+
+FGLogWriter::FGLogWriter(std::unique_ptr<sg_ofstream> output,
+                         Format format,
+                         char delimiter,
+                         const std::vector<std::string>& titles,
+                         size_t capacity,
+                         int flushIntervalMSec) :
+    _output(std::move(output)),
+    _format(format),
+    _delimiter(delimiter),
+    _titles(titles),
+    _flushIntervalMSec(std::max(flushIntervalMSec, 1)),
+    _records(roundUpToPowerOfTwo(std::max(capacity, size_t(2)))),
+    _mask(_records.size() - 1)
+{
+    for (auto& r : _records) {
+        r.cells.resize(_titles.size());
+    }
+
+    writeHeader();
+    _thread = std::thread(&FGLogWriter::run, this);
+}
+
+FGLogWriter::~FGLogWriter()
+{
+    {
+        std::lock_guard<std::mutex> g(_lock);
+        _stop = true;
+    }
+    _wake.notify_one();
+    _thread.join();
+}
+
+bool FGLogWriter::append(double timeSec, const std::vector<SGPropertyNode_ptr>& nodes)
+{
+    const size_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) >= _records.size()) {
+        ++_dropped;
+        return false;
+    }
+
+    Record& r = _records[head & _mask];
+    r.time = timeSec;
+    for (size_t i = 0; i < r.cells.size(); ++i) {
+        const SGPropertyNode* node = nodes[i];
+        Cell& c = r.cells[i];
+        c.type = node->getType();
+        switch (c.type) {
+        case props::NONE:
+            break;
+        case props::BOOL:
+            c.b = node->getBoolValue();
+            break;
+        case props::INT:
+        case props::LONG:
+            c.l = node->getLongValue();
+            break;
+        case props::FLOAT:
+            c.d = node->getFloatValue();
+            break;
+        case props::DOUBLE:
+            c.d = node->getDoubleValue();
+            break;
+        default:
+            c.type = props::STRING;
+            c.s = node->getStringValue();
+            break;
+        }
+    }
+
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void FGLogWriter::sync()
+{
+    std::unique_lock<std::mutex> g(_lock);
+    _syncRequested = true;
+    _wake.notify_one();
+    _synced.wait(g, [this] { return !_syncRequested; });
+}
+
+size_t FGLogWriter::buffered() const
+{
+    return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+}
+
+void FGLogWriter::run()
+{
+    std::unique_lock<std::mutex> g(_lock);
+    for (;;) {
+        _wake.wait_for(g, std::chrono::milliseconds(_flushIntervalMSec),
+                       [this] { return _stop || _syncRequested; });
+
+        const bool stop = _stop;
+        const bool syncing = _syncRequested;
+
+        g.unlock();
+        drain();
+        g.lock();
+
+        if (syncing) {
+            _syncRequested = false;
+            _synced.notify_all();
+        }
+
+        if (stop) {
+            break;
+        }
+    }
+}
+
+size_t FGLogWriter::drain()
+{
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    const size_t head = _head.load(std::memory_order_acquire);
+    if (tail == head) {
+        return 0;
+    }
+
+    const size_t count = head - tail;
+    if (_format == FORMAT_CSV) {
+        for (; tail != head; ++tail) {
+            writeCSV(_records[tail & _mask]);
+            // hand the slot back as soon as possible
+            _tail.store(tail + 1, std::memory_order_release);
+        }
+    } else {
+        while (tail != head) {
+            const size_t n = std::min(head - tail, MAX_BLOCK_RECORDS);
+            writeBinaryBlock(tail, n);
+            tail += n;
+            _tail.store(tail, std::memory_order_release);
+        }
+    }
+
+    _output->flush();
+    if (!(*_output)) {
+        SG_LOG(SG_GENERAL, SG_ALERT, "FGLogger: error writing log file");
+    }
+
+    _written.fetch_add(count, std::memory_order_relaxed);
+    return count;
+}
+
+// the text getStringValue() would have produced
+void FGLogWriter::formatCell(std::ostream& os, const Cell& c)
+{
+    switch (c.type) {
+    case props::NONE:
+        break;
+    case props::BOOL:
+        os << (c.b ? "true" : "false");
+        break;
+    case props::INT:
+    case props::LONG:
+        os << c.l;
+        break;
+    case props::FLOAT:
+        os << c.d;
+        break;
+    case props::DOUBLE: {
+        const auto precision = os.precision(10);
+        os << c.d;
+        os.precision(precision);
+        break;
+    }
+    default:
+        os << c.s;
+        break;
+    }
+}
+
+void FGLogWriter::writeHeader()
+{
+    if (_format == FORMAT_CSV) {
+        (*_output) << "Time";
+        for (const auto& t : _titles) {
+            (*_output) << _delimiter << t;
+        }
+        (*_output) << '\n';
+    } else {
+        std::string header(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        appendU32(header, BINARY_VERSION);
+        appendU32(header, static_cast<uint32_t>(_titles.size() + 1));
+        appendString(header, "Time");
+        for (const auto& t : _titles) {
+            appendString(header, t);
+        }
+        _output->write(header.data(), header.size());
+    }
+
+    _output->flush();
+}
+
+void FGLogWriter::writeCSV(const Record& r)
+{
+    (*_output) << r.time;
+    for (const auto& c : r.cells) {
+        (*_output) << _delimiter;
+        formatCell(*_output, c);
+    }
+    (*_output) << '\n';
+}
+
+void FGLogWriter::writeBinaryBlock(size_t first, size_t count)
+{
+    _block.clear();
+    appendU32(_block, static_cast<uint32_t>(count));
+
+    appendU8(_block, ENCODING_DOUBLE);
+    for (size_t i = 0; i < count; ++i) {
+        appendDouble(_block, _records[(first + i) & _mask].time);
+    }
+
+    std::ostringstream text;
+    for (size_t column = 0; column < _titles.size(); ++column) {
+        // a column is numeric unless there's a string in this block
+        bool numeric = true;
+        for (size_t i = 0; numeric && (i < count); ++i) {
+            numeric = (_records[(first + i) & _mask].cells[column].type != props::STRING);
+        }
+
+        appendU8(_block, numeric ? ENCODING_DOUBLE : ENCODING_STRING);
+        for (size_t i = 0; i < count; ++i) {
+            const Cell& c = _records[(first + i) & _mask].cells[column];
+            if (numeric) {
+                switch (c.type) {
+                case props::BOOL:  appendDouble(_block, c.b ? 1.0 : 0.0); break;
+                case props::INT:
+                case props::LONG:  appendDouble(_block, static_cast<double>(c.l)); break;
+                case props::FLOAT:
+                case props::DOUBLE: appendDouble(_block, c.d); break;
+                default:
+                    // no value
+                    appendDouble(_block, std::numeric_limits<double>::quiet_NaN());
+                    break;
+                }
+            } else {
+                text.str(std::string());
+                formatCell(text, c);
+                appendString(_block, text.str());
+            }
+        }
+    }
+
+    _output->write(_block.data(), _block.size());
+}
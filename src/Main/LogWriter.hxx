@@ -0,0 +1,153 @@
+// LogWriter.hxx - background writer for FGLogger
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/props/props.hxx>
+
+/**
+ * Writes FGLogger records from a thread of its own.
+ *
+ * The main thread snapshots the logged values into a fixed size,
+ * single-producer single-consumer ring buffer; no locks are taken and
+ * nothing is formatted there. The writer thread wakes up at a fixed
+ * interval, and writes whatever has accumulated, either as CSV (the same
+ * text the synchronous logger produces) or in a binary columnar format.
+ * When the writer falls behind and the ring is full, records are dropped
+ * and counted, rather than stalling the simulation.
+ *
+ * The binary format is little-endian:
+ *
+ *   "FGLOGBIN", uint32 version (1), uint32 column count, and for each
+ *   column a uint32 length and the UTF-8 title. The first column is the
+ *   time.
+ *
+ *   Blocks of records follow: uint32 record count, then for each column
+ *   a uint8 encoding and the values of all records in the block. Encoding
+ *   0 is a float64 per record, encoding 1 a uint32 length and the bytes.
+ *
+ * utils/fglogdecode converts it back to CSV.
+ */
+class FGLogWriter
+{
+public:
+    enum Format {
+        FORMAT_CSV,
+        FORMAT_BINARY
+    };
+
+    static const char BINARY_MAGIC[8];
+    static const uint32_t BINARY_VERSION = 1;
+
+    enum BinaryEncoding : uint8_t {
+        ENCODING_DOUBLE = 0,
+        ENCODING_STRING = 1
+    };
+
+    /**
+     * @param titles the column titles, excluding the time
+     * @param capacity records which can be waiting for the writer; rounded
+     * up to a power of two
+     */
+    FGLogWriter(std::unique_ptr<sg_ofstream> output,
+                Format format,
+                char delimiter,
+                const std::vector<std::string>& titles,
+                size_t capacity,
+                int flushIntervalMSec);
+
+    /**
+     * writes the remaining records and stops the thread
+     */
+    ~FGLogWriter();
+
+    FGLogWriter(const FGLogWriter&) = delete;
+    FGLogWriter& operator=(const FGLogWriter&) = delete;
+
+    /**
+     * Snapshot the current values of nodes (in the order of the titles)
+     * as a record. Main thread only. Returns false if the record was
+     * dropped because the buffer is full.
+     */
+    bool append(double timeSec, const std::vector<SGPropertyNode_ptr>& nodes);
+
+    /**
+     * wake the writer, and wait until everything appended so far is
+     * written and flushed
+     */
+    void sync();
+
+    uint64_t written() const { return _written.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return _dropped; }
+    size_t buffered() const;
+    size_t capacity() const { return _records.size(); }
+
+private:
+    struct Cell {
+        simgear::props::Type type = simgear::props::NONE;
+        bool b = false;
+        long l = 0;
+        double d = 0.0;
+        std::string s;
+    };
+
+    struct Record {
+        double time = 0.0;
+        std::vector<Cell> cells;
+    };
+
+    void run();
+    size_t drain();
+    void writeHeader();
+    void writeCSV(const Record& r);
+    static void formatCell(std::ostream& os, const Cell& c);
+    void writeBinaryBlock(size_t first, size_t count);
+
+    std::unique_ptr<sg_ofstream> _output;
+    const Format _format;
+    const char _delimiter;
+    const std::vector<std::string> _titles;
+    const int _flushIntervalMSec;
+
+    std::vector<Record> _records;
+    const size_t _mask;
+
+    // _head is written by the main thread only, _tail by the writer only
+    std::atomic<size_t> _head{0};
+    std::atomic<size_t> _tail{0};
+
+    std::atomic<uint64_t> _written{0};
+    uint64_t _dropped = 0;
+
+    std::string _block; ///< binary encoding scratch space
+
+    std::mutex _lock;
+    std::condition_variable _wake;
+    std::condition_variable _synced;
+    bool _stop = false;
+    bool _syncRequested = false;
+    std::thread _thread;
+};
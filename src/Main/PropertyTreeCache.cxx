@@ -0,0 +1,404 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "PropertyTreeCache.hxx"
+
+#include <cstring>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/misc/ResourceManager.hxx>
+#include <simgear/misc/sg_dir.hxx>
+#include <simgear/misc/strutils.hxx>
+#include <simgear/props/props.hxx>
+#include <simgear/props/props_io.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Main/BinaryIO.hxx>
+#include <Main/StartupTrace.hxx>
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+
+namespace flightgear {
+
+namespace {
+
+const char CACHE_MAGIC[8] = {'F', 'G', 'P', 'R', 'O', 'P', 'T', 'C'};
+const uint32_t CACHE_VERSION = 2;
+
+using binary::readValue;
+using binary::writeString;
+using binary::writeValue;
+
+// string property values can be much longer than names
+std::string readString(std::istream& is)
+{
+    return binary::readString(is, 1u << 26);
+}
+
+std::string readFile(const SGPath& path)
+{
+    sg_ifstream is(path, std::ios::in | std::ios::binary);
+    std::ostringstream contents;
+    contents << is.rdbuf();
+    return contents.str();
+}
+
+// hash a file and, recursively, the files it includes; resolved the
+// same way as by readProperties
+void hashFile(const SGPath& path, std::string& key, std::set<std::string>& visited)
+{
+    if (!visited.insert(path.utf8Str()).second) {
+        return;
+    }
+
+    const std::string contents = readFile(path);
+    key += path.utf8Str() + ":" + simgear::strutils::md5(contents) + ";";
+
+    static const std::regex includeRegex("\\binclude\\s*=\\s*[\"']([^\"']*)[\"']");
+    auto begin = std::sregex_iterator(contents.begin(), contents.end(), includeRegex);
+    for (auto it = begin; it != std::sregex_iterator(); ++it) {
+        const std::string include = (*it)[1].str();
+        const SGPath resolved = simgear::ResourceManager::instance()->findPath(include, path.dirPath());
+        if (resolved.isNull()) {
+            key += "missing:" + include + ";";
+            continue;
+        }
+
+        hashFile(resolved, key, visited);
+    }
+}
+
+enum class NodeType : uint8_t {
+    None = 0,
+    Alias,
+    Bool,
+    Int,
+    Long,
+    Float,
+    Double,
+    String,
+    Unspecified
+};
+
+bool writeChildren(std::ostream& os, const SGPropertyNode* node, const SGPropertyNode* root,
+                   const PropertyTreeCache::NodeFilter& filter);
+
+// the path of an alias target relative to the root being written, so it
+// resolves against whichever node the data is read into. Targets outside
+// that tree keep their absolute path.
+std::string aliasTargetPath(const SGPropertyNode* target, const SGPropertyNode* root)
+{
+    std::string path;
+    for (const SGPropertyNode* n = target; n; n = n->getParent()) {
+        if (n == root) {
+            return path;
+        }
+
+        path = path.empty() ? n->getDisplayName() : (n->getDisplayName() + "/" + path);
+    }
+
+    return target->getPath();
+}
+
+bool writeNode(std::ostream& os, const SGPropertyNode* node, const SGPropertyNode* root,
+               const PropertyTreeCache::NodeFilter& filter)
+{
+    writeString(os, node->getNameString());
+    writeValue(os, static_cast<int32_t>(node->getIndex()));
+    writeValue(os, static_cast<int32_t>(node->getAttributes()));
+
+    switch (node->getType()) {
+    case simgear::props::NONE:
+        writeValue(os, NodeType::None);
+        break;
+    case simgear::props::ALIAS:
+        writeValue(os, NodeType::Alias);
+        writeString(os, aliasTargetPath(node->getAliasTarget(), root));
+        break;
+    case simgear::props::BOOL:
+        writeValue(os, NodeType::Bool);
+        writeValue(os, static_cast<uint8_t>(node->getBoolValue()));
+        break;
+    case simgear::props::INT:
+        writeValue(os, NodeType::Int);
+        writeValue(os, static_cast<int32_t>(node->getIntValue()));
+        break;
+    case simgear::props::LONG:
+        writeValue(os, NodeType::Long);
+        writeValue(os, static_cast<int64_t>(node->getLongValue()));
+        break;
+    case simgear::props::FLOAT:
+        writeValue(os, NodeType::Float);
+        writeValue(os, node->getFloatValue());
+        break;
+    case simgear::props::DOUBLE:
+        writeValue(os, NodeType::Double);
+        writeValue(os, node->getDoubleValue());
+        break;
+    case simgear::props::STRING:
+        writeValue(os, NodeType::String);
+        writeString(os, node->getStringValue());
+        break;
+    case simgear::props::UNSPECIFIED:
+        writeValue(os, NodeType::Unspecified);
+        writeString(os, node->getStringValue());
+        break;
+    default:
+        // extended (vector) values
+        return false;
+    }
+
+    // aliases have no children of their own
+    return writeChildren(os, node->isAlias() ? nullptr : node, root, filter);
+}
+
+bool writeChildren(std::ostream& os, const SGPropertyNode* node, const SGPropertyNode* root,
+                   const PropertyTreeCache::NodeFilter& filter)
+{
+    std::vector<const SGPropertyNode*> children;
+    const int n = node ? node->nChildren() : 0;
+    for (int i = 0; i < n; ++i) {
+        const SGPropertyNode* child = node->getChild(i);
+        if (!filter || filter(child)) {
+            children.push_back(child);
+        }
+    }
+
+    writeValue(os, static_cast<uint32_t>(children.size()));
+    for (auto child : children) {
+        if (!writeNode(os, child, root, filter)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+using AliasList = std::vector<std::pair<SGPropertyNode*, std::string>>;
+
+// read a node record, applying it to a child of parent. With no parent,
+// only checks the record is complete.
+bool readNode(std::istream& is, SGPropertyNode* parent, AliasList& aliases)
+{
+    const std::string name = readString(is);
+    const int index = readValue<int32_t>(is);
+    const int attributes = readValue<int32_t>(is);
+    const NodeType type = readValue<NodeType>(is);
+    if (!is) {
+        return false;
+    }
+
+    SGPropertyNode* node = parent ? parent->getChild(name, index, true) : nullptr;
+    if (node && !node->getAttribute(SGPropertyNode::WRITE)) {
+        SG_LOG(SG_GENERAL, SG_DEBUG, "Not overwriting write-protected property " << node->getPath());
+        node = nullptr;
+    }
+
+    switch (type) {
+    case NodeType::None:
+        break;
+    case NodeType::Alias: {
+        const std::string target = readString(is);
+        if (node) aliases.push_back(std::make_pair(node, target));
+        break;
+    }
+    case NodeType::Bool: {
+        const bool v = readValue<uint8_t>(is) != 0;
+        if (node) node->setBoolValue(v);
+        break;
+    }
+    case NodeType::Int: {
+        const int v = readValue<int32_t>(is);
+        if (node) node->setIntValue(v);
+        break;
+    }
+    case NodeType::Long: {
+        const long v = static_cast<long>(readValue<int64_t>(is));
+        if (node) node->setLongValue(v);
+        break;
+    }
+    case NodeType::Float: {
+        const float v = readValue<float>(is);
+        if (node) node->setFloatValue(v);
+        break;
+    }
+    case NodeType::Double: {
+        const double v = readValue<double>(is);
+        if (node) node->setDoubleValue(v);
+        break;
+    }
+    case NodeType::String: {
+        const std::string v = readString(is);
+        if (node) node->setStringValue(v);
+        break;
+    }
+    case NodeType::Unspecified: {
+        const std::string v = readString(is);
+        if (node) node->setUnspecifiedValue(v.c_str());
+        break;
+    }
+    default:
+        return false;
+    }
+
+    const uint32_t n = readValue<uint32_t>(is);
+    for (uint32_t i = 0; is && (i < n); ++i) {
+        if (!readNode(is, node, aliases)) {
+            return false;
+        }
+    }
+
+    // like readProperties, the access mode is set once the value and
+    // children are. Nodes without a value or children were only created
+    // as alias targets, and keep their mode.
+    if (node && ((type != NodeType::None) || (n > 0))) {
+        node->setAttributes(attributes);
+    }
+
+    return static_cast<bool>(is);
+}
+
+bool readTree(std::istream& is, SGPropertyNode* root)
+{
+    char magic[8];
+    is.read(magic, sizeof(magic));
+    if (!is || memcmp(magic, CACHE_MAGIC, sizeof(magic)) ||
+        (readValue<uint32_t>(is) != CACHE_VERSION))
+    {
+        return false;
+    }
+
+    AliasList aliases;
+    const uint32_t n = readValue<uint32_t>(is);
+    for (uint32_t i = 0; is && (i < n); ++i) {
+        if (!readNode(is, root, aliases)) {
+            return false;
+        }
+    }
+
+    for (const auto& a : aliases) {
+        if (!a.first->alias(root->getNode(a.second, true))) {
+            SG_LOG(SG_GENERAL, SG_WARN, "Failed to set alias to " << a.second);
+        }
+    }
+
+    return static_cast<bool>(is);
+}
+
+void recordRead(bool hit, const SGTimeStamp& start)
+{
+    SGPropertyNode* stats = fgGetNode("/sim/startup/property-cache", true);
+    SGPropertyNode* count = stats->getNode(hit ? "hits" : "misses", true);
+    count->setIntValue(count->getIntValue() + 1);
+    SGPropertyNode* msec = stats->getNode("load-msec", true);
+    msec->setDoubleValue(msec->getDoubleValue() + (SGTimeStamp::now() - start).toUSecs() / 1000.0);
+}
+
+} // of anonymous namespace
+
+bool PropertyTreeCache::isEnabled()
+{
+    return fgGetBool("/sim/startup/property-cache/enabled", false);
+}
+
+std::string PropertyTreeCache::keyFor(const SGPath& path, int defaultMode)
+{
+    std::string key = std::to_string(CACHE_VERSION) + ":" + std::to_string(defaultMode) + ";";
+    std::set<std::string> visited;
+    hashFile(path, key, visited);
+    return simgear::strutils::md5(key);
+}
+
+SGPath PropertyTreeCache::cacheDir()
+{
+    return globals->get_fg_home() / "PropertyCache";
+}
+
+bool PropertyTreeCache::write(std::ostream& os, const SGPropertyNode* root, const NodeFilter& filter)
+{
+    os.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    writeValue(os, CACHE_VERSION);
+    return writeChildren(os, root, root, filter) && os;
+}
+
+bool PropertyTreeCache::read(std::istream& is, SGPropertyNode* root)
+{
+    // check the whole record before modifying the tree
+    const std::streampos start = is.tellg();
+    if (!readTree(is, nullptr)) {
+        return false;
+    }
+
+    is.clear();
+    is.seekg(start);
+    return readTree(is, root);
+}
+
+void PropertyTreeCache::readProperties(const SGPath& path, SGPropertyNode* node, int defaultMode)
+{
+    if (!isEnabled()) {
+        ::readProperties(path, node, defaultMode);
+        return;
+    }
+
+    StartupTrace::Scope traceScope("readProperties:" + path.file(), "property-cache");
+    SGTimeStamp st;
+    st.stamp();
+
+    const SGPath cacheFile = cacheDir() / (keyFor(path, defaultMode) + ".props");
+    if (cacheFile.exists()) {
+        std::istringstream data(readFile(cacheFile));
+        if (read(data, node)) {
+            recordRead(true, st);
+            SG_LOG(SG_GENERAL, SG_DEBUG, "Read " << path << " from the property cache");
+            return;
+        }
+
+        SG_LOG(SG_GENERAL, SG_WARN, "Ignoring corrupt property cache entry " << cacheFile);
+    }
+
+    SGPropertyNode_ptr parsed = new SGPropertyNode;
+    ::readProperties(path, parsed.ptr(), defaultMode);
+
+    // applied from the cache format, so hits and misses give the same tree
+    std::ostringstream os;
+    const bool cacheable = write(os, parsed.ptr());
+    std::istringstream data(os.str());
+    if (!cacheable || !read(data, node)) {
+        ::readProperties(path, node, defaultMode);
+    }
+
+    if (cacheable && !fgGetBool("/sim/fghome-readonly", false)) {
+        simgear::Dir dir(cacheDir());
+        if (!dir.exists()) {
+            dir.create(0755);
+        }
+
+        binary::writeFileReplacing(cacheFile, [&os](std::ostream& of) { of << os.str(); });
+    }
+
+    recordRead(false, st);
+}
+
+} // namespace flightgear
@@ -0,0 +1,80 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+
+#include <simgear/misc/sg_path.hxx>
+
+class SGPropertyNode;
+
+namespace flightgear {
+
+/**
+ * An opt-in cache of parsed property list XML files, in binary form, for
+ * the large configuration files read on every aircraft load and reset:
+ * the -set.xml, sound, instrumentation, systems and property-rule
+ * configurations.
+ *
+ * A cache entry is keyed by the content hash of the file and all the
+ * files it includes, so editing any of them is picked up. The cache is
+ * enabled with /sim/startup/property-cache/enabled; the number of hits
+ * and misses and the time spent reading files are recorded below
+ * /sim/startup/property-cache, and as startup trace events.
+ */
+class PropertyTreeCache
+{
+public:
+    static bool isEnabled();
+
+    /**
+     * a replacement for readProperties(path, node, defaultMode), using
+     * the cache when it is enabled. Throws like readProperties.
+     */
+    static void readProperties(const SGPath& path, SGPropertyNode* node, int defaultMode = 0);
+
+    /**
+     * the key of a file: a hash of its contents and of the (resolved)
+     * files it includes, and the default mode it is read with
+     */
+    static std::string keyFor(const SGPath& path, int defaultMode);
+
+    static SGPath cacheDir();
+
+    using NodeFilter = std::function<bool(const SGPropertyNode*)>;
+
+    /**
+     * serialise the children of a property tree. Returns false for trees
+     * which can not be cached, such as those with extended values. With a
+     * filter, nodes it rejects are left out, with their children. Alias
+     * targets inside root are stored relative to it.
+     */
+    static bool write(std::ostream& os, const SGPropertyNode* root, const NodeFilter& filter = {});
+
+    /**
+     * apply serialised children to a tree, as readProperties would: by
+     * name and index, setting values, attributes and aliases (relative
+     * targets are resolved against root), and leaving write-protected
+     * nodes alone. Returns false if the data is corrupt.
+     */
+    static bool read(std::istream& is, SGPropertyNode* root);
+};
+
+} // namespace flightgear
@@ -0,0 +1,201 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "StartupTasks.hxx"
+
+#include <algorithm>
+#include <exception>
+
+#include <simgear/debug/logstream.hxx>
+
+#include <Main/StartupTrace.hxx>
+#include <Main/fg_props.hxx>
+
+namespace flightgear {
+
+StartupTasks* StartupTasks::instance()
+{
+    static StartupTasks static_instance;
+    return &static_instance;
+}
+
+StartupTasks::~StartupTasks()
+{
+    finish();
+}
+
+void StartupTasks::add(const std::string& name, Work work, const string_list& dependsOn)
+{
+    unsigned int threads = std::min(4u, std::max(1u, std::thread::hardware_concurrency()) - 1);
+    threads = std::max(1u, threads);
+    if (fgHasNode("/sim/startup/init-threads")) {
+        threads = static_cast<unsigned int>(std::max(0, fgGetInt("/sim/startup/init-threads")));
+    }
+
+    if (threads == 0) {
+        run(name, work);
+        std::lock_guard<std::mutex> g(_lock);
+        Task& t = _tasks[name];
+        t.dependsOn = dependsOn;
+        t.state = TaskState::Done;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> g(_lock);
+        if (_tasks.find(name) != _tasks.end()) {
+            SG_LOG(SG_GENERAL, SG_DEV_WARN, "StartupTasks: duplicate task " << name);
+            return;
+        }
+
+        Task& t = _tasks[name];
+        t.work = std::move(work);
+        t.dependsOn = dependsOn;
+    }
+
+    startThreads(threads);
+    _taskAdded.notify_all();
+}
+
+bool StartupTasks::has(const std::string& name) const
+{
+    std::lock_guard<std::mutex> g(_lock);
+    return _tasks.find(name) != _tasks.end();
+}
+
+bool StartupTasks::isDone(const std::string& name) const
+{
+    std::lock_guard<std::mutex> g(_lock);
+    auto it = _tasks.find(name);
+    return (it != _tasks.end()) && (it->second.state == TaskState::Done);
+}
+
+void StartupTasks::wait(const std::string& name)
+{
+    const auto start = StartupTrace::now();
+    std::unique_lock<std::mutex> g(_lock);
+    auto it = _tasks.find(name);
+    if (it == _tasks.end()) {
+        return;
+    }
+
+    if (it->second.state == TaskState::Done) {
+        return;
+    }
+
+    _taskDone.wait(g, [it] { return it->second.state == TaskState::Done; });
+    g.unlock();
+    StartupTrace::addEvent("wait:" + name, "startup-task", start, StartupTrace::now());
+}
+
+void StartupTasks::finish()
+{
+    {
+        std::unique_lock<std::mutex> g(_lock);
+        _taskDone.wait(g, [this] { return allDone(); });
+        _stopping = true;
+    }
+
+    _taskAdded.notify_all();
+    for (auto& t : _threads) {
+        t.join();
+    }
+
+    std::lock_guard<std::mutex> g(_lock);
+    _threads.clear();
+    _stopping = false;
+}
+
+bool StartupTasks::isReady(const Task& t) const
+{
+    if (t.state != TaskState::Pending) {
+        return false;
+    }
+
+    for (const auto& dep : t.dependsOn) {
+        auto it = _tasks.find(dep);
+        if ((it != _tasks.end()) && (it->second.state != TaskState::Done)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool StartupTasks::allDone() const
+{
+    return std::all_of(_tasks.begin(), _tasks.end(), [](const std::pair<const std::string, Task>& t) {
+        return t.second.state == TaskState::Done;
+    });
+}
+
+void StartupTasks::startThreads(unsigned int count)
+{
+    std::lock_guard<std::mutex> g(_lock);
+    while (_threads.size() < count) {
+        _threads.emplace_back(&StartupTasks::workerMain, this);
+    }
+}
+
+void StartupTasks::workerMain()
+{
+    std::unique_lock<std::mutex> g(_lock);
+    for (;;) {
+        auto it = _tasks.end();
+        _taskAdded.wait(g, [this, &it] {
+            if (_stopping) {
+                return true;
+            }
+
+            it = std::find_if(_tasks.begin(), _tasks.end(), [this](const std::pair<const std::string, Task>& t) {
+                return isReady(t.second);
+            });
+            return it != _tasks.end();
+        });
+
+        if (_stopping) {
+            return;
+        }
+
+        it->second.state = TaskState::Running;
+        const std::string name = it->first;
+        Work work = std::move(it->second.work);
+
+        g.unlock();
+        run(name, work);
+        g.lock();
+
+        it->second.state = TaskState::Done;
+        // completing a task may make dependent tasks ready
+        _taskDone.notify_all();
+        _taskAdded.notify_all();
+    }
+}
+
+void StartupTasks::run(const std::string& name, const Work& work)
+{
+    StartupTrace::Scope scope(name, "startup-task");
+    try {
+        work();
+    } catch (std::exception& e) {
+        SG_LOG(SG_GENERAL, SG_WARN, "StartupTasks: task " << name << " failed:" << e.what());
+    }
+}
+
+} // namespace flightgear
@@ -0,0 +1,108 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simgear/misc/strutils.hxx>
+
+namespace flightgear {
+
+/**
+ * Small dependency-graph scheduler for startup work which does not need
+ * the main thread: parsing data files into detached property trees and
+ * similar. Tasks declare the names of the tasks they depend on, and run on
+ * a pool of worker threads as soon as those have completed, overlapping
+ * with the sequential main-thread startup in fgIdleFunction.
+ *
+ * Consumers (usually a subsystem's init()) call wait() for the task whose
+ * result they need; if the task already finished this costs nothing.
+ *
+ * Task work must not touch the global property tree, or any other state
+ * owned by the main thread. So far that is the AI scenario scan and parse
+ * and the AI performance database.
+ */
+class StartupTasks
+{
+public:
+    using Work = std::function<void()>;
+
+    static StartupTasks* instance();
+
+    ~StartupTasks();
+
+    /**
+     * add a task. Unknown dependencies are treated as already complete.
+     * With /sim/startup/init-threads set to 0, the work runs immediately on
+     * the calling thread.
+     */
+    void add(const std::string& name, Work work, const string_list& dependsOn = {});
+
+    bool has(const std::string& name) const;
+
+    bool isDone(const std::string& name) const;
+
+    /**
+     * block until the named task has completed. Returns immediately for
+     * unknown tasks.
+     */
+    void wait(const std::string& name);
+
+    /**
+     * wait for all tasks to complete, and stop the worker threads
+     */
+    void finish();
+
+private:
+    StartupTasks() = default;
+
+    enum class TaskState {
+        Pending,
+        Running,
+        Done
+    };
+
+    struct Task {
+        Work work;
+        string_list dependsOn;
+        TaskState state = TaskState::Pending;
+    };
+
+    // must be called with the lock held
+    bool isReady(const Task& t) const;
+    bool allDone() const;
+
+    void startThreads(unsigned int count);
+    void workerMain();
+    void run(const std::string& name, const Work& work);
+
+    mutable std::mutex _lock;
+    std::condition_variable _taskAdded;
+    std::condition_variable _taskDone;
+    std::map<std::string, Task> _tasks;
+    std::vector<std::thread> _threads;
+    bool _stopping = false;
+};
+
+} // namespace flightgear
@@ -0,0 +1,228 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "StartupTrace.hxx"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/misc/sg_path.hxx>
+#include <simgear/structure/subsystem_mgr.hxx>
+
+namespace flightgear {
+
+namespace {
+
+struct TraceEvent {
+    std::string name;
+    std::string category;
+    int64_t start;
+    int64_t duration;
+    int thread;
+};
+
+const auto static_epoch = std::chrono::steady_clock::now();
+std::atomic<bool> static_enabled{false};
+
+std::mutex static_eventsLock;
+std::vector<TraceEvent> static_events;
+std::map<std::thread::id, int> static_threadIds;
+
+// must be called with the events lock held
+int threadIndex()
+{
+    const auto id = std::this_thread::get_id();
+    auto it = static_threadIds.find(id);
+    if (it == static_threadIds.end()) {
+        it = static_threadIds.insert(std::make_pair(id, static_cast<int>(static_threadIds.size()))).first;
+    }
+    return it->second;
+}
+
+std::string jsonEscape(const std::string& s)
+{
+    std::string r;
+    r.reserve(s.size());
+    for (char c : s) {
+        if ((c == '"') || (c == '\\')) {
+            r.push_back('\\');
+            r.push_back(c);
+        } else if (static_cast<unsigned char>(c) >= 0x20) {
+            r.push_back(c);
+        }
+    }
+    return r;
+}
+
+const char* categoryForState(SGSubsystem::State state)
+{
+    switch (state) {
+    case SGSubsystem::State::BIND: return "bind";
+    case SGSubsystem::State::INIT: return "init";
+    case SGSubsystem::State::POSTINIT: return "postinit";
+    default:
+        return nullptr;
+    }
+}
+
+class SubsystemTraceDelegate : public SGSubsystemMgr::Delegate
+{
+public:
+    void willChange(SGSubsystem* sub, SGSubsystem::State newState) override
+    {
+        if (!StartupTrace::isEnabled() || !categoryForState(newState)) {
+            return;
+        }
+
+        // incremental init calls willChange repeatedly; keep the first
+        _pending.insert(std::make_pair(std::make_pair(sub, newState), StartupTrace::now()));
+    }
+
+    void didChange(SGSubsystem* sub, SGSubsystem::State newState) override
+    {
+        auto it = _pending.find(std::make_pair(sub, newState));
+        if (it == _pending.end()) {
+            return;
+        }
+
+        StartupTrace::addEvent(sub->subsystemId(), categoryForState(newState),
+                               it->second, StartupTrace::now());
+        _pending.erase(it);
+    }
+
+    void clear()
+    {
+        _pending.clear();
+    }
+
+private:
+    // subsystem state changes only happen on the main thread
+    std::map<std::pair<SGSubsystem*, SGSubsystem::State>, int64_t> _pending;
+};
+
+SubsystemTraceDelegate static_delegate;
+SGSubsystemMgr* static_tracedManager = nullptr;
+
+} // of anonymous namespace
+
+void StartupTrace::setEnabled(bool enabled)
+{
+    static_enabled = enabled;
+}
+
+bool StartupTrace::isEnabled()
+{
+    return static_enabled;
+}
+
+int64_t StartupTrace::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - static_epoch)
+        .count();
+}
+
+void StartupTrace::addEvent(const std::string& name, const std::string& category,
+                            int64_t startUSec, int64_t endUSec)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> g(static_eventsLock);
+    static_events.push_back(TraceEvent{name, category, startUSec,
+                                       endUSec - startUSec, threadIndex()});
+}
+
+void StartupTrace::traceSubsystems(SGSubsystemMgr* mgr)
+{
+    if (!mgr || (mgr == static_tracedManager)) {
+        return;
+    }
+
+    mgr->addDelegate(&static_delegate);
+    static_tracedManager = mgr;
+}
+
+void StartupTrace::untraceSubsystems(SGSubsystemMgr* mgr)
+{
+    if (!mgr || (mgr != static_tracedManager)) {
+        return;
+    }
+
+    mgr->removeDelegate(&static_delegate);
+    static_delegate.clear();
+    static_tracedManager = nullptr;
+}
+
+bool StartupTrace::writeToFile(const SGPath& path)
+{
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard<std::mutex> g(static_eventsLock);
+        events = static_events;
+    }
+
+    sg_ofstream f(path, std::ios::out | std::ios::trunc);
+    if (!f.is_open()) {
+        SG_LOG(SG_GENERAL, SG_WARN, "Unable to write startup trace to " << path);
+        return false;
+    }
+
+    f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& e : events) {
+        if (!first) {
+            f << ",\n";
+        }
+        first = false;
+        f << "{\"name\":\"" << jsonEscape(e.name) << "\",\"cat\":\"" << jsonEscape(e.category)
+          << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+          << ",\"ts\":" << e.start << ",\"dur\":" << e.duration << "}";
+    }
+    f << "\n]}\n";
+
+    SG_LOG(SG_GENERAL, SG_INFO, "Wrote startup trace (" << events.size() << " events) to " << path);
+    return true;
+}
+
+void StartupTrace::clear()
+{
+    std::lock_guard<std::mutex> g(static_eventsLock);
+    static_events.clear();
+}
+
+StartupTrace::Scope::Scope(const std::string& name, const std::string& category) : _name(name),
+                                                                                    _category(category),
+                                                                                    _start(StartupTrace::now())
+{
+}
+
+StartupTrace::Scope::~Scope()
+{
+    StartupTrace::addEvent(_name, _category, _start, StartupTrace::now());
+}
+
+} // namespace flightgear
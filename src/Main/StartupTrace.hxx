@@ -0,0 +1,86 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+class SGPath;
+class SGSubsystemMgr;
+
+namespace flightgear {
+
+/**
+ * Records the wall-clock time of startup (and reset) phases, subsystem
+ * bind/init/postinit calls and background startup tasks, and writes them
+ * as a Chrome trace (JSON 'complete' events), viewable in chrome://tracing
+ * or Perfetto.
+ *
+ * Recording is enabled by setting /sim/startup/trace-file; the trace is
+ * written once the main loop is entered.
+ */
+class StartupTrace
+{
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /// microseconds since the trace epoch, on a monotonic clock
+    static int64_t now();
+
+    /**
+     * record a completed event. Safe to call from any thread; the thread
+     * is recorded so parallel work shows up on separate tracks.
+     */
+    static void addEvent(const std::string& name, const std::string& category,
+                         int64_t startUSec, int64_t endUSec);
+
+    /**
+     * register a delegate with the subsystem manager, so subsystem
+     * bind / init / postinit calls are recorded individually.
+     */
+    static void traceSubsystems(SGSubsystemMgr* mgr);
+
+    /**
+     * remove the delegate again; must be called before the manager is
+     * destroyed, so a new manager (after a reset) is traced in turn.
+     */
+    static void untraceSubsystems(SGSubsystemMgr* mgr);
+
+    static bool writeToFile(const SGPath& path);
+
+    static void clear();
+
+    /**
+     * RAII helper recording an event for its lifetime, when tracing is
+     * enabled.
+     */
+    class Scope
+    {
+    public:
+        Scope(const std::string& name, const std::string& category);
+        ~Scope();
+
+    private:
+        const std::string _name;
+        const std::string _category;
+        const int64_t _start;
+    };
+};
+
+} // namespace flightgear
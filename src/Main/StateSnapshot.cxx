@@ -0,0 +1,405 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "StateSnapshot.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <sstream>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/structure/commands.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Main/PropertyTreeCache.hxx>
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+#include <Main/util.hxx>
+
+namespace flightgear {
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'F', 'G', 'S', 'N', 'A', 'P', 'S', 'H'};
+const uint32_t SNAPSHOT_VERSION = 1;
+
+/// the property tree is saved as one section per top-level node, named
+/// with this prefix, so snapshots share the subtrees which did not change
+const char PROPERTIES_SECTION_PREFIX[] = "properties:";
+
+/// subtrees which describe the session rather than the simulation, and
+/// those of AI objects: the AI manager saves and recreates the objects,
+/// which would not happen for properties restored on their own
+const char* const EXCLUDED_PROPERTIES[] = {
+    "/ai/models",
+    "/sim/signals",
+    "/sim/startup",
+    "/sim/snapshot",
+    "/sim/rendering",
+    "/sim/gui",
+    "/sim/menubar",
+    "/devices",
+    "/input",
+    "/nasal"
+};
+
+bool isPropertiesSection(const std::string& name)
+{
+    return name.compare(0, strlen(PROPERTIES_SECTION_PREFIX), PROPERTIES_SECTION_PREFIX) == 0;
+}
+
+using SectionData = std::vector<std::pair<std::string, std::string>>;
+
+SectionData savePropertyTree()
+{
+    std::set<const SGPropertyNode*> excluded;
+    for (auto path : EXCLUDED_PROPERTIES) {
+        excluded.insert(fgGetNode(path));
+    }
+
+    for (auto n : fgGetNode("/sim/snapshot", true)->getChildren("exclude")) {
+        excluded.insert(fgGetNode(n->getStringValue()));
+    }
+
+    auto accept = [&excluded](const SGPropertyNode* node) {
+        const auto type = node->getType();
+        if ((type == simgear::props::EXTENDED) || (type == simgear::props::VEC3D) ||
+            (type == simgear::props::VEC4D))
+        {
+            return false;
+        }
+
+        return node->getAttribute(SGPropertyNode::READ) && (excluded.count(node) == 0);
+    };
+
+    // each subtree is written relative to the root, so aliases between
+    // them resolve as before
+    const SGPropertyNode* root = globals->get_props();
+    SectionData sections;
+    for (int i = 0; i < root->nChildren(); ++i) {
+        const SGPropertyNode* top = root->getChild(i);
+        if (!accept(top)) {
+            continue;
+        }
+
+        std::ostringstream os;
+        PropertyTreeCache::write(os, root, [root, top, &accept](const SGPropertyNode* node) {
+            return ((node->getParent() != root) || (node == top)) && accept(node);
+        });
+        sections.push_back(std::make_pair(PROPERTIES_SECTION_PREFIX + top->getDisplayName(true), os.str()));
+    }
+
+    return sections;
+}
+
+} // of anonymous namespace
+
+StateSnapshot::Section StateSnapshot::section(const std::string& name) const
+{
+    auto it = std::find_if(_sections.begin(), _sections.end(),
+                           [&name](const SectionList::value_type& s) { return s.first == name; });
+    return (it == _sections.end()) ? Section{} : it->second;
+}
+
+size_t StateSnapshot::sizeInBytes() const
+{
+    size_t size = 0;
+    for (const auto& s : _sections) {
+        size += s.second->size();
+    }
+
+    return size;
+}
+
+StateSnapshotManager::StateSnapshotManager() = default;
+
+StateSnapshotManager::~StateSnapshotManager() = default;
+
+void StateSnapshotManager::init()
+{
+    auto cmdMgr = globals->get_commands();
+    cmdMgr->addCommand("snapshot-take", this, &StateSnapshotManager::commandTake);
+    cmdMgr->addCommand("snapshot-restore", this, &StateSnapshotManager::commandRestore);
+    cmdMgr->addCommand("snapshot-delete", this, &StateSnapshotManager::commandDelete);
+}
+
+void StateSnapshotManager::shutdown()
+{
+    auto cmdMgr = globals->get_commands();
+    cmdMgr->removeCommand("snapshot-take");
+    cmdMgr->removeCommand("snapshot-restore");
+    cmdMgr->removeCommand("snapshot-delete");
+
+    _snapshots.clear();
+    _last.reset();
+}
+
+void StateSnapshotManager::addParticipant(const std::string& name, StateSnapshotParticipant* participant)
+{
+    removeParticipant(name);
+    _participants.push_back(std::make_pair(name, participant));
+}
+
+void StateSnapshotManager::removeParticipant(const std::string& name)
+{
+    auto it = std::remove_if(_participants.begin(), _participants.end(),
+                             [&name](const ParticipantList::value_type& p) { return p.first == name; });
+    _participants.erase(it, _participants.end());
+}
+
+StateSnapshotManager::ParticipantList StateSnapshotManager::participants() const
+{
+    ParticipantList result = _participants;
+    SGSubsystemMgr* mgr = globals->get_subsystem_mgr();
+    for (int g = 0; g < SGSubsystemMgr::MAX_GROUPS; ++g) {
+        SGSubsystemGroup* group = mgr->get_group(static_cast<SGSubsystemMgr::GroupType>(g));
+        for (const auto& name : group->member_names()) {
+            auto participant = dynamic_cast<StateSnapshotParticipant*>(group->get_subsystem(name));
+            auto sameName = [&name](const ParticipantList::value_type& p) { return p.first == name; };
+            if (participant && std::none_of(result.begin(), result.end(), sameName)) {
+                result.push_back(std::make_pair(name, participant));
+            }
+        }
+    }
+
+    return result;
+}
+
+StateSnapshotRef StateSnapshotManager::take()
+{
+    SGTimeStamp st;
+    st.stamp();
+
+    // let Nasal code put its state into the property tree
+    fgSetBool("/sim/signals/snapshot-save", true);
+
+    auto snapshot = std::make_shared<StateSnapshot>();
+    snapshot->_simTimeSec = globals->get_sim_time_sec();
+    snapshot->_aircraft = fgGetString("/sim/aircraft");
+
+    auto addSection = [this, &snapshot](const std::string& name, std::string data) {
+        // share the data of an unchanged section with the last snapshot
+        auto previous = _last ? _last->section(name) : StateSnapshot::Section{};
+        if (previous && (*previous == data)) {
+            snapshot->_sections.push_back(std::make_pair(name, previous));
+        } else {
+            snapshot->_sections.push_back(std::make_pair(name, std::make_shared<const std::string>(std::move(data))));
+        }
+    };
+
+    for (auto& s : savePropertyTree()) {
+        addSection(s.first, std::move(s.second));
+    }
+    for (const auto& p : participants()) {
+        std::ostringstream os;
+        p.second->saveSnapshot(os);
+        addSection(p.first, os.str());
+    }
+
+    fgSetBool("/sim/signals/snapshot-save", false);
+
+    _last = snapshot;
+    fgSetDouble("/sim/snapshot/last-take-msec", st.elapsedMSec());
+    fgSetInt("/sim/snapshot/last-size-bytes", static_cast<int>(snapshot->sizeInBytes()));
+    SG_LOG(SG_GENERAL, SG_INFO, "Took state snapshot at " << snapshot->simTimeSec() << "sec ("
+           << snapshot->sizeInBytes() << " bytes) in " << st.elapsedMSec() << "msec");
+    return snapshot;
+}
+
+bool StateSnapshotManager::restore(const StateSnapshotRef& snapshot)
+{
+    if (!snapshot) {
+        return false;
+    }
+
+    if (snapshot->aircraft() != fgGetString("/sim/aircraft")) {
+        SG_LOG(SG_GENERAL, SG_ALERT, "Not restoring a state snapshot of a different aircraft: "
+               << snapshot->aircraft());
+        return false;
+    }
+
+    SGTimeStamp st;
+    st.stamp();
+
+    bool ok = true;
+    for (const auto& s : snapshot->sections()) {
+        if (!isPropertiesSection(s.first)) {
+            continue;
+        }
+
+        std::istringstream is(*s.second);
+        if (!PropertyTreeCache::read(is, globals->get_props())) {
+            SG_LOG(SG_GENERAL, SG_ALERT, "Corrupt property tree in state snapshot");
+            return false;
+        }
+    }
+
+    // participants restore after the properties, which may overwrite some
+    // of their state through tied properties
+    for (const auto& p : participants()) {
+        auto section = snapshot->section(p.first);
+        if (!section) {
+            SG_LOG(SG_GENERAL, SG_WARN, "State snapshot has no state for " << p.first);
+            continue;
+        }
+
+        std::istringstream is(*section);
+        if (!p.second->restoreSnapshot(is)) {
+            SG_LOG(SG_GENERAL, SG_WARN, "Failed to restore the state of " << p.first);
+            ok = false;
+        }
+    }
+
+    globals->set_sim_time_sec(snapshot->simTimeSec());
+
+    // let Nasal code pick up its state from the property tree
+    fgSetBool("/sim/signals/snapshot-restored", true);
+    fgSetBool("/sim/signals/snapshot-restored", false);
+
+    fgSetDouble("/sim/snapshot/last-restore-msec", st.elapsedMSec());
+    SG_LOG(SG_GENERAL, SG_INFO, "Restored state snapshot of " << snapshot->simTimeSec() << "sec in "
+           << st.elapsedMSec() << "msec");
+    return ok;
+}
+
+void StateSnapshotManager::store(const std::string& name, const StateSnapshotRef& snapshot)
+{
+    _snapshots[name] = snapshot;
+}
+
+StateSnapshotRef StateSnapshotManager::find(const std::string& name) const
+{
+    auto it = _snapshots.find(name);
+    return (it == _snapshots.end()) ? StateSnapshotRef{} : it->second;
+}
+
+void StateSnapshotManager::remove(const std::string& name)
+{
+    _snapshots.erase(name);
+}
+
+bool StateSnapshotManager::save(const StateSnapshotRef& snapshot, const SGPath& path, bool compress)
+{
+    // written to a temporary file, so a partial snapshot is never loaded
+    const bool ok = binary::writeFileReplacing(path, [&snapshot](std::ostream& os) {
+        os.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        snapshot::writeValue(os, SNAPSHOT_VERSION);
+        snapshot::writeValue(os, snapshot->simTimeSec());
+        snapshot::writeString(os, snapshot->aircraft());
+        snapshot::writeValue(os, static_cast<uint32_t>(snapshot->sections().size()));
+        for (const auto& s : snapshot->sections()) {
+            snapshot::writeString(os, s.first);
+            snapshot::writeString(os, *s.second);
+        }
+    }, compress);
+
+    if (!ok) {
+        SG_LOG(SG_GENERAL, SG_ALERT, "Failed writing state snapshot " << path);
+    }
+
+    return ok;
+}
+
+StateSnapshotRef StateSnapshotManager::load(const SGPath& path)
+{
+    // reads compressed and uncompressed files alike
+    sg_gzifstream is(path, std::ios::in | std::ios::binary);
+    char magic[8];
+    is.read(magic, sizeof(magic));
+    if (!is || memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) ||
+        (snapshot::readValue<uint32_t>(is) != SNAPSHOT_VERSION))
+    {
+        SG_LOG(SG_GENERAL, SG_ALERT, "Not a compatible state snapshot: " << path);
+        return {};
+    }
+
+    auto result = std::make_shared<StateSnapshot>();
+    result->_simTimeSec = snapshot::readValue<double>(is);
+    result->_aircraft = snapshot::readString(is);
+    const uint32_t count = snapshot::readValue<uint32_t>(is);
+    for (uint32_t i = 0; is && (i < count); ++i) {
+        const std::string name = snapshot::readString(is);
+        auto data = std::make_shared<const std::string>(snapshot::readString(is));
+        result->_sections.push_back(std::make_pair(name, data));
+    }
+
+    if (!is) {
+        SG_LOG(SG_GENERAL, SG_ALERT, "Corrupt state snapshot: " << path);
+        return {};
+    }
+
+    return result;
+}
+
+bool StateSnapshotManager::commandTake(const SGPropertyNode* arg, SGPropertyNode*)
+{
+    auto snapshot = take();
+    store(arg->getStringValue("name", "default"), snapshot);
+    if (!arg->hasValue("file")) {
+        return true;
+    }
+
+    const SGPath file = SGPath::fromUtf8(arg->getStringValue("file"));
+    const SGPath validated = fgValidatePath(file, true);
+    if (validated.isNull()) {
+        SG_LOG(SG_IO, SG_ALERT, "snapshot-take: writing '" << file << "' denied "
+               "(unauthorized access)");
+        return false;
+    }
+
+    return save(snapshot, validated, arg->getBoolValue("compress", true));
+}
+
+bool StateSnapshotManager::commandRestore(const SGPropertyNode* arg, SGPropertyNode*)
+{
+    StateSnapshotRef snapshot;
+    if (arg->hasValue("file")) {
+        const SGPath file = SGPath::fromUtf8(arg->getStringValue("file"));
+        const SGPath validated = fgValidatePath(file, false);
+        if (validated.isNull()) {
+            SG_LOG(SG_IO, SG_ALERT, "snapshot-restore: reading '" << file << "' denied "
+                   "(unauthorized access)");
+            return false;
+        }
+
+        snapshot = load(validated);
+    } else {
+        snapshot = find(arg->getStringValue("name", "default"));
+    }
+
+    if (!snapshot) {
+        SG_LOG(SG_GENERAL, SG_WARN, "snapshot-restore: no such snapshot");
+        return false;
+    }
+
+    return restore(snapshot);
+}
+
+bool StateSnapshotManager::commandDelete(const SGPropertyNode* arg, SGPropertyNode*)
+{
+    remove(arg->getStringValue("name", "default"));
+    return true;
+}
+
+// Register the subsystem.
+SGSubsystemMgr::Registrant<StateSnapshotManager> registrantStateSnapshotManager;
+
+} // namespace flightgear
@@ -0,0 +1,172 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <simgear/misc/sg_path.hxx>
+#include <simgear/props/props.hxx>
+#include <simgear/structure/subsystem_mgr.hxx>
+
+#include <Main/BinaryIO.hxx>
+
+namespace flightgear {
+
+/**
+ * Something with simulation state outside the property tree (integrators,
+ * filter histories, FDM internals) which can be saved in a state snapshot.
+ *
+ * Top-level subsystems implementing this take part automatically, under
+ * their subsystem name; anything else registers with the
+ * StateSnapshotManager.
+ */
+class StateSnapshotParticipant
+{
+public:
+    virtual ~StateSnapshotParticipant() = default;
+
+    virtual void saveSnapshot(std::ostream& os) = 0;
+
+    /// restore the state written by saveSnapshot; false if it can't be
+    virtual bool restoreSnapshot(std::istream& is) = 0;
+};
+
+/**
+ * The complete simulation state at one moment: the property tree, as a
+ * section per top-level node, and a binary section per participant.
+ * Snapshots are immutable and shared by reference, and sections which did
+ * not change since the previous snapshot share their data with it, so
+ * keeping many is cheap.
+ */
+class StateSnapshot
+{
+public:
+    using Section = std::shared_ptr<const std::string>;
+    using SectionList = std::vector<std::pair<std::string, Section>>;
+
+    double simTimeSec() const { return _simTimeSec; }
+    const std::string& aircraft() const { return _aircraft; }
+
+    /// in order: the property tree first, then the participants
+    const SectionList& sections() const { return _sections; }
+    Section section(const std::string& name) const;
+
+    size_t sizeInBytes() const;
+
+private:
+    friend class StateSnapshotManager;
+
+    double _simTimeSec = 0.0;
+    std::string _aircraft;
+    SectionList _sections;
+};
+
+using StateSnapshotRef = std::shared_ptr<const StateSnapshot>;
+
+/**
+ * Takes and restores simulation state snapshots, keeps named snapshots in
+ * memory, and saves them to disk.
+ *
+ * Before taking a snapshot /sim/signals/snapshot-save is set, so Nasal
+ * code can write state held in Nasal variables to the property tree;
+ * after restoring, /sim/signals/snapshot-restored is set so it can read
+ * it back. Property subtrees listed in /sim/snapshot/exclude[n] (as well
+ * as signals, startup, rendering and GUI state) are not saved.
+ *
+ * AI objects are saved by FGAIManager, which recreates them on restore,
+ * rather than as /ai/models properties.
+ *
+ * Commands: snapshot-take, snapshot-restore and snapshot-delete, with a
+ * 'name' (default "default") and optionally a 'file' to save to or load
+ * from.
+ */
+class StateSnapshotManager : public SGSubsystem
+{
+public:
+    StateSnapshotManager();
+    ~StateSnapshotManager() override;
+
+    // Subsystem API.
+    void init() override;
+    void shutdown() override;
+    void update(double dt) override {}
+
+    // Subsystem identification.
+    static const char* staticSubsystemClassId() { return "state-snapshot"; }
+
+    void addParticipant(const std::string& name, StateSnapshotParticipant* participant);
+    void removeParticipant(const std::string& name);
+
+    StateSnapshotRef take();
+
+    /**
+     * restore a snapshot of the same aircraft. Sections without a
+     * participant, and participants without a section, are skipped with a
+     * warning.
+     */
+    bool restore(const StateSnapshotRef& snapshot);
+
+    /// the named in-memory snapshots
+    void store(const std::string& name, const StateSnapshotRef& snapshot);
+    StateSnapshotRef find(const std::string& name) const;
+    void remove(const std::string& name);
+
+    static bool save(const StateSnapshotRef& snapshot, const SGPath& path, bool compress = true);
+
+    /// load a saved snapshot, compressed or not; null on failure
+    static StateSnapshotRef load(const SGPath& path);
+
+private:
+    using ParticipantList = std::vector<std::pair<std::string, StateSnapshotParticipant*>>;
+    ParticipantList participants() const;
+
+    bool commandTake(const SGPropertyNode* arg, SGPropertyNode* root);
+    bool commandRestore(const SGPropertyNode* arg, SGPropertyNode* root);
+    bool commandDelete(const SGPropertyNode* arg, SGPropertyNode* root);
+
+    ParticipantList _participants;
+    std::map<std::string, StateSnapshotRef> _snapshots;
+
+    /// the last snapshot taken, to share unchanged sections with
+    StateSnapshotRef _last;
+};
+
+/**
+ * helpers for participants writing their sections
+ */
+namespace snapshot {
+
+using binary::readValue;
+using binary::writeString;
+using binary::writeValue;
+
+/// sections, and the nested state of participants, can be large
+inline std::string readString(std::istream& is)
+{
+    return binary::readString(is, 1u << 28);
+}
+
+} // namespace snapshot
+
+} // namespace flightgear
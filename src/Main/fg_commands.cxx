@@ -42,6 +42,7 @@
 #include "fg_os.hxx"
 #include "fg_commands.hxx"
 #include "fg_props.hxx"
+#include "FrameProfiler.hxx"
 #include "globals.hxx"
 #include "logger.hxx"
 #include "util.hxx"
@@ -999,6 +1000,35 @@ do_profiler_stop(const SGPropertyNode *arg, SGPropertyNode *root)
 #endif
 }
 
+/**
+ * Record a number of frames with the frame profiler, and write them as a
+ * Chrome trace.
+ *
+ * filename: the trace file, by default Export/frame-trace.json in $FG_HOME
+ * frames: the number of frames to record, default 300
+ */
+static bool
+do_frame_profiler_trace(const SGPropertyNode *arg, SGPropertyNode *root)
+{
+  SGPath file(arg->getStringValue("filename"));
+  if (file.isNull()) {
+    file = globals->get_fg_home() / "Export" / "frame-trace.json";
+  }
+
+  SGPath validated_path = fgValidatePath(file, true);
+  if (validated_path.isNull()) {
+    SG_LOG(SG_GENERAL, SG_ALERT, "frame-profiler-trace: writing to '" << file << "' denied "
+           "(unauthorized directory - authorization no longer follows symlinks)");
+    return false;
+  }
+
+  // creates the missing parent directories
+  validated_path.create_dir(0755);
+
+  flightgear::FrameProfiler::requestTrace(validated_path, arg->getIntValue("frames", 300));
+  return true;
+}
+
 
 ////////////////////////////////////////////////////////////////////////
 // Command setup.
@@ -1056,6 +1086,7 @@ static struct {
 
     { "profiler-start", do_profiler_start },
     { "profiler-stop",  do_profiler_stop },
+    { "frame-profiler-trace", do_frame_profiler_trace },
 
     { 0, 0 }			// zero-terminated
 };
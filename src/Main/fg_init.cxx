@@ -154,6 +154,10 @@
 #include "positioninit.hxx"
 #include "util.hxx"
 #include "AircraftDirVisitorBase.hxx"
+#include "AircraftMetadataCache.hxx"
+#include "PropertyTreeCache.hxx"
+#include "StartupTrace.hxx"
+#include "StateSnapshot.hxx"
 #include <Main/sentryIntegration.hxx>
 
 #if defined(SG_MAC)
@@ -234,7 +238,7 @@ public:
         SG_LOG(SG_GENERAL, SG_INFO, "found aircraft in dir: " << aircraftDir );
         
         try {
-          readProperties(setFile, globals->get_props());
+          flightgear::PropertyTreeCache::readProperties(setFile, globals->get_props());
         } catch ( const sg_exception &e ) {
             SG_LOG(SG_IO, SG_ALERT,
                    "Error reading aircraft: " << e.getFormattedMessage());
@@ -263,7 +267,7 @@ public:
       }
     }
     
-    if (!checkCache()) {
+    if (!checkCache() && !checkMetadataCache()) {
         flightgear::addSentryBreadcrumb("Scanning aircraft paths", "info");
 
         // prepare cache for re-scan
@@ -276,6 +280,7 @@ public:
         _cache->removeChildren("aircraft");
   
         visitAircraftPaths();
+        updateMetadataCache();
     }
     
     if (_foundPath.isNull()) {
@@ -299,7 +304,7 @@ public:
     }
     
     try {
-      readProperties(_foundPath, globals->get_props());
+      flightgear::PropertyTreeCache::readProperties(_foundPath, globals->get_props());
     } catch ( const sg_exception &e ) {
       SG_LOG(SG_INPUT, SG_ALERT,
              "Error reading aircraft: " << e.getFormattedMessage());
@@ -355,8 +360,71 @@ private:
     return false;
   }
   
+  /**
+   * look for the aircraft in the metadata cache, filled by --show-aircraft
+   * and by the directory scan below, avoiding a walk of all aircraft
+   * directories
+   */
+  bool checkMetadataCache()
+  {
+    flightgear::AircraftMetadataCache cache;
+    const SGPath setFile = cache.findSetFile(_searchAircraft, searchDirs());
+    if (setFile.isNull()) {
+        return false;
+    }
+
+    flightgear::addSentryBreadcrumb("Found aircraft via metadata cache", "info");
+    // same as the directory scan, so /sim/aircraft-dir does not depend on
+    // which way the aircraft was found
+    _foundPath = setFile.realpath();
+    return true;
+  }
+
+  /**
+   * record the -set.xml files seen by the directory scan in the metadata
+   * cache. The scan stops at the aircraft, so only the directories before
+   * the one it was found in have been scanned completely.
+   */
+  void updateMetadataCache()
+  {
+    if (fgGetBool("/sim/fghome-readonly", false)) {
+        return;
+    }
+
+    simgear::PathList complete;
+    for (const auto& d : searchDirs()) {
+        std::string prefix = d.utf8Str();
+        if (!prefix.empty() && (prefix.back() != '/')) {
+            prefix += '/';
+        }
+
+        if (!_foundPath.isNull() &&
+            simgear::strutils::starts_with(_scannedSetFiles.back().utf8Str(), prefix))
+        {
+            break;
+        }
+
+        complete.push_back(d);
+    }
+
+    flightgear::AircraftMetadataCache cache;
+    cache.update(_scannedSetFiles);
+    cache.markScanned(complete);
+    cache.save();
+  }
+
+  /// the aircraft directories, in the order visitAircraftPaths() walks them
+  simgear::PathList searchDirs() const
+  {
+    simgear::PathList dirs(globals->get_aircraft_paths());
+    dirs.push_back(globals->get_fg_root() / "Aircraft");
+    return dirs;
+  }
+
   virtual VisitResult visit(const SGPath& p)
   {
+      // the metadata cache is keyed by the path under the aircraft dirs
+      _scannedSetFiles.push_back(p);
       SGPath realPath = p.realpath();
     // create cache node
     int i = 0;
@@ -426,6 +494,7 @@ private:
   }
   
   std::string _searchAircraft;
+  simgear::PathList _scannedSetFiles;
   SGPath _foundPath;
   SGPropertyNode* _cache;
 };
@@ -855,6 +924,8 @@ fgInitNav ()
         }
     }
 
+    cache->openSnapshot();
+
   FGTACANList *channellist = new FGTACANList;
   globals->set_channellist( channellist );
   
@@ -971,6 +1042,7 @@ void fgCreateSubsystems(bool duringReset) {
         globals->add_new_subsystem<FGControls>(SGSubsystemMgr::GENERAL);
         globals->add_new_subsystem<FGInput>(SGSubsystemMgr::GENERAL);
         globals->add_subsystem("history", new FGFlightHistory, SGSubsystemMgr::GENERAL);
+        globals->add_new_subsystem<flightgear::StateSnapshotManager>(SGSubsystemMgr::GENERAL);
 
         {
           SGSubsystem * httpd = flightgear::http::FGHttpd::createInstance( fgGetNode(flightgear::http::PROPERTY_ROOT) );
@@ -1102,9 +1174,27 @@ void fgPostInitSubsystems()
     fgSetBool("/sim/crashed", false);
     fgSetBool("/sim/initialized", true);
 
+    // the state to return to on a fast reset
+    fgSaveInitialState();
+
     SG_LOG( SG_GENERAL, SG_INFO, endl);
 }
 
+namespace {
+
+// the state restored by a fast reset, saved once initialisation is complete
+SGPropertyNode_ptr static_initialState;
+
+void reinitSubsystem(const char* name)
+{
+    auto subsystem = globals->get_subsystem(name);
+    if (subsystem) {
+        subsystem->reinit();
+    }
+}
+
+} // of anonymous namespace
+
 // re-position is a simplified version of the traditional (legacy)
 // reset procedure. We only need to poke systems which will be upset by
 // a sudden change in aircraft position. Since this potentially includes
@@ -1127,7 +1217,9 @@ void fgStartReposition()
   fgSetBool("/sim/crashed", false);
   
   FDMShell* fdm = globals->get_subsystem<FDMShell>();
-  fdm->unbind();
+  if (fdm) {
+    fdm->unbind();
+  }
   
   // update our position based on current presets
   // this will mark position as needed finalized which we'll do in the
@@ -1140,10 +1232,12 @@ void fgStartReposition()
   }
   
   // Initialize the FDM
-  globals->get_subsystem<FDMShell>()->reinit();
+  if (fdm) {
+    fdm->reinit();
+  }
   
   // reset replay buffers
-  globals->get_subsystem<FGReplay>()->reinit();
+  reinitSubsystem("replay");
   
   // ugly: finalizePosition waits for METAR to arrive for the new airport.
   // we don't re-init the environment manager here, since historically we did
@@ -1163,13 +1257,15 @@ void fgStartReposition()
     }
 
   // need to bind FDMshell again
-  fdm->bind();
+  if (fdm) {
+    fdm->bind();
+  }
 
   // need to reset aircraft (systems/instruments/autopilot)
   // so they can adapt to current environment
-  globals->get_subsystem("systems")->reinit();
-  globals->get_subsystem("instrumentation")->reinit();
-  globals->get_subsystem("xml-autopilot")->reinit();
+  reinitSubsystem("systems");
+  reinitSubsystem("instrumentation");
+  reinitSubsystem("xml-autopilot");
 
   // need to update the timezone
   auto timeManager = globals->get_subsystem<TimeManager>();
@@ -1186,8 +1282,90 @@ void fgStartReposition()
   flightgear::addSentryBreadcrumb("end of reposition", "info");
 }
 
+void fgSaveInitialState()
+{
+    if (!fgGetBool("/sim/startup/fast-reset", false)) {
+        static_initialState.clear();
+        return;
+    }
+
+    // copy the read/writeable state; user-archived and preserved values
+    // are kept on reset anyway
+    const int checked = SGPropertyNode::READ | SGPropertyNode::WRITE |
+                        SGPropertyNode::USERARCHIVE | SGPropertyNode::PRESERVE;
+    const int expected = SGPropertyNode::READ | SGPropertyNode::WRITE;
+    static_initialState = new SGPropertyNode;
+    if (!copyProperties(globals->get_props(), static_initialState, expected, checked)) {
+        SG_LOG(SG_GENERAL, SG_INFO, "Some errors saving the initial state");
+    }
+
+    // presets hold the position to reset to, and the Nasal modules stay
+    // loaded, so neither are restored. AI models and canvases own their
+    // property nodes and remove them when they go away; restoring those
+    // would leave ghost nodes behind.
+    SGPropertyNode* sim = static_initialState->getChild("sim", 0, true);
+    sim->removeChildren("presets");
+    sim->removeChildren("startup");
+    static_initialState->removeChildren("nasal");
+    static_initialState->removeChildren("canvas");
+    SGPropertyNode* ai = static_initialState->getChild("ai");
+    if (ai) {
+        ai->removeChildren("models");
+    }
+    SGPropertyNode* cameraGroup = sim->getNode("rendering/camera-group");
+    if (cameraGroup) {
+        cameraGroup->removeChildren("camera");
+        cameraGroup->removeChildren("gui");
+    }
+}
+
+bool fgStartFastReset()
+{
+    if (!fgGetBool("/sim/startup/fast-reset", false) || !static_initialState) {
+        return false;
+    }
+
+    // a different aircraft needs the full reset
+    const std::string aircraft = static_initialState->getStringValue("sim/aircraft");
+    if (aircraft != fgGetString("/sim/aircraft")) {
+        SG_LOG(SG_GENERAL, SG_INFO, "fgStartFastReset: aircraft changed, doing a full reset");
+        return false;
+    }
+
+    SG_LOG(SG_GENERAL, SG_INFO, "fgStartFastReset()");
+    flightgear::addSentryBreadcrumb("start fast reset", "info");
+    flightgear::StartupTrace::Scope traceScope("fast-reset", "startup");
+    SGTimeStamp st;
+    st.stamp();
+
+    if (copyProperties(static_initialState, globals->get_props())) {
+        SG_LOG(SG_GENERAL, SG_INFO, "Initial state restored successfully");
+    } else {
+        SG_LOG(SG_GENERAL, SG_INFO,
+               "Some errors restoring initial state (read-only props?)");
+    }
+
+    // force re-updating the AI models, which the FDM uses to find the
+    // ground level, and the view offsets
+    reinitSubsystem("ai-model");
+    reinitSubsystem("view-manager");
+
+    // everything else which depends on the state is re-initialised as
+    // for a reposition; the aircraft, scenery, navdata and Nasal modules
+    // stay loaded.
+    fgStartReposition();
+
+    fgSetDouble("/sim/startup/last-reset-msec", st.elapsedMSec());
+    SG_LOG(SG_GENERAL, SG_INFO, "Fast reset took:" << st.elapsedMSec());
+    flightgear::addSentryBreadcrumb("end of fast reset", "info");
+    return true;
+}
+
 void fgStartNewReset()
 {
+    // the saved initial state belongs to the old property tree
+    static_initialState.clear();
+
     flightgear::addSentryTag("have-reset", "yes");
 
     // save user settings now, so that USERARCIVE-d values changes since the
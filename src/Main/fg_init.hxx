@@ -81,6 +81,15 @@ void fgPostInitSubsystems();
 // less work than a full re-init.
 void fgStartReposition();
 
+// Save the state a fast reset returns to, if /sim/startup/fast-reset is
+// set. Called at the end of fgPostInitSubsystems.
+void fgSaveInitialState();
+
+// Fast reset: restore the saved initial state and re-initialise the
+// simulation state, keeping the loaded aircraft, scenery, navdata and
+// Nasal modules. Returns false if a full reset is needed instead.
+bool fgStartFastReset();
+
 void fgStartNewReset();
 
 // setup the package system including the global root
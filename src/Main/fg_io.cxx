@@ -40,6 +40,7 @@
 #include <simgear/misc/strutils.hxx>
 #include <simgear/structure/commands.hxx>
 
+#include <Main/FrameProfiler.hxx>
 #include <Network/protocol.hxx>
 #include <Network/ATC-Main.hxx>
 #include <Network/atlas.hxx>
@@ -62,6 +63,7 @@
 #include <Network/ray.hxx>
 #include <Network/rul.hxx>
 #include <Network/generic.hxx>
+#include <Network/ThreadedIOChannel.hxx>
 
 #if FG_HAVE_DDS
 #include <simgear/io/SGDataDistributionService.hxx>
@@ -357,6 +359,10 @@ FGIO::parse_port_config( const string_list& tokens, bool& o_ok )
 }
 
 
+FGIO::FGIO() = default;
+
+FGIO::~FGIO() = default;
+
 // step through the port config streams (from fgOPTIONS) and setup
 // serial port channels for each
 void
@@ -366,6 +372,8 @@ FGIO::init()
     //         globals->get_channel_options_list()->size() << " requests." );
 
     _realDeltaTime = fgGetNode("/sim/time/delta-realtime-sec");
+    _channelsNode = fgGetNode("/io/channels", true);
+    const bool threaded = fgGetBool("/sim/io/threaded-channels");
 
     // we could almost do this in a single step except pushing a valid
     // port onto the port list copies the structure and destroys the
@@ -373,11 +381,12 @@ FGIO::init()
 
     for (const auto& config : *(globals->get_channel_options_list())) {
         bool ok;
-        FGProtocol* p = add_channel(config, ok);
+        FGProtocol* p = add_channel(config, ok, threaded);
         SG_LOG( SG_IO, SG_DEBUG, "add_channel() with config=" << config << " => ok=" << ok << " p=" << p);
         if (ok) {
             if (p) {
                 addToPropertyTree(p->get_name(), config);
+                logThreaded(p);
             }
         }
         else {
@@ -391,7 +400,7 @@ FGIO::init()
 }
 
 // add another I/O channel
-FGProtocol* FGIO::add_channel(const string& config, bool& o_ok)
+FGProtocol* FGIO::add_channel(const string& config, bool& o_ok, bool threaded)
 {
     // parse the configuration string and store the results in the
     // appropriate FGIOChannel structure
@@ -405,6 +414,13 @@ FGProtocol* FGIO::add_channel(const string& config, bool& o_ok)
         return nullptr;
     }
 
+    if (threaded) {
+        // UDP sockets must keep returning one datagram per read
+        const auto tokens = simgear::strutils::split(config, ",");
+        const bool udp = (tokens.size() > 6) && (tokens[1] == "socket") && (tokens[6] == "udp");
+        makeThreaded(p, udp);
+    }
+
     p->open();
     if ( !p->is_enabled() ) {
         SG_LOG( SG_IO, SG_ALERT, "I/O Channel config failed." );
@@ -447,6 +463,10 @@ FGIO::update( double /* delta_time_sec */ )
         p->dec_count_down( delta_time_sec );
         double dt = 1 / p->get_hz();
         if ( p->get_count_down() < 0.33 * dt ) {
+            // looking up the name isn't free, so only when profiling
+            const int scope = flightgear::FrameProfiler::isActive() ?
+                flightgear::FrameProfiler::scopeId("io/" + p->get_name()) : -1;
+            flightgear::FrameProfiler::Scope profile(scope);
             p->process();
             p->inc_count();
             while ( p->get_count_down() < 0.33 * dt ) {
@@ -454,6 +474,57 @@ FGIO::update( double /* delta_time_sec */ )
             }
         } // of channel processing
     } // of io_channels iteration
+
+    if (_executor) {
+        publishThreadedStats();
+    }
+}
+
+bool FGIO::makeThreaded(FGProtocol* p, bool datagrams)
+{
+    SGIOChannel* channel = p->get_io_channel();
+    if (!channel) {
+        return false;
+    }
+
+    // files are read in lock-step with the simulation (playback, replay
+    // with 'repeat'), only real devices benefit from the I/O thread
+    const auto type = channel->get_type();
+    if ((type != sgSocketType) && (type != sgSerialType)) {
+        return false;
+    }
+
+    if (!_executor) {
+        _executor.reset(new FGIOExecutor);
+    }
+
+    const int capacity = fgGetInt("/sim/io/threaded-queue-size", 256);
+    p->set_io_channel(new FGThreadedIOChannel(channel, _executor.get(),
+                                              std::max(capacity, 1), datagrams));
+    return true;
+}
+
+void FGIO::logThreaded(FGProtocol* p)
+{
+    // only once the channel has its final name
+    if (dynamic_cast<FGThreadedIOChannel*>(p->get_io_channel())) {
+        SG_LOG(SG_IO, SG_INFO, "I/O channel \"" << p->get_name() << "\" uses the I/O thread");
+    }
+}
+
+void FGIO::publishThreadedStats()
+{
+    for (auto p : io_channels) {
+        auto threaded = dynamic_cast<FGThreadedIOChannel*>(p->get_io_channel());
+        if (!threaded || !p->is_enabled()) {
+            continue;
+        }
+
+        SGPropertyNode* channelNode = _channelsNode->getChild(p->get_name());
+        if (channelNode) {
+            threaded->publishStats(channelNode->getChild("threaded", 0, true));
+        }
+    }
 }
 
 void
@@ -473,7 +544,10 @@ FGIO::shutdown()
     }
 
     io_channels.clear();
-    
+
+    // all threaded channels are closed, it's safe to stop the thread
+    _executor.reset();
+
     auto cmdMgr = globals->get_commands();
     cmdMgr->removeCommand("add-io-channel");
     cmdMgr->removeCommand("remove-io-channel");
@@ -517,8 +591,9 @@ bool FGIO::commandAddChannel(const SGPropertyNode * arg, SGPropertyNode * root)
 
     string name = arg->getStringValue("name");
     const string config = arg->getStringValue("config");
+    const bool threaded = arg->getBoolValue("threaded", fgGetBool("/sim/io/threaded-channels"));
     bool ok;
-    auto protocol = add_channel(config, ok);
+    auto protocol = add_channel(config, ok, threaded);
     if (!ok) {
         SG_LOG(SG_NETWORK, SG_WARN, "add-io-channel: adding channel failed");
         return false;
@@ -548,6 +623,7 @@ bool FGIO::commandAddChannel(const SGPropertyNode * arg, SGPropertyNode * root)
     }
     // add entry to /io/channels/<name>
     addToPropertyTree(protocol->get_name(), config);
+    logThreaded(protocol);
 
     return true;
 }
@@ -29,16 +29,18 @@
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/props/props.hxx>
 
+#include <memory>
 #include <vector>
 #include <string>
 
 class FGProtocol;
+class FGIOExecutor;
 
 class FGIO : public SGSubsystem
 {
 public:
-    FGIO() = default;
-    ~FGIO() = default;
+    FGIO();
+    ~FGIO();
 
     // Subsystem API.
     void bind() override;
@@ -59,7 +61,7 @@ public:
     static bool isMultiplayerRequested();
 
 private:
-    FGProtocol* add_channel(const std::string& config, bool& o_ok);
+    FGProtocol* add_channel(const std::string& config, bool& o_ok, bool threaded);
     
     FGProtocol* parse_port_config( const std::string& cfgstr, bool& o_ok );
     FGProtocol* parse_port_config( const string_list& tokens, bool& o_ok );
@@ -68,6 +70,15 @@ private:
     void removeFromPropertyTree(const string name);
     string generateName(const string protocol);
 
+    /**
+     * move the socket or serial I/O of a channel to the executor thread.
+     * Returns false (leaving the channel alone) for other transports.
+     * datagrams is set for UDP sockets.
+     */
+    bool makeThreaded(FGProtocol* p, bool datagrams);
+    void logThreaded(FGProtocol* p);
+    void publishThreadedStats();
+
 private:
     // define the global I/O channel list
     //io_container global_io_list;
@@ -76,6 +87,10 @@ private:
     ProtocolVec io_channels;
 
     SGPropertyNode_ptr _realDeltaTime;
+    SGPropertyNode_ptr _channelsNode;
+
+    // created on demand, when the first threaded channel is added
+    std::unique_ptr<FGIOExecutor> _executor;
     
     bool commandAddChannel(const SGPropertyNode * arg, SGPropertyNode * root);
     bool commandRemoveChannel(const SGPropertyNode * arg, SGPropertyNode * root);
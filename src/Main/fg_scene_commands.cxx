@@ -82,11 +82,16 @@ do_exit (const SGPropertyNode * arg, SGPropertyNode * root)
 
 /**
  * Reset FlightGear (Shift-Escape or Menu->File->Reset)
+ *
+ * With /sim/startup/fast-reset set, and the same aircraft, only the
+ * simulation state is re-initialised; see fgStartFastReset().
  */
 static bool
 do_reset (const SGPropertyNode * arg, SGPropertyNode * root)
 {
-    fgResetIdleState();
+    if (!fgStartFastReset()) {
+        fgResetIdleState();
+    }
     return true;
 }
 
@@ -458,7 +463,9 @@ static bool
 do_presets_commit (const SGPropertyNode * arg, SGPropertyNode * root)
 {
     if (fgGetBool("/sim/initialized", false)) {
-      fgResetIdleState();
+      if (!fgStartFastReset()) {
+        fgResetIdleState();
+      }
     } else {
       // Nasal can trigger this during initial init, which confuses
       // the logic in ReInitSubsystems, since initial state has not been
@@ -66,6 +66,7 @@
 
 #include "fg_props.hxx"
 #include "fg_io.hxx"
+#include "StartupTrace.hxx"
 
 class AircraftResourceProvider : public simgear::ResourceProvider
 {
@@ -233,6 +234,7 @@ FGGlobals::~FGGlobals()
     FGFontCache::shutdown();
     fgCancelSnapShot();
 
+    flightgear::StartupTrace::untraceSubsystems(subsystem_mgr);
     delete subsystem_mgr;
     subsystem_mgr = nullptr; // important so ::get_subsystem returns NULL
     vb = nullptr;
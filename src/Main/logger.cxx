@@ -8,7 +8,9 @@
 #endif
 
 #include "logger.hxx"
+#include "LogWriter.hxx"
 
+#include <algorithm>
 #include <ios>
 #include <string>
 #include <cstdlib>
@@ -70,6 +72,16 @@ FGLogger::init ()
       exit(EXIT_FAILURE);
     }
 
+    const string format = child->getStringValue("format", "csv");
+    const bool binary = (format == "binary");
+    if (!binary && (format != "csv")) {
+        SG_LOG(SG_GENERAL, SG_ALERT, "FGLogger: unknown format '" << format
+               << "' for " << filename << ", using csv");
+    }
+
+    // binary logs are always written by the writer thread
+    const bool async = binary || child->getBoolValue("async", false);
+
     string delimiter = child->getStringValue("delimiter");
     if (delimiter.empty()) {
         delimiter = ",";
@@ -80,7 +92,11 @@ FGLogger::init ()
     log.last_time_ms = globals->get_sim_time_sec() * 1000;
     log.delimiter = delimiter.c_str()[0];
     // Security: use the return value of fgValidatePath()
-    log.output.reset(new sg_ofstream(authorizedPath, std::ios_base::out));
+    std::ios_base::openmode mode = std::ios_base::out;
+    if (binary) {
+        mode |= std::ios_base::binary;
+    }
+    log.output.reset(new sg_ofstream(authorizedPath, mode));
     if ( !(*log.output) ) {
       SG_LOG(SG_GENERAL, SG_ALERT, "Cannot write log to " << filename);
       _logs.pop_back();
@@ -91,7 +107,7 @@ FGLogger::init ()
     // Process the individual entries (Time is automatic).
     //
     std::vector<SGPropertyNode_ptr> entries = child->getChildren("entry");
-    (*log.output) << "Time";
+    std::vector<string> titles;
     for (unsigned int j = 0; j < entries.size(); j++) {
       SGPropertyNode * entry = entries[j];
 
@@ -109,10 +125,29 @@ FGLogger::init ()
       SGPropertyNode * node =
 	fgGetNode(entry->getStringValue("property"), true);
       log.nodes.push_back(node);
-      (*log.output) << log.delimiter
-		    << entry->getStringValue("title", node->getPath().c_str());
+      titles.push_back(entry->getStringValue("title", node->getPath().c_str()));
+    }
+
+    if (async) {
+      const long capacity = child->getLongValue("buffer-records", 4096);
+      const int flushInterval = child->getIntValue("flush-interval-ms", 100);
+      log.writer.reset(new FGLogWriter(std::move(log.output),
+                                       binary ? FGLogWriter::FORMAT_BINARY
+                                              : FGLogWriter::FORMAT_CSV,
+                                       log.delimiter, titles,
+                                       static_cast<size_t>(std::max(capacity, 1L)),
+                                       flushInterval));
+      log.written_node = child->getNode("written-records", true);
+      log.dropped_node = child->getNode("dropped-records", true);
+      log.written_node->setLongValue(0);
+      log.dropped_node->setLongValue(0);
+    } else {
+      (*log.output) << "Time";
+      for (const auto& title : titles) {
+        (*log.output) << log.delimiter << title;
+      }
+      (*log.output) << endl;
     }
-    (*log.output) << endl;
   }
 }
 
@@ -123,6 +158,13 @@ FGLogger::reinit ()
     init();
 }
 
+void
+FGLogger::shutdown ()
+{
+    // writes out whatever the writer threads have buffered
+    _logs.clear();
+}
+
 void
 FGLogger::bind ()
 {
@@ -139,6 +181,18 @@ FGLogger::update (double dt)
     double sim_time_sec = globals->get_sim_time_sec();
     double sim_time_ms = sim_time_sec * 1000;
     for (unsigned int i = 0; i < _logs.size(); i++) {
+        if (_logs[i]->writer) {
+            Log& log = *_logs[i];
+            while ((sim_time_ms - log.last_time_ms) >= log.interval_ms) {
+                log.last_time_ms += log.interval_ms;
+                log.writer->append(sim_time_sec, log.nodes);
+            }
+
+            log.written_node->setLongValue(static_cast<long>(log.writer->written()));
+            log.dropped_node->setLongValue(static_cast<long>(log.writer->dropped()));
+            continue;
+        }
+
         while ((sim_time_ms - _logs[i]->last_time_ms) >= _logs[i]->interval_ms) {
             _logs[i]->last_time_ms += _logs[i]->interval_ms;
             (*_logs[i]->output) << sim_time_sec;
@@ -164,6 +218,10 @@ FGLogger::Log::Log ()
 {
 }
 
+FGLogger::Log::~Log ()
+{
+}
+
 
 // Register the subsystem.
 SGSubsystemMgr::Registrant<FGLogger> registrantFGLogger;
@@ -14,8 +14,14 @@
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/props/props.hxx>
 
+class FGLogWriter;
+
 /**
  * Log any property values to any number of CSV files.
+ *
+ * A log with <async>true</async>, or <format>binary</format>, hands its
+ * records to a FGLogWriter, which formats and writes them on a thread of
+ * its own.
  */
 class FGLogger : public SGSubsystem
 {
@@ -25,6 +31,7 @@ public:
     void init() override;
     void reinit() override;
     void unbind() override;
+    void shutdown() override;
     void update(double dt) override;
 
     // Subsystem identification.
@@ -36,12 +43,17 @@ private:
      */
     struct Log {
       Log ();
+      ~Log ();
 
       std::vector<SGPropertyNode_ptr> nodes;
       std::unique_ptr<sg_ofstream> output;
       long interval_ms;
       double last_time_ms;
       char delimiter;
+
+      std::unique_ptr<FGLogWriter> writer;  // null when logging synchronously
+      SGPropertyNode_ptr written_node;
+      SGPropertyNode_ptr dropped_node;
     };
 
     std::vector< std::unique_ptr<Log> > _logs;
@@ -50,6 +50,8 @@
 #include <simgear/emesary/notifications.hxx>
 #include <simgear/debug/logdelta.hxx>
 
+#include <AIModel/AIManager.hxx>
+#include <AIModel/performancedb.hxx>
 #include <Add-ons/AddonManager.hxx>
 #include <GUI/MessageBox.hxx>
 #include <GUI/gui.h>
@@ -70,10 +72,13 @@
 #include "fg_io.hxx"
 #include "fg_os.hxx"
 #include "fg_props.hxx"
+#include "FrameProfiler.hxx"
 #include "main.hxx"
 #include "options.hxx"
 #include "positioninit.hxx"
 #include "screensaver_control.hxx"
+#include "StartupTasks.hxx"
+#include "StartupTrace.hxx"
 #include "subsystemFactory.hxx"
 #include "util.hxx"
 #include <Main/ErrorReporter.hxx>
@@ -102,6 +107,8 @@ extern int _bootstrap_OSInit;
 static SGPropertyNode_ptr frame_signal;
 static SGPropertyNode_ptr nasal_gc_threaded;
 static SGPropertyNode_ptr nasal_gc_threaded_wait;
+static SGPropertyNode_ptr frame_profiler_enabled;
+static SGPropertyNode_ptr performance_monitor_enabled;
 
 #ifdef NASAL_BACKGROUND_GC_THREAD
 extern "C" {
@@ -145,6 +152,9 @@ static void fgMainLoop( void )
     if (notify_gc_config)
          simgear::Emesary::GlobalTransmitter::instance()->NotifyAll(ngccn);
 
+    FrameProfiler::setEnabled(frame_profiler_enabled->getBoolValue());
+    FrameProfiler::beginFrame();
+
      simgear::Emesary::GlobalTransmitter::instance()->NotifyAll(mln_begin);
 
     if (sglog().has_popup()) {
@@ -161,13 +171,27 @@ static void fgMainLoop( void )
     timeManager->computeTimeDeltas(sim_dt, real_dt);
 
     // update all subsystems
-    globals->get_subsystem_mgr()->update(sim_dt);
+    {
+        static const int subsystemsScope = FrameProfiler::scopeId("subsystems");
+        FrameProfiler::Scope profile(subsystemsScope);
+        globals->get_subsystem_mgr()->update(sim_dt);
+
+        // SGPerformanceMonitor uses the same timing hook
+        FrameProfiler::collectSubsystemTimes(globals->get_subsystem_mgr(),
+                                             !performance_monitor_enabled->getBoolValue());
+    }
 
     // flush commands waiting in the queue
-    SGCommandMgr::instance()->executedQueuedCommands();
-    simgear::AtomicChangeListener::fireChangeListeners();
+    {
+        static const int commandsScope = FrameProfiler::scopeId("queued-commands");
+        FrameProfiler::Scope profile(commandsScope);
+        SGCommandMgr::instance()->executedQueuedCommands();
+        simgear::AtomicChangeListener::fireChangeListeners();
+    }
 
      simgear::Emesary::GlobalTransmitter::instance()->NotifyAll(mln_end);
+
+    FrameProfiler::endFrame();
 }
 
 static void initTerrasync()
@@ -278,6 +302,9 @@ void registerMainLoop()
     frame_signal = fgGetNode("/sim/signals/frame", true);
     nasal_gc_threaded = fgGetNode("/sim/nasal-gc-threaded", true);
     nasal_gc_threaded_wait = fgGetNode("/sim/nasal-gc-threaded-wait", true);
+    frame_profiler_enabled = fgGetNode("/sim/performance/profile/enabled", true);
+    performance_monitor_enabled = fgGetNode("/sim/performance-monitor/enabled", true);
+    FrameProfiler::setPropertyRoot(fgGetNode("/sim/performance/profile", true));
     fgRegisterIdleHandler( fgMainLoop );
 }
 
@@ -286,6 +313,9 @@ void unregisterMainLoopProperties()
     frame_signal.reset();
     nasal_gc_threaded.reset();
     nasal_gc_threaded_wait.reset();
+    frame_profiler_enabled.reset();
+    performance_monitor_enabled.reset();
+    FrameProfiler::setPropertyRoot(nullptr);
 }
 
 } // namespace flightgear
@@ -298,12 +328,69 @@ void unregisterMainLoopProperties()
 // then on.
 
 static int idle_state = 0;
+static int64_t startup_trace_begin = -1;
+static std::string startup_trace_path;
+static bool startup_trace_is_reset = false;
+
+static const char* idleStateTraceName(int state)
+{
+    switch (state) {
+    case 0: return "gui-init";
+    case 2: return "terrasync-init";
+    case 3: return "nav-init";
+    case 4: return "general-init";
+    case 5:
+    case 2005: return "position-init";
+    case 7:
+    case 2007: return "create-subsystems";
+    case 8: return "bind-subsystems";
+    case 9: return "init-subsystems";
+    case 10: return "postinit-subsystems";
+    case 900: return "setup-view";
+    case 2000: return "reset-shutdown";
+    default: return "idle";
+    }
+}
+
+// (re-)start recording the startup trace, if /sim/startup/trace-file is set
+static void beginStartupTrace(bool isReset)
+{
+    startup_trace_path = fgGetString("/sim/startup/trace-file");
+    startup_trace_is_reset = isReset;
+    flightgear::StartupTrace::clear();
+    flightgear::StartupTrace::setEnabled(!startup_trace_path.empty());
+    if (!startup_trace_path.empty()) {
+        flightgear::StartupTrace::traceSubsystems(globals->get_subsystem_mgr());
+    }
+
+    startup_trace_begin = flightgear::StartupTrace::now();
+}
+
+static void endStartupTrace()
+{
+    if (!flightgear::StartupTrace::isEnabled()) {
+        return;
+    }
+
+    flightgear::StartupTrace::addEvent(startup_trace_is_reset ? "reset" : "time-to-main-loop", "startup",
+                                       startup_trace_begin, flightgear::StartupTrace::now());
+    flightgear::StartupTrace::writeToFile(SGPath::fromUtf8(startup_trace_path));
+    flightgear::StartupTrace::setEnabled(false);
+}
 
 static void fgIdleFunction ( void ) {
     // Specify our current idle function state.  This is used to run all
     // our initializations out of the idle callback so that we can get a
     // splash screen up and running right away.
 
+    if ((idle_state == 0) && (startup_trace_begin < 0)) {
+        beginStartupTrace(false);
+    } else if (idle_state == 2000) {
+        beginStartupTrace(true);
+    }
+
+    flightgear::StartupTrace::Scope traceScope(idleStateTraceName(idle_state), "startup");
+
     if ( idle_state == 0 ) {
         if (guiInit())
         {
@@ -336,6 +423,12 @@ static void fgIdleFunction ( void ) {
             throw sg_exception("General initialization failed");
         }
 
+        // the aircraft and add-on paths are known now, so data needed by
+        // later subsystem init can be parsed on worker threads, overlapping
+        // with scenery init and subsystem creation.
+        FGAIManager::prefetchScenarios();
+        PerformanceDB::prefetch();
+
         // now we have commands up
         flightgear::delayedSentryInit();
 
@@ -421,6 +514,10 @@ static void fgIdleFunction ( void ) {
     if ( idle_state == 1000 ) {
         sglog().setStartupLoggingEnabled(false);
 
+        // any startup tasks nobody waited for are finished now
+        flightgear::StartupTasks::instance()->finish();
+        endStartupTrace();
+
         // We've finished all our initialization steps, from now on we
         // run the main loop.
         fgSetBool("sim/sceneryloaded", false);
@@ -82,7 +82,7 @@
 #include <Environment/presets.hxx>
 #include <Network/http/httpd.hxx>
 #include <Network/HTTPClient.hxx>
-#include "AircraftDirVisitorBase.hxx"
+#include "AircraftMetadataCache.hxx"
 
 #include <osg/Version>
 #include <flightgearBuildId.h>
@@ -265,7 +265,7 @@ void fgSetDefaults ()
 // resides here so we can share the fgFindAircraftInDir template above,
 // and hence ensure this command lists exectly the same aircraft as the normal
 // loading path.
-class ShowAircraft : public AircraftDirVistorBase
+class ShowAircraft
 {
 public:
     ShowAircraft()
@@ -276,9 +276,17 @@ public:
 
     void show(const vector<SGPath> & path_list)
     {
-		for (vector<SGPath>::const_iterator p = path_list.begin();
-			 p != path_list.end(); ++p)
-			visitDir(*p, 0);
+        // only new or modified -set.xml files are parsed
+        flightgear::AircraftMetadataCache cache;
+        const auto setFiles = flightgear::AircraftMetadataCache::findSetFiles(path_list);
+        for (const auto& m : cache.update(setFiles)) {
+            add(m);
+        }
+        cache.markScanned(path_list);
+
+        if (!fgGetBool("/sim/fghome-readonly", false)) {
+            cache.save();
+        }
 
         simgear::requestConsole(false); // ensure console is shown on Windows
 
@@ -294,48 +302,40 @@ public:
     }
 
 private:
-    virtual VisitResult visit(const SGPath& path)
+    void add(const flightgear::AircraftMetadata& m)
     {
-        SGPropertyNode root;
-        try {
-            readProperties(path, &root);
-        } catch (sg_exception& ) {
-            return VISIT_CONTINUE;
+        // files without a <sim> element are still listed, as maturity 0
+        if (!m.parsed) {
+            return;
         }
 
         int maturity = 0;
         string descStr("   ");
-        descStr += path.file();
+        descStr += m.path.file();
         // trim common suffix from file names
         int nPos = descStr.rfind("-set.xml");
         if (nPos == (int)(descStr.size() - 8)) {
             descStr.resize(nPos);
         }
 
-        SGPropertyNode *node = root.getNode("sim");
-        if (node) {
-            SGPropertyNode* desc = node->getNode("description");
-            // if a status tag is found, read it in
-            if (node->hasValue("status")) {
-                maturity = getNumMaturity(node->getStringValue("status"));
-            }
+        // if a status tag is found, read it in
+        if (!m.status.empty()) {
+            maturity = getNumMaturity(m.status.c_str());
+        }
 
-            if (desc) {
-                if (descStr.size() <= 27+3) {
-                    descStr.append(29+3-descStr.size(), ' ');
-                } else {
-                    descStr += '\n';
-                    descStr.append( 32, ' ');
-                }
-                descStr += desc->getStringValue();
+        if (!m.description.empty()) {
+            if (descStr.size() <= 27+3) {
+                descStr.append(29+3-descStr.size(), ' ');
+            } else {
+                descStr += '\n';
+                descStr.append( 32, ' ');
             }
-        } // of have 'sim' node
+            descStr += m.description;
+        }
 
         if (maturity >= _minStatus) {
             _aircraft.push_back(descStr);
         }
-
-        return VISIT_CONTINUE;
     }
 
 
@@ -1867,6 +1867,9 @@ struct OptionDesc {
     {"model-hz",                     true,  OPTION_INT,    "/sim/model-hz", false, "", 0 },
     {"max-fps",                      true,  OPTION_DOUBLE, "/sim/frame-rate-throttle-hz", false, "", 0 },
     {"speed",                        true,  OPTION_DOUBLE, "/sim/speed-up", false, "", 0 },
+    {"lock-step",                    false, OPTION_BOOL,   "/sim/time/lock-step/enabled", true, "", 0 },
+    {"lock-step-seed",               true,  OPTION_INT,    "/sim/time/lock-step/seed", false, "", 0 },
+    {"as-fast-as-possible",          false, OPTION_BOOL,   "/sim/time/lock-step/as-fast-as-possible", true, "", 0 },
     {"trim",                         false, OPTION_BOOL,   "/sim/presets/trim", true, "", 0 },
     {"notrim",                       false, OPTION_BOOL,   "/sim/presets/trim", false, "", 0 },
     {"on-ground",                    false, OPTION_BOOL,   "/sim/presets/onground", true, "", 0 },
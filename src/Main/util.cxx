@@ -32,6 +32,7 @@
 #include <simgear/debug/logstream.hxx>
 #include <simgear/math/SGLimits.hxx>
 #include <simgear/math/SGMisc.hxx>
+#include <simgear/math/sg_random.h>
 
 #include <GUI/MessageBox.hxx>
 #include "fg_io.hxx"
@@ -72,6 +73,13 @@ fgGetLowPass (double current, double target, double timeratio)
     return current;
 }
 
+void fgSeedRandom()
+{
+    if (!fgGetBool("/sim/time/lock-step/enabled")) {
+        sg_srandom_time();
+    }
+}
+
 static string_list read_allowed_paths;
 static string_list write_allowed_paths;
 
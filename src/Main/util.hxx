@@ -36,6 +36,13 @@
  */
 double fgGetLowPass (double current, double target, double timeratio);
 
+/**
+ * Re-seed the random number generators from the clock. In lock-step mode
+ * this does nothing: the time manager seeds them once from
+ * /sim/time/lock-step/seed, so runs can be repeated exactly.
+ */
+void fgSeedRandom();
+
 /**
  * File access control, used by Nasal and fgcommands.
  * @param path Path to be validated
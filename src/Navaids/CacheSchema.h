@@ -1,7 +1,7 @@
 #ifndef FG_NAVCACHE_SCHEMA_HXX
 #define FG_NAVCACHE_SCHEMA_HXX
 
-const int SCHEMA_VERSION = 20;
+const int SCHEMA_VERSION = 21;
 
 #define SCHEMA_SQL \
 "CREATE TABLE properties (key VARCHAR, value VARCHAR);" \
@@ -34,5 +34,25 @@ const int SCHEMA_VERSION = 20;
 "CREATE INDEX airway_edge_from ON airway_edge(a);" \
 "CREATE INDEX airway_edge_to ON airway_edge(b);"
 
+// full-text index of the positioned names, where the trigram tokenizer
+// allows matching any part of a name. The rowid is the positioned rowid.
+// Created separately from the tables above since the SQLite library
+// might lack FTS5, and filled once a rebuild has inserted everything,
+// after which the triggers keep it up to date.
+#define NAME_INDEX_SQL \
+"CREATE VIRTUAL TABLE positioned_names USING fts5(name, type UNINDEXED, tokenize='trigram')"
+
+#define NAME_INDEX_FILL_SQL \
+"INSERT INTO positioned_names (rowid, name, type) SELECT rowid, name, type FROM positioned WHERE name != ''"
+
+#define NAME_INDEX_TRIGGERS_SQL \
+"CREATE TRIGGER positioned_names_insert AFTER INSERT ON positioned WHEN new.name != '' BEGIN " \
+    "INSERT INTO positioned_names (rowid, name, type) VALUES (new.rowid, new.name, new.type); END", \
+"CREATE TRIGGER positioned_names_delete AFTER DELETE ON positioned BEGIN " \
+    "DELETE FROM positioned_names WHERE rowid=old.rowid; END", \
+"CREATE TRIGGER positioned_names_update AFTER UPDATE OF name, type ON positioned BEGIN " \
+    "DELETE FROM positioned_names WHERE rowid=old.rowid; " \
+    "INSERT INTO positioned_names (rowid, name, type) SELECT new.rowid, new.name, new.type WHERE new.name != ''; END"
+
 #endif
 
@@ -218,6 +218,7 @@ void FlightPlan::insertWayptsAtIndex(const WayptVec& wps, int aIndex)
   lockDelegates();
   _waypointsChanged = true;
   _legs.insert(it, newLegs.begin(), newLegs.end());
+  invalidateRoutePath(index, 0, static_cast<int>(newLegs.size()));
   unlockDelegates();
 }
 
@@ -240,6 +241,7 @@ void FlightPlan::deleteIndex(int aIndex)
   LegRef l = *it;
   _legs.erase(it);
   l->_parent = nullptr; // orphan the leg so it's clear from Nasal
+  invalidateRoutePath(index, 1, 0);
     
   if (_currentIndex == index) {
     // current waypoint was removed
@@ -292,6 +294,7 @@ void FlightPlan::clearLegs()
 
   _currentIndex = -1;
   _legs.clear();  
+  invalidateRoutePath();
   
     notifyCleared();
   unlockDelegates();
@@ -348,6 +351,7 @@ int FlightPlan::clearWayptsWithFlag(WayptFlag flag)
   }
   
   _legs.erase(it, _legs.end());
+  invalidateRoutePath();
     
   if (_legs.empty()) { // maybe all legs were deleted
       notifyCleared();
@@ -883,6 +887,7 @@ bool FlightPlan::load(const SGPath& path)
     _cruiseDataChanged = true;
     _waypointsChanged = true;
     _didLoadFP = true;
+    invalidateRoutePath();
 
     unlockDelegates();
     
@@ -934,6 +939,7 @@ bool FlightPlan::load(std::istream &stream)
     _cruiseDataChanged = true;
     _waypointsChanged = true;
     _didLoadFP = true;
+    invalidateRoutePath();
 
     unlockDelegates();
     
@@ -1432,6 +1438,7 @@ void FlightPlan::activate()
       
       _waypointsChanged = true;
       _legs.insert(it, newLegs.begin(), newLegs.end());
+      invalidateRoutePath(i, 1, static_cast<int>(newLegs.size()));
     } else {
       ++i; // normal case, no expansion
     }
@@ -1605,6 +1612,8 @@ bool FlightPlan::Leg::setHoldCount(int count)
     auto fp = owner();
     fp->lockDelegates();
     fp->_waypointsChanged = true;
+    const int i = index();
+    fp->invalidateRoutePath(i, 1, 1);
     fp->unlockDelegates();
   }
   
@@ -1639,7 +1648,7 @@ void FlightPlan::rebuildLegData()
 {
   _totalDistance = 0.0;
   double totalDistanceIncludingMissed = 0.0;
-  RoutePath path(this);
+  const RoutePath& path = routePath();
   
   for (unsigned int l=0; l<_legs.size(); ++l) {
     _legs[l]->_courseDeg = path.trackForIndex(l);
@@ -1659,13 +1668,12 @@ void FlightPlan::rebuildLegData()
   
 SGGeod FlightPlan::pointAlongRoute(int aIndex, double aOffsetNm) const
 {
-    RoutePath rp(this);
-    return rp.positionForDistanceFrom(aIndex, aOffsetNm * SG_NM_TO_METER);
+    return routePath().positionForDistanceFrom(aIndex, aOffsetNm * SG_NM_TO_METER);
 }
 
 SGGeod FlightPlan::pointAlongRouteNorm(int aIndex, double aOffsetNorm) const
 {
-    RoutePath rp(this);
+    const RoutePath& rp = routePath();
     if (fabs(aOffsetNorm) > 1.0) {
         SG_LOG(SG_AUTOPILOT, SG_ALERT, "FlightPlan::pointAlongRouteNorm: called with invalid arg:" << aOffsetNorm);
         return rp.positionForIndex(aIndex);
@@ -1687,6 +1695,61 @@ SGGeod FlightPlan::pointAlongRouteNorm(int aIndex, double aOffsetNorm) const
     return rp.positionForDistanceFrom(aIndex, d * aOffsetNorm);
 }
 
+const RoutePath& FlightPlan::routePath() const
+{
+    const int count = numLegs();
+    if (!_routePath) {
+        _routePath.reset(new RoutePath(this));
+    } else if (_routePathChangedBegin >= 0) {
+        _routePath->update(this, _routePathChangedBegin, _routePathChangedEnd);
+    } else if (_routePathLegCount != count) {
+        // all legs were replaced, or they changed without telling us
+        _routePath->update(this, 0, count);
+    }
+
+    _routePathChangedBegin = _routePathChangedEnd = -1;
+    _routePathLegCount = count;
+    return *_routePath;
+}
+
+void FlightPlan::invalidateRoutePath(int index, int removed, int inserted)
+{
+    if (!_routePath || (_routePathLegCount < 0)) {
+        return; // will be computed from scratch anyway
+    }
+
+    if (_routePathChangedBegin < 0) {
+        _routePathChangedBegin = index;
+        _routePathChangedEnd = index + inserted;
+        return;
+    }
+
+    // merge with the pending change, whose end moves with the legs after it
+    if (_routePathChangedEnd >= index + removed) {
+        _routePathChangedEnd += inserted - removed;
+    } else if (_routePathChangedEnd > index) {
+        _routePathChangedEnd = index + inserted;
+    }
+
+    _routePathChangedBegin = std::min(_routePathChangedBegin, index);
+    _routePathChangedEnd = std::max(_routePathChangedEnd, index + inserted);
+}
+
+void FlightPlan::invalidateRoutePath()
+{
+    _routePathChangedBegin = _routePathChangedEnd = -1;
+    _routePathLegCount = -1;
+}
+
+void FlightPlan::resetRoutePath()
+{
+    // the turn radii and climb performance come from the AircraftPerformance
+    // created with the path, which has to be created again
+    _routePath.reset();
+    _routePathChangedBegin = _routePathChangedEnd = -1;
+    rebuildLegData();
+}
+
 void FlightPlan::lockDelegates()
 {
   if (_delegateLock == 0) {
@@ -1809,7 +1872,14 @@ FlightPlan::Delegate::~Delegate()
 
 void FlightPlan::setFollowLegTrackToFixes(bool tf)
 {
+    if (tf == _followLegTrackToFix) {
+        return;
+    }
+
     _followLegTrackToFix = tf;
+    // changes the turns of every leg
+    invalidateRoutePath();
+    rebuildLegData();
 }
 
 bool FlightPlan::followLegTrackToFixes() const
@@ -1834,7 +1904,10 @@ void FlightPlan::setIcaoAircraftCategory(const std::string& cat)
         throw sg_range_exception("Invalid ICAO aircraft category:", cat);
     }
 
-    _aircraftCategory = cat[0];
+    if (cat[0] != _aircraftCategory) {
+        _aircraftCategory = cat[0];
+        resetRoutePath();
+    }
 }
 
 void FlightPlan::setIcaoAircraftType(const string &ty)
@@ -2001,6 +2074,7 @@ bool FlightPlan::parseICAORouteString(const std::string& routeData)
         delete l;
     }
     _legs.clear();
+    invalidateRoutePath();
     insertWayptsAtIndex(enroute, 0);
 
     unlockDelegates();
@@ -2084,6 +2158,7 @@ void FlightPlan::setCruiseSpeedKnots(int kts)
     _cruiseAirspeedKnots = kts;
     _cruiseAirspeedMach = 0.0;
     _cruiseDataChanged = true;
+    resetRoutePath();
     unlockDelegates();
 }
 
@@ -2098,6 +2173,7 @@ void FlightPlan::setCruiseSpeedMach(double mach)
     _cruiseDataChanged = true;
     _cruiseAirspeedMach = mach;
     _cruiseAirspeedKnots = 0;
+    resetRoutePath();
     unlockDelegates();
 }
 
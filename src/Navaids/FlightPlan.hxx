@@ -25,10 +25,13 @@
 #define FG_FLIGHTPLAN_HXX
 
 #include <functional>
+#include <memory>
 
 #include <Navaids/route.hxx>
 #include <Airports/airport.hxx>
 
+class RoutePath;
+
 namespace flightgear
 {
 
@@ -336,6 +339,14 @@ public:
      */
   SGGeod pointAlongRouteNorm(int aIndex, double aOffsetNorm) const;
 
+  /**
+   * the path flown along the legs, including turns and procedure legs.
+   * This is computed on first use; after that, changes to the legs only
+   * recompute the legs they affect, so it is cheap to call every frame.
+   * Code modifying a waypoint in place must call Leg::markWaypointDirty.
+   */
+  const RoutePath& routePath() const;
+
   /**
     @brief given an index to insert a waypoint into the plan, find the geographical vicinity.
         This is used to aid disambiguration searches, etc: see the vicinity paramter to 'waypointFromString'
@@ -470,6 +481,22 @@ private:
   double _totalDistance;
   void rebuildLegData();
 
+  /**
+   * record that the legs [index, index + removed) were replaced by
+   * 'inserted' legs, so the route path can be updated incrementally
+   */
+  void invalidateRoutePath(int index, int removed, int inserted);
+  /// all legs were replaced
+  void invalidateRoutePath();
+  /// the aircraft performance changed, compute the route path from scratch
+  void resetRoutePath();
+
+  mutable std::unique_ptr<RoutePath> _routePath;
+  // the changed legs since the route path was updated, or -1 if none
+  mutable int _routePathChangedBegin = -1;
+  mutable int _routePathChangedEnd = -1;
+  mutable int _routePathLegCount = 0;
+
   using LegVec = std::vector<LegRef>;
   LegVec _legs;
 
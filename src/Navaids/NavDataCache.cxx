@@ -31,6 +31,7 @@
 #include <stdint.h> // for int64_t
 #include <sstream>  // for std::ostringstream
 #include <mutex>
+#include <random>
 
 #ifdef SYSTEM_SQLITE
 // the standard sqlite3.h doesn't give a way to set SQLITE_UINT64_TYPE,
@@ -65,6 +66,7 @@
 #include <simgear/threads/SGThread.hxx>
 
 #include "CacheSchema.h"
+#include "NavDataSnapshot.hxx"
 #include "PositionedOctree.hxx"
 #include "fix.hxx"
 #include "markerbeacon.hxx"
@@ -96,6 +98,10 @@ const int MAX_RETRIES = 10;
 
 const int CACHE_SIZE_KBYTES= 32 * 1024;
 
+// with a snapshot attached, SQLite only serves the queries the snapshot
+// cannot, so a small cache suffices
+const int SNAPSHOT_CACHE_SIZE_KBYTES = 2 * 1024;
+
 // bind a std::string to a sqlite statement. The std::string must live the
 // entire duration of the statement execution - do not pass a temporary
 // std::string, or the compiler may delete it, freeing the C-string storage,
@@ -114,6 +120,68 @@ void sqlite_bind_temp_stdstring(sqlite3_stmt* stmt, int value, const std::string
 
 typedef sqlite3_stmt* sqlite3_stmt_ptr;
 
+// the name index uses the FTS5 trigram tokenizer, added in SQLite 3.34
+bool haveTrigramTokenizer()
+{
+  return (sqlite3_libversion_number() >= 3034000) &&
+         sqlite3_compileoption_used("ENABLE_FTS5");
+}
+
+// the trigram index can only match terms of three characters or more
+bool isIndexableTerm(const string& term)
+{
+  size_t chars = 0;
+  for (unsigned char c : term) {
+    if ((c & 0xc0) != 0x80) { // not a UTF-8 continuation byte
+      ++chars;
+    }
+  }
+  return chars >= 3;
+}
+
+// quote a search term as an FTS5 phrase, so it is matched literally
+string nameIndexPhrase(const string& term)
+{
+  return "\"" + simgear::strutils::replace(term, "\"", "\"\"") + "\"";
+}
+
+// SQL selecting the rowids of positioneds matching typeCondition, whose
+// name contains a search term, best matches first: names starting with
+// the term, then names with a word starting with it, then shorter names.
+// Bind the term with bindNameSearchTerm().
+string nameSearchSQL(bool haveNameIndex, const string& term, const string& typeCondition)
+{
+  string sql;
+  if (!haveNameIndex) {
+    sql = "SELECT rowid FROM positioned WHERE name LIKE :contains";
+  } else if (isIndexableTerm(term)) {
+    sql = "SELECT rowid FROM positioned_names WHERE positioned_names MATCH :phrase";
+  } else {
+    // too short for the index, so only match names starting with it
+    sql = "SELECT rowid FROM positioned WHERE name LIKE :prefix";
+  }
+
+  return sql + " AND " + typeCondition +
+    " ORDER BY (name LIKE :prefix) DESC, (name LIKE :word) DESC, length(name), name";
+}
+
+void bindNameSearchTerm(sqlite3_stmt_ptr stmt, const string& term)
+{
+  const std::pair<const char*, string> values[] = {
+    {":phrase", nameIndexPhrase(term)},
+    {":prefix", term + "%"},
+    {":word", "% " + term + "%"},
+    {":contains", "%" + term + "%"}
+  };
+
+  for (const auto& v : values) {
+    const int index = sqlite3_bind_parameter_index(stmt, v.first);
+    if (index > 0) {
+      sqlite_bind_temp_stdstring(stmt, index, v.second);
+    }
+  }
+}
+
 void f_distanceCartSqrFunction(sqlite3_context* ctx, int argc, sqlite3_value* argv[])
 {
   if (argc != 6) {
@@ -267,6 +335,8 @@ public:
     db(nullptr),
     path(p),
     readOnly(false),
+    haveNameIndex(false),
+    haveSnapshotId(false),
     cacheHits(0),
     cacheMisses(0),
     transactionLevel(0),
@@ -331,6 +401,14 @@ public:
 
     reset(checkTables);
 
+    if (haveTrigramTokenizer()) {
+      sqlite3_stmt_ptr checkNameIndex =
+        prepare("SELECT count(*) FROM sqlite_master WHERE name='positioned_names'");
+      execSelect(checkNameIndex);
+      haveNameIndex = (sqlite3_column_int(checkNameIndex, 0) > 0);
+      finalize(checkNameIndex);
+    }
+
     readPropertyQuery = prepare("SELECT value FROM properties WHERE key=?");
     writePropertyQuery = prepare("INSERT INTO properties (key, value) VALUES (?,?)");
     clearProperty = prepare("DELETE FROM properties WHERE key=?1");
@@ -343,6 +421,8 @@ public:
         SG_LOG(SG_NAVCACHE, SG_INFO, "Navcache schema mismatch, will rebuild");
         throw sg_exception("Navcache schema has changed");
       }
+
+      haveSnapshotId = !readSnapshotId().empty();
     }
 
     // see http://www.sqlite.org/pragma.html#pragma_cache_size
@@ -530,6 +610,37 @@ public:
 
           runSQL(sql);
       } // of commands in scheme loop
+
+      if (!haveTrigramTokenizer()) {
+          SG_LOG(SG_NAVCACHE, SG_INFO, "SQLite lacks the FTS5 trigram tokenizer, names will not be indexed");
+          return;
+      }
+
+      try {
+          runSQL(NAME_INDEX_SQL);
+      } catch (sg_exception& e) {
+          SG_LOG(SG_NAVCACHE, SG_WARN, "failed to create the name index:" << e.getFormattedMessage());
+      }
+  }
+
+  /**
+   * Fill the name index, and keep it up to date from now on. Done at the
+   * end of a rebuild, since indexing everything at once is much faster
+   * than row by row.
+   */
+  void buildNameIndex()
+  {
+      if (!haveNameIndex) {
+          return;
+      }
+
+      runSQL(NAME_INDEX_FILL_SQL);
+      for (const char* sql : {NAME_INDEX_TRIGGERS_SQL}) {
+          runSQL(sql);
+      }
+
+      // merge the index into a single b-tree, for the fastest queries
+      runSQL("INSERT INTO positioned_names (positioned_names) VALUES ('optimize')");
   }
 
   void prepareQueries()
@@ -625,6 +736,16 @@ public:
     sqlite3_bind_int(searchAirports, 2, FGPositioned::AIRPORT);
     sqlite3_bind_int(searchAirports, 3, FGPositioned::SEAPORT);
 
+    if (haveNameIndex) {
+      // ?1 is the term as a name index phrase, ?4 the term followed by '%'
+      searchAirportsIndexed = prepare("SELECT ident, name FROM positioned WHERE rowid IN "
+                                      "(SELECT rowid FROM positioned_names WHERE positioned_names MATCH ?1 "
+                                      "UNION SELECT rowid FROM positioned WHERE ident LIKE ?4) " AND_TYPED
+                                      " ORDER BY (ident LIKE ?4) DESC, (name LIKE ?4) DESC, name");
+      searchAirportsPrefix = prepare("SELECT ident, name FROM positioned WHERE (name LIKE ?1 OR ident LIKE ?1) " AND_TYPED
+                                     " ORDER BY (ident LIKE ?1) DESC, name");
+    }
+
     getAllAirports = prepare("SELECT ident, name FROM positioned WHERE type>=?1 AND type <=?2");
     sqlite3_bind_int(getAllAirports, 1, FGPositioned::AIRPORT);
     sqlite3_bind_int(getAllAirports, 2, FGPositioned::SEAPORT);
@@ -664,6 +785,9 @@ public:
     airwayEdgesFrom = prepare("SELECT airway, b FROM airway_edge WHERE network=?1 AND a=?2");
     airwayEdgesTo = prepare("SELECT airway, a FROM airway_edge WHERE network=?1 AND b=?2");
     airwayEdges = prepare("SELECT a, b FROM airway_edge WHERE airway=?1");
+    airwayNetworkEdges = prepare("SELECT e.airway, e.a, e.b, pa.lon, pa.lat, pb.lon, pb.lat "
+                                 "FROM airway_edge AS e, positioned AS pa, positioned AS pb "
+                                 "WHERE e.network=?1 AND pa.rowid=e.a AND pb.rowid=e.b");
   }
 
   void writeIntProperty(const string& key, int value)
@@ -789,6 +913,7 @@ public:
                                 const string& name, const SGGeod& pos, PositionedID apt,
                                 bool spatialIndex)
   {
+    invalidateSnapshot();
     SGVec3d cartPos(SGVec3d::fromGeod(pos));
 
     sqlite3_bind_int(insertPositionedQuery, 1, ty);
@@ -887,8 +1012,46 @@ public:
     deferredOctreeUpdates.clear();
   }
 
+  SGPath snapshotPath() const
+  {
+    return SGPath::fromUtf8(path.base() + ".snapshot");
+  }
+
+  string readSnapshotId()
+  {
+    sqlite_bind_temp_stdstring(readPropertyQuery, 1, "snapshot-id");
+    string result;
+    if (execSelect(readPropertyQuery)) {
+      const char* id = (const char*) sqlite3_column_text(readPropertyQuery, 0);
+      result = id ? id : "";
+    }
+
+    reset(readPropertyQuery);
+    return result;
+  }
+
+  /**
+   * the positioned data is changing: detach the snapshot, and mark the
+   * snapshot file as out of date for the other processes too
+   */
+  void invalidateSnapshot()
+  {
+    snapshot.reset();
+    if (haveSnapshotId && !readOnly) {
+      sqlite_bind_temp_stdstring(clearProperty, 1, "snapshot-id");
+      execUpdate(clearProperty);
+    }
+
+    haveSnapshotId = false;
+  }
+
+  bool writeSnapshot();
+  FGPositioned* loadFromSnapshot(const NavDataSnapshot::Positioned& p,
+                                 sqlite3_int64& aptId);
+
   void removePositionedWithIdent(FGPositioned::Type ty, const std::string& aIdent)
   {
+    invalidateSnapshot();
     sqlite3_bind_int(removePOIQuery, 1, ty);
     sqlite_bind_stdstring(removePOIQuery, 2, aIdent);
     execUpdate(removePOIQuery);
@@ -899,6 +1062,13 @@ public:
   sqlite3* db;
   SGPath path;
     bool readOnly;
+    bool haveNameIndex; ///< the positioned_names table exists
+
+  /// the mapped snapshot of the positioned data, if attached
+  std::unique_ptr<NavDataSnapshot> snapshot;
+  /// the cache records the id of a snapshot, so the snapshot file is
+  /// current until the positioned data changes
+  bool haveSnapshotId;
 
   /// the actual cache of ID -> instances. This holds an owning reference,
   /// so once items are in the cache they will never be deleted until
@@ -934,7 +1104,7 @@ public:
   sqlite3_stmt_ptr getOctreeChildren, insertOctree, updateOctreeChildren,
     getOctreeLeafChildren;
 
-  sqlite3_stmt_ptr searchAirports, getAllAirports;
+  sqlite3_stmt_ptr searchAirports, searchAirportsIndexed, searchAirportsPrefix, getAllAirports;
   sqlite3_stmt_ptr findCommByFreq, findNavsByFreq,
   findNavsByFreqNoPos, findNavaidForRunway;
   sqlite3_stmt_ptr getAirportItems, getAirportItemByIdent;
@@ -946,7 +1116,7 @@ public:
 // airways
   sqlite3_stmt_ptr findAirway, findAirwayNet, insertAirwayEdge,
     isPosInAirway, airwayEdgesFrom, airwayEdgesTo,
-    insertAirway, airwayEdges;
+    insertAirway, airwayEdges, airwayNetworkEdges;
   sqlite3_stmt_ptr loadAirway;
 
 // since there's many permutations of ident/name queries, we create
@@ -969,6 +1139,12 @@ public:
 FGPositioned* NavDataCache::NavDataCachePrivate::loadById(sqlite3_int64 rowid,
                                                           sqlite3_int64& aptId)
 {
+  if (snapshot) {
+    const NavDataSnapshot::Positioned* p = snapshot->find(rowid);
+    if (p) {
+      return loadFromSnapshot(*p, aptId);
+    }
+  }
 
   sqlite3_bind_int64(loadPositioned, 1, rowid);
   execSelect1(loadPositioned);
@@ -1042,6 +1218,210 @@ FGPositioned* NavDataCache::NavDataCachePrivate::loadById(sqlite3_int64 rowid,
   }
 }
 
+// the same objects loadById() creates, from a snapshot record
+FGPositioned* NavDataCache::NavDataCachePrivate::loadFromSnapshot(const NavDataSnapshot::Positioned& p,
+                                                                  sqlite3_int64& aptId)
+{
+  const FGPositioned::Type ty = static_cast<FGPositioned::Type>(p.type);
+  const PositionedID rowid = p.id;
+  const string ident = snapshot->string(p.ident);
+  const string name = snapshot->string(p.name);
+  aptId = p.airport;
+  const SGGeod pos = SGGeod::fromDegM(p.lon, p.lat, p.elevM);
+
+  switch (ty) {
+    case FGPositioned::AIRPORT:
+    case FGPositioned::SEAPORT:
+    case FGPositioned::HELIPORT:
+      return new FGAirport(rowid, ident, pos, name, p.detail > 0, ty);
+
+    case FGPositioned::TOWER:
+      return new AirportTower(rowid, aptId, ident, pos);
+
+    case FGPositioned::RUNWAY:
+    case FGPositioned::HELIPAD:
+    case FGPositioned::TAXIWAY:
+    {
+      const NavDataSnapshot::Runway& rwy = snapshot->runway(p);
+      if (ty == FGPositioned::TAXIWAY) {
+        return new FGTaxiway(rowid, ident, pos, rwy.heading, rwy.length, rwy.width,
+                             rwy.surface);
+      } else if (ty == FGPositioned::HELIPAD) {
+        return new FGHelipad(rowid, aptId, ident, pos, rwy.heading, rwy.length,
+                             rwy.width, rwy.surface);
+      }
+
+      FGRunway* r = new FGRunway(rowid, aptId, ident, pos, rwy.heading, rwy.length,
+                                 rwy.width, rwy.displacedThreshold, rwy.stopway,
+                                 rwy.surface);
+      if (rwy.reciprocal > 0) {
+        r->setReciprocalRunway(rwy.reciprocal);
+      }
+
+      if (rwy.ils > 0) {
+        r->setILS(rwy.ils);
+      }
+
+      return r;
+    }
+
+    case FGPositioned::LOC:
+    case FGPositioned::VOR:
+    case FGPositioned::GS:
+    case FGPositioned::ILS:
+    case FGPositioned::NDB:
+    case FGPositioned::OM:
+    case FGPositioned::MM:
+    case FGPositioned::IM:
+    case FGPositioned::DME:
+    case FGPositioned::TACAN:
+    case FGPositioned::MOBILE_TACAN:
+    {
+      const NavDataSnapshot::Navaid& nav = snapshot->navaid(p);
+      if ((ty == FGPositioned::OM) || (ty == FGPositioned::IM) ||
+          (ty == FGPositioned::MM))
+      {
+        return new FGMarkerBeaconRecord(rowid, ty, nav.runway, pos);
+      }
+
+      FGNavRecord* n =
+        (ty == FGPositioned::MOBILE_TACAN)
+        ? new FGMobileNavRecord
+              (rowid, ty, ident, name, pos, nav.freq, nav.rangeNm, nav.multiuse, nav.runway)
+        : new FGNavRecord
+              (rowid, ty, ident, name, pos, nav.freq, nav.rangeNm, nav.multiuse, nav.runway);
+
+      if (nav.colocated)
+        n->setColocatedDME(nav.colocated);
+
+      return n;
+    }
+
+    case FGPositioned::FIX:
+      return new FGFix(rowid, ident, pos);
+
+    case FGPositioned::WAYPOINT:
+    case FGPositioned::COUNTRY:
+    case FGPositioned::CITY:
+    case FGPositioned::TOWN:
+    case FGPositioned::VILLAGE:
+      return new FGPositioned(rowid, ty, ident, pos);
+
+    case FGPositioned::FREQ_GROUND:
+    case FGPositioned::FREQ_TOWER:
+    case FGPositioned::FREQ_ATIS:
+    case FGPositioned::FREQ_AWOS:
+    case FGPositioned::FREQ_APP_DEP:
+    case FGPositioned::FREQ_ENROUTE:
+    case FGPositioned::FREQ_CLEARANCE:
+    case FGPositioned::FREQ_UNICOM:
+    {
+      const NavDataSnapshot::Comm& comm = snapshot->comm(p);
+      CommStation* c = new CommStation(rowid, name, ty, pos, comm.rangeNm, comm.freqKhz);
+      c->setAirport(aptId);
+      return c;
+    }
+
+    default:
+      return NULL;
+  }
+}
+
+// write the snapshot of the positioned data and the octree, and record
+// its id
+bool NavDataCache::NavDataCachePrivate::writeSnapshot()
+{
+  std::random_device rd;
+  std::mt19937_64 gen((static_cast<uint64_t>(rd()) << 32) ^ rd() ^
+                      static_cast<uint64_t>(time(nullptr)));
+  const uint64_t id = gen();
+
+  NavDataSnapshot::Writer writer(id);
+
+  // the columns loadById() and its helpers read, by positioned rowid
+  sqlite3_stmt_ptr stmt = prepare(
+    "SELECT positioned.rowid, type, ident, name, airport, lon, lat, elev_m, octree_node, "
+    "airport.rowid, has_metar, "
+    "runway.rowid, heading, length_ft, width_m, surface, displaced_threshold, stopway, reciprocal, ils, "
+    "navaid.rowid, navaid.range_nm, freq, multiuse, navaid.runway, colocated, "
+    "comm.rowid, freq_khz, comm.range_nm "
+    "FROM positioned "
+    "LEFT JOIN airport ON airport.rowid=positioned.rowid "
+    "LEFT JOIN runway ON runway.rowid=positioned.rowid "
+    "LEFT JOIN navaid ON navaid.rowid=positioned.rowid "
+    "LEFT JOIN comm ON comm.rowid=positioned.rowid "
+    "ORDER BY positioned.rowid");
+
+  auto text = [stmt](int col) {
+    const char* s = (const char*) sqlite3_column_text(stmt, col);
+    return string(s ? s : "");
+  };
+
+  auto present = [stmt](int col) {
+    return sqlite3_column_type(stmt, col) != SQLITE_NULL;
+  };
+
+  while (stepSelect(stmt)) {
+    writer.addPositioned(sqlite3_column_int64(stmt, 0),
+                         static_cast<FGPositioned::Type>(sqlite3_column_int(stmt, 1)),
+                         text(2), text(3), sqlite3_column_int64(stmt, 4),
+                         SGGeod::fromDegM(sqlite3_column_double(stmt, 5),
+                                          sqlite3_column_double(stmt, 6),
+                                          sqlite3_column_double(stmt, 7)),
+                         sqlite3_column_int64(stmt, 8));
+
+    if (present(9)) {
+      writer.setHasMetar(sqlite3_column_int(stmt, 10) > 0);
+    } else if (present(11)) {
+      NavDataSnapshot::Runway rwy;
+      rwy.heading = sqlite3_column_double(stmt, 12);
+      rwy.length = sqlite3_column_int(stmt, 13); // as loadRunway() reads it
+      rwy.width = sqlite3_column_double(stmt, 14);
+      rwy.surface = sqlite3_column_int(stmt, 15);
+      rwy.displacedThreshold = sqlite3_column_double(stmt, 16);
+      rwy.stopway = sqlite3_column_double(stmt, 17);
+      rwy.reciprocal = sqlite3_column_int64(stmt, 18);
+      rwy.ils = sqlite3_column_int64(stmt, 19);
+      rwy.padding = 0;
+      writer.setRunway(rwy);
+    } else if (present(20)) {
+      NavDataSnapshot::Navaid nav;
+      nav.rangeNm = sqlite3_column_int(stmt, 21);
+      nav.freq = sqlite3_column_int(stmt, 22);
+      nav.multiuse = sqlite3_column_double(stmt, 23);
+      nav.runway = sqlite3_column_int64(stmt, 24);
+      nav.colocated = sqlite3_column_int64(stmt, 25);
+      writer.setNavaid(nav);
+    } else if (present(26)) {
+      NavDataSnapshot::Comm comm;
+      comm.freqKhz = sqlite3_column_int(stmt, 27);
+      comm.rangeNm = sqlite3_column_int(stmt, 28);
+      writer.setComm(comm);
+    }
+  }
+
+  finalize(stmt);
+
+  stmt = prepare("SELECT rowid, children FROM octree");
+  while (stepSelect(stmt)) {
+    writer.addOctreeBranch(sqlite3_column_int64(stmt, 0), sqlite3_column_int(stmt, 1));
+  }
+
+  finalize(stmt);
+
+  if (!writer.write(snapshotPath())) {
+    return false;
+  }
+
+  sqlite_bind_temp_stdstring(clearProperty, 1, "snapshot-id");
+  execUpdate(clearProperty);
+  sqlite_bind_temp_stdstring(writePropertyQuery, 1, "snapshot-id");
+  sqlite_bind_temp_stdstring(writePropertyQuery, 2, std::to_string(id));
+  execUpdate(writePropertyQuery);
+  haveSnapshotId = true;
+  return true;
+}
+
 bool NavDataCache::NavDataCachePrivate::isCachedFileModified(const SGPath& path, bool verbose)
 {
   if (!path.exists()) {
@@ -1314,6 +1694,7 @@ NavDataCache::~NavDataCache()
 // ensure we wip the airports cache too, or we'll get out
 // of sync during tests
   FGAirport::clearAirportsCache();
+  Airway::clearNetworkCaches();
 }
 
 NavDataCache* NavDataCache::createInstance()
@@ -1568,6 +1949,49 @@ unsigned int NavDataCache::rebuildPhaseCompletionPercentage() const
     return d->rebuilder->completionPercent();
 }
 
+void NavDataCache::openSnapshot()
+{
+    if (d->snapshot || !fgGetBool("/sim/navdb/snapshot/enabled", false)) {
+        return;
+    }
+
+    // a snapshot is only current if the cache records its id
+    const SGPath file = d->snapshotPath();
+    std::unique_ptr<NavDataSnapshot> snapshot;
+    const string id = d->readSnapshotId();
+    if (!id.empty()) {
+        snapshot = NavDataSnapshot::open(file);
+        if (snapshot && (std::to_string(snapshot->id()) != id)) {
+            SG_LOG(SG_NAVCACHE, SG_INFO, "NavCache: snapshot " << file << " is out of date");
+            snapshot.reset();
+        }
+    }
+
+    // read-only instances rely on the writeable one to provide it
+    if (!snapshot && !isReadOnly()) {
+        SGTimeStamp st;
+        st.stamp();
+        if (d->writeSnapshot()) {
+            snapshot = NavDataSnapshot::open(file);
+            SG_LOG(SG_NAVCACHE, SG_INFO, "writing the NavCache snapshot took:" << st.elapsedMSec());
+        }
+    }
+
+    if (!snapshot) {
+        SG_LOG(SG_NAVCACHE, SG_INFO, "NavCache: no snapshot available, using the database");
+        return;
+    }
+
+    SG_LOG(SG_NAVCACHE, SG_INFO, "NavCache: using snapshot " << file << " with "
+           << snapshot->size() << " positioneds");
+    d->snapshot = std::move(snapshot);
+
+    // the mapped pages are shared with other processes, and serve most reads
+    std::ostringstream q;
+    q << "PRAGMA cache_size=-" << SNAPSHOT_CACHE_SIZE_KBYTES << ";";
+    d->runSQL(q.str());
+}
+
 void NavDataCache::setRebuildPhaseProgress(RebuildPhase ph, unsigned int percent)
 {
     if (!d->rebuilder.get()) {
@@ -1613,6 +2037,7 @@ void NavDataCache::doRebuild()
   rebuildInProgress = true;
 
   try {
+    d->snapshot.reset(); // the new data will need a new snapshot
     d->close(); // completely close the sqlite object
     d->path.remove(); // remove the file on disk
     d->init(); // start again from scratch
@@ -1686,6 +2111,10 @@ void NavDataCache::doRebuild()
 
           d->flushDeferredOctreeUpdates();
 
+          st.stamp();
+          d->buildNameIndex();
+          SG_LOG(SG_NAVCACHE, SG_INFO, "building name index took:" << st.elapsedMSec());
+
           string sceneryPaths = SGPath::join(globals->get_fg_scenery(), ";");
           writeStringProperty("scenery_paths", sceneryPaths);
 
@@ -1978,6 +2407,7 @@ PositionedID NavDataCache::insertAirport(FGPositioned::Type ty, const string& id
 
 void NavDataCache::updatePosition(PositionedID item, const SGGeod &pos)
 {
+  d->invalidateSnapshot();
   if (d->cache.find(item) != d->cache.end()) {
     SG_LOG(SG_NAVCACHE, SG_DEBUG, "updating position of an item in the cache");
     d->cache[item]->modifyPosition(pos);
@@ -2063,6 +2493,7 @@ NavDataCache::insertRunway(FGPositioned::Type ty, const string& ident,
 
 void NavDataCache::setRunwayReciprocal(PositionedID runway, PositionedID recip)
 {
+  d->invalidateSnapshot();
   sqlite3_bind_int64(d->setRunwayReciprocal, 1, runway);
   sqlite3_bind_int64(d->setRunwayReciprocal, 2, recip);
   d->execUpdate(d->setRunwayReciprocal);
@@ -2075,6 +2506,7 @@ void NavDataCache::setRunwayReciprocal(PositionedID runway, PositionedID recip)
 
 void NavDataCache::setRunwayILS(PositionedID runway, PositionedID ils)
 {
+  d->invalidateSnapshot();
   sqlite3_bind_int64(d->setRunwayILS, 1, runway);
   sqlite3_bind_int64(d->setRunwayILS, 2, ils);
   d->execUpdate(d->setRunwayILS);
@@ -2110,6 +2542,7 @@ NavDataCache::insertNavaid(FGPositioned::Type ty, const string& ident,
 
 void NavDataCache::setNavaidColocated(PositionedID navaid, PositionedID colocatedDME)
 {
+  d->invalidateSnapshot();
   // Update DB entries...
   sqlite3_bind_int64(d->setNavaidColocated, 1, navaid);
   sqlite3_bind_int64(d->setNavaidColocated, 2, colocatedDME);
@@ -2154,6 +2587,7 @@ bool NavDataCache::removePOI(FGPositioned::Type ty, const std::string& aIdent)
 
 void NavDataCache::setAirportMetar(const string& icao, bool hasMetar)
 {
+  d->invalidateSnapshot();
   sqlite_bind_stdstring(d->setAirportMetar, 1, icao);
   sqlite3_bind_int(d->setAirportMetar, 2, hasMetar);
   d->execUpdate(d->setAirportMetar);
@@ -2164,7 +2598,26 @@ FGPositionedList NavDataCache::findAllWithIdent( const string& s,
                                                  FGPositioned::Filter* filter,
                                                  bool exact )
 {
-  return d->findAllByString(s, "ident", filter, exact);
+  // the snapshot matches like the SQL below, except for LIKE wildcards
+  if (!d->snapshot || s.empty() || (s.find_first_of("%_") != string::npos)) {
+    return d->findAllByString(s, "ident", filter, exact);
+  }
+
+  FGPositionedList result;
+  for (const auto* p : d->snapshot->findWithIdent(s, !exact)) {
+    if (filter && ((p->type < filter->minType()) || (p->type > filter->maxType()))) {
+      continue;
+    }
+
+    FGPositionedRef pos = loadById(p->id);
+    if (filter && !filter->pass(pos)) {
+      continue;
+    }
+
+    result.push_back(pos);
+  }
+
+  return result;
 }
 
 //------------------------------------------------------------------------------
@@ -2180,6 +2633,30 @@ FGPositionedRef NavDataCache::findClosestWithIdent( const string& aIdent,
                                                     const SGGeod& aPos,
                                                     FGPositioned::Filter* aFilter )
 {
+  SGVec3d cartPos(SGVec3d::fromGeod(aPos));
+  if (d->snapshot && !aIdent.empty()) {
+    // candidates by distance, as ordered by the SQL below
+    std::vector<std::pair<double, PositionedID>> candidates;
+    for (const auto* p : d->snapshot->findWithIdent(aIdent, false)) {
+      if (aFilter && ((p->type < aFilter->minType()) || (p->type > aFilter->maxType()))) {
+        continue;
+      }
+
+      SGVec3d cart(SGVec3d::fromGeod(SGGeod::fromDegM(p->lon, p->lat, p->elevM)));
+      candidates.push_back(std::make_pair(distSqr(cart, cartPos), p->id));
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    for (const auto& c : candidates) {
+      FGPositionedRef pos = loadById(c.second);
+      if (!aFilter || aFilter->pass(pos)) {
+        return pos;
+      }
+    }
+
+    return {};
+  }
+
   sqlite_bind_stdstring(d->findClosestWithIdent, 1, aIdent);
   if (aFilter) {
     sqlite3_bind_int(d->findClosestWithIdent, 2, aFilter->minType());
@@ -2189,7 +2666,6 @@ FGPositionedRef NavDataCache::findClosestWithIdent( const string& aIdent,
     sqlite3_bind_int(d->findClosestWithIdent, 3, FGPositioned::LAST_TYPE);
   }
 
-  SGVec3d cartPos(SGVec3d::fromGeod(aPos));
   sqlite3_bind_double(d->findClosestWithIdent, 4, cartPos.x());
   sqlite3_bind_double(d->findClosestWithIdent, 5, cartPos.y());
   sqlite3_bind_double(d->findClosestWithIdent, 6, cartPos.z());
@@ -2213,6 +2689,10 @@ FGPositionedRef NavDataCache::findClosestWithIdent( const string& aIdent,
 
 int NavDataCache::getOctreeBranchChildren(int64_t octreeNodeId)
 {
+    if (d->snapshot) {
+        return d->snapshot->octreeBranchChildren(octreeNodeId);
+    }
+
     sqlite3_bind_int64(d->getOctreeChildren, 1, octreeNodeId);
     if (!d->execSelect(d->getOctreeChildren)) {
         // this can occur when in read-only mode: we don't add
@@ -2232,7 +2712,8 @@ void NavDataCache::defineOctreeNode(Octree::Branch* pr, Octree::Node* nd)
   if (isReadOnly()) {
     return;
   }
-  
+
+  d->invalidateSnapshot();
   sqlite3_bind_int64(d->insertOctree, 1, nd->guid());
   d->execInsert(d->insertOctree);
 
@@ -2253,6 +2734,10 @@ void NavDataCache::defineOctreeNode(Octree::Branch* pr, Octree::Node* nd)
 TypedPositionedVec
 NavDataCache::getOctreeLeafChildren(int64_t octreeNodeId)
 {
+  if (d->snapshot) {
+    return d->snapshot->octreeLeafChildren(octreeNodeId);
+  }
+
   sqlite3_bind_int64(d->getOctreeLeafChildren, 1, octreeNodeId);
 
   TypedPositionedVec r;
@@ -2281,14 +2766,24 @@ char** NavDataCache::searchAirportNamesAndIdents(const std::string& searchInput)
   bool heli_p = searchInput.substr(0, heliport.length()) == heliport;
   auto pos = searchInput.find(":");
   string aFilter((pos != string::npos) ? searchInput.substr(pos+1) : searchInput);
-  string searchTerm("%" + aFilter + "%");
 
   if (aFilter.empty() && !heli_p) {
     stmt = d->getAllAirports;
     numAllocated = 4096; // start much larger for all airports
   } else {
-    stmt = d->searchAirports;
-    sqlite_bind_stdstring(stmt, 1, searchTerm);
+    if (!d->haveNameIndex) {
+      stmt = d->searchAirports;
+      sqlite_bind_temp_stdstring(stmt, 1, "%" + aFilter + "%");
+    } else if (isIndexableTerm(aFilter)) {
+      // names containing the term, idents starting with it
+      stmt = d->searchAirportsIndexed;
+      sqlite_bind_temp_stdstring(stmt, 1, nameIndexPhrase(aFilter));
+      sqlite_bind_temp_stdstring(stmt, 4, aFilter + "%");
+    } else {
+      stmt = d->searchAirportsPrefix;
+      sqlite_bind_temp_stdstring(stmt, 1, aFilter + "%");
+    }
+
     if (heli_p) {
         sqlite3_bind_int(stmt, 2, FGPositioned::HELIPORT);
         sqlite3_bind_int(stmt, 3, FGPositioned::HELIPORT);
@@ -2578,6 +3073,27 @@ AirwayEdgeVec NavDataCache::airwayEdgesFrom(int network, PositionedID pos)
   return result;
 }
 
+AirwayNetworkEdgeVec NavDataCache::airwayNetworkEdges(int network)
+{
+    sqlite3_bind_int(d->airwayNetworkEdges, 1, network);
+
+    AirwayNetworkEdgeVec result;
+    while (d->stepSelect(d->airwayNetworkEdges)) {
+        AirwayNetworkEdge e;
+        e.airway = sqlite3_column_int(d->airwayNetworkEdges, 0);
+        e.a = sqlite3_column_int64(d->airwayNetworkEdges, 1);
+        e.b = sqlite3_column_int64(d->airwayNetworkEdges, 2);
+        e.posA = SGGeod::fromDeg(sqlite3_column_double(d->airwayNetworkEdges, 3),
+                                 sqlite3_column_double(d->airwayNetworkEdges, 4));
+        e.posB = SGGeod::fromDeg(sqlite3_column_double(d->airwayNetworkEdges, 5),
+                                 sqlite3_column_double(d->airwayNetworkEdges, 6));
+        result.push_back(e);
+    }
+
+    d->reset(d->airwayNetworkEdges);
+    return result;
+}
+
 AirwayRef NavDataCache::loadAirway(int airwayID)
 {
     sqlite3_bind_int(d->loadAirway, 1, airwayID);
@@ -2808,22 +3324,32 @@ public:
 };
 
 NavDataCache::ThreadedGUISearch::ThreadedGUISearch(const std::string& term, bool onlyAirports) :
+    ThreadedGUISearch(term, onlyAirports ?
+                      std::vector<FGPositioned::Type>{FGPositioned::AIRPORT, FGPositioned::HELIPORT, FGPositioned::SEAPORT} :
+                      std::vector<FGPositioned::Type>{FGPositioned::AIRPORT, FGPositioned::HELIPORT, FGPositioned::SEAPORT,
+                                            FGPositioned::FIX, FGPositioned::NDB, FGPositioned::VOR})
+{
+}
+
+NavDataCache::ThreadedGUISearch::ThreadedGUISearch(const std::string& term, const std::vector<FGPositioned::Type>& types) :
     d(new ThreadedGUISearchPrivate)
 {
-    SGPath p = NavDataCache::instance()->path();
+    NavDataCache* cache = NavDataCache::instance();
+    SGPath p = cache->path();
     int openFlags = SQLITE_OPEN_READONLY;
     std::string pathUtf8 = p.utf8Str();
     sqlite3_open_v2(pathUtf8.c_str(), &d->db, openFlags, NULL);
 
-    std::string sql;
-    if (onlyAirports) {
-        sql = "SELECT rowid FROM positioned WHERE name LIKE '%" + term
-                + "%' AND (type >= 1 AND type <= 3)";
-    } else {
-        sql = "SELECT rowid FROM positioned WHERE name LIKE '%" + term
-                + "%' AND ((type >= 1 AND type <= 3) OR ((type >= 9 AND type <= 11))) ";
+    std::ostringstream typeCondition;
+    typeCondition << "type IN (";
+    for (auto it = types.begin(); it != types.end(); ++it) {
+        typeCondition << (it == types.begin() ? "" : ",") << static_cast<int>(*it);
     }
+    typeCondition << ")";
+
+    const std::string sql = nameSearchSQL(cache->d->haveNameIndex, term, typeCondition.str());
     sqlite3_prepare_v2(d->db, sql.c_str(), sql.length(), &d->query, NULL);
+    bindNameSearchTerm(d->query, term);
 
     d->start();
 }
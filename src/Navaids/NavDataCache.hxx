@@ -48,6 +48,16 @@ typedef std::vector<TypedPositioned> TypedPositionedVec;
 typedef std::pair<int, PositionedID> AirwayEdge;
 typedef std::vector<AirwayEdge> AirwayEdgeVec;
 
+/// an edge of an airway network, with the location of both end nodes, as
+/// returned by NavDataCache::airwayNetworkEdges
+struct AirwayNetworkEdge
+{
+    int airway;
+    PositionedID a, b;
+    SGGeod posA, posB;
+};
+typedef std::vector<AirwayNetworkEdge> AirwayNetworkEdgeVec;
+
 namespace Octree {
   class Node;
   class Branch;
@@ -128,6 +138,14 @@ public:
   RebuildPhase rebuild();
 
   unsigned int rebuildPhaseCompletionPercentage() const;
+
+  /**
+   * attach the memory-mapped snapshot of the positioned data, when enabled
+   * by /sim/navdb/snapshot/enabled, so loading positioneds and the octree
+   * needs no SQL. The snapshot is written first if missing or out of date,
+   * unless the cache is read-only. Call once the cache is up to date.
+   */
+  void openSnapshot();
   void setRebuildPhaseProgress(RebuildPhase ph, unsigned int percent = 0);
 
   bool isCachedFileModified(const SGPath& path) const;
@@ -304,6 +322,12 @@ public:
    */
   AirwayEdgeVec airwayEdgesFrom(int network, PositionedID pos);
 
+  /**
+   * retrieve every edge in a network, including the positions of both end
+   * nodes, in a single query. Used to build the in-memory routing graph.
+   */
+  AirwayNetworkEdgeVec airwayNetworkEdges(int network);
+
     AirwayRef loadAirway(int airwayID);
 
     /**
@@ -325,10 +349,21 @@ public:
 
     bool isReadOnly() const;
 
+    /**
+     * Search the names of positioneds on a thread of its own, for
+     * search-as-you-type in the UI. Where the cache has the full-text name
+     * index, terms of three characters or more match anywhere in a name,
+     * shorter terms only at the start. The best matches come first: names
+     * starting with the term, then names with a word starting with it.
+     */
     class ThreadedGUISearch
     {
     public:
+        /// search airports, heliports and seaports, and optionally fixes,
+        /// NDBs and VORs
         ThreadedGUISearch(const std::string& term, bool onlyAirports);
+
+        ThreadedGUISearch(const std::string& term, const std::vector<FGPositioned::Type>& types);
         ~ThreadedGUISearch();
 
         PositionedIDVec results() const;
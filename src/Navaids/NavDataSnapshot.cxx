@@ -0,0 +1,538 @@
+// NavDataSnapshot.cxx - a memory-mapped, read-only image of the positioned
+// data in the NavDataCache
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "config.h"
+
+#include "NavDataSnapshot.hxx"
+
+#include <algorithm>
+#include <cstring>
+
+#include <simgear/compiler.h>
+#include <simgear/debug/logstream.hxx>
+#include <simgear/structure/exception.hxx>
+
+#include <Main/BinaryIO.hxx>
+
+#if defined(SG_WINDOWS)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace flightgear
+{
+
+namespace
+{
+
+const char SNAPSHOT_MAGIC[8] = {'F', 'G', 'N', 'A', 'V', 'S', 'N', 'P'};
+const uint32_t SNAPSHOT_VERSION = 1;
+
+// sections are aligned to this, so the records can be used in place
+const size_t SECTION_ALIGN = 8;
+
+// the cache compares idents with the NOCASE collation, which only folds ASCII
+inline char foldCase(char c)
+{
+    return ((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// compare folded idents; with a prefix length, only that many characters
+int compareIdents(const char* a, const char* b, size_t prefixLength = std::string::npos)
+{
+    for (size_t i = 0; i < prefixLength; ++i) {
+        const char ca = foldCase(a[i]), cb = foldCase(b[i]);
+        if (ca != cb) {
+            return (static_cast<unsigned char>(ca) < static_cast<unsigned char>(cb)) ? -1 : 1;
+        }
+
+        if (ca == 0) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+} // of anonymous namespace
+
+struct NavDataSnapshot::OctreeLeaf
+{
+    int64_t node;
+    uint32_t first, count;
+};
+
+struct NavDataSnapshot::OctreeBranch
+{
+    int64_t node;
+    int32_t children;
+    int32_t padding;
+};
+
+struct NavDataSnapshot::Header
+{
+    struct Section
+    {
+        uint64_t offset, count;
+    };
+
+    char magic[8];
+    uint32_t version;
+    uint32_t padding;
+    uint64_t id;
+    // reject snapshots written by a build with a different layout
+    uint32_t recordSizes[6];
+
+    Section positioned, runways, navaids, comms;
+    Section identIndex, leaves, leafEntries, branches;
+    Section strings;
+
+    void setRecordSizes()
+    {
+        recordSizes[0] = sizeof(NavDataSnapshot::Positioned);
+        recordSizes[1] = sizeof(NavDataSnapshot::Runway);
+        recordSizes[2] = sizeof(NavDataSnapshot::Navaid);
+        recordSizes[3] = sizeof(NavDataSnapshot::Comm);
+        recordSizes[4] = sizeof(NavDataSnapshot::OctreeLeaf);
+        recordSizes[5] = sizeof(NavDataSnapshot::OctreeBranch);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+
+class NavDataSnapshot::Mapping
+{
+public:
+    ~Mapping()
+    {
+        if (!data) {
+            return;
+        }
+#if defined(SG_WINDOWS)
+        UnmapViewOfFile(data);
+#else
+        munmap(const_cast<char*>(data), size);
+#endif
+    }
+
+    bool map(const SGPath& path)
+    {
+#if defined(SG_WINDOWS)
+        const std::wstring wpath = path.wstr();
+        HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ,
+                                  FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        HANDLE mapping = nullptr;
+        if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart > 0)) {
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        }
+
+        if (mapping) {
+            // the view keeps the mapping and file open
+            data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            size = static_cast<size_t>(fileSize.QuadPart);
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if ((fstat(fd, &st) == 0) && (st.st_size > 0)) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                data = static_cast<const char*>(p);
+                size = static_cast<size_t>(st.st_size);
+            }
+        }
+        ::close(fd); // the mapping stays valid
+#endif
+        return data != nullptr;
+    }
+
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////
+
+NavDataSnapshot::Writer::Writer(uint64_t id) :
+    _id(id)
+{
+    addString(std::string());
+}
+
+uint32_t NavDataSnapshot::Writer::addString(const std::string& s)
+{
+    auto it = _stringOffsets.find(s);
+    if (it != _stringOffsets.end()) {
+        return it->second;
+    }
+
+    const uint32_t offset = static_cast<uint32_t>(_strings.size());
+    _strings.append(s.c_str(), s.size() + 1);
+    _stringOffsets.emplace(s, offset);
+    return offset;
+}
+
+void NavDataSnapshot::Writer::addPositioned(PositionedID id, FGPositioned::Type ty,
+                                            const std::string& ident, const std::string& name,
+                                            PositionedID airport, const SGGeod& pos,
+                                            int64_t octreeNode)
+{
+    Positioned p;
+    p.id = id;
+    p.airport = airport;
+    p.lon = pos.getLongitudeDeg();
+    p.lat = pos.getLatitudeDeg();
+    p.elevM = pos.getElevationM();
+    p.type = ty;
+    p.ident = addString(ident);
+    p.name = addString(name);
+    p.detail = -1;
+    _positioned.push_back(p);
+    _octreeNodes.push_back(octreeNode);
+}
+
+void NavDataSnapshot::Writer::setHasMetar(bool hasMetar)
+{
+    _positioned.back().detail = hasMetar ? 1 : 0;
+}
+
+void NavDataSnapshot::Writer::setRunway(const Runway& runway)
+{
+    _positioned.back().detail = static_cast<int32_t>(_runways.size());
+    _runways.push_back(runway);
+}
+
+void NavDataSnapshot::Writer::setNavaid(const Navaid& navaid)
+{
+    _positioned.back().detail = static_cast<int32_t>(_navaids.size());
+    _navaids.push_back(navaid);
+}
+
+void NavDataSnapshot::Writer::setComm(const Comm& comm)
+{
+    _positioned.back().detail = static_cast<int32_t>(_comms.size());
+    _comms.push_back(comm);
+}
+
+void NavDataSnapshot::Writer::addOctreeBranch(int64_t node, int childMask)
+{
+    _branches.emplace_back(node, childMask);
+}
+
+bool NavDataSnapshot::Writer::write(const SGPath& path)
+{
+    // ident index: positioneds with an ident, by folded ident then ID
+    std::vector<uint32_t> identIndex;
+    for (uint32_t i = 0; i < _positioned.size(); ++i) {
+        if (_strings[_positioned[i].ident] != 0) {
+            identIndex.push_back(i);
+        }
+    }
+
+    std::stable_sort(identIndex.begin(), identIndex.end(), [this](uint32_t a, uint32_t b) {
+        return compareIdents(&_strings[_positioned[a].ident], &_strings[_positioned[b].ident]) < 0;
+    });
+
+    // octree leaves: the positioneds grouped by node, in order of ID
+    std::vector<uint32_t> leafEntries;
+    for (uint32_t i = 0; i < _positioned.size(); ++i) {
+        if (_octreeNodes[i] != 0) {
+            leafEntries.push_back(i);
+        }
+    }
+
+    std::stable_sort(leafEntries.begin(), leafEntries.end(), [this](uint32_t a, uint32_t b) {
+        return _octreeNodes[a] < _octreeNodes[b];
+    });
+
+    std::vector<OctreeLeaf> leaves;
+    for (uint32_t i = 0; i < leafEntries.size(); ++i) {
+        const int64_t node = _octreeNodes[leafEntries[i]];
+        if (leaves.empty() || (leaves.back().node != node)) {
+            leaves.push_back({node, i, 0});
+        }
+        ++leaves.back().count;
+    }
+
+    std::vector<OctreeBranch> branches;
+    for (const auto& b : _branches) {
+        branches.push_back({b.first, b.second, 0});
+    }
+
+    std::sort(branches.begin(), branches.end(), [](const OctreeBranch& a, const OctreeBranch& b) {
+        return a.node < b.node;
+    });
+
+    // lay out the sections
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.id = _id;
+    header.setRecordSizes();
+
+    uint64_t offset = sizeof(Header);
+    auto place = [&offset](Header::Section& section, size_t count, size_t recordSize) {
+        offset = (offset + SECTION_ALIGN - 1) & ~uint64_t(SECTION_ALIGN - 1);
+        section.offset = offset;
+        section.count = count;
+        offset += count * recordSize;
+    };
+
+    place(header.positioned, _positioned.size(), sizeof(Positioned));
+    place(header.runways, _runways.size(), sizeof(Runway));
+    place(header.navaids, _navaids.size(), sizeof(Navaid));
+    place(header.comms, _comms.size(), sizeof(Comm));
+    place(header.identIndex, identIndex.size(), sizeof(uint32_t));
+    place(header.leaves, leaves.size(), sizeof(OctreeLeaf));
+    place(header.leafEntries, leafEntries.size(), sizeof(uint32_t));
+    place(header.branches, branches.size(), sizeof(OctreeBranch));
+    place(header.strings, _strings.size(), 1);
+
+    // write to a temporary file, so a reader never maps a partial snapshot
+    const bool ok = binary::writeFileReplacing(path, [&](std::ostream& file) {
+        uint64_t written = 0;
+        auto writeSection = [&file, &written](const Header::Section& section,
+                                              const void* data, size_t recordSize) {
+            static const char zeroes[SECTION_ALIGN] = {0};
+            file.write(zeroes, section.offset - written);
+            file.write(static_cast<const char*>(data), section.count * recordSize);
+            written = section.offset + section.count * recordSize;
+        };
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        written = sizeof(Header);
+        writeSection(header.positioned, _positioned.data(), sizeof(Positioned));
+        writeSection(header.runways, _runways.data(), sizeof(Runway));
+        writeSection(header.navaids, _navaids.data(), sizeof(Navaid));
+        writeSection(header.comms, _comms.data(), sizeof(Comm));
+        writeSection(header.identIndex, identIndex.data(), sizeof(uint32_t));
+        writeSection(header.leaves, leaves.data(), sizeof(OctreeLeaf));
+        writeSection(header.leafEntries, leafEntries.data(), sizeof(uint32_t));
+        writeSection(header.branches, branches.data(), sizeof(OctreeBranch));
+        writeSection(header.strings, _strings.data(), 1);
+    });
+
+    if (!ok) {
+        SG_LOG(SG_NAVCACHE, SG_WARN, "NavDataSnapshot: unable to write " << path);
+        return false;
+    }
+
+    SG_LOG(SG_NAVCACHE, SG_INFO, "NavDataSnapshot: wrote " << _positioned.size()
+           << " positioneds (" << offset / 1024 << " KiB) to " << path);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+std::unique_ptr<NavDataSnapshot> NavDataSnapshot::open(const SGPath& path)
+{
+    std::unique_ptr<NavDataSnapshot> snapshot(new NavDataSnapshot);
+    snapshot->_mapping.reset(new Mapping);
+    if (!snapshot->_mapping->map(path)) {
+        return {};
+    }
+
+    const char* data = snapshot->_mapping->data;
+    const size_t size = snapshot->_mapping->size;
+    if (size < sizeof(Header)) {
+        SG_LOG(SG_NAVCACHE, SG_WARN, "NavDataSnapshot: " << path << " is truncated");
+        return {};
+    }
+
+    Header expected;
+    expected.setRecordSizes();
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) ||
+        (header->version != SNAPSHOT_VERSION) ||
+        memcmp(header->recordSizes, expected.recordSizes, sizeof(expected.recordSizes)))
+    {
+        SG_LOG(SG_NAVCACHE, SG_INFO, "NavDataSnapshot: " << path << " has a different format");
+        return {};
+    }
+
+    auto valid = [size](const Header::Section& section, size_t recordSize) {
+        return ((section.offset % SECTION_ALIGN) == 0) &&
+               (section.offset <= size) &&
+               (section.count <= (size - section.offset) / recordSize);
+    };
+
+    bool ok = valid(header->positioned, sizeof(Positioned)) &&
+              valid(header->runways, sizeof(Runway)) &&
+              valid(header->navaids, sizeof(Navaid)) &&
+              valid(header->comms, sizeof(Comm)) &&
+              valid(header->identIndex, sizeof(uint32_t)) &&
+              valid(header->leaves, sizeof(OctreeLeaf)) &&
+              valid(header->leafEntries, sizeof(uint32_t)) &&
+              valid(header->branches, sizeof(OctreeBranch)) &&
+              valid(header->strings, 1);
+
+    // the string table starts with the empty string, and is terminated
+    ok = ok && (header->strings.count > 0) &&
+         (data[header->strings.offset] == 0) &&
+         (data[header->strings.offset + header->strings.count - 1] == 0);
+    if (!ok) {
+        SG_LOG(SG_NAVCACHE, SG_WARN, "NavDataSnapshot: " << path << " is corrupt");
+        return {};
+    }
+
+    snapshot->_header = header;
+    snapshot->_positioned = reinterpret_cast<const Positioned*>(data + header->positioned.offset);
+    snapshot->_runways = reinterpret_cast<const Runway*>(data + header->runways.offset);
+    snapshot->_navaids = reinterpret_cast<const Navaid*>(data + header->navaids.offset);
+    snapshot->_comms = reinterpret_cast<const Comm*>(data + header->comms.offset);
+    snapshot->_identIndex = reinterpret_cast<const uint32_t*>(data + header->identIndex.offset);
+    snapshot->_leaves = reinterpret_cast<const OctreeLeaf*>(data + header->leaves.offset);
+    snapshot->_leafEntries = reinterpret_cast<const uint32_t*>(data + header->leafEntries.offset);
+    snapshot->_branches = reinterpret_cast<const OctreeBranch*>(data + header->branches.offset);
+    snapshot->_strings = data + header->strings.offset;
+    return snapshot;
+}
+
+NavDataSnapshot::~NavDataSnapshot()
+{
+}
+
+uint64_t NavDataSnapshot::id() const
+{
+    return _header->id;
+}
+
+size_t NavDataSnapshot::size() const
+{
+    return _header->positioned.count;
+}
+
+const NavDataSnapshot::Positioned* NavDataSnapshot::find(PositionedID id) const
+{
+    const Positioned* end = _positioned + _header->positioned.count;
+    const Positioned* it = std::lower_bound(_positioned, end, id,
+        [](const Positioned& p, PositionedID id) { return p.id < id; });
+    return ((it != end) && (it->id == id)) ? it : nullptr;
+}
+
+const NavDataSnapshot::Runway& NavDataSnapshot::runway(const Positioned& p) const
+{
+    if ((p.detail < 0) || (static_cast<uint64_t>(p.detail) >= _header->runways.count)) {
+        throw sg_range_exception("NavDataSnapshot: bad runway record");
+    }
+    return _runways[p.detail];
+}
+
+const NavDataSnapshot::Navaid& NavDataSnapshot::navaid(const Positioned& p) const
+{
+    if ((p.detail < 0) || (static_cast<uint64_t>(p.detail) >= _header->navaids.count)) {
+        throw sg_range_exception("NavDataSnapshot: bad navaid record");
+    }
+    return _navaids[p.detail];
+}
+
+const NavDataSnapshot::Comm& NavDataSnapshot::comm(const Positioned& p) const
+{
+    if ((p.detail < 0) || (static_cast<uint64_t>(p.detail) >= _header->comms.count)) {
+        throw sg_range_exception("NavDataSnapshot: bad comm record");
+    }
+    return _comms[p.detail];
+}
+
+const char* NavDataSnapshot::string(uint32_t offset) const
+{
+    return (offset < _header->strings.count) ? _strings + offset : _strings;
+}
+
+int NavDataSnapshot::octreeBranchChildren(int64_t node) const
+{
+    const OctreeBranch* end = _branches + _header->branches.count;
+    const OctreeBranch* it = std::lower_bound(_branches, end, node,
+        [](const OctreeBranch& b, int64_t node) { return b.node < node; });
+    return ((it != end) && (it->node == node)) ? it->children : 0;
+}
+
+std::vector<std::pair<FGPositioned::Type, PositionedID>>
+NavDataSnapshot::octreeLeafChildren(int64_t node) const
+{
+    std::vector<std::pair<FGPositioned::Type, PositionedID>> result;
+    const OctreeLeaf* end = _leaves + _header->leaves.count;
+    const OctreeLeaf* it = std::lower_bound(_leaves, end, node,
+        [](const OctreeLeaf& l, int64_t node) { return l.node < node; });
+    if ((it == end) || (it->node != node) ||
+        (it->first + static_cast<uint64_t>(it->count) > _header->leafEntries.count))
+    {
+        return result;
+    }
+
+    result.reserve(it->count);
+    for (uint32_t i = it->first; i < it->first + it->count; ++i) {
+        const uint32_t index = _leafEntries[i];
+        if (index < _header->positioned.count) {
+            const Positioned& p = _positioned[index];
+            result.emplace_back(static_cast<FGPositioned::Type>(p.type), p.id);
+        }
+    }
+
+    return result;
+}
+
+std::vector<const NavDataSnapshot::Positioned*>
+NavDataSnapshot::findWithIdent(const std::string& ident, bool prefix) const
+{
+    std::vector<const Positioned*> result;
+    const size_t length = prefix ? ident.size() : std::string::npos;
+    const uint32_t* begin = _identIndex;
+    const uint32_t* end = _identIndex + _header->identIndex.count;
+
+    auto identOf = [this](uint32_t index) -> const char* {
+        return (index < _header->positioned.count) ? string(_positioned[index].ident) : _strings;
+    };
+
+    const char* key = ident.c_str();
+    const uint32_t* first = std::lower_bound(begin, end, key,
+        [&identOf, length](uint32_t index, const char* key) {
+            return compareIdents(identOf(index), key, length) < 0;
+        });
+    const uint32_t* last = std::upper_bound(first, end, key,
+        [&identOf, length](const char* key, uint32_t index) {
+            return compareIdents(key, identOf(index), length) < 0;
+        });
+
+    for (const uint32_t* it = first; it != last; ++it) {
+        result.push_back(_positioned + *it);
+    }
+
+    std::sort(result.begin(), result.end(), [](const Positioned* a, const Positioned* b) {
+        return a->id < b->id;
+    });
+
+    return result;
+}
+
+} // of namespace flightgear
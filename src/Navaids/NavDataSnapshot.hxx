@@ -0,0 +1,177 @@
+// NavDataSnapshot.hxx - a memory-mapped, read-only image of the positioned
+// data in the NavDataCache
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef FG_NAVDATASNAPSHOT_HXX
+#define FG_NAVDATASNAPSHOT_HXX
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <simgear/misc/sg_path.hxx>
+
+#include <Navaids/positioned.hxx>
+
+namespace flightgear
+{
+
+/**
+ * A compact binary image of the positioned data in the NavDataCache:
+ * fixed-layout records sorted by ID, a string table, an index of the
+ * idents and the octree. It is mapped read-only, so loading positioneds
+ * and walking the octree need no SQL, and the pages are shared by every
+ * FlightGear process using the same cache.
+ *
+ * A snapshot is only valid for the cache it was written from: both
+ * store the same (random) id, which the cache drops when the positioned
+ * data changes.
+ */
+class NavDataSnapshot
+{
+public:
+    struct Positioned
+    {
+        int64_t id;
+        int64_t airport;
+        double lon, lat, elevM;
+        int32_t type;
+        uint32_t ident;  ///< offset in the string table
+        uint32_t name;   ///< offset in the string table
+        /// index of the runway, navaid or comm record, or for airports
+        /// whether there is a METAR station
+        int32_t detail;
+    };
+
+    struct Runway
+    {
+        double heading, length, width, displacedThreshold, stopway;
+        int64_t reciprocal, ils;
+        int32_t surface;
+        int32_t padding;
+    };
+
+    struct Navaid
+    {
+        double multiuse;
+        int64_t runway, colocated;
+        int32_t rangeNm, freq;
+    };
+
+    struct Comm
+    {
+        int32_t freqKhz, rangeNm;
+    };
+
+    /**
+     * Collect the contents of a snapshot, and write it. Positioneds must
+     * be added in order of increasing ID, each followed by its details.
+     */
+    class Writer
+    {
+    public:
+        explicit Writer(uint64_t id);
+
+        void addPositioned(PositionedID id, FGPositioned::Type ty,
+                           const std::string& ident, const std::string& name,
+                           PositionedID airport, const SGGeod& pos,
+                           int64_t octreeNode);
+
+        // details of the last positioned added
+        void setHasMetar(bool hasMetar);
+        void setRunway(const Runway& runway);
+        void setNavaid(const Navaid& navaid);
+        void setComm(const Comm& comm);
+
+        void addOctreeBranch(int64_t node, int childMask);
+
+        size_t size() const { return _positioned.size(); }
+
+        /// write to a temporary file, then replace path with it
+        bool write(const SGPath& path);
+
+    private:
+        uint32_t addString(const std::string& s);
+
+        uint64_t _id;
+        std::vector<Positioned> _positioned;
+        std::vector<int64_t> _octreeNodes;
+        std::vector<Runway> _runways;
+        std::vector<Navaid> _navaids;
+        std::vector<Comm> _comms;
+        std::vector<std::pair<int64_t, int32_t>> _branches;
+        std::string _strings;
+        std::unordered_map<std::string, uint32_t> _stringOffsets;
+    };
+
+    /**
+     * Map a snapshot file. Returns nullptr if it does not exist or is not
+     * a valid snapshot.
+     */
+    static std::unique_ptr<NavDataSnapshot> open(const SGPath& path);
+
+    ~NavDataSnapshot();
+
+    uint64_t id() const;
+    size_t size() const;
+
+    /// the positioned with an ID, or nullptr if the snapshot lacks it
+    const Positioned* find(PositionedID id) const;
+
+    const Runway& runway(const Positioned& p) const;
+    const Navaid& navaid(const Positioned& p) const;
+    const Comm& comm(const Positioned& p) const;
+    const char* string(uint32_t offset) const;
+
+    /// the child mask of an octree branch, 0 for an unknown branch
+    int octreeBranchChildren(int64_t node) const;
+
+    /// the positioneds in an octree leaf, and their types
+    std::vector<std::pair<FGPositioned::Type, PositionedID>> octreeLeafChildren(int64_t node) const;
+
+    /**
+     * the positioneds with an ident, ignoring (ASCII) case like the cache,
+     * or with an ident starting with it; in order of ID
+     */
+    std::vector<const Positioned*> findWithIdent(const std::string& ident, bool prefix) const;
+
+private:
+    NavDataSnapshot() = default;
+
+    class Mapping;
+    struct Header;
+    struct OctreeLeaf;
+    struct OctreeBranch;
+
+    std::unique_ptr<Mapping> _mapping;
+    const Header* _header = nullptr;
+    const Positioned* _positioned = nullptr;
+    const Runway* _runways = nullptr;
+    const Navaid* _navaids = nullptr;
+    const Comm* _comms = nullptr;
+    const uint32_t* _identIndex = nullptr;
+    const OctreeLeaf* _leaves = nullptr;
+    const uint32_t* _leafEntries = nullptr;
+    const OctreeBranch* _branches = nullptr;
+    const char* _strings = nullptr;
+};
+
+} // of namespace flightgear
+
+#endif // of FG_NAVDATASNAPSHOT_HXX
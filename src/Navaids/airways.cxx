@@ -23,12 +23,16 @@
 
 #include <tuple>
 #include <algorithm>
+#include <limits>
+#include <queue>
 #include <set>
+#include <unordered_map>
 
 #include <simgear/sg_inlines.h>
 #include <simgear/structure/exception.hxx>
 #include <simgear/io/iostreams/sgstream.hxx>
 #include <simgear/misc/sg_path.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <Main/globals.hxx>
 #include <Navaids/positioned.hxx>
@@ -50,46 +54,50 @@ typedef SGSharedPtr<FGPositioned> FGPositionedRef;
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AStarOpenNode : public SGReferenced
+/**
+ * Compact in-memory copy of an airway network, in compressed sparse row
+ * form: the outgoing edges of node i are stored at
+ * [offsets[i], offsets[i+1]) in targets/airways/lengths. Node indices are
+ * dense, so the A* search can use plain vectors for its bookkeeping, and
+ * never touches SQL or FGPositioned until the final route is built.
+ */
+struct AirwayGraph
 {
-public:
-  AStarOpenNode(FGPositionedRef aNode, double aLegDist, 
-    int aAirway,
-    FGPositionedRef aDest, AStarOpenNode* aPrev) :
-    node(aNode),
-    previous(aPrev),
-    airway(aAirway)
-  { 
-    distanceFromStart = aLegDist;
-    if (previous) {
-      distanceFromStart +=  previous->distanceFromStart;
-    }
-    
-		directDistanceToDestination = SGGeodesy::distanceM(node->geod(), aDest->geod());
-  }
-  
-  virtual ~AStarOpenNode()
+  static constexpr unsigned int NoNode = std::numeric_limits<unsigned int>::max();
+
+  unsigned int indexOf(PositionedID pos) const
   {
+    auto it = index.find(pos);
+    return (it == index.end()) ? NoNode : it->second;
   }
-  
-  FGPositionedRef node;
-  SGSharedPtr<AStarOpenNode> previous;
-  int airway;
-  double distanceFromStart; // aka 'g(x)'
-  double directDistanceToDestination; // aka 'h(x)'
-  
-  /**
-	 * aka 'f(x)'
-	 */
-	double totalCost() const {
-		return distanceFromStart + directDistanceToDestination;
-	}
+
+  unsigned int size() const
+  { return static_cast<unsigned int>(ids.size()); }
+
+  std::unordered_map<PositionedID, unsigned int> index;
+  PositionedIDVec ids;
+  std::vector<SGGeod> positions;
+
+  std::vector<unsigned int> offsets;
+  std::vector<unsigned int> targets;
+  std::vector<int> airways;
+  std::vector<double> lengths;
 };
 
-using AStarOpenNodeRef = SGSharedPtr<AStarOpenNode>;
+// limit on the number of search results cached per network
+static const size_t MAX_CACHED_SEARCHES = 64;
 
 ////////////////////////////////////////////////////////////////////////////
 
+Airway::Network::Network() :
+  _networkID(UnknownLevel)
+{
+}
+
+Airway::Network::~Network()
+{
+}
+
 Airway::Network* Airway::lowLevel()
 {
   static Network* static_lowLevel = nullptr;
@@ -113,6 +121,12 @@ Airway::Network* Airway::highLevel()
   return static_highLevel;
 }
 
+void Airway::clearNetworkCaches()
+{
+  lowLevel()->clearCaches();
+  highLevel()->clearCaches();
+}
+
 Airway::Airway(const std::string& aIdent,
                const Level level,
                int dbId,
@@ -416,6 +430,84 @@ void Airway::Network::addEdge(int aWay, const SGGeod& aStartPos,
   }
   
   NavDataCache::instance()->insertEdge(_networkID, aWay, start->guid(), end->guid());
+  clearCaches();
+}
+
+void Airway::Network::clearCaches()
+{
+  _graph.reset();
+  _inNetworkCache.clear();
+  _searchCache.clear();
+  _searchCacheOrder.clear();
+}
+
+const AirwayGraph& Airway::Network::graph() const
+{
+  if (_graph) {
+    return *_graph;
+  }
+
+  SGTimeStamp st;
+  st.stamp();
+
+  std::unique_ptr<AirwayGraph> g(new AirwayGraph);
+  const AirwayNetworkEdgeVec edges = NavDataCache::instance()->airwayNetworkEdges(_networkID);
+
+  auto intern = [&g](PositionedID id, const SGGeod& pos) {
+    auto r = g->index.insert(std::make_pair(id, g->size()));
+    if (r.second) {
+      g->ids.push_back(id);
+      g->positions.push_back(pos);
+    }
+    return r.first->second;
+  };
+
+  std::vector<std::pair<unsigned int, unsigned int> > ends;
+  ends.reserve(edges.size());
+  for (const auto& e : edges) {
+    const unsigned int a = intern(e.a, e.posA);
+    const unsigned int b = intern(e.b, e.posB);
+    ends.push_back(std::make_pair(a, b));
+  }
+
+// all edges are bidirectional, so every stored edge contributes to the
+// degree of both end nodes
+  const unsigned int nodeCount = g->size();
+  g->offsets.assign(nodeCount + 1, 0);
+  for (const auto& ab : ends) {
+    ++g->offsets[ab.first + 1];
+    ++g->offsets[ab.second + 1];
+  }
+
+  for (unsigned int i = 0; i < nodeCount; ++i) {
+    g->offsets[i + 1] += g->offsets[i];
+  }
+
+  const size_t edgeCount = g->offsets[nodeCount];
+  g->targets.resize(edgeCount);
+  g->airways.resize(edgeCount);
+  g->lengths.resize(edgeCount);
+
+// forward edges first then reverse ones, matching the order of
+// NavDataCache::airwayEdgesFrom
+  std::vector<unsigned int> cursor(g->offsets.begin(), g->offsets.end() - 1);
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < ends.size(); ++i) {
+      const unsigned int from = pass ? ends[i].second : ends[i].first;
+      const unsigned int to = pass ? ends[i].first : ends[i].second;
+      const unsigned int slot = cursor[from]++;
+      g->targets[slot] = to;
+      g->airways[slot] = edges[i].airway;
+      g->lengths[slot] = SGGeodesy::distanceM(g->positions[from], g->positions[to]);
+    }
+  }
+
+  SG_LOG(SG_NAVAID, SG_DEBUG, "built airway graph for network " << _networkID
+         << ": " << nodeCount << " nodes, " << edgeCount << " edges in "
+         << st.elapsedMSec() << "msec");
+
+  _graph = std::move(g);
+  return *_graph;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -434,7 +526,7 @@ bool Airway::Network::inNetwork(PositionedID posID) const
     return it->second; // cached, easy
   }
   
-  bool r =  NavDataCache::instance()->isInAirwayNetwork(_networkID, posID);
+  bool r = graph().indexOf(posID) != AirwayGraph::NoNode;
   _inNetworkCache.insert(it, std::make_pair(posID, r));
   return r;
 }
@@ -566,126 +658,147 @@ Airway::Network::findNodeByIdent(const std::string& ident, const SGGeod& near) c
 
 /////////////////////////////////////////////////////////////////////////////
 
-typedef vector<AStarOpenNodeRef> OpenNodeHeap;
-
-static void buildWaypoints(AStarOpenNodeRef aNode, WayptVec& aRoute)
+static void buildWaypoints(const AirwayGraph& aGraph,
+                           const std::vector<std::pair<unsigned int, int> >& aPath,
+                           WayptVec& aRoute)
 {
-// count the route length, and hence pre-size aRoute
-  size_t count = 0;
-  AStarOpenNodeRef n = aNode;
-  for (; n != nullptr; ++count, n = n->previous) {;}
-  aRoute.resize(count);
-  
-// run over the route, creating waypoints
-  for (n = aNode; n; n=n->previous) {
+  NavDataCache* cache = NavDataCache::instance();
+  aRoute.clear();
+  aRoute.reserve(aPath.size());
+
+// only the nodes on the final route are ever loaded as FGPositioned
+  for (const auto& step : aPath) {
+      FGPositionedRef pos = cache->loadById(aGraph.ids[step.first]);
       // get / create airway to be the owner for this waypoint
-      AirwayRef awy = Airway::loadByCacheId(n->airway);
-      auto wp = new NavaidWaypoint(n->node, awy);
+      AirwayRef awy = Airway::loadByCacheId(step.second);
+      auto wp = new NavaidWaypoint(pos, awy);
       if (awy) {
           wp->setFlag(WPT_VIA);
       }
       wp->setFlag(WPT_GENERATED);
-      aRoute[--count] = wp;
+      aRoute.push_back(wp);
   }
 }
 
-/**
- * Inefficent (linear) helper to find an open node in the heap
- */
-static AStarOpenNodeRef
-findInOpen(const OpenNodeHeap& aHeap, FGPositioned* aPos)
-{
-  for (unsigned int i=0; i<aHeap.size(); ++i) {
-    if (aHeap[i]->node == aPos) {
-      return aHeap[i];
-    }
-  }
-  
-  return nullptr;
-}
+namespace {
 
-class HeapOrder
+struct OpenNode
 {
-public:
-  bool operator()(AStarOpenNode* a, AStarOpenNode* b)
+  double totalCost; // aka 'f(x)'
+  unsigned int node;
+
+  bool operator<(const OpenNode& other) const
   {
-    return a->totalCost() > b->totalCost();
+    // std::priority_queue is a max-heap, we want the lowest f(x) on top
+    return totalCost > other.totalCost;
   }
 };
 
+} // of anonymous namespace
+
 bool Airway::Network::search2(FGPositionedRef aStart, FGPositionedRef aDest,
   WayptVec& aRoute)
-{  
-  typedef set<PositionedID> ClosedNodeSet;
-  
-  OpenNodeHeap openNodes;
-  ClosedNodeSet closedNodes;
-  HeapOrder ordering;
-  
-  openNodes.push_back(new AStarOpenNode(aStart, 0.0, 0, aDest, nullptr));
-  
-// A* open node iteration
-  while (!openNodes.empty()) {
-    std::pop_heap(openNodes.begin(), openNodes.end(), ordering);
-    AStarOpenNodeRef x = openNodes.back();
-    FGPositioned* xp = x->node;    
-    openNodes.pop_back();
-    closedNodes.insert(xp->guid());
-  
-#ifdef DEBUG_AWY_SEARCH
-    SG_LOG(SG_NAVAID, SG_INFO, "x:" << xp->ident() << ", f(x)=" << x->totalCost());
-#endif
-    
-  // check if xp is the goal; if so we're done, since there cannot be an open
-  // node with lower f(x) value.
-    if (xp == aDest) {
-      buildWaypoints(x, aRoute);
-      return true;
+{
+  if (!aStart || !aDest) {
+    return false;
+  }
+
+  const SearchKey key(aStart->guid(), aDest->guid());
+  const AirwayGraph& g = graph();
+  auto cached = _searchCache.find(key);
+  if (cached != _searchCache.end()) {
+    if (cached->second.empty()) {
+      return false;
     }
-    
-  // adjacent (neighbour) iteration
-    NavDataCache* cache = NavDataCache::instance();
-    for (auto other : cache->airwayEdgesFrom(_networkID, xp->guid())) {
-      if (closedNodes.count(other.second)) {
-        continue; // closed, ignore
+
+    buildWaypoints(g, cached->second, aRoute);
+    return true;
+  }
+
+  const unsigned int start = g.indexOf(key.first);
+  const unsigned int dest = g.indexOf(key.second);
+  SearchResult path;
+
+  if ((start != AirwayGraph::NoNode) && (dest != AirwayGraph::NoNode)) {
+    const double unknown = -1.0;
+    const SGGeod& destPos = g.positions[dest];
+
+    // g(x), h(x) and the best predecessor for each node; open nodes are
+    // kept in a heap with lazy deletion of superseded entries.
+    std::vector<double> distanceFromStart(g.size(), std::numeric_limits<double>::max());
+    std::vector<double> directDistanceToDestination(g.size(), unknown);
+    std::vector<unsigned int> previous(g.size(), AirwayGraph::NoNode);
+    std::vector<int> viaAirway(g.size(), 0);
+    std::vector<bool> closed(g.size(), false);
+    std::priority_queue<OpenNode> openNodes;
+
+    distanceFromStart[start] = 0.0;
+    directDistanceToDestination[start] = SGGeodesy::distanceM(g.positions[start], destPos);
+    openNodes.push(OpenNode{directDistanceToDestination[start], start});
+
+  // A* open node iteration
+    while (!openNodes.empty()) {
+      const unsigned int x = openNodes.top().node;
+      openNodes.pop();
+      if (closed[x]) {
+        continue; // stale entry, x was re-opened with a better score
       }
 
-      FGPositioned* yp = cache->loadById(other.second);
-      double edgeDistanceM = SGGeodesy::distanceM(xp->geod(), yp->geod());
-      AStarOpenNodeRef y = findInOpen(openNodes, yp);
-      if (y) { // already open
-        double g = x->distanceFromStart + edgeDistanceM;
-        if (g > y->distanceFromStart) {
-          // worse path, ignore
+      closed[x] = true;
+
 #ifdef DEBUG_AWY_SEARCH
-          SG_LOG(SG_NAVAID, SG_INFO, "\tabandoning " << yp->ident() <<
-           " path is worse: g(y)" << y->distanceFromStart << ", g'=" << g);
+      SG_LOG(SG_NAVAID, SG_INFO, "x:" << g.ids[x] << ", g(x)=" << distanceFromStart[x]);
 #endif
-          continue;
+
+    // check if x is the goal; if so we're done, since there cannot be an open
+    // node with lower f(x) value.
+      if (x == dest) {
+        for (unsigned int n = x; n != AirwayGraph::NoNode; n = previous[n]) {
+          path.push_back(std::make_pair(n, viaAirway[n]));
         }
-        
-      // we need to update y. Unfortunately this means rebuilding the heap,
-      // since y's score can change arbitrarily
-#ifdef DEBUG_AWY_SEARCH
-        SG_LOG(SG_NAVAID, SG_INFO, "\tfixing up previous for new path to " << yp->ident() << ", d =" << g);
-#endif
-        y->previous = x;
-        y->distanceFromStart = g;
-        y->airway = other.first;
-        std::make_heap(openNodes.begin(), openNodes.end(), ordering);
-      } else { // not open, insert a new node for y into the heap
-        y = new AStarOpenNode(yp, edgeDistanceM, other.first, aDest, x);
-#ifdef DEBUG_AWY_SEARCH
-        SG_LOG(SG_NAVAID, SG_INFO, "\ty=" << yp->ident() << ", f(y)=" << y->totalCost());
-#endif
-        openNodes.push_back(y);
-        std::push_heap(openNodes.begin(), openNodes.end(), ordering);
+        std::reverse(path.begin(), path.end());
+        break;
       }
-    } // of neighbour iteration
-  } // of open node iteration
-  
-  SG_LOG(SG_NAVAID, SG_INFO, "A* failed to find route");
-  return false;
+
+    // adjacent (neighbour) iteration
+      for (unsigned int e = g.offsets[x]; e < g.offsets[x + 1]; ++e) {
+        const unsigned int y = g.targets[e];
+        if (closed[y]) {
+          continue; // closed, ignore
+        }
+
+        const double gy = distanceFromStart[x] + g.lengths[e];
+        if (gy > distanceFromStart[y]) {
+          continue; // already open via a better path
+        }
+
+        if (directDistanceToDestination[y] == unknown) {
+          directDistanceToDestination[y] = SGGeodesy::distanceM(g.positions[y], destPos);
+        }
+
+        distanceFromStart[y] = gy;
+        previous[y] = x;
+        viaAirway[y] = g.airways[e];
+        openNodes.push(OpenNode{gy + directDistanceToDestination[y], y});
+      } // of neighbour iteration
+    } // of open node iteration
+  }
+
+  if (_searchCache.size() >= MAX_CACHED_SEARCHES) {
+    _searchCache.erase(_searchCacheOrder.front());
+    _searchCacheOrder.pop_front();
+  }
+
+  _searchCache[key] = path;
+  _searchCacheOrder.push_back(key);
+
+  if (path.empty()) {
+    SG_LOG(SG_NAVAID, SG_INFO, "A* failed to find route");
+    return false;
+  }
+
+  buildWaypoints(g, path, aRoute);
+  return true;
 }
 
 } // of namespace flightgear
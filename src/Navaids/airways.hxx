@@ -20,7 +20,9 @@
 #ifndef FG_AIRWAYS_HXX
 #define FG_AIRWAYS_HXX
 
+#include <deque>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include <Navaids/route.hxx>
@@ -36,6 +38,7 @@ struct SearchContext;
 class AdjacentWaypoint;
 class InAirwayFilter;
 class Airway;
+struct AirwayGraph;
 
 using AirwayRef = SGSharedPtr<Airway>;
 
@@ -102,6 +105,8 @@ public:
     friend class Airway;
     friend class InAirwayFilter;
     
+    Network();
+    ~Network();
   
     /**
      * Principal routing algorithm. Attempts to find the best route beween
@@ -131,6 +136,18 @@ public:
                             bool exactTo, bool exactFrom);
       
     bool search2(FGPositionedRef aStart, FGPositionedRef aDest, WayptVec& aRoute);
+
+    /**
+     * the in-memory (compressed sparse row) graph of this network, loaded
+     * from the NavDataCache on first use.
+     */
+    const AirwayGraph& graph() const;
+
+    /**
+     * discard the in-memory graph, the search result cache and the membership
+     * cache, eg because the NavDataCache was rebuilt.
+     */
+    void clearCaches();
   
     /**
      * Test if a positioned item is part of this airway network or not.
@@ -156,6 +173,18 @@ public:
      */
     typedef std::map<PositionedID, bool> NetworkMembershipDict;
     mutable NetworkMembershipDict _inNetworkCache;
+
+    mutable std::unique_ptr<AirwayGraph> _graph;
+
+    /**
+     * cache of search2() results, as a sequence of (graph node, airway)
+     * pairs, keyed by the start and destination nodes. Bounded in size,
+     * oldest entries are discarded first.
+     */
+    typedef std::pair<PositionedID, PositionedID> SearchKey;
+    typedef std::vector<std::pair<unsigned int, int> > SearchResult;
+    std::map<SearchKey, SearchResult> _searchCache;
+    std::deque<SearchKey> _searchCacheOrder;
     
     Level _networkID;
   };
@@ -163,6 +192,12 @@ public:
 
   static Network* highLevel();
   static Network* lowLevel();
+
+  /**
+   * discard cached routing data of both networks; called when the
+   * NavDataCache is destroyed.
+   */
+  static void clearNetworkCaches();
   
 private:
   Airway(const std::string& aIdent, const Level level, int dbId, int aTop, int aBottom);
@@ -239,6 +239,13 @@ TurnInfo turnCenterAndAngleFromExit(const SGGeod& pt, double outHeadingDeg,
     return r;
 }
 
+bool sameGeod(const SGGeod& a, const SGGeod& b)
+{
+  return (a.getLongitudeRad() == b.getLongitudeRad()) &&
+    (a.getLatitudeRad() == b.getLatitudeRad()) &&
+    (a.getElevationM() == b.getElevationM());
+}
+
 class WayptData;
 using WayptDataVec = std::vector<WayptData>;
 using WpDataIt =  WayptDataVec::iterator;
@@ -606,6 +613,26 @@ public:
       return pointOnEntryTurnFromHeading(legCourseTrue + theta);
   }
   
+  /**
+   * test if all the computed data is identical, i.e. legs computed from
+   * this one would come out the same
+   */
+  bool sameGeometry(const WayptData& other) const
+  {
+    return (wpt == other.wpt) && (hasEntry == other.hasEntry) &&
+      (posValid == other.posValid) && (legCourseValid == other.legCourseValid) &&
+      (skipped == other.skipped) && (flyOver == other.flyOver) &&
+      sameGeod(pos, other.pos) && sameGeod(turnEntryPos, other.turnEntryPos) &&
+      sameGeod(turnExitPos, other.turnExitPos) &&
+      sameGeod(turnEntryCenter, other.turnEntryCenter) &&
+      sameGeod(turnExitCenter, other.turnExitCenter) &&
+      (turnEntryAngle == other.turnEntryAngle) && (turnExitAngle == other.turnExitAngle) &&
+      (turnRadius == other.turnRadius) && (legCourseTrue == other.legCourseTrue) &&
+      (pathDistanceM == other.pathDistanceM) &&
+      (turnPathDistanceM == other.turnPathDistanceM) &&
+      (overflightCompensationAngle == other.overflightCompensationAngle);
+  }
+
   WayptRef wpt;
   bool hasEntry, posValid, legCourseValid, skipped;
   SGGeod pos, turnEntryPos, turnExitPos, turnEntryCenter, turnExitCenter;
@@ -621,11 +648,34 @@ bool isDescentWaypoint(const WayptRef& wpt)
   return (wpt->flag(WPT_APPROACH) && !wpt->flag(WPT_MISS)) || wpt->flag(WPT_ARRIVAL);
 }
 
+// index of the closest leg before index which isn't skipped or a
+// discontinuity, or -1
+int previousValidIndex(const WayptDataVec& waypoints, int index)
+{
+  do {
+    if (index <= 0) {
+      return -1;
+    }
+
+    --index;
+  } while (waypoints.at(index).skipped || (waypoints.at(index).wpt->type() == "discontinuity"));
+
+  return index;
+}
+
 class RoutePath::RoutePathPrivate
 {
 public:
     WayptDataVec waypoints;
 
+    // for incremental updates: the legs after the static pass (initPass1),
+    // and each leg as it was just before the turn computation reached it
+    WayptDataVec initial;
+    WayptDataVec entry;
+
+    // lazily computed result of pathForIndex, per leg; shared by copies
+    mutable std::vector<std::shared_ptr<const SGGeodVec>> paths;
+
     AircraftPerformance perf;
     bool constrainLegCourses;
 
@@ -813,15 +863,12 @@ public:
   
     WayptDataVec::iterator previousValidWaypoint(unsigned int index)
     {
-        do {
-            if (index == 0) {
-                return waypoints.end();
-            }
-            
-            --index;
-        } while (waypoints.at(index).skipped || (waypoints.at(index).wpt->type() == "discontinuity"));
+        const int prev = previousValidIndex(waypoints, index);
+        if (prev < 0) {
+            return waypoints.end();
+        }
 
-        return waypoints.begin() + index;
+        return waypoints.begin() + prev;
     }
 
     WayptDataVec::iterator previousValidWaypoint(WayptDataVec::iterator it)
@@ -894,43 +941,153 @@ void RoutePath::commonInit()
     d->waypoints[i].initPass1(prevPtr, nextPtr);
   }
 
+  d->initial = d->waypoints;
+  d->entry = d->waypoints;
+  d->paths.assign(d->waypoints.size(), nullptr);
+
   for (unsigned int i=0; i<d->waypoints.size(); ++i) {
-      if (d->waypoints[i].skipped) {
-          continue;
-      }
+    computeLeg(i);
+  }
+}
 
-      double alt = 0.0; // FIXME
-      double radiusM = d->perf.turnRadiusMForAltitude(alt);
+void RoutePath::computeLeg(int i)
+{
+  d->entry[i] = d->waypoints[i];
+  if (d->waypoints[i].skipped) {
+    return;
+  }
 
-      if (i > 0) {
-          auto prevIt = d->previousValidWaypoint(i);
-          WayptData* prevPtr = (prevIt == d->waypoints.end()) ? nullptr : &(*prevIt);
+  double alt = 0.0; // FIXME
+  double radiusM = d->perf.turnRadiusMForAltitude(alt);
 
-          d->waypoints[i].computeLegCourse(prevPtr, radiusM);
-          d->computeDynamicPosition(i);
+  if (i > 0) {
+      auto prevIt = d->previousValidWaypoint(i);
+      WayptData* prevPtr = (prevIt == d->waypoints.end()) ? nullptr : &(*prevIt);
+
+      d->waypoints[i].computeLegCourse(prevPtr, radiusM);
+      d->computeDynamicPosition(i);
+  }
+
+  auto nextIt = d->nextValidWaypoint(i);
+  if (nextIt != d->waypoints.end()) {
+      nextIt->computeLegCourse(&(d->waypoints[i]), radiusM);
+
+      if (nextIt->legCourseValid) {
+          d->waypoints[i].computeTurn(radiusM, d->constrainLegCourses, *nextIt);
+      } else {
+        // next waypoint has indeterminate course. Let's create a sharp turn
+        // this can happen when the following point is ATC vectors, for example.
+        d->waypoints[i].turnEntryPos = d->waypoints[i].pos;
+        d->waypoints[i].turnExitPos = d->waypoints[i].pos;
       }
+  } else {
+    // final waypt, fix up some data
+    d->waypoints[i].turnExitPos = d->waypoints[i].pos;
+    d->waypoints[i].turnEntryPos = d->waypoints[i].pos;
+  }
 
-      auto nextIt = d->nextValidWaypoint(i);
-      if (nextIt != d->waypoints.end()) {
-          nextIt->computeLegCourse(&(d->waypoints[i]), radiusM);
+  // now turn is computed, can resolve distances
+  d->waypoints[i].pathDistanceM = computeDistanceForIndex(i);
+}
 
-          if (nextIt->legCourseValid) {
-              d->waypoints[i].computeTurn(radiusM, d->constrainLegCourses, *nextIt);
-          } else {
-            // next waypoint has indeterminate course. Let's create a sharp turn
-            // this can happen when the following point is ATC vectors, for example.
-            d->waypoints[i].turnEntryPos = d->waypoints[i].pos;
-            d->waypoints[i].turnExitPos = d->waypoints[i].pos;
-          }
-    } else {
-      // final waypt, fix up some data
-      d->waypoints[i].turnExitPos = d->waypoints[i].pos;
-      d->waypoints[i].turnEntryPos = d->waypoints[i].pos;
+void RoutePath::update(const flightgear::FlightPlan* fp, int begin, int end)
+{
+    const int oldCount = static_cast<int>(d->waypoints.size());
+    const int count = fp->numLegs();
+    const int delta = count - oldCount;
+
+    // the position of a heading-to-altitude leg depends on the next known
+    // altitude when descending, and on the path from the previous one
+    // when climbing, so possibly on legs far away.
+    int firstDescentVNAV = count;
+    std::vector<std::pair<int, int>> climbVNAV; // leg, first leg it depends on
+    int knownAltitude = -1;
+    WayptRef previous;
+    for (int l = 0; l < count; ++l) {
+        WayptRef wpt = fp->legAtIndex(l)->waypoint();
+        if ((l > 0) && wpt->flag(WPT_DYNAMIC) && (wpt->type() == "hdgToAlt")) {
+            if (isDescentWaypoint(previous)) {
+                firstDescentVNAV = std::min(firstDescentVNAV, l);
+            } else {
+                climbVNAV.emplace_back(l, knownAltitude);
+            }
+        }
+
+        if ((wpt->altitudeRestriction() == RESTRICT_AT) || (wpt->type() == "runway")) {
+            knownAltitude = l;
+        }
+        previous = wpt;
+    }
+
+    const bool constrain = fp->followLegTrackToFixes();
+    if ((begin < 0) || (begin > end) || (end > count) ||
+        (end - delta < begin) || (end - delta > oldCount) ||
+        (constrain != d->constrainLegCourses))
+    {
+        // not a change we can apply, recompute everything
+        begin = 0;
+        end = count;
+    }
+
+    d->constrainLegCourses = constrain;
+
+    // the legs before the change keep their data, except for the previous
+    // waypoint, whose turn depends on the first changed leg, and the one
+    // before that, whose turn may have adjusted the previous leg's course.
+    int restart = previousValidIndex(d->waypoints, std::min(begin, firstDescentVNAV));
+    restart = std::max(previousValidIndex(d->waypoints, restart), 0);
+
+    WayptDataVec oldWaypoints, oldEntry;
+    oldWaypoints.swap(d->waypoints);
+    oldEntry.swap(d->entry);
+    auto oldPaths = std::move(d->paths);
+
+    d->initial.erase(d->initial.begin() + restart, d->initial.end());
+    for (int l = restart; l < count; ++l) {
+        d->initial.push_back(WayptData(fp->legAtIndex(l)->waypoint()));
+        d->initial.back().initPass0();
+    }
+
+    for (int l = std::max(restart, 1); l < count; ++l) {
+        WayptData* nextPtr = ((l + 1) < count) ? &d->initial[l + 1] : nullptr;
+        const int prev = previousValidIndex(d->initial, l);
+        d->initial[l].initPass1((prev < 0) ? nullptr : &d->initial[prev], nextPtr);
+    }
+
+    d->waypoints.assign(oldWaypoints.begin(), oldWaypoints.begin() + restart);
+    d->waypoints.insert(d->waypoints.end(), d->initial.begin() + restart, d->initial.end());
+    if (restart > 0) {
+        // as left by the turn computation of the legs before it
+        d->waypoints[restart] = oldEntry[restart];
+    }
+
+    d->entry.assign(oldEntry.begin(), oldEntry.begin() + restart);
+    d->entry.insert(d->entry.end(), d->initial.begin() + restart, d->initial.end());
+    d->paths.assign(oldPaths.begin(), oldPaths.begin() + restart);
+    d->paths.resize(count);
+
+    for (int l = restart; l < count; ++l) {
+        // once past the change, a leg arrived at exactly as before, from
+        // a previous waypoint which is exactly as before, must come out the
+        // same, as must all legs following it: take them over unchanged.
+        const int old = l - delta;
+        const WayptData& prev = d->waypoints[l - 1];
+        const bool climbReachesBack = std::any_of(climbVNAV.begin(), climbVNAV.end(),
+            [l](const std::pair<int, int>& c) { return (c.first >= l) && (c.second < l - 1); });
+        if ((l > end) && !climbReachesBack &&
+            !prev.skipped && (prev.wpt->type() != "discontinuity") &&
+            !d->waypoints[l].skipped && (d->waypoints[l].wpt->type() != "discontinuity") &&
+            prev.sameGeometry(oldWaypoints[old - 1]) &&
+            d->waypoints[l].sameGeometry(oldEntry[old]))
+        {
+            std::copy(oldWaypoints.begin() + old, oldWaypoints.end(), d->waypoints.begin() + l);
+            std::copy(oldEntry.begin() + old, oldEntry.end(), d->entry.begin() + l);
+            std::copy(oldPaths.begin() + old, oldPaths.end(), d->paths.begin() + l);
+            break;
+        }
+
+        computeLeg(l);
     }
-    
-    // now turn is computed, can resolve distances
-    d->waypoints[i].pathDistanceM = computeDistanceForIndex(i);
-  }
 }
 
 SGGeodVec RoutePath::pathForIndex(int index) const
@@ -939,6 +1096,16 @@ SGGeodVec RoutePath::pathForIndex(int index) const
     return {};
   }
 
+  auto& path = d->paths[index];
+  if (!path) {
+    path = std::make_shared<const SGGeodVec>(computePathForIndex(index));
+  }
+
+  return *path;
+}
+
+SGGeodVec RoutePath::computePathForIndex(int index) const
+{
   const WayptData& w(d->waypoints[index]);
   const std::string& ty(w.wpt->type());
   SGGeodVec r;
@@ -57,10 +57,22 @@ public:
   
   double distanceBetweenIndices(int from, int to) const;
 
+  /**
+   * Bring the path up to date with fp, after its legs [begin, end) were
+   * inserted or modified, and legs removed before end. The legs from end
+   * onwards must be unchanged, apart from their index. Only the legs
+   * affected by the change are recomputed.
+   */
+  void update(const flightgear::FlightPlan* fp, int begin, int end);
+
 private:
   class RoutePathPrivate;
   
   void commonInit();
+
+  void computeLeg(int index);
+
+  flightgear::SGGeodVec computePathForIndex(int index) const;
   
   double computeDistanceForIndex(int index) const;
 
@@ -0,0 +1,304 @@
+// ThreadedIOChannel.cxx -- perform channel I/O on a dedicated thread
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "config.h"
+
+#include "ThreadedIOChannel.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include <simgear/debug/logstream.hxx>
+
+#include "protocol.hxx"
+
+namespace {
+
+// weight of a new sample in the latency averages
+const double LATENCY_SMOOTHING = 0.1;
+
+// upper bound on reads from one channel per executor pass, so a flooding
+// peer can't starve the other channels
+const int MAX_READS_PER_PASS = 64;
+
+void updateAverage(std::atomic<double>& average, double sample)
+{
+    const double previous = average.load(std::memory_order_relaxed);
+    const double next = (previous == 0.0) ? sample :
+        previous + LATENCY_SMOOTHING * (sample - previous);
+    average.store(next, std::memory_order_relaxed);
+}
+
+} // of anonymous namespace
+
+FGThreadedIOChannel::FGThreadedIOChannel(SGIOChannel* channel, FGIOExecutor* executor,
+                                         size_t queueCapacity, bool datagrams) :
+    _channel(channel),
+    _executor(executor),
+    _dir(SG_IO_NONE),
+    _datagrams(datagrams),
+    _inbound(queueCapacity),
+    _outbound(queueCapacity)
+{
+    set_type(channel->get_type());
+}
+
+FGThreadedIOChannel::~FGThreadedIOChannel()
+{
+    if (_registered) {
+        close();
+    }
+}
+
+bool FGThreadedIOChannel::open(const SGProtocolDir d)
+{
+    _dir = d;
+    set_dir(d);
+
+    if (!_channel->open(d)) {
+        return false;
+    }
+
+    set_valid(true);
+    if (!_registered) {
+        _executor->add(this);
+        _registered = true;
+    }
+    return true;
+}
+
+int FGThreadedIOChannel::read(char* buf, int length)
+{
+    if (_pending.empty() && !fillPending()) {
+        return 0;
+    }
+
+    const int result = std::min(length, static_cast<int>(_pending.size()));
+    memcpy(buf, _pending.data(), result);
+    if (_datagrams) {
+        // like recv(), whatever doesn't fit in the buffer is discarded,
+        // rather than returned as the start of the next datagram
+        _pending.clear();
+    } else {
+        _pending.erase(0, result);
+    }
+    return result;
+}
+
+int FGThreadedIOChannel::readline(char* buf, int length)
+{
+    if (length <= 0) {
+        return 0;
+    }
+
+    auto eol = _pending.find('\n');
+    while (eol == std::string::npos) {
+        const size_t searchFrom = _pending.size();
+        if (!fillPending()) {
+            return 0;
+        }
+        eol = _pending.find('\n', searchFrom);
+    }
+
+    // same contract as SGSocket: the line includes the terminator, and
+    // the buffer is null-terminated
+    const int result = std::min(length - 1, static_cast<int>(eol + 1));
+    memcpy(buf, _pending.data(), result);
+    buf[result] = '\0';
+    _pending.erase(0, result);
+    return result;
+}
+
+int FGThreadedIOChannel::write(const char* buf, const int length)
+{
+    Message m;
+    m.data.assign(buf, length);
+    m.stampUSec = FGIOExecutor::nowUSec();
+    if (!_outbound.push(std::move(m))) {
+        // report success: the protocol can't do anything useful with the
+        // failure, and the drop is visible in the statistics
+        ++_outDrops;
+    }
+    return length;
+}
+
+int FGThreadedIOChannel::writestring(const char* str)
+{
+    return write(str, static_cast<int>(strlen(str)));
+}
+
+bool FGThreadedIOChannel::close()
+{
+    if (_registered) {
+        _executor->remove(this);
+        _registered = false;
+    }
+
+    // the executor no longer touches the channel, deliver what's left
+    // from this thread
+    flushOutbound();
+    _pending.clear();
+    set_valid(false);
+    return _channel->close();
+}
+
+bool FGThreadedIOChannel::eof() const
+{
+    // only sockets and serial ports are wrapped, neither has an end
+    return false;
+}
+
+bool FGThreadedIOChannel::fillPending()
+{
+    Message m;
+    if (!_inbound.pop(m)) {
+        return false;
+    }
+
+    updateAverage(_inLatencyUSec, static_cast<double>(FGIOExecutor::nowUSec() - m.stampUSec));
+    _pending.append(m.data);
+    return true;
+}
+
+bool FGThreadedIOChannel::flushOutbound()
+{
+    bool didWork = false;
+    Message m;
+    while (_outbound.pop(m)) {
+        const int length = static_cast<int>(m.data.size());
+        if (_channel->write(m.data.data(), length) != length) {
+            ++_writeErrors;
+        }
+
+        updateAverage(_outLatencyUSec, static_cast<double>(FGIOExecutor::nowUSec() - m.stampUSec));
+        didWork = true;
+    }
+    return didWork;
+}
+
+bool FGThreadedIOChannel::service()
+{
+    bool didWork = flushOutbound();
+    if ((_dir != SG_IO_IN) && (_dir != SG_IO_BI)) {
+        return didWork;
+    }
+
+    _readBuffer.resize(FG_MAX_MSG_SIZE);
+    for (int i = 0; i < MAX_READS_PER_PASS; ++i) {
+        const int length = _channel->read(_readBuffer.data(), FG_MAX_MSG_SIZE);
+        if (length <= 0) {
+            break;
+        }
+
+        Message m;
+        m.data.assign(_readBuffer.data(), length);
+        m.stampUSec = FGIOExecutor::nowUSec();
+        if (!_inbound.push(std::move(m))) {
+            ++_inDrops;
+        }
+        didWork = true;
+    }
+
+    return didWork;
+}
+
+void FGThreadedIOChannel::publishStats(SGPropertyNode* node)
+{
+    node->setDoubleValue("latency-in-ms", inboundLatencyMSec());
+    node->setDoubleValue("latency-out-ms", outboundLatencyMSec());
+    node->setIntValue("queue-depth-in", static_cast<int>(inboundQueueDepth()));
+    node->setIntValue("queue-depth-out", static_cast<int>(outboundQueueDepth()));
+    node->setLongValue("dropped-in", static_cast<long>(inboundDrops()));
+    node->setLongValue("dropped-out", static_cast<long>(outboundDrops()));
+    node->setLongValue("write-errors", static_cast<long>(writeErrors()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FGIOExecutor::FGIOExecutor()
+{
+    _thread = std::thread(&FGIOExecutor::run, this);
+}
+
+FGIOExecutor::~FGIOExecutor()
+{
+    _stop = true;
+    _thread.join();
+
+    if (!_channels.empty()) {
+        SG_LOG(SG_IO, SG_DEV_WARN, "I/O executor destroyed with " << _channels.size() << " channels registered");
+    }
+}
+
+void FGIOExecutor::add(FGThreadedIOChannel* channel)
+{
+    std::lock_guard<std::mutex> g(_lock);
+    _channels.push_back(channel);
+}
+
+void FGIOExecutor::remove(FGThreadedIOChannel* channel)
+{
+    std::unique_lock<std::mutex> g(_lock);
+    _channels.erase(std::remove(_channels.begin(), _channels.end(), channel),
+                    _channels.end());
+
+    // the executor thread may be in the middle of servicing the channel
+    _idle.wait(g, [this, channel]() { return _active != channel; });
+}
+
+int64_t FGIOExecutor::nowUSec()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void FGIOExecutor::run()
+{
+    std::vector<FGThreadedIOChannel*> channels;
+    while (!_stop) {
+        {
+            std::lock_guard<std::mutex> g(_lock);
+            channels = _channels;
+        }
+
+        // service without holding the lock, so a channel blocking in a
+        // read or write doesn't also block add() and remove()
+        bool didWork = false;
+        for (auto c : channels) {
+            {
+                std::lock_guard<std::mutex> g(_lock);
+                if (std::find(_channels.begin(), _channels.end(), c) == _channels.end()) {
+                    continue; // removed since the copy was taken
+                }
+                _active = c;
+            }
+
+            didWork |= c->service();
+
+            {
+                std::lock_guard<std::mutex> g(_lock);
+                _active = nullptr;
+            }
+            _idle.notify_all();
+        }
+
+        if (!didWork) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
@@ -0,0 +1,202 @@
+// ThreadedIOChannel.hxx -- perform channel I/O on a dedicated thread
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simgear/io/iochannel.hxx>
+#include <simgear/props/props.hxx>
+
+/**
+ * Bounded, lock-free single-producer / single-consumer queue. push() must
+ * only be called from one thread and pop() from one other thread.
+ */
+template <typename T>
+class SPSCQueue
+{
+public:
+    explicit SPSCQueue(size_t capacity) : _slots(capacity + 1)
+    {
+    }
+
+    /// returns false (and leaves the item alone) if the queue is full
+    bool push(T&& item)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        const size_t next = increment(tail);
+        if (next == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        _slots[tail] = std::move(item);
+        _tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        item = std::move(_slots[head]);
+        _head.store(increment(head), std::memory_order_release);
+        return true;
+    }
+
+    /// approximate when called concurrently with push() or pop()
+    size_t size() const
+    {
+        const size_t head = _head.load(std::memory_order_acquire);
+        const size_t tail = _tail.load(std::memory_order_acquire);
+        return (tail >= head) ? (tail - head) : (tail + _slots.size() - head);
+    }
+
+private:
+    size_t increment(size_t i) const
+    {
+        return (i + 1 == _slots.size()) ? 0 : i + 1;
+    }
+
+    std::vector<T> _slots;
+    std::atomic<size_t> _head{0};
+    std::atomic<size_t> _tail{0};
+};
+
+class FGIOExecutor;
+
+/**
+ * Wraps a socket or serial channel so its reads and writes happen on the
+ * FGIOExecutor thread. The owning FGProtocol keeps calling read(),
+ * readline() and write() from the main thread, as part of its process(),
+ * but these only move data through a pair of SPSC queues, so a slow
+ * serial port or blocking socket can't stall the main loop. All property
+ * access stays in the protocol, on the main thread.
+ *
+ * When a queue is full, data is dropped and counted.
+ *
+ * For datagram channels (UDP sockets) each read() returns at most one
+ * datagram, as the wrapped socket would; otherwise the received data is
+ * treated as a stream.
+ */
+class FGThreadedIOChannel : public SGIOChannel
+{
+public:
+    FGThreadedIOChannel(SGIOChannel* channel, FGIOExecutor* executor,
+                        size_t queueCapacity = 256, bool datagrams = false);
+    ~FGThreadedIOChannel();
+
+    bool open(const SGProtocolDir d) override;
+    int read(char* buf, int length) override;
+    int readline(char* buf, int length) override;
+    int write(const char* buf, const int length) override;
+    int writestring(const char* str) override;
+    bool close() override;
+    bool eof() const override;
+
+    /**
+     * copy the statistics to properties below the node; called from the
+     * main thread, normally once per FGIO update.
+     */
+    void publishStats(SGPropertyNode* node);
+
+    /// exponentially averaged latency between the I/O thread receiving
+    /// data and the protocol reading it
+    double inboundLatencyMSec() const { return _inLatencyUSec / 1000.0; }
+    /// averaged latency between the protocol writing data, and the I/O
+    /// thread passing it to the channel
+    double outboundLatencyMSec() const { return _outLatencyUSec / 1000.0; }
+
+    size_t inboundQueueDepth() const { return _inbound.size(); }
+    size_t outboundQueueDepth() const { return _outbound.size(); }
+    uint64_t inboundDrops() const { return _inDrops; }
+    uint64_t outboundDrops() const { return _outDrops; }
+    uint64_t writeErrors() const { return _writeErrors; }
+
+private:
+    friend class FGIOExecutor;
+
+    struct Message {
+        std::string data;
+        int64_t stampUSec = 0;
+    };
+
+    /// perform pending I/O; called on the executor thread.
+    /// Returns true if any data was moved.
+    bool service();
+
+    bool flushOutbound();
+    bool fillPending();
+
+    std::unique_ptr<SGIOChannel> _channel;
+    FGIOExecutor* _executor;
+    SGProtocolDir _dir;
+    const bool _datagrams;
+    bool _registered = false;
+
+    SPSCQueue<Message> _inbound;
+    SPSCQueue<Message> _outbound;
+
+    // inbound data not yet consumed by the protocol; main thread only
+    std::string _pending;
+
+    std::atomic<double> _inLatencyUSec{0.0};
+    std::atomic<double> _outLatencyUSec{0.0};
+    std::atomic<uint64_t> _inDrops{0};
+    std::atomic<uint64_t> _outDrops{0};
+    std::atomic<uint64_t> _writeErrors{0};
+    std::vector<char> _readBuffer; // executor thread only
+};
+
+/**
+ * The thread servicing all FGThreadedIOChannels.
+ */
+class FGIOExecutor
+{
+public:
+    FGIOExecutor();
+    ~FGIOExecutor();
+
+    void add(FGThreadedIOChannel* channel);
+
+    /**
+     * remove a channel; once this returns, the executor thread no longer
+     * touches it.
+     */
+    void remove(FGThreadedIOChannel* channel);
+
+    static int64_t nowUSec();
+
+private:
+    void run();
+
+    std::mutex _lock;
+    std::condition_variable _idle;
+    std::vector<FGThreadedIOChannel*> _channels;
+    // the channel being serviced, if any; guarded by _lock
+    FGThreadedIOChannel* _active = nullptr;
+    std::atomic<bool> _stop{false};
+    std::thread _thread;
+};
@@ -26,6 +26,9 @@
 
 #include <string.h>                // strstr()
 #include <stdlib.h>                // strtod(), atoi()
+#include <algorithm>
+#include <cctype>
+#include <cmath>
 #include <cstdio>
 
 #include <simgear/debug/logstream.hxx>
@@ -46,6 +49,93 @@
 
 using simgear::strutils::unescape;
 
+namespace {
+
+// ASCII chunks used to be formatted into a char[255]; keep that limit
+const size_t MAX_ASCII_CHUNK = 254;
+
+// format an int as "%d" would, returns the number of characters
+int format_int(char* out, int value)
+{
+    char digits[12];
+    int n = 0;
+    // unsigned arithmetic, so INT_MIN works
+    unsigned int u = (value < 0) ? 0u - static_cast<unsigned int>(value)
+                                 : static_cast<unsigned int>(value);
+    do {
+        digits[n++] = static_cast<char>('0' + (u % 10));
+        u /= 10;
+    } while (u);
+
+    int len = 0;
+    if (value < 0) {
+        out[len++] = '-';
+    }
+    while (n > 0) {
+        out[len++] = digits[--n];
+    }
+    return len;
+}
+
+// format a value as "%.<precision>f" would, returns the number of
+// characters, or -1 if the value must be formatted by snprintf: values
+// which are very large, not finite, or so close to a rounding tie that the
+// double multiplication below could round differently from printf.
+int format_fixed(char* out, size_t available, double value, int precision)
+{
+    static const double scales[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+    if (!std::isfinite(value) || (precision < 0) || (precision > 9)) {
+        return -1;
+    }
+
+    const double scaled = std::fabs(value) * scales[precision];
+    if (scaled >= 1e12) {
+        return -1;
+    }
+
+    const double whole = std::floor(scaled);
+    const double fraction = scaled - whole;
+    if (std::fabs(fraction - 0.5) < 1e-3) {
+        return -1;
+    }
+
+    uint64_t n = static_cast<uint64_t>(whole) + ((fraction > 0.5) ? 1 : 0);
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + (n % 10));
+        n /= 10;
+    } while (n);
+
+    // at least one digit before the decimal point
+    while (count <= precision) {
+        digits[count++] = '0';
+    }
+
+    const bool negative = std::signbit(value);
+    const size_t needed = (negative ? 1 : 0) + count + ((precision > 0) ? 1 : 0);
+    if (needed > available) {
+        return -1;
+    }
+
+    int len = 0;
+    if (negative) {
+        out[len++] = '-';
+    }
+    while (count > precision) {
+        out[len++] = digits[--count];
+    }
+    if (precision > 0) {
+        out[len++] = '.';
+        while (count > 0) {
+            out[len++] = digits[--count];
+        }
+    }
+    return len;
+}
+
+} // of anonymous namespace
+
 class FGProtocolWrapper {
 public:
   virtual ~FGProtocolWrapper() {}
@@ -221,7 +311,7 @@ int FGSTXETXWrapper::unwrap( size_t n, uint8_t * buf )
   return n;
 }
 
-FGGeneric::FGGeneric(vector<string> tokens) : exitOnError(false), initOk(false), wrapper(NULL)
+FGGeneric::FGGeneric(vector<string> tokens) : binary_words_host_order(true), truncation_warned(false), exitOnError(false), initOk(false), wrapper(NULL)
 {
     size_t configToken;
     if (tokens[1] == "socket") {
@@ -351,34 +441,37 @@ bool FGGeneric::gen_message_binary() {
             val = _out_message[i].offset +
                   _out_message[i].prop->getFloatValue() * _out_message[i].factor;
             int16_t wordVal = val;
+            if ((binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) && !binary_words_host_order) {
+                wordVal = (int16_t) sg_bswap_16((uint16_t)wordVal);
+            }
             memcpy(&buf[length], &wordVal, sizeof(int16_t));
             length += sizeof(int16_t);
             break;
         }
 
         default: // SG_STRING
+        {
             const char *strdata = _out_message[i].prop->getStringValue();
-            int32_t strlength = strlen(strdata);
+            // clip so the length, the string and a footer always fit
+            const int32_t space = FG_MAX_MSG_SIZE - length - 2 * (int32_t) sizeof(int32_t);
+            const int32_t strlength = std::min<int32_t>(strlen(strdata), std::max<int32_t>(space, 0));
 
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
-                SG_LOG( SG_IO, SG_ALERT, "Generic protocol: "
-                        "FG_STRING will be written in host byte order.");
-            }
             /* Format for strings is 
              * [length as int, 4 bytes][ASCII data, length bytes]
              */
-            if (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) {
-                strlength = sg_bswap_32(strlength);
+            int32_t wireLength = strlength;
+            if ((binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) && !binary_words_host_order) {
+                wireLength = sg_bswap_32(strlength);
             }
-            memcpy(&buf[length], &strlength, sizeof(int32_t));
+            memcpy(&buf[length], &wireLength, sizeof(int32_t));
             length += sizeof(int32_t);
-            strncpy(&buf[length], strdata, strlength);
+            memcpy(&buf[length], strdata, strlength);
             length += strlength; 
             /* FIXME padding for alignment? Something like: 
              * length += (strlength % 4 > 0 ? sizeof(int32_t) - strlength % 4 : 0;
              */
             break;
-
+        }
         }
     }
 
@@ -407,67 +500,114 @@ bool FGGeneric::gen_message_binary() {
     return true;
 }
 
-bool FGGeneric::gen_message_ascii() {
-    string generic_sentence;
-    char tmp[255];
-    length = 0;
-
+int FGGeneric::append_ascii_chunk(const _serial_prot& chunk, char* out, size_t available,
+                                  bool& truncated) const
+{
+    // 'out' always has room for a terminating NUL after 'available' chars
+    const size_t cap = std::min(available, MAX_ASCII_CHUNK);
+    const char* format = chunk.format.c_str();
+    char tmp[32];
+    int n = -1;
     double val;
-    for (unsigned int i = 0; i < _out_message.size(); i++) {
 
-        if (i > 0) {
-            generic_sentence += var_separator;
+    // n is the length of the complete chunk, which may not have fit
+    auto clip = [cap, &truncated](int n) {
+        truncated |= (n > (int)cap);
+        return std::max(0, std::min(n, (int)cap));
+    };
+
+    switch (chunk.type) {
+    case FG_BYTE:
+    case FG_WORD:
+    case FG_INT:
+        val = chunk.offset + chunk.prop->getFloatValue() * chunk.factor;
+        if (chunk.format_kind == FMT_INT) {
+            n = format_int(tmp, (int)val);
+        } else {
+            n = snprintf(out, cap + 1, format, (int)val);
+            return clip(n);
         }
-        
-        string format = simgear::strutils::sanitizePrintfFormat(_out_message[i].format);
+        break;
 
-        switch (_out_message[i].type) {
-        case FG_BYTE:
-        case FG_WORD:
-        case FG_INT:
-            val = _out_message[i].offset +
-                  _out_message[i].prop->getFloatValue() * _out_message[i].factor;
-            snprintf(tmp, 255, format.c_str(), (int)val);
-            break;
+    case FG_BOOL:
+        if (chunk.format_kind == FMT_INT) {
+            n = format_int(tmp, chunk.prop->getBoolValue() ? 1 : 0);
+        } else {
+            n = snprintf(out, cap + 1, format, chunk.prop->getBoolValue());
+            return clip(n);
+        }
+        break;
 
-        case FG_BOOL:
-            snprintf(tmp, 255, format.c_str(),
-                               _out_message[i].prop->getBoolValue());
-            break;
+    case FG_FIXED:
+    case FG_FLOAT:
+    case FG_DOUBLE:
+        val = chunk.offset + ((chunk.type == FG_DOUBLE) ? chunk.prop->getDoubleValue()
+                                                         : chunk.prop->getFloatValue()) * chunk.factor;
+        if (chunk.type != FG_DOUBLE) {
+            val = (float)val;
+        }
 
-        case FG_FIXED:
-            val = _out_message[i].offset +
-                _out_message[i].prop->getFloatValue() * _out_message[i].factor;
-            snprintf(tmp, 255, format.c_str(), (float)val);
-            break;
+        if (chunk.format_kind == FMT_FIXED) {
+            n = format_fixed(tmp, sizeof(tmp), val, chunk.precision);
+        }
 
-        case FG_FLOAT:
-            val = _out_message[i].offset +
-                _out_message[i].prop->getFloatValue() * _out_message[i].factor;
-            snprintf(tmp, 255, format.c_str(), (float)val);
-            break;
+        if (n < 0) {
+            n = snprintf(out, cap + 1, format, val);
+            return clip(n);
+        }
+        break;
 
-        case FG_DOUBLE:
-            val = _out_message[i].offset +
-                _out_message[i].prop->getDoubleValue() * _out_message[i].factor;
-            snprintf(tmp, 255, format.c_str(), (double)val);
-            break;
+    default: // SG_STRING
+        if (chunk.format_kind == FMT_STRING) {
+            const char* str = chunk.prop->getStringValue();
+            const int len = clip((int)strlen(str));
+            memcpy(out, str, len);
+            return len;
+        }
 
-        default: // SG_STRING
-            snprintf(tmp, 255, format.c_str(),
-                                   _out_message[i].prop->getStringValue());
+        n = snprintf(out, cap + 1, format, chunk.prop->getStringValue());
+        return clip(n);
+    }
+
+    n = clip(n);
+    memcpy(out, tmp, n);
+    return n;
+}
+
+bool FGGeneric::gen_message_ascii() {
+    // chunks are formatted straight into buf; keep one byte spare so
+    // snprintf always has room for its NUL
+    const int capacity = FG_MAX_MSG_SIZE - 1;
+    bool truncated = false;
+    length = 0;
+
+    auto append = [this, capacity, &truncated](const string& s) {
+        const int n = std::min((int)s.size(), capacity - length);
+        memcpy(buf + length, s.data(), n);
+        length += n;
+        truncated |= (n < (int)s.size());
+    };
+
+    for (unsigned int i = 0; i < _out_message.size(); i++) {
+
+        if (i > 0) {
+            append(var_separator);
         }
 
-        generic_sentence += tmp;
+        length += append_ascii_chunk(_out_message[i], buf + length, capacity - length, truncated);
     }
 
     /* After each lot of variables has been added, put the line separator
      * char/string
      */
-    generic_sentence += line_separator;
+    append(line_separator);
+    truncated |= (length >= capacity);
 
-    length =  generic_sentence.length();
-    strncpy( buf, generic_sentence.c_str(), length );
+    if (truncated && !truncation_warned) {
+        SG_LOG(SG_IO, SG_WARN, "Generic protocol: message from " << file_name
+               << " truncated to " << length << " bytes");
+        truncation_warned = true;
+    }
 
     return true;
 }
@@ -488,6 +628,12 @@ bool FGGeneric::parse_message_binary(int length) {
     p2 = p1 + length;
     while ((++i < (int)_in_message.size()) && (p1  < p2)) {
 
+        // stop at a chunk which doesn't fit in the remaining record
+        if ((_in_message[i].type != FG_STRING) &&
+            (p1 + binary_chunk_size(_in_message[i].type) > p2)) {
+            break;
+        }
+
         switch (_in_message[i].type) {
         case FG_INT:
             if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
@@ -553,10 +699,26 @@ bool FGGeneric::parse_message_binary(int length) {
             break;
 
         default: // SG_STRING
-            SG_LOG( SG_IO, SG_ALERT, "Generic protocol: "
-                    "Ignoring unsupported binary input chunk type.");
+        {
+            // same layout as gen_message_binary(): length, then data
+            if (p1 + sizeof(int32_t) > p2) {
+                p1 = p2;
+                break;
+            }
+
+            int32_t strlength;
+            memcpy(&strlength, p1, sizeof(int32_t));
+            if ((binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) && !binary_words_host_order) {
+                strlength = (int32_t) sg_bswap_32((uint32_t)strlength);
+            }
+            p1 += sizeof(int32_t);
+
+            strlength = std::max<int32_t>(0, std::min<int32_t>(strlength, p2 - p1));
+            _in_message[i].prop->setStringValue(string(p1, strlength));
+            p1 += strlength;
             break;
         }
+        }
     }
     
     return true;
@@ -581,7 +743,15 @@ bool FGGeneric::parse_message_ascii(int length) {
     while ((++i < chunks) && p1) {
         char* p2 = NULL;
 
-        if (varsep_len > 0)
+        if (varsep_len == 1)
+        {
+            p2 = strchr(p1, var_separator[0]);
+            if (p2) {
+                *p2 = 0;
+                p2 += 1;
+            }
+        }
+        else if (varsep_len > 0)
         {
             p2 = strstr(p1, var_separator.c_str());
             if (p2) {
@@ -900,6 +1070,20 @@ FGGeneric::read_config(SGPropertyNode *root, vector<_serial_prot> &msg)
             }
         }
 
+        // FG_WORD values and FG_STRING lengths have always been written in
+        // host byte order; existing peers depend on that
+        binary_words_host_order = true;
+        if ( root->hasValue("word_byte_order") ) {
+            string word_order = root->getStringValue("word_byte_order");
+            if ( word_order == "byte_order" ) {
+                binary_words_host_order = false;
+            } else if ( word_order != "host" ) {
+                SG_LOG(SG_IO, SG_ALERT,
+                       "generic protocol: Undefined generic binary protocol "
+                       "word byte order '" << word_order << "', using HOST byte order.");
+            }
+        }
+
         if( root->hasValue( "wrapper" ) ) {
             string w = root->getStringValue( "wrapper" );
             if( w == "kiss" )  wrapper = new FGKissWrapper();
@@ -918,6 +1102,7 @@ FGGeneric::read_config(SGPropertyNode *root, vector<_serial_prot> &msg)
 
         // chunk.name = chunks[i]->getStringValue("name");
         chunk.format = unescape(chunks[i]->getStringValue("format", "%d"));
+        compile_format(chunk);
         chunk.offset = chunks[i]->getDoubleValue("offset");
         chunk.factor = chunks[i]->getDoubleValue("factor", 1.0);
         chunk.min = chunks[i]->getDoubleValue("min");
@@ -951,12 +1136,22 @@ FGGeneric::read_config(SGPropertyNode *root, vector<_serial_prot> &msg)
             record_length += sizeof(int32_t);
         } else if (type == "string") {
             chunk.type = FG_STRING;
+            if (binary_mode && binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION && binary_words_host_order) {
+                SG_LOG( SG_IO, SG_ALERT, "Generic protocol: "
+                        "FG_STRING length will be written in host byte order, "
+                        "unless word_byte_order is set to byte_order.");
+            }
         } else if (type == "byte") {
             chunk.type = FG_BYTE;
             record_length += sizeof(int8_t);
         } else if (type == "word") {
             chunk.type = FG_WORD;
             record_length += sizeof(int16_t);
+            if (binary_mode && binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION && binary_words_host_order) {
+                SG_LOG( SG_IO, SG_ALERT, "Generic protocol: "
+                        "FG_WORD will be written in host byte order, "
+                        "unless word_byte_order is set to byte_order.");
+            }
         } else {
             chunk.type = FG_INT;
             record_length += sizeof(int32_t);
@@ -991,6 +1186,44 @@ FGGeneric::read_config(SGPropertyNode *root, vector<_serial_prot> &msg)
     return true;
 }
 
+void FGGeneric::compile_format(_serial_prot& chunk)
+{
+    // validate once, rather than on every message
+    chunk.format = simgear::strutils::sanitizePrintfFormat(chunk.format);
+    chunk.format_kind = FMT_PRINTF;
+    chunk.precision = 6;
+
+    const string& f = chunk.format;
+    if (f == "%d" || f == "%i") {
+        chunk.format_kind = FMT_INT;
+    } else if (f == "%s") {
+        chunk.format_kind = FMT_STRING;
+    } else if (f == "%f" || f == "%lf") {
+        chunk.format_kind = FMT_FIXED;
+    } else if ((f.size() == 4) && (f.compare(0, 2, "%.") == 0) &&
+               isdigit(f[2]) && (f[3] == 'f')) {
+        chunk.format_kind = FMT_FIXED;
+        chunk.precision = f[2] - '0';
+    }
+}
+
+int FGGeneric::binary_chunk_size(e_type type)
+{
+    switch (type) {
+    case FG_BOOL:
+    case FG_BYTE:
+        return 1;
+    case FG_WORD:
+        return sizeof(int16_t);
+    case FG_DOUBLE:
+        return sizeof(int64_t);
+    case FG_STRING:
+        return sizeof(int32_t); // the length prefix
+    default:
+        return sizeof(int32_t);
+    }
+}
+
 void FGGeneric::updateValue(FGGeneric::_serial_prot& prot, bool val)
 {
   if( prot.rel )
@@ -61,9 +61,16 @@ protected:
 
     enum e_type { FG_BOOL=0, FG_INT, FG_FLOAT, FG_DOUBLE, FG_STRING, FG_FIXED, FG_BYTE, FG_WORD };
 
+    // how an ASCII chunk is formatted, decided once when the protocol is
+    // loaded: the common plain conversions have fast paths which avoid
+    // snprintf, anything else is passed to snprintf as before.
+    enum e_format { FMT_PRINTF=0, FMT_INT, FMT_FIXED, FMT_STRING };
+
     typedef struct {
      // string name;
-        string format;
+        string format;      // sanitized printf format
+        e_format format_kind;
+        int precision;      // for FMT_FIXED
         e_type type;
         double offset;
         double factor;
@@ -95,12 +102,21 @@ private:
     int binary_footer_value;
     int binary_record_length;
     enum {BYTE_ORDER_NEEDS_CONVERSION, BYTE_ORDER_MATCHES_NETWORK_ORDER} binary_byte_order;
+    // write FG_WORD and the FG_STRING length in host byte order, whatever
+    // binary_byte_order says
+    bool binary_words_host_order;
+
+    bool truncation_warned;
 
     bool gen_message_ascii();
     bool gen_message_binary();
     bool parse_message_ascii(int length);
     bool parse_message_binary(int length);
     bool read_config(SGPropertyNode *root, vector<_serial_prot> &msg);
+    static void compile_format(_serial_prot& chunk);
+    static int binary_chunk_size(e_type type);
+    int append_ascii_chunk(const _serial_prot& chunk, char* out, size_t available,
+                           bool& truncated) const;
     bool exitOnError;
     bool initOk;
 
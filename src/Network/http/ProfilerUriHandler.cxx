@@ -0,0 +1,53 @@
+// ProfilerUriHandler.cxx -- frame profiler statistics as JSON
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "ProfilerUriHandler.hxx"
+
+#include <sstream>
+
+#include <simgear/debug/logstream.hxx>
+#include <Main/FrameProfiler.hxx>
+
+namespace flightgear {
+namespace http {
+
+bool ProfilerUriHandler::handleRequest( const HTTPRequest & request, HTTPResponse & response, Connection * connection )
+{
+  response.Header["Content-Type"] = "application/json; charset=UTF-8";
+  response.Header["Access-Control-Allow-Origin"] = "*";
+  response.Header["Access-Control-Allow-Methods"] = "OPTIONS, GET";
+  response.Header["Access-Control-Allow-Headers"] = "Origin, Accept, Content-Type, X-Requested-With, X-CSRF-Token";
+
+  if( request.Method == "OPTIONS" ){
+      return true; // OPTIONS only needs the headers
+  }
+
+  if( request.Method != "GET" ){
+    SG_LOG(SG_NETWORK,SG_INFO, "ProfilerUriHandler: invalid request method '" << request.Method << "'" );
+    response.Header["Allow"] = "OPTIONS, GET";
+    response.StatusCode = 405;
+    response.Content = "{}";
+    return true;
+  }
+
+  std::ostringstream os;
+  FrameProfiler::writeJSON(os);
+  response.Content = os.str();
+  return true;
+}
+
+} // namespace http
+} // namespace flightgear
@@ -31,6 +31,7 @@
 #include "PkgUriHandler.hxx"
 #include "RunUriHandler.hxx"
 #include "NavdbUriHandler.hxx"
+#include "ProfilerUriHandler.hxx"
 #include "PropertyChangeObserver.hxx"
 #include <Main/fg_props.hxx>
 
@@ -478,6 +479,12 @@ void MongooseHttpd::init()
       SG_LOG(SG_NETWORK, SG_INFO, "httpd: adding navdb uri handler at " << uri);
       _uriHandler.push_back(new flightgear::http::NavdbUriHandler(uri));
     }
+
+    // not in older preferences, so on by default
+    if ((uri = n->getStringValue("profiler", "/profiler"))[0] != 0) {
+      SG_LOG(SG_NETWORK, SG_INFO, "httpd: adding profiler uri handler at " << uri);
+      _uriHandler.push_back(new flightgear::http::ProfilerUriHandler(uri));
+    }
   }
 
   _server = mg_create_server(this, MongooseHttpd::staticRequestHandler);
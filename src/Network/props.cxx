@@ -35,12 +35,16 @@
 #include <simgear/props/props.hxx>
 #include <simgear/props/props_io.hxx>
 #include <simgear/structure/exception.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <sstream>
 #include <iostream>
 #include <errno.h>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <unordered_map>
 
 #include <Main/globals.hxx>
 #include <Viewer/viewmgr.hxx>
@@ -64,6 +68,60 @@ using std::ends;
 using std::cout;
 using std::endl;
 
+namespace {
+
+// binary subscription frames are in network byte order
+void appendU8(std::string& out, uint8_t v)
+{
+    out.push_back(static_cast<char>(v));
+}
+
+void appendU32(std::string& out, uint32_t v)
+{
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((v >> shift) & 0xff));
+    }
+}
+
+void appendU64(std::string& out, uint64_t v)
+{
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((v >> shift) & 0xff));
+    }
+}
+
+void appendBytes(std::string& out, const std::string& bytes)
+{
+    appendU32(out, static_cast<uint32_t>(bytes.size()));
+    out.append(bytes);
+}
+
+void putU32(std::string& out, size_t pos, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) {
+        out[pos + i] = static_cast<char>((v >> (24 - 8 * i)) & 0xff);
+    }
+}
+
+// value types in binary frames
+enum BinaryValueType : uint8_t {
+    BINARY_NONE = 0,
+    BINARY_BOOL = 1,
+    BINARY_INT = 2,
+    BINARY_LONG = 3,
+    BINARY_FLOAT = 4,
+    BINARY_DOUBLE = 5,
+    BINARY_STRING = 6,
+    BINARY_DECLARE = 0xff ///< not a value: the path of a new subscription id
+};
+
+const char BINARY_FRAME_MAGIC[] = "FGPS";
+
+// larger pushes might not fit in the channel's output buffer
+const size_t SEND_CHUNK_SIZE = 1024;
+
+} // of anonymous namespace
+
 /**
  * Props connection class.
  * This class represents a connection to props client.
@@ -107,7 +165,30 @@ public:
     void valueChanged(SGPropertyNode *node) override;
 
     void publishDirtySubscriptions();
+
+    /**
+     * Queue data for the client. Everything goes through here, so replies
+     * can't overtake (or split) a partially sent subscription frame.
+     */
+    bool push(const char* s) { send(s); return true; }
 private:
+    enum PublishFormat {
+        PUBLISH_LINES,  ///< path=value per changed property
+        PUBLISH_BATCH,  ///< one frame of id=value lines per publish
+        PUBLISH_BINARY  ///< one binary frame per publish
+    };
+
+    static constexpr unsigned int NO_SUBSCRIPTION = ~0u;
+
+    struct Subscription {
+        SGPropertyNode_ptr node; ///< null once unsubscribed
+        std::string path;
+        bool listening = false;  ///< false for children of a subscribed node
+        bool declared = false;   ///< the client has been told our id
+        bool dirty = false;
+        unsigned int parent = NO_SUBSCRIPTION; ///< the subscription which found a child
+        std::vector<unsigned int> children;
+    };
 
     typedef string_list ParameterList;
 
@@ -129,8 +210,27 @@ private:
 	    return true;
     }
 
-    std::vector<SGPropertyNode_ptr> _listeners;
-    std::set<SGPropertyNode_ptr> _dirtySubscriptions;
+    unsigned int addSubscription(SGPropertyNode* node, bool listening);
+    unsigned int addChildSubscription(SGPropertyNode* node);
+    void removeSubscription(unsigned int id);
+    void appendLines(std::string& out);
+    void appendBatchFrame(std::string& out);
+    void appendBinaryFrame(std::string& out);
+    void send(const std::string& data);
+    void flushOutgoing();
+
+    // subscriptions, indexed by id
+    std::vector<Subscription> _subscriptions;
+    std::unordered_map<const SGPropertyNode*, unsigned int> _subscriptionIds;
+    std::vector<unsigned int> _dirtySubscriptions;
+
+    PublishFormat _publishFormat = PUBLISH_LINES;
+    double _publishInterval = 0.0; ///< zero to publish on each process()
+    SGTimeStamp _lastPublish;
+    uint32_t _frameSequence = 0;
+
+    // data which didn't fit in the output buffer yet
+    std::string _outgoing;
 
     typedef void (PropsChannel::*TelnetCallback) (const ParameterList&);
     std::map<std::string, TelnetCallback> callback_map;
@@ -138,6 +238,7 @@ private:
     // callback implementations:
     void subscribe(const ParameterList &p);
     void unsubscribe(const ParameterList &p);
+    void subscribeMode(const ParameterList &p);
     void beginNasal(const ParameterList &p);
 
     FGProps* _owner = nullptr;
@@ -154,14 +255,17 @@ FGProps::PropsChannel::PropsChannel(FGProps* owner)
     setTerminator( "\r\n" );
     callback_map["subscribe"] 	= 	&PropsChannel::subscribe;
     callback_map["unsubscribe"]	=	&PropsChannel::unsubscribe;
+    callback_map["subscribe-mode"] = &PropsChannel::subscribeMode;
     callback_map["nasal"] =         &PropsChannel::beginNasal;
 }
 
 FGProps::PropsChannel::~PropsChannel()
 {
   // clean up all registered listeners
-    for (SGPropertyNode_ptr l : _listeners) {
-        l->removeChangeListener(this);
+    for (auto& sub : _subscriptions) {
+        if (sub.listening) {
+            sub.node->removeChangeListener(this);
+        }
     }
 
     _owner->removeChannel(this);
@@ -170,43 +274,137 @@ FGProps::PropsChannel::~PropsChannel()
 void FGProps::PropsChannel::subscribe(const ParameterList &param) {
 	if (! check_args(param,1,"subscribe")) return;
 
-	std::string command = param[0];
-	const char* p = param[1].c_str();
-	if (!p) return;
+	// any number of paths; the listeners mark the subscriptions dirty, and
+	// publishDirtySubscriptions() sends the changed values in one go
+	for (unsigned int i = 1; i < param.size(); ++i) {
+		const std::string& p = param[i];
+
+		SGPropertyNode *n = globals->get_props()->getNode( p,true );
+		if ( n->isTied() ) {
+			error("Error:Tied properties cannot register listeners");
+			continue;
+		}
+
+		const unsigned int id = addSubscription(n, true);
+		Subscription& sub = _subscriptions[id];
+
+		std::string reply = param[0] + " " + p;
+		if (_publishFormat != PUBLISH_LINES) {
+			// clients refer to subscriptions by id, and get the current
+			// value in the next frame
+			reply += " " + std::to_string(id);
+			sub.declared = true;
+			if (!sub.dirty) {
+				sub.dirty = true;
+				_dirtySubscriptions.push_back(id);
+			}
+		}
+
+		reply += getTerminator();
+		send(reply);
+	}
+}
 
-  //SG_LOG(SG_GENERAL, SG_ALERT, p << std::endl);
-  push( command.c_str() ); push ( " " );
-  push( p );
-  push( getTerminator() );
+unsigned int FGProps::PropsChannel::addSubscription(SGPropertyNode* node, bool listening)
+{
+	auto it = _subscriptionIds.find(node);
+	if (it == _subscriptionIds.end()) {
+		const unsigned int id = static_cast<unsigned int>(_subscriptions.size());
+		Subscription sub;
+		sub.node = node;
+		sub.path = node->getPath(true);
+		_subscriptions.push_back(sub);
+		it = _subscriptionIds.emplace(node, id).first;
+	}
 
-  SGPropertyNode *n = globals->get_props()->getNode( p,true );
-	if ( n->isTied() ) {
-		error("Error:Tied properties cannot register listeners");
-		return;
+	Subscription& sub = _subscriptions[it->second];
+	if (listening && !sub.listening) {
+		node->addChangeListener( this );
+		sub.listening = true;
 	}
 
- 	if (n) {
-    n->addChangeListener( this );
-	 _listeners.push_back( n ); // housekeeping, save for deletion in dtor later on
-  } else {
-		 error("listener could not be added");
-  }
+	return it->second;
 }
 
 void FGProps::PropsChannel::unsubscribe(const ParameterList &param) {
   if (!check_args(param,1,"unsubscribe")) return;
 
   try {
-   SGPropertyNode *n = globals->get_props()->getNode( param[1].c_str() );
-   if (n) {
-       n->removeChangeListener( this );
-       _dirtySubscriptions.erase(n);
+   for (unsigned int i = 1; i < param.size(); ++i) {
+     SGPropertyNode *n = globals->get_props()->getNode( param[i].c_str() );
+     auto it = n ? _subscriptionIds.find(n) : _subscriptionIds.end();
+     if (it != _subscriptionIds.end()) {
+       removeSubscription(it->second);
+     }
    }
   } catch (sg_exception&) {
 	  error("Error:Listener could not be removed");
   }
 }
 
+// drop a subscription, and the children its listener found which were
+// not subscribed in their own right
+void FGProps::PropsChannel::removeSubscription(unsigned int id)
+{
+	std::vector<unsigned int> children;
+	{
+		// keep the slot, so ids stay valid; a pending dirty entry is
+		// skipped when publishing
+		Subscription& sub = _subscriptions[id];
+		if (sub.listening) {
+			sub.node->removeChangeListener( this );
+		}
+
+		_subscriptionIds.erase(sub.node.get());
+		children.swap(sub.children);
+		sub = Subscription();
+	}
+
+	for (auto c : children) {
+		Subscription& child = _subscriptions[c];
+		if (!child.node || (child.parent != id)) {
+			continue; // already gone
+		}
+
+		if (child.listening) {
+			child.parent = NO_SUBSCRIPTION;
+		} else {
+			removeSubscription(c);
+		}
+	}
+}
+
+void FGProps::PropsChannel::subscribeMode(const ParameterList &param)
+{
+    if (!check_args(param, 1, "subscribe-mode")) return;
+
+    if (param[1] == "lines") {
+        _publishFormat = PUBLISH_LINES;
+    } else if (param[1] == "batch") {
+        _publishFormat = PUBLISH_BATCH;
+    } else if (param[1] == "binary") {
+        _publishFormat = PUBLISH_BINARY;
+    } else {
+        error("Error:Unknown subscription format:" + param[1]);
+        return;
+    }
+
+    double hz = 0.0;
+    if (param.size() > 2) {
+        hz = std::max(0.0, atof(param[2].c_str()));
+    }
+    _publishInterval = (hz > 0.0) ? (1.0 / hz) : 0.0;
+
+    // existing subscriptions are declared (again) in the next frame
+    for (auto& sub : _subscriptions) {
+        sub.declared = false;
+    }
+
+    std::ostringstream reply;
+    reply << param[0] << " " << param[1] << " " << hz << getTerminator();
+    send(reply.str());
+}
+
 void FGProps::PropsChannel::beginNasal(const ParameterList &param)
 {
     std::string eofMarker = "##EOF##";
@@ -223,21 +421,225 @@ void FGProps::PropsChannel::beginNasal(const ParameterList &param)
 //TODO: provide support for different types of subscriptions MODES ? (child added/removed, thesholds, min/max)
   void FGProps::PropsChannel::valueChanged(SGPropertyNode* ptr)
   {
-      _dirtySubscriptions.insert(ptr);
+      auto it = _subscriptionIds.find(ptr);
+      const unsigned int id = (it != _subscriptionIds.end()) ? it->second
+                                                             : addChildSubscription(ptr);
+      if (id == NO_SUBSCRIPTION)
+          return;
+
+      Subscription& sub = _subscriptions[id];
+      if (!sub.dirty) {
+          sub.dirty = true;
+          _dirtySubscriptions.push_back(id);
+      }
+  }
+
+  // listeners on a subscribed node also see changes of its descendants,
+  // which get an id of their own, owned by the nearest subscribed ancestor
+  unsigned int FGProps::PropsChannel::addChildSubscription(SGPropertyNode* node)
+  {
+      for (SGPropertyNode* p = node->getParent(); p; p = p->getParent()) {
+          auto it = _subscriptionIds.find(p);
+          if ((it == _subscriptionIds.end()) || !_subscriptions[it->second].listening)
+              continue;
+
+          const unsigned int parent = it->second;
+          const unsigned int id = addSubscription(node, false);
+          _subscriptions[id].parent = parent;
+          _subscriptions[parent].children.push_back(id);
+          return id;
+      }
+
+      return NO_SUBSCRIPTION; // a late notification for something we dropped
   }
 
   void FGProps::PropsChannel::publishDirtySubscriptions()
   {
+      flushOutgoing();
+
       if (_dirtySubscriptions.empty())
           return; // nothing to send
 
-      std::stringstream response;
-      for (auto sub : _dirtySubscriptions) {
-          response << sub->getPath(true) << "=" <<  sub->getStringValue() << getTerminator();
+      // everything changed was unsubscribed meanwhile: no empty frame
+      const bool anyLeft = std::any_of(_dirtySubscriptions.begin(), _dirtySubscriptions.end(),
+                                       [this](unsigned int id) { return _subscriptions[id].node.valid(); });
+      if (!anyLeft) {
+          for (auto id : _dirtySubscriptions) {
+              _subscriptions[id].dirty = false;
+          }
+          _dirtySubscriptions.clear();
+          return;
+      }
+
+      // a slow client gets fewer, not longer, updates: values keep
+      // collecting in the dirty list meanwhile
+      if (!_outgoing.empty())
+          return;
+
+      if (_publishInterval > 0.0) {
+          if (_lastPublish.elapsedMSec() < _publishInterval * 1000.0)
+              return;
+          _lastPublish.stamp();
       }
 
-      push(response.str().c_str());
+      std::string response;
+      switch (_publishFormat) {
+      case PUBLISH_LINES:  appendLines(response); break;
+      case PUBLISH_BATCH:  appendBatchFrame(response); break;
+      case PUBLISH_BINARY: appendBinaryFrame(response); break;
+      }
+
+      for (auto id : _dirtySubscriptions) {
+          _subscriptions[id].dirty = false;
+      }
       _dirtySubscriptions.clear();
+
+      send(response);
+  }
+
+  void FGProps::PropsChannel::appendLines(std::string& out)
+  {
+      for (auto id : _dirtySubscriptions) {
+          const Subscription& sub = _subscriptions[id];
+          if (!sub.node) {
+              continue;
+          }
+
+          out += sub.path;
+          out += "=";
+          out += sub.node->getStringValue();
+          out += getTerminator();
+      }
+  }
+
+  // frame <sequence> <count>
+  // <id>=<value>
+  // ...
+  // preceded by 'subscribe <path> <id>' lines for ids the client
+  // doesn't know yet
+  void FGProps::PropsChannel::appendBatchFrame(std::string& out)
+  {
+      std::string body;
+      unsigned int count = 0;
+      for (auto id : _dirtySubscriptions) {
+          Subscription& sub = _subscriptions[id];
+          if (!sub.node) {
+              continue;
+          }
+
+          if (!sub.declared) {
+              out += "subscribe " + sub.path + " " + std::to_string(id) + getTerminator();
+              sub.declared = true;
+          }
+
+          std::string value = sub.node->getStringValue();
+          value = simgear::strutils::replace(value, "\r", "\\r");
+          value = simgear::strutils::replace(value, "\n", "\\n");
+
+          body += std::to_string(id);
+          body += "=";
+          body += value;
+          body += getTerminator();
+          ++count;
+      }
+
+      out += "frame " + std::to_string(_frameSequence++) + " " + std::to_string(count) + getTerminator();
+      out += body;
+  }
+
+  // 'FGPS', uint32 length of the remainder, uint32 sequence, uint32 count,
+  // then count entries of uint32 id, uint8 type and the value. Strings
+  // are a uint32 length and the bytes. Integers and IEEE floats are
+  // big-endian.
+  void FGProps::PropsChannel::appendBinaryFrame(std::string& out)
+  {
+      using namespace simgear;
+
+      const size_t start = out.size();
+      out.append(BINARY_FRAME_MAGIC, 4);
+      appendU32(out, 0); // length, filled in below
+      appendU32(out, _frameSequence++);
+      appendU32(out, 0); // count, filled in below
+
+      uint32_t count = 0;
+      for (auto id : _dirtySubscriptions) {
+          Subscription& sub = _subscriptions[id];
+          if (!sub.node) {
+              continue;
+          }
+
+          if (!sub.declared) {
+              appendU32(out, id);
+              appendU8(out, BINARY_DECLARE);
+              appendBytes(out, sub.path);
+              sub.declared = true;
+              ++count;
+          }
+
+          const SGPropertyNode* node = sub.node;
+          appendU32(out, id);
+          switch (node->getType()) {
+          case props::NONE:
+              appendU8(out, BINARY_NONE);
+              break;
+          case props::BOOL:
+              appendU8(out, BINARY_BOOL);
+              appendU8(out, node->getBoolValue() ? 1 : 0);
+              break;
+          case props::INT:
+              appendU8(out, BINARY_INT);
+              appendU32(out, static_cast<uint32_t>(node->getIntValue()));
+              break;
+          case props::LONG:
+              appendU8(out, BINARY_LONG);
+              appendU64(out, static_cast<uint64_t>(node->getLongValue()));
+              break;
+          case props::FLOAT: {
+              const float f = node->getFloatValue();
+              uint32_t bits;
+              memcpy(&bits, &f, sizeof(bits));
+              appendU8(out, BINARY_FLOAT);
+              appendU32(out, bits);
+              break;
+          }
+          case props::DOUBLE: {
+              const double d = node->getDoubleValue();
+              uint64_t bits;
+              memcpy(&bits, &d, sizeof(bits));
+              appendU8(out, BINARY_DOUBLE);
+              appendU64(out, bits);
+              break;
+          }
+          default:
+              appendU8(out, BINARY_STRING);
+              appendBytes(out, node->getStringValue());
+              break;
+          }
+          ++count;
+      }
+
+      putU32(out, start + 4, static_cast<uint32_t>(out.size() - start - 8));
+      putU32(out, start + 12, count);
+  }
+
+  void FGProps::PropsChannel::send(const std::string& data)
+  {
+      _outgoing += data;
+      flushOutgoing();
+  }
+
+  void FGProps::PropsChannel::flushOutgoing()
+  {
+      size_t sent = 0;
+      while (sent < _outgoing.size()) {
+          const size_t n = std::min(SEND_CHUNK_SIZE, _outgoing.size() - sent);
+          if (!bufferSend(_outgoing.data() + sent, static_cast<int>(n))) {
+              break; // output buffer is full, retry next time
+          }
+          sent += n;
+      }
+
+      _outgoing.erase(0, sent);
   }
 
 /**
@@ -675,8 +1077,9 @@ setd <var> <val>   set Double <var> to a new <val>\r\n\
 setf <var> <val>   alias for setd\r\n\
 seti <var> <val>   set Int <var> to a new <val>\r\n\
 del <var> <nod>    delete <nod> in <var>\r\n\
-subscribe <var>	   subscribe to property changes \r\n\
-unsubscribe <var>  unscubscribe from property changes (var must be the property name/path used by subscribe)\r\n\
+subscribe <var> [<var> ...]  subscribe to property changes \r\n\
+unsubscribe <var> [<var> ...]  unscubscribe from property changes (var must be the property name/path used by subscribe)\r\n\
+subscribe-mode <lines|batch|binary> [<hz>]  how and how often changes are sent\r\n\
 nasal [EOF <marker>]  execute arbitrary Nasal code (simulator must be running with Nasal allowed from sockets)\r\n\
 ";
                 push( msg );
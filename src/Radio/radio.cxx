@@ -23,14 +23,52 @@
 #include <cmath>
 
 #include <stdlib.h>
+#include <algorithm>
+#include <array>
 #include <deque>
+#include <map>
+#include <mutex>
 #include "radio.hxx"
 #include <simgear/scene/material/mat.hxx>
+#include <simgear/timing/timestamp.hxx>
 #include <Scenery/scenery.hxx>
 
 #define WITH_POINT_TO_POINT 1
 #include "itm.cpp"
 
+namespace {
+
+/// interned terrain material names and their clutter properties
+struct MaterialTable
+{
+	std::mutex lock;
+	std::map<string, RadioMaterialId> ids;
+	std::vector<std::pair<double, double> > properties;	/// clutter height, density
+};
+
+/// quantised receiver lat/lon, transmitter lat/lon and sampling distance
+typedef std::array<long, 5> ProfileKey;
+
+/// terrain profiles are only used from the main thread, like the scenery
+struct ProfileCache
+{
+	struct Entry
+	{
+		FGRadioTerrainProfile profile;
+		SGTimeStamp sampled;
+	};
+	
+	std::map<ProfileKey, Entry> entries;
+	std::deque<ProfileKey> order;	/// insertion order, for eviction
+	unsigned int hits = 0;
+	unsigned int misses = 0;
+};
+
+MaterialTable s_materials;
+ProfileCache s_profiles;
+
+} // of anonymous namespace
+
 
 FGRadioTransmission::FGRadioTransmission() {
 	
@@ -239,8 +277,6 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	double tx_erp = dbm_to_watt(tx_pow + _tx_antenna_gain - _tx_line_losses);
 	
 
-	FGScenery * scenery = globals->get_scenery();
-	
 	double own_lat = fgGetDouble("/position/latitude-deg");
 	double own_lon = fgGetDouble("/position/longitude-deg");
 	double own_alt_ft = fgGetDouble("/position/altitude-ft");
@@ -251,8 +287,6 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	
 	
 	SGGeod own_pos = SGGeod::fromDegM( own_lon, own_lat, own_alt );
-	SGGeod max_own_pos = SGGeod::fromDegM( own_lon, own_lat, SG_MAX_ELEVATION_M );
-	SGGeoc center = SGGeoc::fromGeod( max_own_pos );
 	SGGeoc own_pos_c = SGGeoc::fromGeod( own_pos );
 	
 	
@@ -263,7 +297,6 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	
 	sender_alt_ft = sender_pos.getElevationFt();
 	sender_alt = sender_alt_ft * SG_FEET_TO_METER;
-	SGGeod max_sender_pos = SGGeod::fromGeodM( pos, SG_MAX_ELEVATION_M );
 	SGGeoc sender_pos_c = SGGeoc::fromGeod( sender_pos );
 	
 	
@@ -271,7 +304,6 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	double course = SGGeodesy::courseRad(own_pos_c, sender_pos_c);
 	double reverse_course = SGGeodesy::courseRad(sender_pos_c, own_pos_c);
 	double distance_m = SGGeodesy::distanceM(own_pos, sender_pos);
-	double probe_distance = 0.0;
 	/** If distance larger than this value (300 km), assume reception imposssible to spare CPU cycles */
 	if (distance_m > 300000)
 		return -1.0;
@@ -286,26 +318,14 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	}
 	
 		
-	int max_points = (int)floor(distance_m / point_distance);
-	//double delta_last = fmod(distance_m, point_distance);
-	
-	deque<double> elevations;
-	deque<string*> materials;
-	
+	const FGRadioTerrainProfile &profile = get_terrain_profile(own_pos, sender_pos, point_distance);
+	const double elevation_under_pilot = profile.elevations.front();
+	const double elevation_under_sender = profile.elevations.back();
 
-	double elevation_under_pilot = 0.0;
-	if (scenery->get_elevation_m( max_own_pos, elevation_under_pilot, NULL )) {
-		receiver_height = own_alt - elevation_under_pilot; 
-	}
-
-	double elevation_under_sender = 0.0;
-	if (scenery->get_elevation_m( max_sender_pos, elevation_under_sender, NULL )) {
-		transmitter_height = sender_alt - elevation_under_sender;
-	}
-	else {
-		transmitter_height = sender_alt;
+	if (profile.pilot_elevation_valid) {
+		receiver_height = own_alt - elevation_under_pilot;
 	}
-	
+	transmitter_height = sender_alt - elevation_under_sender;
 	
 	transmitter_height += _tx_antenna_height;
 	receiver_height += _rx_antenna_height;
@@ -315,78 +335,20 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	_root_node->setDoubleValue("station[0]/tx-height", transmitter_height);
 	_root_node->setDoubleValue("station[0]/distance", distance_m / 1000);
 	
-	unsigned int e_size = (deque<unsigned>::size_type)max_points;
-	
-	while (elevations.size() <= e_size) {
-		probe_distance += point_distance;
-		SGGeod probe = SGGeod::fromGeoc(center.advanceRadM( course, probe_distance ));
-		const simgear::BVHMaterial *material = 0;
-		double elevation_m = 0.0;
-	
-		if (scenery->get_elevation_m( probe, elevation_m, &material )) {
-                        const SGMaterial *mat;
-                        mat = dynamic_cast<const SGMaterial*>(material);
-			if((transmission_type == 3) || (transmission_type == 4)) {
-				elevations.push_back(elevation_m);
-				if(mat) {
-					const std::vector<string> mat_names = mat->get_names();
-					string* name = new string(mat_names[0]);
-					materials.push_back(name);
-				}
-				else {
-					string* no_material = new string("None"); 
-					materials.push_back(no_material);
-				}
-			}
-			else {
-				 elevations.push_front(elevation_m);
-				 if(mat) {
-				 	 const std::vector<string> mat_names = mat->get_names();
-				 	 string* name = new string(mat_names[0]);
-				 	 materials.push_front(name);
-				}
-				else {
-					string* no_material = new string("None"); 
-					materials.push_front(no_material);
-				}
-			}
-		}
-		else {
-			if((transmission_type == 3) || (transmission_type == 4)) {
-				elevations.push_back(0.0);
-				string* no_material = new string("None"); 
-				materials.push_back(no_material);
-			}
-			else {
-				string* no_material = new string("None"); 
-				elevations.push_front(0.0);
-				materials.push_front(no_material);
-			}
-		}
-	}
-	if((transmission_type == 3) || (transmission_type == 4)) {
-		elevations.push_front(elevation_under_pilot);
-		//if (delta_last > (point_distance / 2) )			// only add last point if it's farther than half point_distance
-			elevations.push_back(elevation_under_sender);
+	// ITM expects the number of intervals and the sampling distance ahead of
+	// the elevations, ordered from the transmitter to the receiver
+	const bool pilot_transmits = (transmission_type == 3) || (transmission_type == 4);
+	const size_t num_points = profile.elevations.size();
+	std::vector<double> itm_elev(num_points + 2);
+	itm_elev[0] = (double)num_points - 1;
+	itm_elev[1] = point_distance;
+	std::vector<RadioMaterialId> materials(profile.materials);
+	if (pilot_transmits) {
+		std::copy(profile.elevations.begin(), profile.elevations.end(), itm_elev.begin() + 2);
 	}
 	else {
-		elevations.push_back(elevation_under_pilot);
-		//if (delta_last > (point_distance / 2) )
-			elevations.push_front(elevation_under_sender);
-	}
-	
-	
-	double num_points= (double)elevations.size();
-
-
-	elevations.push_front(point_distance);
-	elevations.push_front(num_points -1);
-
-	int size = elevations.size();
-    std::vector<double> itm_elev(size);
-
-	for(int i=0;i<size;i++) {
-		itm_elev[i]=elevations[i];
+		std::copy(profile.elevations.rbegin(), profile.elevations.rend(), itm_elev.begin() + 2);
+		std::reverse(materials.begin(), materials.end());
 	}
 	
 	if((transmission_type == 3) || (transmission_type == 4)) {
@@ -457,16 +419,12 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	//_root_node->setDoubleValue("station[0]/tx-pattern-gain", tx_pattern_gain);
 	//_root_node->setDoubleValue("station[0]/rx-pattern-gain", rx_pattern_gain);
 
-	for (unsigned i =0; i < materials.size(); i++) {
-		delete materials[i];
-	}
-	
 	return signal;
 
 }
 
 
-void FGRadioTransmission::calculate_clutter_loss(double freq, double itm_elev[], deque<string*> &materials,
+void FGRadioTransmission::calculate_clutter_loss(double freq, double itm_elev[], const std::vector<RadioMaterialId> &materials,
 	double transmitter_height, double receiver_height, int p_mode,
 	double horizons[], double &clutter_loss) {
 	
@@ -804,110 +762,107 @@ void FGRadioTransmission::calculate_clutter_loss(double freq, double itm_elev[],
 }
 
 
-void FGRadioTransmission::get_material_properties(string* mat_name, double &height, double &density) {
-	
-	if(!mat_name)
-		return;
+static void lookup_material_properties(const string &mat_name, double &height, double &density) {
 	
-	if(*mat_name == "Landmass") {
+	if(mat_name == "Landmass") {
 		height = 15.0;
 		density = 0.2;
 	}
 
-	else if(*mat_name == "SomeSort") {
+	else if(mat_name == "SomeSort") {
 		height = 15.0;
 		density = 0.2;
 	}
 
-	else if(*mat_name == "Island") {
+	else if(mat_name == "Island") {
 		height = 15.0;
 		density = 0.2;
 	}
-	else if(*mat_name == "Default") {
+	else if(mat_name == "Default") {
 		height = 15.0;
 		density = 0.2;
 	}
-	else if(*mat_name == "EvergreenBroadCover") {
+	else if(mat_name == "EvergreenBroadCover") {
 		height = 20.0;
 		density = 0.2;
 	}
-	else if(*mat_name == "EvergreenForest") {
+	else if(mat_name == "EvergreenForest") {
 		height = 20.0;
 		density = 0.2;
 	}
-	else if(*mat_name == "DeciduousBroadCover") {
+	else if(mat_name == "DeciduousBroadCover") {
 		height = 15.0;
 		density = 0.3;
 	}
-	else if(*mat_name == "DeciduousForest") {
+	else if(mat_name == "DeciduousForest") {
 		height = 15.0;
 		density = 0.3;
 	}
-	else if(*mat_name == "MixedForestCover") {
+	else if(mat_name == "MixedForestCover") {
 		height = 20.0;
 		density = 0.25;
 	}
-	else if(*mat_name == "MixedForest") {
+	else if(mat_name == "MixedForest") {
 		height = 15.0;
 		density = 0.25;
 	}
-	else if(*mat_name == "RainForest") {
+	else if(mat_name == "RainForest") {
 		height = 25.0;
 		density = 0.55;
 	}
-	else if(*mat_name == "EvergreenNeedleCover") {
+	else if(mat_name == "EvergreenNeedleCover") {
 		height = 15.0;
 		density = 0.2;
 	}
-	else if(*mat_name == "WoodedTundraCover") {
+	else if(mat_name == "WoodedTundraCover") {
 		height = 5.0;
 		density = 0.15;
 	}
-	else if(*mat_name == "DeciduousNeedleCover") {
+	else if(mat_name == "DeciduousNeedleCover") {
 		height = 5.0;
 		density = 0.2;
 	}
-	else if(*mat_name == "ScrubCover") {
+	else if(mat_name == "ScrubCover") {
 		height = 3.0;
 		density = 0.15;
 	}
-	else if(*mat_name == "BuiltUpCover") {
+	else if(mat_name == "BuiltUpCover") {
 		height = 30.0;
 		density = 0.7;
 	}
-	else if(*mat_name == "Urban") {
+	else if(mat_name == "Urban") {
 		height = 30.0;
 		density = 0.7;
 	}
-	else if(*mat_name == "Construction") {
+	else if(mat_name == "Construction") {
 		height = 30.0;
 		density = 0.7;
 	}
-	else if(*mat_name == "Industrial") {
+	else if(mat_name == "Industrial") {
 		height = 30.0;
 		density = 0.7;
 	}
-	else if(*mat_name == "Port") {
+	else if(mat_name == "Port") {
 		height = 30.0;
 		density = 0.7;
 	}
-	else if(*mat_name == "Town") {
+	else if(mat_name == "Town") {
 		height = 10.0;
 		density = 0.5;
 	}
-	else if(*mat_name == "SubUrban") {
+	else if(mat_name == "SubUrban") {
 		height = 10.0;
 		density = 0.5;
 	}
-	else if(*mat_name == "CropWoodCover") {
+	else if(mat_name == "CropWoodCover") {
 		height = 10.0;
 		density = 0.1;
 	}
-	else if(*mat_name == "CropWood") {
+	else if(mat_name == "CropWood") {
 		height = 10.0;
 		density = 0.1;
 	}
-	else if(*mat_name == "AgroForest") {
+	else if(mat_name == "AgroForest") {
 		height = 10.0;
 		density = 0.1;
 	}
@@ -919,6 +874,135 @@ void FGRadioTransmission::get_material_properties(string* mat_name, double &heig
 }
 
 
+void FGRadioTransmission::get_material_properties(RadioMaterialId mat_id, double &height, double &density) {
+	
+	std::lock_guard<std::mutex> g(s_materials.lock);
+	if (mat_id >= s_materials.properties.size()) {
+		height = 0.0;
+		density = 0.0;
+		return;
+	}
+	height = s_materials.properties[mat_id].first;
+	density = s_materials.properties[mat_id].second;
+}
+
+
+RadioMaterialId FGRadioTransmission::intern_material(const string &name) {
+	
+	std::lock_guard<std::mutex> g(s_materials.lock);
+	auto it = s_materials.ids.find(name);
+	if (it != s_materials.ids.end())
+		return it->second;
+	
+	// resolve the clutter properties once per material instead of once per probe point
+	double height = 0.0, density = 0.0;
+	lookup_material_properties(name, height, density);
+	RadioMaterialId id = s_materials.properties.size();
+	s_materials.properties.push_back(std::make_pair(height, density));
+	s_materials.ids[name] = id;
+	return id;
+}
+
+
+const FGRadioTerrainProfile& FGRadioTransmission::get_terrain_profile(const SGGeod &own_pos,
+		const SGGeod &sender_pos, double point_distance) {
+	
+	// endpoints which moved less than about one sampling interval share a profile
+	const double quantum_deg = point_distance / (SG_NM_TO_METER * 60.0);
+	ProfileKey key{ {
+		(long)floor(own_pos.getLatitudeDeg() / quantum_deg),
+		(long)floor(own_pos.getLongitudeDeg() / quantum_deg),
+		(long)floor(sender_pos.getLatitudeDeg() / quantum_deg),
+		(long)floor(sender_pos.getLongitudeDeg() / quantum_deg),
+		(long)floor(point_distance) } };
+	
+	// profiles sampled before the scenery along the path was loaded are
+	// only kept for a short while
+	auto it = s_profiles.entries.find(key);
+	if (it != s_profiles.entries.end()) {
+		if (it->second.profile.complete || (it->second.sampled.elapsedMSec() < 10000)) {
+			++s_profiles.hits;
+			return it->second.profile;
+		}
+		s_profiles.entries.erase(it);
+		s_profiles.order.erase(std::find(s_profiles.order.begin(), s_profiles.order.end(), key));
+	}
+	++s_profiles.misses;
+	
+	FGScenery * scenery = globals->get_scenery();
+	FGRadioTerrainProfile profile;
+	
+	SGGeod max_own_pos = SGGeod::fromGeodM( own_pos, SG_MAX_ELEVATION_M );
+	SGGeod max_sender_pos = SGGeod::fromGeodM( sender_pos, SG_MAX_ELEVATION_M );
+	SGGeoc center = SGGeoc::fromGeod( max_own_pos );
+	double course = SGGeodesy::courseRad(SGGeoc::fromGeod(own_pos), SGGeoc::fromGeod(sender_pos));
+	double distance_m = SGGeodesy::distanceM(own_pos, sender_pos);
+	unsigned int num_probes = (unsigned int)floor(distance_m / point_distance) + 1;
+	
+	double elevation_under_pilot = 0.0;
+	if (!scenery->get_elevation_m( max_own_pos, elevation_under_pilot, NULL )) {
+		profile.pilot_elevation_valid = false;
+		profile.complete = false;
+	}
+	double elevation_under_sender = 0.0;
+	if (!scenery->get_elevation_m( max_sender_pos, elevation_under_sender, NULL )) {
+		profile.complete = false;
+	}
+	
+	const RadioMaterialId no_material = intern_material("None");
+	profile.elevations.reserve(num_probes + 2);
+	profile.materials.reserve(num_probes);
+	profile.elevations.push_back(elevation_under_pilot);
+	
+	for (unsigned int i = 1; i <= num_probes; ++i) {
+		SGGeod probe = SGGeod::fromGeoc(center.advanceRadM( course, i * point_distance ));
+		const simgear::BVHMaterial *material = 0;
+		double elevation_m = 0.0;
+		
+		if (scenery->get_elevation_m( probe, elevation_m, &material )) {
+			const SGMaterial *mat = dynamic_cast<const SGMaterial*>(material);
+			profile.elevations.push_back(elevation_m);
+			profile.materials.push_back(mat ? intern_material(mat->get_names()[0]) : no_material);
+		}
+		else {
+			profile.elevations.push_back(0.0);
+			profile.materials.push_back(no_material);
+			profile.complete = false;
+		}
+	}
+	profile.elevations.push_back(elevation_under_sender);
+	
+	const size_t max_entries = (size_t)SGMisci::max(1, fgGetInt("/sim/radio/profile-cache-size", 256));
+	while (s_profiles.entries.size() >= max_entries) {
+		s_profiles.entries.erase(s_profiles.order.front());
+		s_profiles.order.pop_front();
+	}
+	s_profiles.order.push_back(key);
+	ProfileCache::Entry &entry = s_profiles.entries[key];
+	entry.profile = std::move(profile);
+	entry.sampled.stamp();
+	return entry.profile;
+}
+
+
+void FGRadioTransmission::clearTerrainProfileCache() {
+	s_profiles.entries.clear();
+	s_profiles.order.clear();
+	s_profiles.hits = 0;
+	s_profiles.misses = 0;
+}
+
+
+unsigned int FGRadioTransmission::terrainProfileCacheHits() {
+	return s_profiles.hits;
+}
+
+
+unsigned int FGRadioTransmission::terrainProfileCacheMisses() {
+	return s_profiles.misses;
+}
+
+
 double FGRadioTransmission::LOS_calculate_attenuation(SGGeod pos, double freq, int transmission_type) {
 	
 	double frq_mhz = freq;
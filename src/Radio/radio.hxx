@@ -24,6 +24,7 @@
 #include <simgear/compiler.h>
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <deque>
+#include <vector>
 #include <Main/fg_props.hxx>
 
 #include <simgear/math/sg_geodesy.hxx>
@@ -32,6 +33,22 @@
 
 using std::string;
 
+/// interned terrain material name, see FGRadioTransmission::intern_material()
+typedef unsigned int RadioMaterialId;
+
+/*** Terrain profile between receiver and transmitter as sampled for ITM.
+*	Profiles are cached by quantised endpoint positions and shared between
+*	transmissions, so repeated ATC and chat messages on the same path
+*	don't probe the scenery again.
+***/
+struct FGRadioTerrainProfile
+{
+	std::vector<double> elevations;	/// from receiver to transmitter, both ends included
+	std::vector<RadioMaterialId> materials;	/// probe points only, same order
+	bool pilot_elevation_valid = true;
+	bool complete = true;	/// false if any probe missed loaded scenery
+};
+
 
 class FGRadioTransmission 
 {
@@ -74,15 +91,23 @@ private:
 *	@param: frequency, elevation data, terrain type, horizon distances, calculated loss
 *	@return: none
 ***/
-	void calculate_clutter_loss(double freq, double itm_elev[], std::deque<string*> &materials,
+	void calculate_clutter_loss(double freq, double itm_elev[], const std::vector<RadioMaterialId> &materials,
 			double transmitter_height, double receiver_height, int p_mode,
 			double horizons[], double &clutter_loss);
 	
 /*** 	Temporary material properties database
-*		@param: terrain type, median clutter height, radiowave attenuation factor
+*		@param: interned terrain type, median clutter height, radiowave attenuation factor
 *		@return: none
 ***/
-	void get_material_properties(string* mat_name, double &height, double &density);
+	void get_material_properties(RadioMaterialId mat_id, double &height, double &density);
+
+/*** Return the terrain profile between the receiver and transmitter, either
+*	from the profile cache or by probing the scenery in one batch
+*	@param: receiver position, transmitter position, sampling distance
+*	@return: the profile
+***/
+	const FGRadioTerrainProfile& get_terrain_profile(const SGGeod &own_pos, const SGGeod &sender_pos,
+			double point_distance);
 	
 	
 public:
@@ -110,6 +135,14 @@ public:
     static double watt_to_dbm(double power_watt);
     static double dbm_to_watt(double dbm);
     static double dbm_to_microvolt(double dbm);
+
+    /// terrain material names are interned, profiles only store the id
+    static RadioMaterialId intern_material(const string &name);
+
+    /// terrain profile cache statistics and control, mostly for testing
+    static void clearTerrainProfileCache();
+    static unsigned int terrainProfileCacheHits();
+    static unsigned int terrainProfileCacheMisses();
     
     
 /*** Receive ATC radio communication as text
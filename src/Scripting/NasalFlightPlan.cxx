@@ -1928,8 +1928,7 @@ static naRef f_leg_courseAndDistanceFrom(naContext c, naRef me, int argc, naRef*
     SGGeod pos;
     geodFromArgs(args, 0, argc, pos);
 
-    RoutePath path(leg->owner());
-    SGGeod    wpPos = path.positionForIndex(leg->index());
+    SGGeod    wpPos = leg->owner()->routePath().positionForIndex(leg->index());
     double    courseDeg, az2, distanceM;
     SGGeodesy::inverse(pos, wpPos, courseDeg, az2, distanceM);
 
@@ -1946,8 +1945,7 @@ static naRef f_leg_path(naContext c, naRef me, int argc, naRef* args)
         naRuntimeError(c, "leg.setAltitude called on non-flightplan-leg object");
     }
 
-    RoutePath path(leg->owner());
-    SGGeodVec gv(path.pathForIndex(leg->index()));
+    SGGeodVec gv(leg->owner()->routePath().pathForIndex(leg->index()));
 
     naRef result = naNewVector(c);
     for (SGGeod p : gv) {
@@ -0,0 +1,134 @@
+// NasalPropertyCache.cxx -- cache property path lookups for getprop/setprop
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "NasalPropertyCache.hxx"
+
+#include <cstdio>
+
+#include <Main/globals.hxx>
+
+namespace {
+
+// more distinct paths than this means they're being generated, and the
+// cache would only grow
+const size_t MAX_ENTRIES = 8192;
+
+// can't appear in property names, keeps ("a", "b") apart from ("ab")
+const char SEPARATOR = '\x01';
+
+} // of anonymous namespace
+
+std::atomic<unsigned int> NasalPropertyCache::_globalGeneration{0};
+
+NasalPropertyCache::NasalPropertyCache(SGPropertyNode* root) :
+    _root(root),
+    _thread(std::this_thread::get_id()),
+    _generation(_globalGeneration)
+{
+    _root->addChangeListener(this);
+}
+
+NasalPropertyCache::~NasalPropertyCache()
+{
+    _root->removeChangeListener(this);
+}
+
+// mirrors the argument handling of findnode() in NasalSys.cxx: a string,
+// optionally followed by a number, is one path element
+bool NasalPropertyCache::makeKey(naRef* vec, int len)
+{
+    _key.clear();
+    for (int i = 0; i < len; i++) {
+        naRef a = vec[i];
+        if (!naIsString(a)) {
+            return false; // let findnode() complain
+        }
+
+        if (i > 0) {
+            _key.push_back(SEPARATOR);
+        }
+        _key.append(naStr_data(a), naStr_len(a));
+
+        naRef b = i < len - 1 ? naNumValue(vec[i + 1]) : naNil();
+        if (!naIsNil(b)) {
+            char index[16];
+            const int n = snprintf(index, sizeof(index), "[%d]", (int)b.num);
+            _key.append(index, n);
+            i++;
+        }
+    }
+
+    return true;
+}
+
+SGPropertyNode* NasalPropertyCache::find(naRef* vec, int len)
+{
+    _keyValid = false;
+    if ((std::this_thread::get_id() != _thread) || (globals->get_props() != _root)) {
+        return nullptr;
+    }
+
+    const unsigned int generation = _globalGeneration;
+    if (generation != _generation) {
+        _nodes.clear();
+        _generation = generation;
+    }
+
+    if (!makeKey(vec, len)) {
+        return nullptr;
+    }
+
+    auto it = _nodes.find(_key);
+    if (it != _nodes.end()) {
+        ++_hits;
+        return it->second;
+    }
+
+    ++_misses;
+    _keyValid = true;
+    return nullptr;
+}
+
+void NasalPropertyCache::insert(SGPropertyNode* node)
+{
+    if (!_keyValid || !node) {
+        return;
+    }
+
+    if (_nodes.size() >= MAX_ENTRIES) {
+        _nodes.clear();
+    }
+
+    _nodes.emplace(_key, node);
+    _keyValid = false;
+}
+
+void NasalPropertyCache::invalidateAll()
+{
+    ++_globalGeneration;
+}
+
+void NasalPropertyCache::childRemoved(SGPropertyNode* parent, SGPropertyNode* child)
+{
+    // a cached node could be the child, or anywhere below it. Checking
+    // would cost more than re-resolving the paths which are still used.
+    _nodes.clear();
+    _keyValid = false;
+}
@@ -0,0 +1,83 @@
+// NasalPropertyCache.hxx -- cache property path lookups for getprop/setprop
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SCRIPTING_NASAL_PROPERTY_CACHE_HXX
+#define SCRIPTING_NASAL_PROPERTY_CACHE_HXX
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <simgear/nasal/nasal.h>
+#include <simgear/props/props.hxx>
+
+/**
+ * Maps the path arguments of getprop() and setprop() to the node they
+ * resolved to, so scripts polling the same paths don't walk the tree on
+ * every call. Only used from the thread which created it, Nasal threads
+ * always walk the tree.
+ *
+ * Removing any node below the root drops the whole cache, as does
+ * invalidateAll(), which is called when Nasal changes an alias.
+ */
+class NasalPropertyCache : public SGPropertyChangeListener
+{
+public:
+    explicit NasalPropertyCache(SGPropertyNode* root);
+    ~NasalPropertyCache();
+
+    /**
+     * Look up the node for getprop/setprop style path arguments. Returns
+     * nullptr on a miss; the node found by walking the tree should then
+     * be passed to insert().
+     */
+    SGPropertyNode* find(naRef* vec, int len);
+
+    /**
+     * Remember the node for the arguments of the last, missed, find().
+     */
+    void insert(SGPropertyNode* node);
+
+    /**
+     * Drop the contents of all caches.
+     */
+    static void invalidateAll();
+
+    size_t size() const { return _nodes.size(); }
+    unsigned long hits() const { return _hits; }
+    unsigned long misses() const { return _misses; }
+
+    void childRemoved(SGPropertyNode* parent, SGPropertyNode* child) override;
+
+private:
+    bool makeKey(naRef* vec, int len);
+
+    SGPropertyNode_ptr _root;
+    std::thread::id _thread;
+    std::unordered_map<std::string, SGPropertyNode_ptr> _nodes;
+
+    std::string _key; // key of the last find(), re-used to avoid allocations
+    bool _keyValid = false;
+
+    unsigned int _generation;
+    unsigned long _hits = 0;
+    unsigned long _misses = 0;
+
+    static std::atomic<unsigned int> _globalGeneration;
+};
+
+#endif // of SCRIPTING_NASAL_PROPERTY_CACHE_HXX
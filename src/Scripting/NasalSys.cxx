@@ -62,6 +62,7 @@
 #include "NasalFlightPlan.hxx"
 #include "NasalHTTP.hxx"
 #include "NasalModelData.hxx"
+#include "NasalPropertyCache.hxx"
 #include "NasalPositioned.hxx"
 #include "NasalSGPath.hxx"
 #include "NasalString.hxx"
@@ -72,6 +73,7 @@
 #include <Main/globals.hxx>
 #include <Main/util.hxx>
 #include <Main/fg_props.hxx>
+#include <Main/FrameProfiler.hxx>
 #include <Main/sentryIntegration.hxx>
 
 using std::map;
@@ -81,6 +83,7 @@ using std::vector;
 void postinitNasalGUI(naRef globals, naContext c);
 
 static FGNasalSys* nasalSys = nullptr;
+static std::unique_ptr<NasalPropertyCache> propertyCache;
 
 // this is used by the test-suite to simplify
 // how much Nasal modules we load by default
@@ -114,10 +117,24 @@ void FGNasalModuleListener::valueChanged(SGPropertyNode*)
 
 //////////////////////////////////////////////////////////////////////////
 
-class TimerObj : public SGReferenced
+// source location of the Nasal code calling us, for identifying timers
+static std::string callerLocation(naContext c)
+{
+    if (!c) {
+        return "unknown";
+    }
+
+    std::string location = naStr_data(naGetSourceFile(c, 0));
+    location.append(":");
+    location.append(std::to_string(naGetLine(c, 0)));
+    return location;
+}
+
+class TimerObj : public SGReferenced, public NasalTimerQueue::Timer
 {
 public:
   TimerObj(Context *c, FGNasalSys* sys, naRef f, naRef self, double interval) :
+    NasalTimerQueue::Timer(callerLocation(c)),
     _sys(sys),
     _func(f),
     _self(self),
@@ -149,7 +166,7 @@ public:
   void stop()
   {
     if (_isRunning) {
-      globals->get_event_mgr()->removeTask(_name);
+      _sys->_timers->cancel(this);
       _isRunning = false;
     }
   }
@@ -173,13 +190,7 @@ public:
     }
 
     _isRunning = true;
-    if (_singleShot) {
-      globals->get_event_mgr()->addEvent(_name, this, &TimerObj::invoke, _interval, _isSimTime);
-    } else {
-      globals->get_event_mgr()->addTask(_name, this, &TimerObj::invoke,
-                                        _interval, _interval /* delay */,
-                                        _isSimTime);
-    }
+    _sys->_timers->schedule(this, _interval, _isSimTime);
   }
 
   // stop and then start -
@@ -190,18 +201,25 @@ public:
     start();
   }
 
-  void invoke()
+  void expired() override
   {
     if( _singleShot )
       // Callback may restart the timer, so update status before callback is
-      // called (Prevent warnings of deleting not existing tasks from the
-      // event manager).
+      // called
       _isRunning = false;
+    else
+      // re-arm first, so the callback can stop or restart us
+      _sys->_timers->schedule(this, _interval, _isSimTime);
 
     naRef *args = nullptr;
     _sys->callMethod(_func, _self, 0, args, naNil() /* locals */);
   }
 
+  void cancelled() override
+  {
+    _isRunning = false;
+  }
+
   void setSingleShot(bool aSingleShot)
   {
     _singleShot = aSingleShot;
@@ -271,7 +289,8 @@ typedef nasal::Ghost<TimeStampObjRef> NasalTimeStampObj;
 ///////////////////////////////////////////////////////////////////////////
 
 FGNasalSys::FGNasalSys() :
-    _inited(false)
+    _inited(false),
+    _timers(new NasalTimerQueue)
 {
      nasalSys = this;
     _context = 0;
@@ -410,7 +429,7 @@ FGNasalScript* FGNasalSys::parseScript(const char* src, const char* name)
 // This allows a Nasal object to hold onto a property path and use it
 // like a node object, e.g. setprop(ObjRoot, "size-parsecs", 2.02).  This
 // is the utility function that walks the property tree.
-static SGPropertyNode* findnode(naContext c, naRef* vec, int len, bool create=false)
+static SGPropertyNode* walknode(naContext c, naRef* vec, int len, bool create)
 {
     SGPropertyNode* p = globals->get_props();
     try {
@@ -434,6 +453,22 @@ static SGPropertyNode* findnode(naContext c, naRef* vec, int len, bool create=fa
     return p;
 }
 
+// Scripts tend to poll the same paths over and over, so look them up in
+// the cache before walking the tree.
+static SGPropertyNode* findnode(naContext c, naRef* vec, int len, bool create=false)
+{
+    if (!propertyCache) {
+        return walknode(c, vec, len, create);
+    }
+
+    SGPropertyNode* p = propertyCache->find(vec, len);
+    if (!p) {
+        p = walknode(c, vec, len, create);
+        propertyCache->insert(p);
+    }
+    return p;
+}
+
 // getprop() extension function.  Concatenates its string arguments as
 // property names and returns the value of the specified property.  Or
 // nil if it doesn't exist.
@@ -722,7 +757,7 @@ static naRef f_rand(naContext c, naRef me, int argc, naRef* args)
 
 static naRef f_srand(naContext c, naRef me, int argc, naRef* args)
 {
-    sg_srandom_time();
+    fgSeedRandom();
     return naNum(0);
 }
 
@@ -1141,6 +1176,14 @@ void FGNasalSys::init()
         .method("elapsedUSec", &TimeStampObj::elapsedUSec)
         ;
 
+    propertyCache.reset(new NasalPropertyCache(globals->get_props()));
+
+    // timers run from update(), on the clocks the event manager uses
+    _realDtNode = fgGetNode("/sim/time/delta-realtime-sec", true);
+    _timerBudgetNode = fgGetNode("/sim/nasal/timer-budget-ms", true);
+    _timerStatsNode = fgGetNode("/sim/nasal/timers", true);
+    _timerStatsAge = 0.0;
+
     // everything after here, skip if we're doing minimal init, so
     // we don'tload FG_DATA/Nasal or add-ons
     if (global_nasalMinimalInit) {
@@ -1189,6 +1232,8 @@ void FGNasalSys::shutdown()
     shutdownNasalFlightPlan();
     shutdownNasalUnitTestInSim();
 
+    propertyCache.reset();
+
     for (auto l : _listener)
         delete l.second;
     _listener.clear();
@@ -1202,10 +1247,8 @@ void FGNasalSys::shutdown()
         delete ml;
     _moduleListeners.clear();
 
-    for (auto t : _nasalTimers) {
-        delete t;
-    }
-    _nasalTimers.clear();
+    // deletes the settimer() timers, and stops the maketimer() ones
+    _timers->clear();
 
     naClearSaved();
 
@@ -1250,7 +1293,25 @@ naRef FGNasalSys::wrappedPropsNode(SGPropertyNode* aProps)
     return wrapped;
 }
 
-void FGNasalSys::update(double)
+void FGNasalSys::updateTimers(double dt)
+{
+    const double realDt = _realDtNode->getDoubleValue();
+    _timers->setBudgetMSec(_timerBudgetNode->getDoubleValue());
+    {
+        static const int timersScope = flightgear::FrameProfiler::scopeId("nasal/timers");
+        flightgear::FrameProfiler::Scope profile(timersScope);
+        _timers->update(dt, realDt);
+    }
+
+    _timerStatsAge += realDt;
+    const bool listSlowest = (_timerStatsAge >= 1.0);
+    if (listSlowest) {
+        _timerStatsAge = 0.0;
+    }
+    _timers->publishStats(_timerStatsNode, listSlowest ? 10 : 0);
+}
+
+void FGNasalSys::update(double dt)
 {
     if( NasalClipboard::getInstance() )
         NasalClipboard::getInstance()->update();
@@ -1277,6 +1338,12 @@ void FGNasalSys::update(double)
     // Destroy all queued ghosts
     nasal::ghostProcessDestroyList();
 
+    // Timers, within the configured budget. The slowest callbacks are
+    // listed once a second, the counters every frame.
+    if (_timerStatsNode) {
+        updateTimers(dt);
+    }
+
     // The global context is a legacy thing.  We use dynamically
     // created contexts for naCall() now, so that we can call them
     // recursively.  But there are still spots that want to use it for
@@ -1663,26 +1730,14 @@ void FGNasalSys::setTimer(naContext c, int argc, naRef* args)
 
     bool simtime = (argc > 2 && naTrue(args[2])) ? false : true;
 
-    // A unique name for the timer based on the file name and line number of the function.
-    std::string name = "settimer-";
-    name.append(naStr_data(naGetSourceFile(c, 0)));
-    name.append(":");
-    name.append(std::to_string(naGetLine(c, 0)));
-
-    // Generate and register a C++ timer handler
-    NasalTimer* t = new NasalTimer(handler, this);
-    _nasalTimers.push_back(t);
-    globals->get_event_mgr()->addEvent(name,
-                                       t, &NasalTimer::timerExpired,
-                                       delta.num, simtime);
+    // Generate and register a C++ timer handler; the queue owns it
+    NasalTimer* t = new NasalTimer(handler, this, callerLocation(c));
+    _timers->schedule(t, delta.num, simtime);
 }
 
 void FGNasalSys::handleTimer(NasalTimer* t)
 {
     call(t->handler, 0, 0, naNil());
-    auto it =  std::find(_nasalTimers.begin(), _nasalTimers.end(), t);
-    assert(it != _nasalTimers.end());
-    _nasalTimers.erase(it);
     delete t;
 }
 
@@ -1699,7 +1754,8 @@ void FGNasalSys::gcRelease(int key)
 
 //------------------------------------------------------------------------------
 
-NasalTimer::NasalTimer(naRef h, FGNasalSys* sys) :
+NasalTimer::NasalTimer(naRef h, FGNasalSys* sys, const std::string& location) :
+    NasalTimerQueue::Timer(location),
     handler(h), nasal(sys)
 {
     assert(sys);
@@ -1711,13 +1767,18 @@ NasalTimer::~NasalTimer()
     naGCRelease(gcKey);
 }
 
-void NasalTimer::timerExpired()
+void NasalTimer::expired()
 {
     nasal->handleTimer(this);
     // note handleTimer calls delete on us, don't do anything
     // which requires 'this' to be valid here
 }
 
+void NasalTimer::cancelled()
+{
+    delete this;
+}
+
 
 int FGNasalSys::_listenerId = 0;
 
@@ -1824,14 +1885,14 @@ bool FGNasalSys::removeCommand(const std::string& name)
 
 void FGNasalSys::addPersistentTimer(TimerObj* pto)
 {
-    _persistentTimers.push_back(pto);
+    _persistentTimers.insert(pto);
 }
 
 void FGNasalSys::removePersistentTimer(TimerObj* obj)
 {
-    auto it = std::find(_persistentTimers.begin(), _persistentTimers.end(), obj);
-    assert(it != _persistentTimers.end());
-    _persistentTimers.erase(it);
+    const auto erased = _persistentTimers.erase(obj);
+    assert(erased == 1);
+    SG_UNUSED(erased);
 }
 
 // Register the subsystem.
@@ -1870,6 +1931,8 @@ FGNasalListener::~FGNasalListener()
 void FGNasalListener::call(SGPropertyNode* which, naRef mode)
 {
     if(_active || _dead) return;
+    static const int listenerScope = flightgear::FrameProfiler::scopeId("nasal-listener");
+    flightgear::FrameProfiler::Scope profile(listenerScope);
     _active++;
     naRef arg[4];
     arg[0] = _nas->propNodeGhost(which);
@@ -18,6 +18,7 @@
 
 #include <map>
 #include <memory>
+#include <unordered_set>
 
 class FGNasalScript;
 class FGNasalListener;
@@ -27,6 +28,7 @@ class NasalCommand;
 class FGNasalModuleListener;
 struct NasalTimer;  ///< timer created by settimer
 class TimerObj;     ///< persistent timer created by maketimer
+class NasalTimerQueue;
 
 namespace simgear { class BufferedLogCallback; }
 
@@ -200,9 +202,15 @@ private:
 
     naRef _wrappedNodeFunc;
 
-    // track NasalTimer instances (created via settimer() call) -
-    // this allows us to clean these up on shutdown
-    std::vector<NasalTimer*> _nasalTimers;
+    // all timers, both from settimer() and maketimer(). NasalTimer
+    // instances are owned by the queue, and cleaned up on shutdown.
+    std::unique_ptr<NasalTimerQueue> _timers;
+    SGPropertyNode_ptr _timerBudgetNode;
+    SGPropertyNode_ptr _timerStatsNode;
+    SGPropertyNode_ptr _realDtNode;
+    double _timerStatsAge = 0.0;
+
+    void updateTimers(double dt);
 
     // NasalTimer is a friend to invoke handleTimer and do the actual
     // dispatch of the settimer-d callback
@@ -212,7 +220,7 @@ private:
 
     // track persistent timers. These are owned from the Nasal side, so we
     // only track a non-owning reference here.
-    std::vector<TimerObj*> _persistentTimers;
+    std::unordered_set<TimerObj*> _persistentTimers;
 
     friend TimerObj;
 
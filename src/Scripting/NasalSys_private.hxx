@@ -20,6 +20,8 @@
 #include <simgear/nasal/nasal.h>
 #include <simgear/xml/easyxml.hxx>
 
+#include "NasalTimerQueue.hxx"
+
 /**
   @breif wrapper for naEqual which recursively checks vec/hash equality
     Probably not very performant.
@@ -78,13 +80,14 @@ private:
 // See the implementation of the settimer() extension function for
 // more notes.
 //
-struct NasalTimer
+struct NasalTimer : public NasalTimerQueue::Timer
 {
-    NasalTimer(naRef handler, FGNasalSys* sys);
-    
-    void timerExpired();
+    NasalTimer(naRef handler, FGNasalSys* sys, const std::string& location);
+
+    void expired() override;
+    void cancelled() override;
     ~NasalTimer();
-    
+
     naRef handler;
     int gcKey = 0;
     FGNasalSys* nasal = nullptr;
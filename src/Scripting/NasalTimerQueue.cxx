@@ -0,0 +1,391 @@
+// NasalTimerQueue.cxx -- hierarchical timer wheel for Nasal timers
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "NasalTimerQueue.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+namespace {
+
+// resolution of the wheels: timers due within the same millisecond share
+// a slot; advance() sorts each batch, so they still expire in order of
+// their exact due time
+const double TICKS_PER_SEC = 1000.0;
+
+const unsigned int LEVELS = 4;
+const unsigned int SLOT_BITS = 6;
+const unsigned int SLOTS = 1 << SLOT_BITS;
+const uint64_t SLOT_MASK = SLOTS - 1;
+
+// timers further away than the wheels reach (about 4.6 hours) wait in an
+// overflow list, which is re-examined whenever the top level wraps
+const uint64_t WHEEL_RANGE = uint64_t(1) << (LEVELS * SLOT_BITS);
+
+uint64_t tickFor(double t)
+{
+    return t <= 0.0 ? 0 : static_cast<uint64_t>(std::floor(t * TICKS_PER_SEC));
+}
+
+} // of anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+NasalTimerList::NasalTimerList()
+{
+    _head.prev = _head.next = &_head;
+}
+
+NasalTimerList::~NasalTimerList()
+{
+    // don't leave timers pointing at us
+    while (!empty()) {
+        pop_front();
+    }
+}
+
+void NasalTimerList::push_back(Hook* h)
+{
+    assert(h->list == nullptr);
+    h->prev = _head.prev;
+    h->next = &_head;
+    _head.prev->next = h;
+    _head.prev = h;
+    h->list = this;
+    ++_size;
+}
+
+NasalTimerList::Hook* NasalTimerList::pop_front()
+{
+    if (empty()) {
+        return nullptr;
+    }
+
+    Hook* h = _head.next;
+    unlink(h);
+    return h;
+}
+
+void NasalTimerList::unlink(Hook* h)
+{
+    if (!h->list) {
+        return;
+    }
+
+    h->prev->next = h->next;
+    h->next->prev = h->prev;
+    --h->list->_size;
+    h->prev = h->next = nullptr;
+    h->list = nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A hierarchical timer wheel: LEVELS levels of SLOTS slots each, where a
+ * slot on level n spans SLOTS^n ticks. Timers are placed on the lowest
+ * level covering their due tick, and moved down (cascaded) when the
+ * level below wraps around.
+ */
+class NasalTimerWheel
+{
+public:
+    typedef NasalTimerQueue::Timer Timer;
+
+    double now() const { return _now; }
+
+    void insert(Timer* t)
+    {
+        const uint64_t due = tickFor(t->_due);
+        if (due < _tick) {
+            // the tick was already processed, but the timer isn't due
+            // yet (or was scheduled while dispatching)
+            _current.push_back(t);
+            return;
+        }
+
+        const uint64_t delta = due - _tick;
+        if (delta >= WHEEL_RANGE) {
+            _overflow.push_back(t);
+            return;
+        }
+
+        unsigned int level = 0;
+        while (delta >= (uint64_t(1) << ((level + 1) * SLOT_BITS))) {
+            ++level;
+        }
+
+        _slots[level][(due >> (level * SLOT_BITS)) & SLOT_MASK].push_back(t);
+    }
+
+    void advance(double dt, NasalTimerList& ready)
+    {
+        _now += dt;
+
+        std::vector<Timer*> batch;
+        collect(_current, batch);
+
+        const uint64_t target = tickFor(_now);
+        for (; _tick <= target; ++_tick) {
+            cascade();
+            collect(_slots[0][_tick & SLOT_MASK], batch);
+        }
+
+        // slots (and the current list) hold timers in the order they were
+        // scheduled; expire them in order of their due time, as before
+        std::stable_sort(batch.begin(), batch.end(),
+                         [](const Timer* a, const Timer* b) { return a->_due < b->_due; });
+        for (Timer* t : batch) {
+            ready.push_back(t);
+        }
+    }
+
+    size_t size() const
+    {
+        size_t count = _current.size() + _overflow.size();
+        for (const auto& level : _slots) {
+            for (const auto& slot : level) {
+                count += slot.size();
+            }
+        }
+        return count;
+    }
+
+    void clear(NasalTimerList& out)
+    {
+        move(_current, out);
+        move(_overflow, out);
+        for (auto& level : _slots) {
+            for (auto& slot : level) {
+                move(slot, out);
+            }
+        }
+    }
+
+private:
+    // when level 0 wraps, empty the current slot of level 1 into the
+    // levels below, and so on upwards
+    void cascade()
+    {
+        if (_tick & SLOT_MASK) {
+            return;
+        }
+
+        for (unsigned int level = 1; level < LEVELS; ++level) {
+            const uint64_t index = (_tick >> (level * SLOT_BITS)) & SLOT_MASK;
+            reinsert(_slots[level][index]);
+            if (index != 0) {
+                return;
+            }
+        }
+
+        reinsert(_overflow);
+    }
+
+    void reinsert(NasalTimerList& list)
+    {
+        // timers still out of range go back on the overflow list
+        for (size_t n = list.size(); n > 0; --n) {
+            insert(static_cast<Timer*>(list.pop_front()));
+        }
+    }
+
+    // move the timers from list which are due to ready; the others stay
+    // for a later frame
+    void collect(NasalTimerList& list, std::vector<Timer*>& ready)
+    {
+        for (size_t n = list.size(); n > 0; --n) {
+            Timer* t = static_cast<Timer*>(list.pop_front());
+            if (t->_due <= _now) {
+                ready.push_back(t);
+            } else {
+                _current.push_back(t);
+            }
+        }
+    }
+
+    static void move(NasalTimerList& from, NasalTimerList& to)
+    {
+        while (!from.empty()) {
+            to.push_back(from.pop_front());
+        }
+    }
+
+    double _now = 0.0;
+    uint64_t _tick = 0; // the next tick to process
+    NasalTimerList _slots[LEVELS][SLOTS];
+    NasalTimerList _current;
+    NasalTimerList _overflow;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+NasalTimerQueue::Timer::Timer(const std::string& location) :
+    _location(location)
+{
+}
+
+NasalTimerQueue::Timer::~Timer()
+{
+    NasalTimerList::unlink(this);
+}
+
+NasalTimerQueue::NasalTimerQueue() :
+    _simWheel(new NasalTimerWheel),
+    _realWheel(new NasalTimerWheel)
+{
+}
+
+NasalTimerQueue::~NasalTimerQueue()
+{
+    clear();
+}
+
+void NasalTimerQueue::schedule(Timer* t, double delaySec, bool simTime)
+{
+    NasalTimerList::unlink(t);
+
+    if (!t->_stats) {
+        auto& stats = _stats[t->_location];
+        if (!stats) {
+            stats.reset(new CallbackStats);
+            stats->location = t->_location;
+        }
+        t->_stats = stats.get();
+    }
+
+    NasalTimerWheel* wheel = simTime ? _simWheel.get() : _realWheel.get();
+    t->_due = wheel->now() + std::max(delaySec, 0.0);
+    wheel->insert(t);
+}
+
+void NasalTimerQueue::cancel(Timer* t)
+{
+    NasalTimerList::unlink(t);
+}
+
+void NasalTimerQueue::update(double simDt, double realDt)
+{
+    _simWheel->advance(simDt, _ready);
+    _realWheel->advance(realDt, _ready);
+
+    SGTimeStamp frame;
+    frame.stamp();
+
+    const double budgetUSec = _budgetMSec * 1000.0;
+    _dispatched = 0;
+    while (!_ready.empty()) {
+        // always make some progress
+        if ((budgetUSec > 0.0) && (_dispatched > 0) &&
+            (frame.elapsedUSec() >= budgetUSec)) {
+            break;
+        }
+
+        Timer* t = static_cast<Timer*>(_ready.pop_front());
+        CallbackStats* stats = t->_stats; // t may be gone after expired()
+
+        SGTimeStamp st;
+        st.stamp();
+        t->expired();
+        const double msec = st.elapsedUSec() / 1000.0;
+
+        ++stats->calls;
+        stats->totalMSec += msec;
+        stats->maxMSec = std::max(stats->maxMSec, msec);
+        ++_dispatched;
+    }
+
+    if (!_ready.empty()) {
+        ++_overrunFrames;
+        _deferredTotal += _ready.size();
+        SG_LOG(SG_NASAL, SG_DEBUG, "Nasal timers over budget: deferred " << _ready.size()
+               << " of " << (_ready.size() + _dispatched) << " callbacks");
+    }
+}
+
+void NasalTimerQueue::clear()
+{
+    NasalTimerList all;
+    _simWheel->clear(all);
+    _realWheel->clear(all);
+    while (!_ready.empty()) {
+        all.push_back(_ready.pop_front());
+    }
+
+    while (!all.empty()) {
+        static_cast<Timer*>(all.pop_front())->cancelled();
+    }
+}
+
+size_t NasalTimerQueue::pending() const
+{
+    size_t count = _ready.size();
+    for (auto wheel : {_simWheel.get(), _realWheel.get()}) {
+        count += wheel->size();
+    }
+    return count;
+}
+
+std::vector<const NasalTimerQueue::CallbackStats*> NasalTimerQueue::slowest(size_t count) const
+{
+    std::vector<const CallbackStats*> result;
+    result.reserve(_stats.size());
+    for (const auto& s : _stats) {
+        if (s.second->calls > 0) {
+            result.push_back(s.second.get());
+        }
+    }
+
+    auto slower = [](const CallbackStats* a, const CallbackStats* b) {
+        return a->maxMSec > b->maxMSec;
+    };
+
+    if (result.size() > count) {
+        std::partial_sort(result.begin(), result.begin() + count, result.end(), slower);
+        result.resize(count);
+    } else {
+        std::sort(result.begin(), result.end(), slower);
+    }
+    return result;
+}
+
+void NasalTimerQueue::publishStats(SGPropertyNode* node, size_t slowestCount) const
+{
+    node->setIntValue("pending", static_cast<int>(pending()));
+    node->setIntValue("dispatched", static_cast<int>(dispatchedLastFrame()));
+    node->setIntValue("deferred", static_cast<int>(deferredLastFrame()));
+    node->setLongValue("deferred-total", static_cast<long>(_deferredTotal));
+    node->setLongValue("overrun-frames", static_cast<long>(_overrunFrames));
+
+    const auto worst = slowest(slowestCount);
+    for (size_t i = 0; i < worst.size(); ++i) {
+        SGPropertyNode* n = node->getChild("slowest", static_cast<int>(i), true);
+        n->setStringValue("location", worst[i]->location);
+        n->setLongValue("calls", static_cast<long>(worst[i]->calls));
+        n->setDoubleValue("max-ms", worst[i]->maxMSec);
+        n->setDoubleValue("mean-ms", worst[i]->totalMSec / worst[i]->calls);
+        n->setDoubleValue("total-ms", worst[i]->totalMSec);
+    }
+}
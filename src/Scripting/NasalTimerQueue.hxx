@@ -0,0 +1,168 @@
+// NasalTimerQueue.hxx -- hierarchical timer wheel for Nasal timers
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SCRIPTING_NASAL_TIMER_QUEUE_HXX
+#define SCRIPTING_NASAL_TIMER_QUEUE_HXX
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <simgear/props/props.hxx>
+
+class NasalTimerWheel;
+
+/**
+ * Intrusive, circular list of timers. Insertion and removal are O(1),
+ * and timers know which list they are on.
+ */
+class NasalTimerList
+{
+public:
+    struct Hook {
+        Hook* prev = nullptr;
+        Hook* next = nullptr;
+        NasalTimerList* list = nullptr;
+    };
+
+    NasalTimerList();
+    ~NasalTimerList();
+
+    NasalTimerList(const NasalTimerList&) = delete;
+    NasalTimerList& operator=(const NasalTimerList&) = delete;
+
+    bool empty() const { return _head.next == &_head; }
+    size_t size() const { return _size; }
+
+    void push_back(Hook* h);
+    Hook* pop_front();
+    static void unlink(Hook* h);
+
+private:
+    Hook _head;
+    size_t _size = 0;
+};
+
+/**
+ * The timers created by settimer() and maketimer(), kept in two
+ * hierarchical timer wheels, one for simulated and one for real time.
+ *
+ * Scheduling and cancelling a timer are O(1). Expired timers are
+ * dispatched from update(), within an optional time budget per frame;
+ * timers which don't fit are deferred to the next frame, ahead of any
+ * newly expired ones. Timers scheduled while dispatching run in the
+ * next frame at the earliest, even with a zero delay.
+ *
+ * The run time of the callbacks is accumulated per source location, for
+ * finding the expensive ones.
+ */
+class NasalTimerQueue
+{
+public:
+    struct CallbackStats {
+        std::string location;
+        unsigned long calls = 0;
+        double totalMSec = 0.0;
+        double maxMSec = 0.0;
+    };
+
+    class Timer : private NasalTimerList::Hook
+    {
+    public:
+        /**
+         * @param location where the timer was created, usually file:line.
+         * Statistics are collected per location.
+         */
+        explicit Timer(const std::string& location);
+        virtual ~Timer();
+
+        /// called from NasalTimerQueue::update() when the timer expires;
+        /// may delete the timer
+        virtual void expired() = 0;
+
+        /// called by NasalTimerQueue::clear() for timers still scheduled;
+        /// may delete the timer
+        virtual void cancelled() {}
+
+        bool isScheduled() const { return list != nullptr; }
+        const std::string& location() const { return _location; }
+
+    private:
+        friend class NasalTimerQueue;
+        friend class NasalTimerWheel;
+
+        std::string _location;
+        double _due = 0.0;
+        CallbackStats* _stats = nullptr;
+    };
+
+    NasalTimerQueue();
+    ~NasalTimerQueue();
+
+    /**
+     * schedule (or re-schedule) a timer to expire after delaySec, in
+     * simulated or real time.
+     */
+    void schedule(Timer* t, double delaySec, bool simTime);
+
+    void cancel(Timer* t);
+
+    /**
+     * advance the clocks and run the expired timers
+     */
+    void update(double simDt, double realDt);
+
+    /**
+     * cancel all timers, calling their cancelled() hook
+     */
+    void clear();
+
+    /// per-frame dispatch budget, zero or less for no limit
+    void setBudgetMSec(double budget) { _budgetMSec = budget; }
+
+    size_t pending() const;
+    size_t dispatchedLastFrame() const { return _dispatched; }
+    size_t deferredLastFrame() const { return _ready.size(); }
+    unsigned long overrunFrames() const { return _overrunFrames; }
+    unsigned long deferredTotal() const { return _deferredTotal; }
+
+    /**
+     * the callback statistics, slowest (by worst case run time) first
+     */
+    std::vector<const CallbackStats*> slowest(size_t count) const;
+
+    /**
+     * write the counters, and the slowest callbacks, below node
+     */
+    void publishStats(SGPropertyNode* node, size_t slowestCount = 10) const;
+
+private:
+    std::unique_ptr<NasalTimerWheel> _simWheel;
+    std::unique_ptr<NasalTimerWheel> _realWheel;
+
+    NasalTimerList _ready;
+
+    std::unordered_map<std::string, std::unique_ptr<CallbackStats>> _stats;
+
+    double _budgetMSec = 0.0;
+    size_t _dispatched = 0;
+    unsigned long _overrunFrames = 0;
+    unsigned long _deferredTotal = 0;
+};
+
+#endif // of SCRIPTING_NASAL_TIMER_QUEUE_HXX
@@ -10,6 +10,7 @@
 
 #include <Main/globals.hxx>
 
+#include "NasalPropertyCache.hxx"
 #include "NasalSys.hxx"
 
 using namespace std;
@@ -826,6 +827,7 @@ static naRef f_alias(naContext c, naRef me, int argc, naRef* args)
         naRuntimeError(c, (char *)err.c_str());
         return naNil();
     }
+    NasalPropertyCache::invalidateAll();
     return naNum(node->alias(al));
 }
 
@@ -837,6 +839,7 @@ static naRef f_alias(naContext c, naRef me, int argc, naRef* args)
 static naRef f_unalias(naContext c, naRef me, int argc, naRef* args)
 {
     NODENOARG();
+    NasalPropertyCache::invalidateAll();
     return naNum(node->unalias());
 }
 
@@ -20,10 +20,17 @@
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
 #include <simgear/sg_inlines.h>
+#include <simgear/math/SGMisc.hxx>
+#include <simgear/misc/strutils.hxx>
 #include <simgear/debug/logstream.hxx>
 #include <simgear/misc/sg_path.hxx>
+#include <simgear/misc/sg_dir.hxx>
+#include <simgear/io/iostreams/sgstream.hxx>
 #include <simgear/threads/SGThread.hxx>
 
+#include <cstring>
+#include <sstream>
+
 #include <flite_hts_engine.h>
 
 using std::string;
@@ -37,38 +44,139 @@ class FLITEVoiceSynthesizer::WorkerThread : public SGThread
 {
 public:
   WorkerThread(FLITEVoiceSynthesizer * synthesizer)
-      : _synthesizer(synthesizer)
+      : _synthesizer(synthesizer), _engine(new Flite_HTS_Engine)
+  {
+    Flite_HTS_Engine_initialize(_engine);
+    Flite_HTS_Engine_load(_engine, _synthesizer->_voice.c_str());
+  }
+
+  ~WorkerThread()
   {
+    Flite_HTS_Engine_clear(_engine);
+    delete _engine;
   }
+
   virtual void run();
 private:
   FLITEVoiceSynthesizer * _synthesizer;
+  // flite+hts_engine is not reentrant, every worker owns its engine
+  Flite_HTS_Engine * _engine;
 };
 
 void FLITEVoiceSynthesizer::WorkerThread::run()
 {
   for (;;) {
-    SynthesizeRequest request = _synthesizer->_requests.pop();
-
-    // marker value indicating termination requested
-    if ((request.speed < 0.0) && (request.volume < 0.0)) {
+    QueuedRequest queued;
+    if (!_synthesizer->pop(queued)) {
       SG_LOG(SG_SOUND, SG_DEBUG, "FLITE synthesis thread exiting");
       return;
     }
 
+    const SynthesizeRequest & request = queued.request;
     if ( NULL != request.listener) {
-      SGSharedPtr<SGSoundSample> sample = _synthesizer->synthesize(request.text, request.volume, request.speed, request.pitch);
-      request.listener->SoundSampleReady( sample );
+      SGSharedPtr<SGSoundSample> sample = _synthesizer->synthesize(_engine, request.text, request.volume, request.speed, request.pitch);
+      // the whole text is synthesized before it is handed over, so this is
+      // the time from queueing to the complete sample
+      SG_LOG(SG_SOUND, SG_DEBUG, "FLITE synthesis time: " << queued.queued.elapsedMSec() << "ms"
+             << " (priority " << request.priority << ", " << request.text.size() << " characters)");
+      request.listener->SoundSampleReady( sample, request );
+      _synthesizer->done( request.listener );
+    }
+  }
+}
+
+VoicePhraseCache::VoicePhraseCache( size_t maxBytes, const SGPath & diskCacheDir )
+    : _maxBytes(maxBytes), _diskCacheDir(diskCacheDir)
+{
+  if (!_diskCacheDir.isNull()) {
+    simgear::Dir d(_diskCacheDir);
+    if (!d.exists()) d.create(0755);
+  }
+}
+
+SGPath VoicePhraseCache::diskPath( const std::string & key ) const
+{
+  std::ostringstream os;
+  os << std::hex << std::hash<std::string>()(key) << ".pcm";
+  return _diskCacheDir / os.str();
+}
+
+bool VoicePhraseCache::get( const std::string & key, Phrase & phrase )
+{
+  {
+    std::lock_guard<std::mutex> g(_lock);
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+      _lru.splice(_lru.begin(), _lru, it->second);
+      phrase = it->second->second;
+      ++_hits;
+      return true;
+    }
+  }
+
+  if (!_diskCacheDir.isNull()) {
+    sg_ifstream f(diskPath(key), std::ios::in | std::ios::binary);
+    uint32_t keyLen = 0, count = 0;
+    int32_t rate = 0;
+    if (f.read(reinterpret_cast<char*>(&keyLen), sizeof(keyLen)) && (keyLen == key.size())) {
+      std::string storedKey(keyLen, '\0');
+      f.read(&storedKey[0], keyLen);
+      f.read(reinterpret_cast<char*>(&rate), sizeof(rate));
+      f.read(reinterpret_cast<char*>(&count), sizeof(count));
+      // guard against hash collisions and truncated files
+      if (f && (storedKey == key) && (rate > 0)) {
+        phrase.rate = rate;
+        phrase.samples.resize(count);
+        if (f.read(reinterpret_cast<char*>(phrase.samples.data()), count * sizeof(short))) {
+          ++_hits;
+          std::lock_guard<std::mutex> g(_lock);
+          if (_index.find(key) == _index.end()) {
+            _lru.emplace_front(key, phrase);
+            _index[key] = _lru.begin();
+            _bytes += phrase.samples.size() * sizeof(short);
+            evict();
+          }
+          return true;
+        }
+      }
     }
   }
+
+  ++_misses;
+  return false;
 }
 
-SynthesizeRequest SynthesizeRequest::cancelThreadRequest()
+void VoicePhraseCache::put( const std::string & key, const Phrase & phrase )
 {
-  SynthesizeRequest marker;
-  marker.volume = -999.0;
-  marker.speed = -999.0;
-  return marker;
+  {
+    std::lock_guard<std::mutex> g(_lock);
+    if (_index.find(key) != _index.end()) return;
+    _lru.emplace_front(key, phrase);
+    _index[key] = _lru.begin();
+    _bytes += phrase.samples.size() * sizeof(short);
+    evict();
+  }
+
+  if (!_diskCacheDir.isNull()) {
+    sg_ofstream f(diskPath(key), std::ios::out | std::ios::binary | std::ios::trunc);
+    uint32_t keyLen = key.size(), count = phrase.samples.size();
+    int32_t rate = phrase.rate;
+    f.write(reinterpret_cast<const char*>(&keyLen), sizeof(keyLen));
+    f.write(key.data(), keyLen);
+    f.write(reinterpret_cast<const char*>(&rate), sizeof(rate));
+    f.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    f.write(reinterpret_cast<const char*>(phrase.samples.data()), count * sizeof(short));
+  }
+}
+
+// must be called with _lock held
+void VoicePhraseCache::evict()
+{
+  while ((_bytes > _maxBytes) && (_lru.size() > 1)) {
+    _bytes -= _lru.back().second.samples.size() * sizeof(short);
+    _index.erase(_lru.back().first);
+    _lru.pop_back();
+  }
 }
 
 string FLITEVoiceSynthesizer::getVoicePath( voice_t voice )
@@ -88,48 +196,185 @@ string FLITEVoiceSynthesizer::getVoicePath( const string & voice )
 
 void FLITEVoiceSynthesizer::synthesize( SynthesizeRequest & request)
 {
-  _requests.push(request);
+  push(request);
+}
+
+void FLITEVoiceSynthesizer::push( const SynthesizeRequest & request )
+{
+  {
+    std::lock_guard<std::mutex> g(_requestLock);
+    QueuedRequest queued;
+    queued.request = request;
+    queued.sequence = _sequence++;
+    queued.queued.stamp();
+    _requests.push(queued);
+  }
+  _requestAvailable.notify_one();
+}
+
+bool FLITEVoiceSynthesizer::pop( QueuedRequest & request )
+{
+  std::unique_lock<std::mutex> g(_requestLock);
+  _requestAvailable.wait(g, [this] { return _exiting || !_requests.empty(); });
+  if (_exiting) return false;
+  request = _requests.top();
+  _requests.pop();
+  if (request.request.listener) {
+    ++_inProgress[request.request.listener];
+  }
+  return true;
+}
+
+void FLITEVoiceSynthesizer::done( SoundSampleReadyListener * listener )
+{
+  {
+    std::lock_guard<std::mutex> g(_requestLock);
+    auto it = _inProgress.find(listener);
+    if (--it->second == 0) _inProgress.erase(it);
+  }
+  _requestDone.notify_all();
+}
+
+void FLITEVoiceSynthesizer::cancel( SoundSampleReadyListener * listener )
+{
+  std::unique_lock<std::mutex> g(_requestLock);
+  std::priority_queue<QueuedRequest> remaining;
+  for (; !_requests.empty(); _requests.pop()) {
+    if (_requests.top().request.listener != listener) remaining.push(_requests.top());
+  }
+  _requests.swap(remaining);
+
+  _requestDone.wait(g, [this, listener] { return _inProgress.find(listener) == _inProgress.end(); });
+}
+
+std::vector<string> FLITEVoiceSynthesizer::splitPhrases( const string & text )
+{
+  std::vector<string> phrases;
+  string current;
+  for (string::size_type i = 0; i < text.size(); ++i) {
+    const char c = text[i];
+    current += c;
+    // split at line breaks and on punctuation followed by whitespace, but
+    // keep decimals like 118.5 together
+    const bool boundary = (c == '\n') ||
+        ((c == '.' || c == ',' || c == ';' || c == ':' || c == '!' || c == '?')
+         && ((i + 1 == text.size()) || isspace(static_cast<unsigned char>(text[i + 1]))));
+    if (boundary) {
+      string p = simgear::strutils::strip(current);
+      if (!p.empty()) phrases.push_back(p);
+      current.clear();
+    }
+  }
+
+  string p = simgear::strutils::strip(current);
+  if (!p.empty()) phrases.push_back(p);
+  return phrases;
 }
 
 FLITEVoiceSynthesizer::FLITEVoiceSynthesizer(const std::string & voice)
     // REVIEW: Memory Leak - 1,696 bytes in 4 blocks are definitely lost in loss record 6,145 of 6,440
-    : _engine(new Flite_HTS_Engine), _worker(new FLITEVoiceSynthesizer::WorkerThread(this)), _volume(6.0)
+    : _voice(voice), _engine(new Flite_HTS_Engine), _volume(6.0)
 {
   _volume = fgGetDouble("/sim/sound/voice-synthesizer/volume", _volume );
   Flite_HTS_Engine_initialize(_engine);
   Flite_HTS_Engine_load(_engine, voice.c_str());
-  _worker->start();
+
+  const size_t cacheSize = fgGetInt("/sim/sound/voice-synthesizer/phrase-cache-kb", 16384) * 1024;
+  SGPath diskCache;
+  if (fgGetBool("/sim/sound/voice-synthesizer/disk-cache", false)) {
+    diskCache = globals->get_fg_home() / "VoiceCache";
+  }
+  _phraseCache.reset(new VoicePhraseCache(cacheSize, diskCache));
+
+  const int numWorkers = SGMisci::max(1, fgGetInt("/sim/sound/voice-synthesizer/threads", 2));
+  for (int i = 0; i < numWorkers; ++i) {
+    WorkerThread * worker = new FLITEVoiceSynthesizer::WorkerThread(this);
+    _workers.push_back(worker);
+    worker->start();
+  }
 }
 
 FLITEVoiceSynthesizer::~FLITEVoiceSynthesizer()
 {
-  // push the special marker value
-  _requests.push(SynthesizeRequest::cancelThreadRequest());
-  _worker->join();
+  {
+    std::lock_guard<std::mutex> g(_requestLock);
+    _exiting = true;
+  }
+  _requestAvailable.notify_all();
+
+  for (WorkerThread * worker : _workers) {
+    worker->join();
+    delete worker;
+  }
+
+  SG_LOG(SG_SOUND, SG_DEBUG, "FLITE phrase cache: " << _phraseCache->hits() << " hits, "
+         << _phraseCache->misses() << " misses");
   Flite_HTS_Engine_clear(_engine);
 }
 
 SGSoundSample * FLITEVoiceSynthesizer::synthesize(const std::string & text, double volume, double speed, double pitch )
+{
+  std::lock_guard<std::mutex> g(_engineLock);
+  return synthesize(_engine, text, volume, speed, pitch);
+}
+
+bool FLITEVoiceSynthesizer::renderPhrase( Flite_HTS_Engine * engine, const std::string & phrase,
+                                          double volume, double speed, double pitch,
+                                          VoicePhraseCache::Phrase & result )
+{
+  std::ostringstream key;
+  key << _voice << '|' << _volume << '|' << speed << '|' << pitch << '|' << phrase;
+  if (_phraseCache->get(key.str(), result)) return true;
+
+  HTS_Engine_set_volume( &engine->engine, _volume );
+  HTS_Engine_set_speed( &engine->engine, 0.8 + 0.4 * speed );
+  HTS_Engine_add_half_tone(&engine->engine, -4.0 + 8.0 * pitch );
+
+  void* data;
+  int rate, count;
+  if ( FALSE == Flite_HTS_Engine_synthesize_samples_mono16(engine, phrase.c_str(), &data, &count, &rate)) return false;
+
+  result.rate = rate;
+  result.samples.assign(reinterpret_cast<short*>(data), reinterpret_cast<short*>(data) + count);
+  free(data);
+
+  _phraseCache->put(key.str(), result);
+  return true;
+}
+
+SGSoundSample * FLITEVoiceSynthesizer::synthesize( Flite_HTS_Engine * engine, const std::string & text,
+                                                   double volume, double speed, double pitch )
 {
   SG_CLAMP_RANGE( volume, 0.0, 1.0 );
   SG_CLAMP_RANGE( speed, 0.0, 10.0 );
   SG_CLAMP_RANGE( pitch, 0.0, 10.0 );
-  HTS_Engine_set_volume( &_engine->engine, _volume );
-  HTS_Engine_set_speed( &_engine->engine, 0.8 + 0.4 * speed );
-  HTS_Engine_add_half_tone(&_engine->engine, -4.0 + 8.0 * pitch );
 
-    
-  void* data;
-  int rate, count;
-  if ( FALSE == Flite_HTS_Engine_synthesize_samples_mono16(_engine, text.c_str(), &data, &count, &rate)) return NULL;
+  // Recurring phrases (station names, standard phraseology, most of an ATIS
+  // that was only updated for a new QNH) are served from the phrase cache;
+  // only new phrases go through the synthesizer.
+  std::vector<short> samples;
+  int rate = 0;
+  for (const string & phrase : splitPhrases(text)) {
+    VoicePhraseCache::Phrase rendered;
+    if (!renderPhrase(engine, phrase, volume, speed, pitch, rendered)) continue;
+    if (rate == 0) rate = rendered.rate;
+    if (rendered.rate != rate) {
+      SG_LOG(SG_SOUND, SG_DEV_WARN, "FLITE phrase sample rate mismatch, skipping '" << phrase << "'");
+      continue;
+    }
+    samples.insert(samples.end(), rendered.samples.begin(), rendered.samples.end());
+  }
 
+  if (samples.empty()) return NULL;
+
+  const size_t bytes = samples.size() * sizeof(short);
   auto buf = std::unique_ptr<unsigned char, decltype(free)*>{
-    reinterpret_cast<unsigned char*>( data ),
+    reinterpret_cast<unsigned char*>( malloc(bytes) ),
     free
   };
+  memcpy(buf.get(), samples.data(), bytes);
   return new SGSoundSample(buf,
-                           count * sizeof(short),
+                           bytes,
                            rate,
                            SG_SAMPLE_MONO16);
 }
-
@@ -19,10 +19,22 @@
 #ifndef VOICESYNTHESIZER_HXX_
 #define VOICESYNTHESIZER_HXX_
 
+#include <simgear/misc/sg_path.hxx>
 #include <simgear/sound/sample.hxx>
 #include <simgear/threads/SGQueue.hxx>
-
+#include <simgear/timing/timestamp.hxx>
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
 struct _Flite_HTS_Engine;
 
 /**
@@ -34,25 +46,49 @@ public:
   virtual SGSoundSample * synthesize( const std::string & text, double volume, double speed, double pitch ) = 0;
 };
 
+struct SynthesizeRequest;
+
 class SoundSampleReadyListener {
 public:
   virtual ~SoundSampleReadyListener() {}
-  virtual void SoundSampleReady( SGSharedPtr<SGSoundSample> ) = 0;
+  virtual void SoundSampleReady( SGSharedPtr<SGSoundSample> ) {}
+
+  /**
+   * Called by the synthesizer with the request the sample was made for, so
+   * a listener with several requests in flight can tell them apart by id.
+   */
+  virtual void SoundSampleReady( SGSharedPtr<SGSoundSample> sample, const SynthesizeRequest & ) {
+    SoundSampleReady( sample );
+  }
 };
 
 struct SynthesizeRequest {
+  /**
+   * Requests with a higher priority are synthesized first. ATC instructions
+   * must not wait behind a long ATIS text.
+   */
+  typedef enum {
+    PRIORITY_ATIS = 0,
+    PRIORITY_NORMAL = 10,
+    PRIORITY_ATC = 20
+  } priority_t;
+
   SynthesizeRequest() {
     speed = 0.5;
     volume = 1.0;
     pitch = 0.5;
+    priority = PRIORITY_NORMAL;
     listener = NULL;
+    id = 0;
   }
   SynthesizeRequest( const SynthesizeRequest & other ) {
     text = other.text;
     speed = other.speed;
     volume = other.volume;
     pitch = other.pitch;
+    priority = other.priority;
     listener = other.listener;
+    id = other.id;
   }
 
   SynthesizeRequest & operator = ( const SynthesizeRequest & other ) {
@@ -60,19 +96,56 @@ struct SynthesizeRequest {
     speed = other.speed;
     volume = other.volume;
     pitch = other.pitch;
+    priority = other.priority;
     listener = other.listener;
+    id = other.id;
     return *this;
   }
 
-  // return a special marker request used to indicate the synthesis thread
-  // should be exited.
-  static SynthesizeRequest cancelThreadRequest();
-
   std::string text;
   double speed;
   double volume;
   double pitch;
+  int priority;
   SoundSampleReadyListener * listener;
+  // chosen by the caller, passed back to the listener unchanged
+  unsigned int id;
+};
+
+/**
+ * A bounded cache of rendered PCM phrases, shared by all synthesizer workers.
+ * Phrases are kept in memory with LRU eviction and optionally persisted
+ * below $FG_HOME/VoiceCache so they survive a restart.
+ */
+class VoicePhraseCache {
+public:
+  struct Phrase {
+    std::vector<short> samples;
+    int rate = 0;
+  };
+
+  VoicePhraseCache( size_t maxBytes, const SGPath & diskCacheDir );
+
+  bool get( const std::string & key, Phrase & phrase );
+  void put( const std::string & key, const Phrase & phrase );
+
+  size_t hits() const { return _hits; }
+  size_t misses() const { return _misses; }
+
+private:
+  SGPath diskPath( const std::string & key ) const;
+  void evict();
+
+  typedef std::list<std::pair<std::string, Phrase> > PhraseList;
+
+  std::mutex _lock;
+  PhraseList _lru;
+  std::unordered_map<std::string, PhraseList::iterator> _index;
+  size_t _bytes = 0;
+  size_t _maxBytes;
+  SGPath _diskCacheDir;
+  std::atomic<size_t> _hits {0};
+  std::atomic<size_t> _misses {0};
 };
 
 /**
@@ -96,14 +169,63 @@ public:
   virtual SGSoundSample * synthesize( const std::string & text, double volume, double speed, double pitch  );
 
   virtual void synthesize( SynthesizeRequest & request );
+
+  /**
+   * Drop the queued requests of a listener, and wait for those being
+   * synthesized to be delivered. Synthesizers are shared between all users
+   * of a voice, so this must be called before a listener is destroyed.
+   */
+  void cancel( SoundSampleReadyListener * listener );
+
+  /**
+   * Split a text into phrases at sentence and clause boundaries. Each
+   * phrase is synthesized (or fetched from the phrase cache) separately.
+   */
+  static std::vector<std::string> splitPhrases( const std::string & text );
+
 private:
+  class WorkerThread;
+
+  struct QueuedRequest {
+    SynthesizeRequest request;
+    unsigned int sequence;
+    SGTimeStamp queued;
+
+    bool operator < ( const QueuedRequest & other ) const {
+      // std::priority_queue pops the largest element: higher priority first,
+      // FIFO within the same priority
+      if (request.priority != other.request.priority)
+        return request.priority < other.request.priority;
+      return sequence > other.sequence;
+    }
+  };
+
+  SGSoundSample * synthesize( struct _Flite_HTS_Engine * engine, const std::string & text,
+                              double volume, double speed, double pitch );
+  bool renderPhrase( struct _Flite_HTS_Engine * engine, const std::string & phrase,
+                     double volume, double speed, double pitch, VoicePhraseCache::Phrase & result );
+  void push( const SynthesizeRequest & request );
+  bool pop( QueuedRequest & request );
+  void done( SoundSampleReadyListener * listener );
+
+  std::string _voice;
+
+  // engine used by the synchronous synthesize() call
   struct _Flite_HTS_Engine * _engine;
+  std::mutex _engineLock;
 
-  class WorkerThread;
-  WorkerThread * _worker;
+  std::vector<WorkerThread*> _workers;
+
+  std::mutex _requestLock;
+  std::condition_variable _requestAvailable;
+  std::priority_queue<QueuedRequest> _requests;
+  // number of requests being synthesized, per listener
+  std::map<SoundSampleReadyListener*, int> _inProgress;
+  std::condition_variable _requestDone;
+  unsigned int _sequence = 0;
+  bool _exiting = false;
 
-  typedef SGBlockingQueue<SynthesizeRequest> SynthesizeRequestList;
-  SynthesizeRequestList _requests;
+  std::unique_ptr<VoicePhraseCache> _phraseCache;
 
   double _volume;
 };
@@ -33,6 +33,7 @@
 
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
+#include <Main/PropertyTreeCache.hxx>
 #include <Main/sentryIntegration.hxx>
 #include <Sound/soundmanager.hxx>
 #include <algorithm>
@@ -134,7 +135,7 @@ FGFX::init()
     SGPropertyNode root;
     try {
         flightgear::SentryXMLErrorSupression xmls;
-        readProperties(path, &root);
+        flightgear::PropertyTreeCache::readProperties(path, &root);
     } catch (const sg_exception& e) {
         simgear::reportFailure(simgear::LoadFailure::BadData, simgear::ErrorCode::AudioFX,
                                "Failure loading FX XML:" + e.getFormattedMessage(), e.getLocation());
@@ -24,16 +24,15 @@
 #endif
 
 #include "flitevoice.hxx"
+#include "soundmanager.hxx"
 #include <Main/fg_props.hxx>
 #include <simgear/sound/sample_group.hxx>
 #include <flite_hts_engine.h>
 
 using std::string;
 
-#include "VoiceSynthesizer.hxx"
-
 FGFLITEVoice::FGFLITEVoice(FGVoiceMgr * mgr, const SGPropertyNode_ptr node, const char * sampleGroupRefName)
-    : FGVoice(mgr), _synthesizer( NULL), _seconds_to_run(0.0)
+    : FGVoice(mgr), _synthesizer( NULL), _nextId(0), _synthesisTimeMSec(0.0), _seconds_to_run(0.0)
 {
 
   _sampleName = node->getStringValue("desc", node->getPath().c_str());
@@ -41,9 +40,12 @@ FGFLITEVoice::FGFLITEVoice(FGVoiceMgr * mgr, const SGPropertyNode_ptr node, cons
     SGPath voice = globals->get_fg_root() / "ATC" /
       node->getStringValue("htsvoice", "cmu_us_arctic_slt.htsvoice");
 
-  _synthesizer = new FLITEVoiceSynthesizer(voice.utf8Str());
+  // use the same synthesizer (and request queue) as the ATIS, so ATC
+  // instructions can overtake a long ATIS text
+  FGSoundManager *smgr = globals->get_subsystem<FGSoundManager>();
+  _synthesizer = dynamic_cast<FLITEVoiceSynthesizer*>(smgr->getSynthesizer(voice.utf8Str()));
+  _synthesisTimeNode = node->getNode("synthesis-time-ms", true);
 
-  SGSoundMgr *smgr = globals->get_subsystem<SGSoundMgr>();
   _sgr = smgr->find(sampleGroupRefName, true);
   _sgr->tie_to_listener();
 
@@ -56,7 +58,7 @@ FGFLITEVoice::FGFLITEVoice(FGVoiceMgr * mgr, const SGPropertyNode_ptr node, cons
 
 FGFLITEVoice::~FGFLITEVoice()
 {
-  delete _synthesizer;
+  _synthesizer->cancel(this);
 }
 
 void FGFLITEVoice::speak(const string & msg)
@@ -64,12 +66,44 @@ void FGFLITEVoice::speak(const string & msg)
   // this is called from voice.cxx:FGVoiceMgr::FGVoiceThread::run
   string s = simgear::strutils::strip(msg);
   if (false == s.empty()) {
-    _sampleQueue.push(_synthesizer->synthesize(msg, 1.0, 0.5, 0.5));
+    // queue with ATC priority so instructions are not delayed by a
+    // concurrently synthesized ATIS
+    SynthesizeRequest request;
+    request.text = s;
+    request.priority = SynthesizeRequest::PRIORITY_ATC;
+    request.listener = this;
+    {
+      std::lock_guard<std::mutex> g(_pendingLock);
+      request.id = _nextId++;
+      _pending[request.id].requested.stamp();
+    }
+    _synthesizer->synthesize(request);
+  }
+}
+
+void FGFLITEVoice::SoundSampleReady(SGSharedPtr<SGSoundSample> sample, const SynthesizeRequest & request)
+{
+  // we are now in the synthesizers worker thread!
+  std::lock_guard<std::mutex> g(_pendingLock);
+  PendingSample & pending = _pending[request.id];
+  pending.sample = sample;
+  pending.ready = true;
+
+  // ids are handed out in order, so the first entry is the oldest request
+  while (!_pending.empty() && _pending.begin()->second.ready) {
+    PendingSample & next = _pending.begin()->second;
+    if (next.sample.valid()) {
+      // from speak() to the complete sample, including time spent queued
+      _synthesisTimeMSec = next.requested.elapsedMSec();
+      _sampleQueue.push(next.sample);
+    }
+    _pending.erase(_pending.begin());
   }
 }
 
 void FGFLITEVoice::update(double dt)
 {
+  _synthesisTimeNode->setDoubleValue(_synthesisTimeMSec);
   _seconds_to_run -= dt;
 
   if (_seconds_to_run < 0.0) {
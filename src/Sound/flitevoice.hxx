@@ -23,27 +23,47 @@
 #ifndef _FLITEVOICE_HXX
 #define _FLITEVOICE_HXX
 
+#include <atomic>
+#include <map>
+#include <mutex>
+
 #include "voice.hxx"
+#include "VoiceSynthesizer.hxx"
 #include <simgear/sound/soundmgr.hxx>
 #include <simgear/sound/sample.hxx>
 #include <simgear/threads/SGQueue.hxx>
 
-class VoiceSynthesizer;
-
-class FGFLITEVoice: public FGVoiceMgr::FGVoice {
+class FGFLITEVoice: public FGVoiceMgr::FGVoice, SoundSampleReadyListener {
 public:
   FGFLITEVoice(FGVoiceMgr *, const SGPropertyNode_ptr, const char * sampleGroupRefName = "flite-voice");
   virtual ~FGFLITEVoice();
   virtual void speak(const std::string & msg);
   virtual void update(double dt);
+  virtual void SoundSampleReady(SGSharedPtr<SGSoundSample> sample, const SynthesizeRequest & request);
 
 private:
   FGFLITEVoice(const FGFLITEVoice & other);
   FGFLITEVoice & operator =(const FGFLITEVoice & other);
 
+  struct PendingSample {
+    SGTimeStamp requested;
+    SGSharedPtr<SGSoundSample> sample;
+    bool ready = false;
+  };
+
   SGSharedPtr<SGSampleGroup> _sgr;
-  VoiceSynthesizer * _synthesizer;
+  // shared with all other users of the voice, owned by the FGSoundManager
+  FLITEVoiceSynthesizer * _synthesizer;
   SGLockedQueue<SGSharedPtr<SGSoundSample> > _sampleQueue;
+
+  // the synthesizer workers may finish our requests out of order; results
+  // wait here, by request id, until all earlier ones are done
+  std::mutex _pendingLock;
+  std::map<unsigned int, PendingSample> _pending;
+  unsigned int _nextId;
+
+  std::atomic<double> _synthesisTimeMSec;
+  SGPropertyNode_ptr _synthesisTimeNode;
   std::string _sampleName;
   double _seconds_to_run;
 };
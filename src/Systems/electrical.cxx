@@ -27,6 +27,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <unordered_map>
 
 #include <simgear/structure/exception.hxx>
 #include <simgear/misc/sg_path.hxx>
@@ -35,6 +36,7 @@
 
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
+#include <Main/PropertyTreeCache.hxx>
 
 #include "electrical.hxx"
 
@@ -43,7 +45,8 @@ FGElectricalComponent::FGElectricalComponent() :
     kind(-1),
     name(""),
     volts(0.0),
-    load_amps(0.0)
+    load_amps(0.0),
+    available_amps(0.0)
 {
 }
 
@@ -357,6 +360,7 @@ FGElectricalSystem::FGElectricalSystem ( SGPropertyNode *node ) :
     path(node->getStringValue("path")),
     enabled(false)
 {
+    _cacheSolutions = node->getBoolValue("cache-solutions", true);
 }
 
 
@@ -372,6 +376,13 @@ void FGElectricalSystem::init () {
     _volts_out = fgGetNode( "/systems/electrical/volts", true );
     _amps_out = fgGetNode( "/systems/electrical/amps", true );
 
+    _master_bat_node = fgGetNode( "/controls/engines/engine[0]/master-bat", true );
+    _master_alt_node = fgGetNode( "/controls/engines/engine[0]/master-alt", true );
+    _engine_rpm_node = fgGetNode( "/engines/engine[0]/rpm", true );
+    _alternator_node = fgGetNode( "/systems/electrical/suppliers/alternator", true );
+    _beacon_node = fgGetNode( "/controls/switches/flashing-beacon", true );
+    _nav_lights_node = fgGetNode( "/controls/switches/nav-lights", true );
+
     // allow the electrical system to be specified via the
     // aircraft-set.xml file (for backwards compatibility) or through
     // the aircraft-systems.xml file.  If a -set.xml entry is
@@ -401,9 +412,10 @@ void FGElectricalSystem::init () {
                 "Reading deprecated xml electrical system model from\n    "
                 << config.str() );
         try {
-            readProperties( config, config_props );
+            flightgear::PropertyTreeCache::readProperties( config, config_props );
 
             if ( build(config_props) ) {
+                compile();
                 enabled = true;
             } else {
                 throw sg_exception("Logic error in electrical system file.");
@@ -436,6 +448,12 @@ void FGElectricalSystem::unbind ()
     _serviceable_node.reset();
     _volts_out.reset();
     _amps_out.reset();
+    _master_bat_node.reset();
+    _master_alt_node.reset();
+    _engine_rpm_node.reset();
+    _alternator_node.reset();
+    _beacon_node.reset();
+    _nav_lights_node.reset();
 }
 
 void FGElectricalSystem::deleteComponents(comp_list& comps)
@@ -450,6 +468,14 @@ void FGElectricalSystem::deleteComponents(comp_list& comps)
 
 void FGElectricalSystem::shutdown()
 {
+    _nodes.clear();
+    _nodeOutputs.clear();
+    _switchNodes.clear();
+    _roots.clear();
+    _batteries.clear();
+    _solution = Solution();
+    enabled = false;
+
     deleteComponents(suppliers);
     deleteComponents(buses);
     deleteComponents(outputs);
@@ -462,104 +488,29 @@ void FGElectricalSystem::update (double dt)
         return;
     }
 
-    // cout << "Updating electrical system, dt = " << dt << endl;
     _serviceable = _serviceable_node->getBoolValue();
-    
-    unsigned int i;
-
-    // zero out the voltage before we start, but don't clear the
-    // requested load values.
-    for ( i = 0; i < suppliers.size(); ++i ) {
-        suppliers[i]->set_volts( 0.0 );
-    }
-    for ( i = 0; i < buses.size(); ++i ) {
-        buses[i]->set_volts( 0.0 );
-    }
-    for ( i = 0; i < outputs.size(); ++i ) {
-        outputs[i]->set_volts( 0.0 );
-    }
-    for ( i = 0; i < connectors.size(); ++i ) {
-        connectors[i]->set_volts( 0.0 );
-    }
-
-    // for each "external" supplier, propagate the electrical current
-    for ( i = 0; i < suppliers.size(); ++i ) {
-        FGElectricalSupplier *node = (FGElectricalSupplier *)suppliers[i];
-        if ( node->get_model() == FGElectricalSupplier::FG_EXTERNAL ) {
-            float load;
-            // cout << "Starting propagation: " << suppliers[i]->get_name()
-            //      << endl;
-            load = propagate( suppliers[i], dt,
-                              node->get_output_volts(),
-                              node->get_output_amps(),
-                              " " );
-
-            if ( node->apply_load( load, dt ) < 0.0 ) {
-                SG_LOG(SG_SYSTEMS, SG_ALERT,
-                       "Error drawing more current than available!");
-            }
-        }
-    }
 
-    // for each "alternator" supplier, propagate the electrical
-    // current
-    for ( i = 0; i < suppliers.size(); ++i ) {
-        FGElectricalSupplier *node = (FGElectricalSupplier *)suppliers[i];
-        if ( node->get_model() == FGElectricalSupplier::FG_ALTERNATOR) {
-            float load;
-            // cout << "Starting propagation: " << suppliers[i]->get_name()
-            //      << endl;
-            load = propagate( suppliers[i], dt,
-                              node->get_output_volts(),
-                              node->get_output_amps(),
-                              " " );
-
-            if ( node->apply_load( load, dt ) < 0.0 ) {
-                SG_LOG(SG_SYSTEMS, SG_ALERT,
-                       "Error drawing more current than available!");
-            }
-        }
-    }
-
-    // for each "battery" supplier, propagate the electrical
-    // current
-    for ( i = 0; i < suppliers.size(); ++i ) {
-        FGElectricalSupplier *node = (FGElectricalSupplier *)suppliers[i];
-        if ( node->get_model() == FGElectricalSupplier::FG_BATTERY ) {
-            float load;
-            // cout << "Starting propagation: " << suppliers[i]->get_name()
-            //      << endl;
-            load = propagate( suppliers[i], dt,
-                              node->get_output_volts(),
-                              node->get_output_amps(),
-                              " " );
-            // cout << "battery load = " << load << endl;
-
-            if ( node->apply_load( load, dt ) < 0.0 ) {
-                SG_LOG(SG_SYSTEMS, SG_ALERT,
-                       "Error drawing more current than available!");
-            }
-        }
+    if ( !_cacheSolutions || !replaySolution( dt ) ) {
+        solve( dt );
     }
 
-    float alt_norm
-        = fgGetFloat("/systems/electrical/suppliers/alternator") / 60.0;
+    float alt_norm = _alternator_node->getFloatValue() / 60.0;
 
     // impliment an extremely simplistic voltage model (assumes
     // certain naming conventions in electrical system config)
     // FIXME: we probably want to be able to feed power from all
     // engines if they are running and the master-alt is switched on
     float volts = 0.0;
-    if ( fgGetBool("/controls/engines/engine[0]/master-bat") ) {
+    if ( _master_bat_node->getBoolValue() ) {
         volts = 24.0;
     }
-    if ( fgGetBool("/controls/engines/engine[0]/master-alt") ) {
-        if ( fgGetFloat("/engines/engine[0]/rpm") > 800 ) {
+    if ( _master_alt_node->getBoolValue() ) {
+        if ( _engine_rpm_node->getFloatValue() > 800 ) {
             float alt_contrib = 28.0;
             if ( alt_contrib > volts ) {
                 volts = alt_contrib;
             }
-        } else if ( fgGetFloat("/engines/engine[0]/rpm") > 200 ) {
+        } else if ( _engine_rpm_node->getFloatValue() > 200 ) {
             float alt_contrib = 20.0;
             if ( alt_contrib > volts ) {
                 volts = alt_contrib;
@@ -572,17 +523,17 @@ void FGElectricalSystem::update (double dt)
     // naming conventions in the electrical system config) ... FIXME:
     // make this more generic
     float amps = 0.0;
-    if ( fgGetBool("/controls/engines/engine[0]/master-bat") ) {
-        if ( fgGetBool("/controls/engines/engine[0]/master-alt") &&
-             fgGetFloat("/engines/engine[0]/rpm") > 800 )
+    if ( _master_bat_node->getBoolValue() ) {
+        if ( _master_alt_node->getBoolValue() &&
+             _engine_rpm_node->getFloatValue() > 800 )
         {
             amps += 40.0 * alt_norm;
         }
         amps -= 15.0;            // normal load
-        if ( fgGetBool("/controls/switches/flashing-beacon") ) {
+        if ( _beacon_node->getBoolValue() ) {
             amps -= 7.5;
         }
-        if ( fgGetBool("/controls/switches/nav-lights") ) {
+        if ( _nav_lights_node->getBoolValue() ) {
             amps -= 7.5;
         }
         if ( amps > 7.0 ) {
@@ -629,12 +580,162 @@ bool FGElectricalSystem::build (SGPropertyNode* config_props) {
 }
 
 
+// flatten the component graph: one array of nodes with index ranges for
+// their outputs and switches, and the suppliers in propagation order
+void FGElectricalSystem::compile() {
+    _nodes.clear();
+    _nodeOutputs.clear();
+    _switchNodes.clear();
+    _roots.clear();
+    _batteries.clear();
+    _solution = Solution();
+
+    std::unordered_map<FGElectricalComponent*, unsigned int> indices;
+    auto addNodes = [this, &indices](const comp_list& comps) {
+        for ( auto c : comps ) {
+            indices[c] = static_cast<unsigned int>(_nodes.size());
+            CompiledNode n;
+            n.component = c;
+            n.kind = c->get_kind();
+            n.supplier = (n.kind == FGElectricalComponent::FG_SUPPLIER) ?
+                static_cast<FGElectricalSupplier *>(c) : nullptr;
+            n.battery = n.supplier &&
+                (n.supplier->get_model() == FGElectricalSupplier::FG_BATTERY);
+            n.firstOutput = n.numOutputs = 0;
+            n.firstSwitch = n.numSwitches = 0;
+            _nodes.push_back(n);
+        }
+    };
+
+    addNodes(suppliers);
+    addNodes(buses);
+    addNodes(outputs);
+    addNodes(connectors);
+
+    for ( auto& n : _nodes ) {
+        n.firstOutput = static_cast<unsigned int>(_nodeOutputs.size());
+        for ( int i = 0; i < n.component->get_num_outputs(); ++i ) {
+            _nodeOutputs.push_back(indices.at(n.component->get_output(i)));
+        }
+        n.numOutputs = static_cast<unsigned int>(_nodeOutputs.size()) - n.firstOutput;
+
+        n.firstSwitch = static_cast<unsigned int>(_switchNodes.size());
+        if ( n.kind == FGElectricalComponent::FG_CONNECTOR ) {
+            auto connector = static_cast<FGElectricalConnector *>(n.component);
+            for ( const auto& sw : connector->get_switches() ) {
+                _switchNodes.push_back(sw.get_node());
+            }
+        }
+        n.numSwitches = static_cast<unsigned int>(_switchNodes.size()) - n.firstSwitch;
+    }
+
+    // externals first, then alternators, then batteries
+    const FGElectricalSupplier::FGSupplierType order[] = {
+        FGElectricalSupplier::FG_EXTERNAL,
+        FGElectricalSupplier::FG_ALTERNATOR,
+        FGElectricalSupplier::FG_BATTERY
+    };
+    for ( auto model : order ) {
+        for ( unsigned int i = 0; i < _nodes.size(); ++i ) {
+            if ( _nodes[i].supplier && _nodes[i].supplier->get_model() == model ) {
+                _roots.push_back(i);
+            }
+        }
+    }
+
+    for ( unsigned int i = 0; i < _nodes.size(); ++i ) {
+        if ( _nodes[i].battery ) {
+            _batteries.push_back(i);
+        }
+    }
+
+    _switchScratch.resize(_switchNodes.size());
+    _batteryScratch.resize(_batteries.size());
+}
+
+
+// return true if all switches of a connector are closed
+bool FGElectricalSystem::switchesClosed( unsigned int index ) const {
+    const CompiledNode& n = _nodes[index];
+    for ( unsigned int i = 0; i < n.numSwitches; ++i ) {
+        if ( !_switchNodes[n.firstSwitch + i]->getBoolValue() ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void FGElectricalSystem::solve( double dt ) {
+    const size_t count = _nodes.size();
+
+    Solution& sol = _solution;
+    sol.valid = false;
+    sol.serviceable = _serviceable;
+    sol.events.clear();
+    sol.published.clear();
+    sol.startLoads.resize(count);
+    sol.switchStates.resize(_switchNodes.size());
+    for ( size_t i = 0; i < _switchNodes.size(); ++i ) {
+        sol.switchStates[i] = _switchNodes[i]->getBoolValue();
+    }
+
+    // zero out the voltage before we start, but don't clear the
+    // requested load values.
+    for ( size_t i = 0; i < count; ++i ) {
+        _nodes[i].component->set_volts( 0.0 );
+        sol.startLoads[i] = _nodes[i].component->get_load_amps();
+    }
+
+    // propagate the electrical current from each supplier
+    for ( auto root : _roots ) {
+        FGElectricalSupplier *node = _nodes[root].supplier;
+        const float volts = node->get_output_volts();
+        const float amps = node->get_output_amps();
+        sol.events.push_back({SolverEvent::READ_VOLTS, root, volts});
+        sol.events.push_back({SolverEvent::READ_AMPS, root, amps});
+
+        float load = propagate( root, dt, volts, amps );
+
+        sol.events.push_back({SolverEvent::APPLY_LOAD, root, load});
+        if ( node->apply_load( load, dt ) < 0.0 ) {
+            SG_LOG(SG_SYSTEMS, SG_ALERT,
+                   "Error drawing more current than available!");
+        }
+    }
+
+    sol.volts.resize(count);
+    sol.loads.resize(count);
+    sol.available.resize(count);
+    for ( size_t i = 0; i < count; ++i ) {
+        const FGElectricalComponent *c = _nodes[i].component;
+        sol.volts[i] = c->get_volts();
+        sol.loads[i] = c->get_load_amps();
+        sol.available[i] = c->get_available_amps();
+    }
+
+    // only the last publication of each node determines the property
+    // values, keep those in order
+    std::vector<bool> seen(count, false);
+    auto keep = std::remove_if(sol.published.rbegin(), sol.published.rend(),
+                               [&seen](unsigned int i) {
+                                   const bool dup = seen[i];
+                                   seen[i] = true;
+                                   return dup;
+                               });
+    sol.published.erase(sol.published.begin(), keep.base());
+
+    sol.valid = true;
+}
+
+
 // propagate the electrical current through the network, returns the
 // total current drawn by the children of this node.
-float FGElectricalSystem::propagate( FGElectricalComponent *node, double dt,
-                                     float input_volts, float input_amps,
-                                     string s ) {
-    s += " ";
+float FGElectricalSystem::propagate( unsigned int index, double dt,
+                                     float input_volts, float input_amps ) {
+    const CompiledNode& n = _nodes[index];
+    FGElectricalComponent *node = n.component;
 
     float total_load = 0.0;
 
@@ -642,88 +743,143 @@ float FGElectricalSystem::propagate( FGElectricalComponent *node, double dt,
     float volts = 0.0;
     if ( !_serviceable) {
         volts = 0;
-    } else if ( node->get_kind() == FGElectricalComponent::FG_SUPPLIER ) {
-        // cout << s << "is a supplier (" << node->get_name() << ")" << endl;
-        FGElectricalSupplier *supplier = (FGElectricalSupplier *)node;
-        if ( supplier->get_model() == FGElectricalSupplier::FG_BATTERY ) {
-            // cout << s << " (and is a battery)" << endl;
-            float battery_volts = supplier->get_output_volts();
+    } else if ( n.kind == FGElectricalComponent::FG_SUPPLIER ) {
+        if ( n.battery ) {
+            float battery_volts = n.supplier->get_output_volts();
+            _solution.events.push_back({SolverEvent::READ_VOLTS, index, battery_volts});
             if ( battery_volts < (input_volts - 0.1) ) {
                 // special handling of a battery charge condition
-                // cout << s << "  (and is being charged) in v = "
-                //      << input_volts << " current v = " << battery_volts
-                //      << endl;
-                supplier->apply_load( -supplier->get_charge_amps(), dt );
-                return supplier->get_charge_amps();
+                const float charge = n.supplier->get_charge_amps();
+                _solution.events.push_back({SolverEvent::APPLY_CHARGE, index, -charge});
+                n.supplier->apply_load( -charge, dt );
+                return charge;
             }
         }
         volts = input_volts;
-    } else if ( node->get_kind() == FGElectricalComponent::FG_BUS ) {
-        // cout << s << "is a bus (" << node->get_name() << ")" << endl;
+    } else if ( n.kind == FGElectricalComponent::FG_BUS ) {
         volts = input_volts;
-    } else if ( node->get_kind() == FGElectricalComponent::FG_OUTPUT ) {
-        // cout << s << "is an output (" << node->get_name() << ")" << endl;
+    } else if ( n.kind == FGElectricalComponent::FG_OUTPUT ) {
         volts = input_volts;
         if ( volts > 1.0 ) {
             // draw current if we have voltage
             total_load = node->get_load_amps();
         }
-    } else if ( node->get_kind() == FGElectricalComponent::FG_CONNECTOR ) {
-        // cout << s << "is a connector (" << node->get_name() << ")" << endl;
-        if ( ((FGElectricalConnector *)node)->get_state() ) {
+    } else if ( n.kind == FGElectricalComponent::FG_CONNECTOR ) {
+        if ( switchesClosed( index ) ) {
             volts = input_volts;
         } else {
             volts = 0.0;
         }
-        // cout << s << "  input_volts = " << volts << endl;
     } else {
         SG_LOG( SG_SYSTEMS, SG_ALERT, "unknown node type" );
     }
 
-    int i;
-
     // if this node has found a stronger power source, update the
     // value and propagate to all children
     if ( volts > node->get_volts() ) {
         node->set_volts( volts );
-        for ( i = 0; i < node->get_num_outputs(); ++i ) {
-            FGElectricalComponent *child = node->get_output(i);
+        for ( unsigned int i = 0; i < n.numOutputs; ++i ) {
+            const unsigned int child = _nodeOutputs[n.firstOutput + i];
             // send current equal to load
-            total_load += propagate( child, dt,
-                                     volts, child->get_load_amps(),
-                                     s );
+            total_load += propagate( child, dt, volts,
+                                     _nodes[child].component->get_load_amps() );
         }
 
         // if not an output node, register the downstream current draw
         // (sum of all children) with this node.  If volts are zero,
         // current draw should be zero.
-        if ( node->get_kind() != FGElectricalComponent::FG_OUTPUT ) {
+        if ( n.kind != FGElectricalComponent::FG_OUTPUT ) {
             node->set_load_amps( total_load );
         }
 
         node->set_available_amps( input_amps - total_load );
 
         node->publishVoltageToProps();
-
-        /*
-        cout << s << node->get_name() << " -> (volts) " << node->get_volts()
-             << endl;
-        cout << s << node->get_name() << " -> (load amps) " << total_load
-             << endl;
-        cout << s << node->get_name() << " -> (input amps) " << input_amps
-             << endl;
-        cout << s << node->get_name() << " -> (extra amps) "
-             << node->get_available_amps() << endl;
-        */
+        _solution.published.push_back( index );
 
         return total_load;
     } else {
-        // cout << s << "no further propagation" << endl;
         return 0.0;
     }
 }
 
 
+bool FGElectricalSystem::replaySolution( double dt ) {
+    Solution& sol = _solution;
+    if ( !sol.valid || (sol.serviceable != _serviceable) ) {
+        return false;
+    }
+
+    for ( size_t i = 0; i < _switchNodes.size(); ++i ) {
+        _switchScratch[i] = _switchNodes[i]->getBoolValue();
+    }
+    if ( _switchScratch != sol.switchStates ) {
+        return false;
+    }
+
+    // loads feed into the available amps, so must match as well. This
+    // holds from the second frame with unchanged inputs on.
+    for ( size_t i = 0; i < _nodes.size(); ++i ) {
+        if ( _nodes[i].component->get_load_amps() != sol.startLoads[i] ) {
+            return false;
+        }
+    }
+
+    // repeat the supplier reads and battery updates in order; any read
+    // which differs means the traversal could too, so undo and solve
+    for ( size_t i = 0; i < _batteries.size(); ++i ) {
+        _batteryScratch[i] = _nodes[_batteries[i]].supplier->get_percent_remaining();
+    }
+
+    int overdrawn = 0;
+    for ( const auto& ev : sol.events ) {
+        FGElectricalSupplier* supplier = _nodes[ev.node].supplier;
+        bool ok = true;
+        switch ( ev.type ) {
+        case SolverEvent::READ_VOLTS:
+            ok = (supplier->get_output_volts() == ev.value);
+            break;
+        case SolverEvent::READ_AMPS:
+            ok = (supplier->get_output_amps() == ev.value);
+            break;
+        case SolverEvent::APPLY_CHARGE:
+            supplier->apply_load( ev.value, dt );
+            break;
+        case SolverEvent::APPLY_LOAD:
+            if ( supplier->apply_load( ev.value, dt ) < 0.0 ) {
+                ++overdrawn;
+            }
+            break;
+        }
+
+        if ( !ok ) {
+            for ( size_t b = 0; b < _batteries.size(); ++b ) {
+                _nodes[_batteries[b]].supplier->set_percent_remaining(_batteryScratch[b]);
+            }
+            return false;
+        }
+    }
+
+    for ( int i = 0; i < overdrawn; ++i ) {
+        SG_LOG(SG_SYSTEMS, SG_ALERT,
+               "Error drawing more current than available!");
+    }
+
+    for ( size_t i = 0; i < _nodes.size(); ++i ) {
+        FGElectricalComponent *c = _nodes[i].component;
+        c->set_volts( sol.volts[i] );
+        c->set_load_amps( sol.loads[i] );
+        c->set_available_amps( sol.available[i] );
+    }
+
+    for ( auto i : sol.published ) {
+        _nodes[i].component->publishVoltageToProps();
+    }
+
+    return true;
+}
+
+
 // search for the named component and return a pointer to it, NULL otherwise
 FGElectricalComponent *FGElectricalSystem::find ( const string &name ) {
     unsigned int i;
@@ -142,6 +142,10 @@ public:
     float get_output_volts();
     float get_output_amps();
     float get_charge_amps() const { return charge_amps; }
+
+    // battery state, so the solver can undo a speculative update
+    float get_percent_remaining() const { return percent_remaining; }
+    void set_percent_remaining( float p ) { percent_remaining = p; }
 };
 
 
@@ -181,6 +185,7 @@ public:
 
     inline bool get_state() const { return switch_node->getBoolValue(); }
     void set_state( bool val ) { switch_node->setBoolValue( val ); }
+    SGPropertyNode* get_node() const { return switch_node; }
 };
 
 
@@ -205,6 +210,8 @@ public:
     void set_switches( bool state );
 
     bool get_state();
+
+    const switch_list& get_switches() const { return switches; }
 };
 
 
@@ -230,9 +237,6 @@ public:
     static const char* staticSubsystemClassId() { return "electrical"; }
 
     bool build (SGPropertyNode* config_props);
-    float propagate( FGElectricalComponent *node, double dt,
-                     float input_volts, float input_amps,
-                     std::string s = "" );
     FGElectricalComponent *find ( const std::string &name );
 
 protected:
@@ -241,6 +245,73 @@ protected:
 private:
     void deleteComponents(comp_list& comps);
 
+    // flatten the component graph into _nodes, once it's built
+    void compile();
+
+    // solve the whole network from scratch, recording the solution
+    void solve( double dt );
+    float propagate( unsigned int index, double dt,
+                     float input_volts, float input_amps );
+    bool switchesClosed( unsigned int index ) const;
+
+    // apply the last solution again, if none of its inputs have changed.
+    // Returns false, with no state modified, if a full solve is needed.
+    bool replaySolution( double dt );
+
+    // a component, with its outputs and switches as ranges of
+    // _nodeOutputs and _switchNodes
+    struct CompiledNode {
+        FGElectricalComponent* component;
+        FGElectricalSupplier* supplier; // null unless a supplier
+        int kind;
+        bool battery;
+        unsigned int firstOutput, numOutputs;
+        unsigned int firstSwitch, numSwitches;
+    };
+
+    // the supplier reads and battery updates made while solving. The
+    // traversal only depends on these, the switch states, the
+    // serviceable flag and the component loads, so while they all
+    // repeat, the previous solution can be re-used.
+    struct SolverEvent {
+        enum Type {
+            READ_VOLTS,
+            READ_AMPS,
+            APPLY_CHARGE,
+            APPLY_LOAD
+        };
+
+        Type type;
+        unsigned int node;
+        float value;
+    };
+
+    struct Solution {
+        bool valid = false;
+        bool serviceable = true;
+        std::vector<char> switchStates;
+        std::vector<float> startLoads;
+        std::vector<SolverEvent> events;
+
+        // results, indexed like _nodes
+        std::vector<float> volts;
+        std::vector<float> loads;
+        std::vector<float> available;
+        // nodes to publish, in order of their final publication
+        std::vector<unsigned int> published;
+    };
+
+    std::vector<CompiledNode> _nodes;
+    std::vector<unsigned int> _nodeOutputs;
+    std::vector<SGPropertyNode*> _switchNodes;
+    std::vector<unsigned int> _roots; // externals, alternators, batteries
+    std::vector<unsigned int> _batteries;
+
+    bool _cacheSolutions = true;
+    Solution _solution;
+    std::vector<char> _switchScratch;
+    std::vector<float> _batteryScratch;
+
     std::string name;
     int num;
     std::string path;
@@ -256,6 +327,14 @@ private:
     SGPropertyNode_ptr _amps_out;
     SGPropertyNode_ptr _serviceable_node;
     bool _serviceable = true;
+
+    // inputs of the simplistic /systems/electrical/{volts,amps} model
+    SGPropertyNode_ptr _master_bat_node;
+    SGPropertyNode_ptr _master_alt_node;
+    SGPropertyNode_ptr _engine_rpm_node;
+    SGPropertyNode_ptr _alternator_node;
+    SGPropertyNode_ptr _beacon_node;
+    SGPropertyNode_ptr _nav_lights_node;
 };
 
 #endif // _SYSTEMS_ELECTRICAL_HXX
@@ -14,6 +14,7 @@
 
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
+#include <Main/PropertyTreeCache.hxx>
 #include <Main/util.hxx>
 
 #include <cstdlib>
@@ -45,7 +46,7 @@ FGSystemMgr::FGSystemMgr ()
                 << config );
         try
         {
-          readProperties( config, config_props );
+          flightgear::PropertyTreeCache::readProperties( config, config_props );
           build(config_props);
         }
         catch( const sg_exception& )
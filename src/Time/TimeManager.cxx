@@ -29,12 +29,14 @@
 #include <simgear/structure/commands.hxx>
 #include <simgear/timing/sg_time.hxx>
 #include <simgear/math/SGMath.hxx>
+#include <simgear/math/sg_random.h>
 
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
 #include <Time/bodysolver.hxx>
 
 #include <algorithm>
+#include <cstdlib>
 
 #ifdef HAVE_UNISTD_H
     #include <unistd.h>    // for gettimeofday() and the _POSIX_TIMERS define
@@ -104,16 +106,36 @@ void TimeManager::init()
   _maxFrameRate  = fgGetNode("/sim/frame-rate-throttle-hz", true);
   _localTimeStringNode = fgGetNode("/sim/time/local-time-string", true);
   _warpDelta = fgGetNode("/sim/time/warp-delta", true);
+
+  _lockStepEnabled = fgGetNode("/sim/time/lock-step/enabled", true);
+  _lockStepFrames = fgGetNode("/sim/time/lock-step/frames-per-update", true);
+  _lockStepFastest = fgGetNode("/sim/time/lock-step/as-fast-as-possible", true);
+  if (isLockStep()) {
+      SGPropertyNode_ptr startTime = fgGetNode("/sim/time/lock-step/start-time-utc", true);
+      if (startTime->getLongValue() == 0) {
+          // record the start time, so the run can be repeated
+          startTime->setLongValue(time(nullptr));
+      }
+
+      _lockStepStartTime = startTime->getLongValue();
+
+      // seed once; fgSeedRandom() leaves the generators alone from now on
+      const int seed = fgGetInt("/sim/time/lock-step/seed", 1);
+      sg_srandom(seed);
+      srand(seed);
+      SG_LOG(SG_GENERAL, SG_INFO, "Lock-step mode, starting at " << _lockStepStartTime
+             << " with seed " << seed);
+  }
   
   SGPath zone(globals->get_fg_root());
   zone.append("Timezone");
   
-  _impl = new SGTime(globals->get_aircraft_position(), zone, _timeOverride->getLongValue());
+  _impl = new SGTime(globals->get_aircraft_position(), zone, timeOverride());
   
   _warpDelta->setDoubleValue(0.0);
   updateLocalTime();
   
-  _impl->update(globals->get_aircraft_position(), _timeOverride->getLongValue(),
+  _impl->update(globals->get_aircraft_position(), timeOverride(),
                _warp->getIntValue());
   globals->set_time_params(_impl);
     
@@ -177,6 +199,10 @@ void TimeManager::unbind()
     _steadyClockDrift.clear();
     _computeDrift.clear();
     _simTimeFactor.clear();
+
+    _lockStepEnabled.clear();
+    _lockStepFrames.clear();
+    _lockStepFastest.clear();
 }
 
 void TimeManager::postinit()
@@ -212,7 +238,7 @@ void TimeManager::valueChanged(SGPropertyNode* aProp)
     }
     
     _impl->update(globals->get_aircraft_position(),
-                   _timeOverride->getLongValue(),
+                   timeOverride(),
                    _warp->getIntValue());
   }
 }
@@ -379,8 +405,72 @@ void TimeManager::computeTimeDeltasSimple(double& simDt, double& realDt)
             );
 }
 
+void TimeManager::computeTimeDeltasLockStep(double& simDt, double& realDt)
+{
+    const double modelHz = _modelHz->getDoubleValue();
+    const int framesPerUpdate = std::max(1, _lockStepFrames->getIntValue());
+
+    if (_firstUpdate) {
+        _firstUpdate = false;
+        _lastStamp.stamp();
+        _dtRemainder = 0.0;
+        _steadyClock = 0.0;
+        _lastClockFreeze = _clockFreeze->getBoolValue();
+
+        SGSubsystemGroup* fdmGroup = globals->get_subsystem_mgr()->get_group(SGSubsystemMgr::FDM);
+        fdmGroup->set_fixed_update_time(1.0 / modelHz);
+    }
+
+    // always a whole number of model steps, with no remainder carried
+    // over, so every run takes the same steps
+    const double dt = framesPerUpdate / modelHz;
+
+    const bool wait_for_scenery = !_sceneryLoaded->getBoolValue();
+    if (wait_for_scenery) {
+        // how many frames it takes to load the scenery depends on the
+        // system, so nothing advances until it is loaded
+        _lastFrameTime = 0;
+        _frameCount = 0;
+        _lastStamp.stamp();
+        simDt = realDt = 0.0;
+    } else {
+        if (!_lockStepFastest->getBoolValue()) {
+            // the wall clock only paces the frames, it never changes dt
+            SGTimeStamp frameWaitStart = SGTimeStamp::now();
+            SGTimeStamp::sleepUntil(_lastStamp + SGTimeStamp::fromSec(dt));
+            _frameWait->setDoubleValue(frameWaitStart.elapsedMSec());
+        }
+
+        SGTimeStamp currentStamp;
+        currentStamp.stamp();
+        _frameLatencyMax = std::max(_frameLatencyMax, (currentStamp - _lastStamp).toSecs());
+        _lastStamp = currentStamp;
+
+        // speed-up does not apply: frames-per-update and as-fast-as-possible
+        // take its place
+        realDt = dt;
+        simDt = _clockFreeze->getBoolValue() ? 0.0 : dt;
+    }
+
+    globals->inc_sim_time_sec(simDt);
+    _steadyClock += realDt;
+    _mpProtocolClock = _steadyClock + _mpClockOffset->getDoubleValue();
+
+    _dtRemainderNode->setDoubleValue(_dtRemainder);
+    _steadyClockNode->setDoubleValue(_steadyClock);
+    _mpProtocolClockNode->setDoubleValue(_mpProtocolClock);
+
+    _timeDelta->setDoubleValue(realDt);
+    _simTimeDelta->setDoubleValue(simDt);
+}
+
 void TimeManager::computeTimeDeltas(double& simDt, double& realDt)
 {
+    if (isLockStep()) {
+        computeTimeDeltasLockStep(simDt, realDt);
+        return;
+    }
+
     if (_simpleTimeEnabled->getBoolValue()) {
         computeTimeDeltasSimple(simDt, realDt);
         return;
@@ -500,7 +590,10 @@ void TimeManager::update(double dt)
   bool freeze = _clockFreeze->getBoolValue();
   time_t now = time(NULL);
 
-  if (freeze) {
+  if (isLockStep()) {
+    // the calendar follows the simulation time, which already stops while
+    // frozen, so the warp needs no adjustment
+  } else if (freeze) {
     // clock freeze requested
     if (_timeOverride->getLongValue() == 0) {
       _timeOverride->setLongValue(now);
@@ -552,7 +645,7 @@ void TimeManager::update(double dt)
 
   _lastClockFreeze = freeze;
   _impl->update(globals->get_aircraft_position(),
-               _timeOverride->getLongValue(),
+               timeOverride(),
                _warp->getIntValue());
 
   updateLocalTimeString();
@@ -705,6 +798,20 @@ double TimeManager::getSimSpeedUpFactor() const
     return _simTimeFactor->getDoubleValue();
 }
 
+bool TimeManager::isLockStep() const
+{
+    return _lockStepEnabled && _lockStepEnabled->getBoolValue();
+}
+
+time_t TimeManager::timeOverride() const
+{
+    if (isLockStep()) {
+        return _lockStepStartTime + static_cast<time_t>(globals->get_sim_time_sec());
+    }
+
+    return _timeOverride->getLongValue();
+}
+
 // Register the subsystem.
 SGSubsystemMgr::Registrant<TimeManager> registrantTimeManager(
     SGSubsystemMgr::INIT,
@@ -52,6 +52,19 @@ public:
     
     void computeTimeDeltasSimple(double& simDt, double& realDt);
 
+    /**
+     * Deterministic lock-step mode, for headless and scenario runs: every
+     * frame advances the simulation by exactly
+     * /sim/time/lock-step/frames-per-update steps of 1/model-hz, and the
+     * calendar time follows the simulation time from
+     * /sim/time/lock-step/start-time-utc, so nothing depends on the system
+     * clock. Frames are paced to real time, unless
+     * /sim/time/lock-step/as-fast-as-possible is set.
+     */
+    void computeTimeDeltasLockStep(double& simDt, double& realDt);
+
+    bool isLockStep() const;
+
     // SGPropertyChangeListener overrides
     void valueChanged(SGPropertyNode *) override;
 
@@ -84,6 +97,9 @@ private:
     // set up a time offset (aka warp) if one is specified
     void initTimeOffset();
 
+    // the time SGTime should use instead of the system clock, or zero
+    time_t timeOverride() const;
+
     bool _inited;
     SGTime* _impl;
     SGTimeStamp _lastStamp;
@@ -132,6 +148,11 @@ private:
     SGPropertyNode_ptr _simpleTimeFdm;
     double _simple_time_utc;
     double _simple_time_fdm;
+
+    SGPropertyNode_ptr _lockStepEnabled;
+    SGPropertyNode_ptr _lockStepFrames;
+    SGPropertyNode_ptr _lockStepFastest;
+    time_t _lockStepStartTime = 0;
 };
 
 #endif // of FG_TIME_TIMEMANAGER_HXX
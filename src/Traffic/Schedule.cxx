@@ -50,6 +50,7 @@
 #include <AIModel/AIManager.hxx>
 #include <AIModel/AIAircraft.hxx>
 #include <Airports/airport.hxx>
+#include <Airports/airportdynamicsmanager.hxx>
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
 
@@ -202,10 +203,7 @@ bool FGAISchedule::init()
 bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
 {
 
-  time_t totalTimeEnroute,
-         elapsedTimeEnroute,
-         //remainingTimeEnroute,
-         deptime = 0;
+  time_t deptime = 0;
 
   if (!valid) {
     return true; // processing complete
@@ -270,6 +268,45 @@ bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
     return true; // processing complete
   }
 
+  double speed = updatePosition(flight, now, userCart);
+
+
+  // If distance between user and simulated aircraft is less
+  // then 500nm, create this flight. At jet speeds 500 nm is roughly
+  // one hour flight time, so that would be a good approximate point
+  // to start a more detailed simulation of this aircraft.
+  SG_LOG (SG_AI, SG_BULK, "Traffic manager: " << registration << " is scheduled for a flight from "
+	     << dep->getId() << " to " << arr->getId() << ". Current distance to user: "
+             << distanceToUser);
+  // load the ground networks in the background before they are needed
+  bool airportsReady = true;
+  if (distanceToUser < TRAFFICTOAIDISTTOPREFETCH) {
+    airportsReady = flightgear::AirportDynamicsManager::prefetch(dep);
+    airportsReady = flightgear::AirportDynamicsManager::prefetch(arr) && airportsReady;
+  }
+
+  if (distanceToUser >= TRAFFICTOAIDISTTOSTART) {
+    return true; // out of visual range, for the moment.
+  }
+
+  if (!airportsReady) {
+    return false; // try again once the airports are loaded
+  }
+
+  if (!createAIAircraft(flight, speed, deptime)) {
+      valid = false;
+  }
+
+
+    return true; // processing complete
+}
+
+double FGAISchedule::updatePosition(FGScheduledFlight* flight, time_t now, const SGVec3d& userCart)
+{
+  FGAirport* dep = flight->getDepartureAirport();
+  FGAirport* arr = flight->getArrivalAirport();
+  time_t totalTimeEnroute, elapsedTimeEnroute;
+
   double speed = 450.0;
   if (dep != arr) {
     totalTimeEnroute = flight->getArrivalTime() - flight->getDepartureTime();
@@ -307,25 +344,44 @@ bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
   // cartesian calculations are more numerically stable over the (potentially)
   // large distances involved here: see bug #80
   distanceToUser = dist(userCart, SGVec3d::fromGeod(position)) * SG_METER_TO_NM;
+  return speed;
+}
 
+time_t FGAISchedule::getNextUpdateTime(time_t now, const SGVec3d& userCart, time_t maxInterval)
+{
+  if (!scheduleComplete || flights.empty()) {
+    return now;
+  }
 
-  // If distance between user and simulated aircraft is less
-  // then 500nm, create this flight. At jet speeds 500 nm is roughly
-  // one hour flight time, so that would be a good approximate point
-  // to start a more detailed simulation of this aircraft.
-  SG_LOG (SG_AI, SG_BULK, "Traffic manager: " << registration << " is scheduled for a flight from "
-	     << dep->getId() << " to " << arr->getId() << ". Current distance to user: "
-             << distanceToUser);
-  if (distanceToUser >= TRAFFICTOAIDISTTOSTART) {
-    return true; // out of visual range, for the moment.
+  time_t next = now + maxInterval;
+  if (aiAircraft) {
+    // in visual range, only check back occasionally whether it died
+    return std::min(next, now + 10);
   }
 
-  if (!createAIAircraft(flight, speed, deptime)) {
-      valid = false;
+  // the current leg has to be advanced once it is in the past
+  FGScheduledFlight* flight = flights.front();
+  if (flight->getArrivalTime() < now) {
+    return now;
   }
+  next = std::min(next, flight->getArrivalTime());
 
+  // update() returns before computing the distance when it moves on to the
+  // next leg, so the one it left may belong to the previous leg
+  if (!flight->getDepartureAirport() || !flight->getArrivalAirport()) {
+    return next;
+  }
+  updatePosition(flight, now, userCart);
+
+  if (distanceToUser >= TRAFFICTOAIDISTTOPREFETCH) {
+    double closingSec = (distanceToUser - TRAFFICTOAIDISTTOPREFETCH) / TRAFFICMAXCLOSINGSPEED * 3600.0;
+    next = std::min(next, now + (time_t) closingSec);
+  } else if (distanceToUser >= TRAFFICTOAIDISTTOSTART) {
+    double closingSec = (distanceToUser - TRAFFICTOAIDISTTOSTART) / TRAFFICMAXCLOSINGSPEED * 3600.0;
+    next = std::min(next, now + (time_t) closingSec);
+  }
 
-    return true; // processing complete
+  return std::max(next, now);
 }
 
 bool FGAISchedule::validModelPath(const std::string& modelPath)
@@ -30,7 +30,11 @@
 #define _FGSCHEDULE_HXX_
 
 #define TRAFFICTOAIDISTTOSTART 150.0
+// worst case closing speed of a distant AI aircraft and the user, in knots
+#define TRAFFICMAXCLOSINGSPEED 1200.0
 #define TRAFFICTOAIDISTTODIE   200.0
+// distance at which the ground networks of the airports start loading
+#define TRAFFICTOAIDISTTOPREFETCH 200.0
 
 // forward decls
 class FGAIAircraft;
@@ -75,6 +79,13 @@ class FGAISchedule
    * create the AIAircraft (and flight plan) and register with the AIManager
    */
   bool createAIAircraft(FGScheduledFlight* flight, double speedKnots, time_t deptime);
+
+  /**
+   * Move to the position along the given leg at the given time, and update
+   * the distance to the user.
+   * @return the speed to start the AI aircraft with, in knots
+   */
+  double updatePosition(FGScheduledFlight* flight, time_t now, const SGVec3d& userCart);
   
   // the aiAircraft associated with us
   SGSharedPtr<FGAIAircraft> aiAircraft;
@@ -104,6 +115,18 @@ class FGAISchedule
   bool update(time_t now, const SGVec3d& userCart);
   bool init();
 
+  /**
+   * Earliest time at which another update() can change anything for this
+   * schedule: when the current leg ends, or when the aircraft could come
+   * within TRAFFICTOAIDISTTOPREFETCH or TRAFFICTOAIDISTTOSTART of the user
+   * at the worst case closing speed. The distance to the user is computed
+   * afresh, since update() may have moved on to another leg without it.
+   * Never later than now + maxInterval.
+   */
+  time_t getNextUpdateTime(time_t now, const SGVec3d& userCart, time_t maxInterval);
+  bool isValid() const { return valid; }
+  double getDistanceToUser() const { return distanceToUser; }
+
   double getSpeed         ();
   //void setClosestDistanceToUser();
   bool next();   // forces the schedule to move on to the next flight.
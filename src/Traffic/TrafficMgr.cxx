@@ -62,6 +62,7 @@
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/threads/SGThread.hxx>
 #include <simgear/timing/sg_time.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <simgear/xml/easyxml.hxx>
 #include <simgear/scene/tsync/terrasync.hxx>
@@ -435,6 +436,8 @@ FGTrafficManager::FGTrafficManager() :
   doingInit(false),
   trafficSyncRequested(false),
   waitingMetarTime(0.0),
+  lastUpdateTime(0),
+  lastWarp(0),
   enabled("/sim/traffic-manager/enabled"),
   aiEnabled("/sim/ai/enabled"),
   realWxEnabled("/environment/realwx/enabled"),
@@ -505,6 +508,7 @@ void FGTrafficManager::shutdown()
         cachefile.close();
     }
     scheduledAircraft.clear();
+    scheduleQueue.clear();
 
     for (auto flight : flights) {
         for (auto scheduled : flight.second)
@@ -512,7 +516,6 @@ void FGTrafficManager::shutdown()
     }
     flights.clear();
 
-    currAircraft = scheduledAircraft.begin();
     doingInit = false;
     inited = false;
     trafficSyncRequested = false;
@@ -625,9 +628,11 @@ void FGTrafficManager::finishInit()
 
     sort(scheduledAircraft.begin(), scheduledAircraft.end(),
          compareSchedules);
-    currAircraft = scheduledAircraft.begin();
     currAircraftClosest = scheduledAircraft.begin();
 
+    initScheduler(globals->get_time_params()->get_cur_time(),
+                  globals->get_aircraft_position_cart());
+
     doingInit = false;
     inited = true;
     active = true;
@@ -676,13 +681,13 @@ void FGTrafficManager::loadHeuristics()
       }
     }
 
-  for(currAircraft = scheduledAircraft.begin(); currAircraft != scheduledAircraft.end(); ++currAircraft) {
-        const string& registration = (*currAircraft)->getRegistration();
+  for (auto schedule : scheduledAircraft) {
+        const string& registration = schedule->getRegistration();
         HeuristicMapIterator itr = heurMap.find(registration);
         if (itr != heurMap.end()) {
-            (*currAircraft)->setrunCount(itr->second.runCount);
-            (*currAircraft)->setHits(itr->second.hits);
-            (*currAircraft)->setLastUsed(itr->second.lastRun);
+            schedule->setrunCount(itr->second.runCount);
+            schedule->setHits(itr->second.hits);
+            schedule->setLastUsed(itr->second.lastRun);
         }
     }
 }
@@ -757,18 +762,117 @@ void FGTrafficManager::update(double dt)
     }
 
     SGVec3d userCart = globals->get_aircraft_position_cart();
+    time_t now = globals->get_time_params()->get_cur_time();
+
+    updateSchedules(now, userCart);
+}
 
-    if (currAircraft == scheduledAircraft.end()) {
-        currAircraft = scheduledAircraft.begin();
+void FGTrafficManager::initScheduler(time_t now, const SGVec3d& userCart)
+{
+    SGPropertyNode_ptr schedulerNode = fgGetNode("/sim/traffic-manager/scheduler", true);
+    _budgetUsecNode = schedulerNode->getNode("budget-usec", true);
+    if (!_budgetUsecNode->hasValue()) {
+        _budgetUsecNode->setIntValue(500);
+    }
+    _maxIntervalNode = schedulerNode->getNode("max-interval-sec", true);
+    if (!_maxIntervalNode->hasValue()) {
+        _maxIntervalNode->setIntValue(300);
     }
+    _backlogNode = schedulerNode->getNode("backlog", true);
+    _processedNode = schedulerNode->getNode("processed", true);
+    _latencyNode = schedulerNode->getNode("latency-sec", true);
+    _queueSizeNode = schedulerNode->getNode("queue-size", true);
+    _warpNode = fgGetNode("/sim/time/warp", true);
+
+    lastUserCart = userCart;
+    lastUpdateTime = now;
+    lastWarp = _warpNode->getIntValue();
+    rebuildScheduleQueue(now);
+}
 
-    time_t now = globals->get_time_params()->get_cur_time();
+void FGTrafficManager::testSuiteSetSchedules(const ScheduleVector& schedules, time_t now, const SGVec3d& userCart)
+{
+    scheduledAircraft = schedules;
+    initScheduler(now, userCart);
+}
+
+void FGTrafficManager::rebuildScheduleQueue(time_t now)
+{
+    // everything is due now, in order of the schedule score
+    scheduleQueue.clear();
+    scheduleQueue.reserve(scheduledAircraft.size());
+    double rank = 0.0;
+    for (auto schedule : scheduledAircraft) {
+        scheduleQueue.push_back({now, rank, schedule});
+        rank += 1.0;
+    }
+    std::make_heap(scheduleQueue.begin(), scheduleQueue.end());
+}
+
+void FGTrafficManager::updateSchedules(time_t now, const SGVec3d& userCart)
+{
+    // after a relocation all estimates of when traffic can come into
+    // range are wrong, start over
+    if (dist(userCart, lastUserCart) * SG_METER_TO_NM > TRAFFICTOAIDISTTOSTART / 2) {
+        SG_LOG(SG_AI, SG_DEBUG, "Traffic manager: user relocated, rescheduling all traffic");
+        rebuildScheduleQueue(now);
+    } else if ((now < lastUpdateTime) || (_warpNode->getIntValue() != lastWarp)) {
+        // the due times are in simulated time, which includes the warp:
+        // when it went back, the queue would stall until it caught up again
+        SG_LOG(SG_AI, SG_DEBUG, "Traffic manager: time offset changed, rescheduling all traffic");
+        rebuildScheduleQueue(now);
+    }
+    lastUserCart = userCart;
+    lastUpdateTime = now;
+    lastWarp = _warpNode->getIntValue();
+
+    const time_t maxInterval = std::max(1, _maxIntervalNode->getIntValue());
+    const double budgetUsec = _budgetUsecNode->getIntValue();
+    SGTimeStamp start;
+    start.stamp();
+
+    int processed = 0;
+    time_t maxLatency = 0;
+    // always make progress by at least one schedule, as before
+    while (!scheduleQueue.empty() && (scheduleQueue.front().due <= now)) {
+        if ((processed > 0) && (start.elapsedUSec() >= budgetUsec)) {
+            break;
+        }
+
+        std::pop_heap(scheduleQueue.begin(), scheduleQueue.end());
+        ScheduleQueueEntry entry = scheduleQueue.back();
+        scheduleQueue.pop_back();
+
+        maxLatency = std::max(maxLatency, now - entry.due);
+        ++processed;
 
-    //cerr << "Processing << " << (*currAircraft)->getRegistration() << " with score " << (*currAircraft)->getScore() << endl;
-    if ((*currAircraft)->update(now, userCart)) {
-        // schedule is done - process another aircraft in next iteration
-        currAircraft++;
+        FGAISchedule* schedule = entry.schedule;
+        if (schedule->update(now, userCart)) {
+            if (!schedule->isValid()) {
+                continue; // will never do anything again
+            }
+            entry.due = schedule->getNextUpdateTime(now, userCart, maxInterval);
+        } else {
+            // not ready yet, continue processing in the next frame
+            entry.due = now + 1;
+        }
+
+        entry.rank = schedule->getDistanceToUser();
+        scheduleQueue.push_back(entry);
+        std::push_heap(scheduleQueue.begin(), scheduleQueue.end());
     }
+
+    int backlog = 0;
+    if (!scheduleQueue.empty() && (scheduleQueue.front().due <= now)) {
+        // only counted when we're behind
+        backlog = std::count_if(scheduleQueue.begin(), scheduleQueue.end(),
+                                [now](const ScheduleQueueEntry& e) { return e.due <= now; });
+    }
+
+    _processedNode->setIntValue(processed);
+    _backlogNode->setIntValue(backlog);
+    _latencyNode->setIntValue(maxLatency);
+    _queueSizeNode->setIntValue(scheduleQueue.size());
 }
 
 void FGTrafficManager::readTimeTableFromFile(SGPath infileName)
@@ -85,7 +85,39 @@ private:
     std::string waitingMetarStation;
 
     ScheduleVector scheduledAircraft;
-    ScheduleVectorIterator currAircraft, currAircraftClosest;
+    ScheduleVectorIterator currAircraftClosest;
+
+    // Schedules are updated in order of their next event time, closest to
+    // the user first, for as long as the per-frame time budget allows.
+    struct ScheduleQueueEntry
+    {
+        time_t due;
+        // orders entries due at the same time, lowest first: the position
+        // in the schedule score order after a rebuild, then the distance to
+        // the user
+        double rank;
+        FGAISchedule* schedule;
+
+        // heap order: the entry due first (then lowest ranked) is on top
+        bool operator<(const ScheduleQueueEntry& other) const
+        {
+            if (due != other.due)
+                return due > other.due;
+            return rank > other.rank;
+        }
+    };
+
+    std::vector<ScheduleQueueEntry> scheduleQueue;
+    SGVec3d lastUserCart;
+    time_t lastUpdateTime;
+    int lastWarp;
+
+    void initScheduler(time_t now, const SGVec3d& userCart);
+    void rebuildScheduleQueue(time_t now);
+    void updateSchedules(time_t now, const SGVec3d& userCart);
+
+    SGPropertyNode_ptr _budgetUsecNode, _maxIntervalNode, _warpNode;
+    SGPropertyNode_ptr _backlogNode, _processedNode, _latencyNode, _queueSizeNode;
 
     FGScheduledFlightMap flights;
 
@@ -121,6 +153,13 @@ public:
     // Subsystem identification.
     static const char* staticSubsystemClassId() { return "traffic-manager"; }
 
+    /**
+     * For the test suite: run the scheduler on the given schedules, which
+     * stay owned by the caller, without loading any traffic files.
+     */
+    void testSuiteSetSchedules(const ScheduleVector& schedules, time_t now, const SGVec3d& userCart);
+    void testSuiteUpdateSchedules(time_t now, const SGVec3d& userCart) { updateSchedules(now, userCart); }
+
     FGScheduledFlightVecIterator getFirstFlight(const std::string &ref) { return flights[ref].begin(); }
     FGScheduledFlightVecIterator getLastFlight(const std::string &ref) { return flights[ref].end(); }
 };
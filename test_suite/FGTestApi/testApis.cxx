@@ -9,6 +9,11 @@
 
 void FGAirport::testSuiteInjectGroundnetXML(const SGPath& path)
 {
+    // wait for, and discard, any background load
+    if (_groundNetworkLoad.valid()) {
+        _groundNetworkLoad.get();
+    }
+
     _groundNetwork.reset(new FGGroundNetwork(const_cast<FGAirport*>(this)));
     XMLLoader::loadFromPath(_groundNetwork.get(), path);
     _groundNetwork->init();
@@ -0,0 +1,222 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+#include <vector>
+
+#include <cJSON.h>
+
+#include <simgear/io/iostreams/sgstream.hxx>
+
+#include "formatting.hxx"
+#include "perfResults.hxx"
+
+
+// The median of sorted values.
+static double median(const std::vector<double>& sorted)
+{
+    const size_t n = sorted.size();
+    if (n == 0)
+        return 0.0;
+    return (n % 2) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+
+// Time a benchmark.
+const PerfStats& PerfResults::measure(const std::string& name, const std::function<void()>& fn,
+                                      int iterations)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Warm up the caches, and anything initialised lazily.
+    for (int i = 0; i < _warmUp; ++i)
+        fn();
+
+    std::vector<double> samples;
+    samples.reserve(_repeats);
+    for (int i = 0; i < std::max(_repeats, 1); ++i) {
+        const auto start = Clock::now();
+        fn();
+        const std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+        samples.push_back(elapsed.count() / std::max(iterations, 1));
+    }
+
+    // The statistics.
+    PerfStats stats;
+    stats.name = name;
+    stats.samples = static_cast<int>(samples.size());
+    stats.iterations = iterations;
+
+    std::sort(samples.begin(), samples.end());
+    stats.median = median(samples);
+    stats.min = samples.front();
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+
+    // Nearest rank.
+    const size_t rank = static_cast<size_t>(std::ceil(0.95 * samples.size()));
+    stats.p95 = samples[std::min(std::max(rank, size_t(1)), samples.size()) - 1];
+
+    std::vector<double> deviations;
+    std::transform(samples.begin(), samples.end(), std::back_inserter(deviations),
+                   [&stats](double s) { return std::fabs(s - stats.median); });
+    std::sort(deviations.begin(), deviations.end());
+    stats.mad = median(deviations);
+
+    // Compare with the baseline.  A regression must be beyond both the
+    // threshold and the noise, taken as three standard deviations
+    // estimated from the MAD.
+    auto it = _baseline.find(name);
+    if (it != _baseline.end()) {
+        stats.haveBaseline = true;
+        stats.baselineMedian = it->second.median;
+        stats.threshold = it->second.threshold;
+        const double slowdown = stats.median - stats.baselineMedian;
+        stats.regressed = (slowdown > stats.baselineMedian * stats.threshold) &&
+                          (slowdown > 3.0 * 1.4826 * stats.mad);
+    }
+
+    _results.push_back(stats);
+    return _results.back();
+}
+
+
+// Read the baseline.
+int PerfResults::loadBaseline(const SGPath& path)
+{
+    sg_ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open the performance baseline \"" << path.utf8Str() << "\"." << std::endl;
+        return 1;
+    }
+
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    cJSON* json = cJSON_Parse(contents.str().c_str());
+    cJSON* benchmarks = json ? cJSON_GetObjectItem(json, "benchmarks") : nullptr;
+    if (!benchmarks || (benchmarks->type != cJSON_Array)) {
+        std::cerr << "The performance baseline \"" << path.utf8Str() << "\" is not valid." << std::endl;
+        cJSON_Delete(json);
+        return 1;
+    }
+
+    for (int i = 0; i < cJSON_GetArraySize(benchmarks); ++i) {
+        cJSON* b = cJSON_GetArrayItem(benchmarks, i);
+        cJSON* name = cJSON_GetObjectItem(b, "name");
+        cJSON* median = cJSON_GetObjectItem(b, "median");
+        cJSON* threshold = cJSON_GetObjectItem(b, "threshold");
+        if (!name || (name->type != cJSON_String) || !median || (median->type != cJSON_Number))
+            continue;
+
+        Baseline entry;
+        entry.median = median->valuedouble;
+        entry.threshold = (threshold && (threshold->type == cJSON_Number)) ? threshold->valuedouble : _threshold;
+        _baseline[name->valuestring] = entry;
+    }
+
+    cJSON_Delete(json);
+    return 0;
+}
+
+
+// Write the results as JSON.
+int PerfResults::writeJSON(const SGPath& path) const
+{
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "version", 1);
+    cJSON_AddStringToObject(json, "unit", "usec");
+    cJSON_AddNumberToObject(json, "warm-up", _warmUp);
+    cJSON_AddNumberToObject(json, "repeats", _repeats);
+
+    cJSON* benchmarks = cJSON_CreateArray();
+    for (const auto& stats : _results) {
+        cJSON* b = cJSON_CreateObject();
+        cJSON_AddStringToObject(b, "name", stats.name.c_str());
+        cJSON_AddNumberToObject(b, "samples", stats.samples);
+        cJSON_AddNumberToObject(b, "iterations", stats.iterations);
+        cJSON_AddNumberToObject(b, "median", stats.median);
+        cJSON_AddNumberToObject(b, "p95", stats.p95);
+        cJSON_AddNumberToObject(b, "mad", stats.mad);
+        cJSON_AddNumberToObject(b, "min", stats.min);
+        cJSON_AddNumberToObject(b, "mean", stats.mean);
+        if (stats.haveBaseline) {
+            cJSON_AddNumberToObject(b, "baseline-median", stats.baselineMedian);
+            cJSON_AddNumberToObject(b, "threshold", stats.threshold);
+            cJSON_AddBoolToObject(b, "regressed", stats.regressed);
+        }
+        cJSON_AddItemToArray(benchmarks, b);
+    }
+    cJSON_AddItemToObject(json, "benchmarks", benchmarks);
+
+    char* text = cJSON_Print(json);
+    sg_ofstream file(path, std::ios::out | std::ios::trunc);
+    file << text << std::endl;
+    const bool ok = file.good();
+    free(text);
+    cJSON_Delete(json);
+
+    if (!ok) {
+        std::cerr << "Cannot write the performance results to \"" << path.utf8Str() << "\"." << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+
+// Print the results.
+int PerfResults::report(CppUnit::OStream& stream) const
+{
+    if (_results.empty())
+        return 0;
+
+    std::string text = "Performance test results (usec)";
+    printSection(stream, text);
+
+    char buffer[200];
+    snprintf(buffer, sizeof(buffer), "%-34s %10s %10s %10s %10s\n", "Benchmark", "median", "p95", "MAD", "baseline");
+    stream << buffer;
+
+    int regressions = 0;
+    for (const auto& stats : _results) {
+        std::string name = stats.name;
+        if (name.size() > 34)
+            name = name.substr(0, 31) + "...";
+        snprintf(buffer, sizeof(buffer), "%-34s %10.3f %10.3f %10.3f", name.c_str(), stats.median, stats.p95, stats.mad);
+        stream << buffer;
+
+        if (stats.haveBaseline) {
+            const double change = 100.0 * (stats.median - stats.baselineMedian) / stats.baselineMedian;
+            snprintf(buffer, sizeof(buffer), " %10.3f %+6.1f%%", stats.baselineMedian, change);
+            stream << buffer;
+            if (stats.regressed) {
+                stream << " REGRESSION";
+                ++regressions;
+            }
+        }
+        stream << "\n";
+    }
+    stream << std::endl;
+
+    return regressions;
+}
@@ -0,0 +1,106 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FG_TEST_SUITE_PERF_RESULTS_HXX
+#define _FG_TEST_SUITE_PERF_RESULTS_HXX
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+
+#include <cppunit/portability/Stream.h>
+
+#include <simgear/misc/sg_path.hxx>
+
+
+// The statistics of a benchmark, with times in microseconds per iteration.
+struct PerfStats {
+    std::string name;
+    int samples = 0;
+    int iterations = 1;
+    double median = 0.0;
+    double p95 = 0.0;
+    double mad = 0.0;   // median absolute deviation
+    double min = 0.0;
+    double mean = 0.0;
+
+    // The baseline comparison, if the baseline has this benchmark.
+    bool haveBaseline = false;
+    double baselineMedian = 0.0;
+    double threshold = 0.0;
+    bool regressed = false;
+};
+
+
+// The performance test singleton, timing the benchmarks of the performance
+// tests and collecting their results.
+class PerfResults
+{
+public:
+    // Return the singleton, instantiating it if required.
+    static PerfResults& get()
+    {
+        static PerfResults instance;
+        return instance;
+    }
+
+    // Function deletion to allow the class to be a singleton.
+    PerfResults(PerfResults const&) = delete;
+    void operator=(PerfResults const&) = delete;
+
+    // Settings.
+    void setWarmUp(int runs) { _warmUp = runs; }
+    void setRepeats(int runs) { _repeats = runs; }
+    void setThreshold(double fraction) { _threshold = fraction; }
+
+    // Time a benchmark.  fn is run untimed for the warm-up runs, then timed
+    // for each of the repeats.  iterations is the number of operations fn
+    // performs per run, so the statistics are per operation.
+    const PerfStats& measure(const std::string& name, const std::function<void()>& fn,
+                             int iterations = 1);
+
+    // Read the baseline, a JSON file written by writeJSON().  A benchmark
+    // entry may have a "threshold" overriding the default.
+    int loadBaseline(const SGPath& path);
+
+    // Write the results as JSON.
+    int writeJSON(const SGPath& path) const;
+
+    // Print the results, and the comparison with the baseline.  Returns
+    // the number of regressions.
+    int report(CppUnit::OStream& stream) const;
+
+private:
+    PerfResults() = default;
+
+    struct Baseline {
+        double median;
+        double threshold;
+    };
+
+    int _warmUp = 3;
+    int _repeats = 20;
+    // allowed slowdown of the median, relative to the baseline
+    double _threshold = 0.1;
+
+    std::map<std::string, Baseline> _baseline;
+    std::deque<PerfStats> _results;
+};
+
+
+#endif // _FG_TEST_SUITE_PERF_RESULTS_HXX
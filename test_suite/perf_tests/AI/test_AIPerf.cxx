@@ -0,0 +1,84 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_AIPerf.hxx"
+
+#include <string>
+
+#include "test_suite/FGTestApi/NavDataCache.hxx"
+#include "test_suite/FGTestApi/testGlobals.hxx"
+#include "test_suite/perfResults.hxx"
+
+#include <AIModel/AIManager.hxx>
+#include <Airports/airport.hxx>
+#include <Main/globals.hxx>
+
+
+// Set up function for each test.
+void AIPerfTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("ai-perf");
+    FGTestApi::setUp::initNavDataCache();
+
+    globals->add_new_subsystem<FGAIManager>(SGSubsystemMgr::POST_FDM);
+
+    auto props = globals->get_props();
+    props->setBoolValue("sim/ai/enabled", true);
+
+    globals->get_subsystem_mgr()->bind();
+    globals->get_subsystem_mgr()->init();
+    globals->get_subsystem_mgr()->postinit();
+}
+
+
+// Clean up after each test.
+void AIPerfTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+// An AI manager update with a busy sky: aircraft circling around EGGD.
+void AIPerfTests::testUpdate()
+{
+    auto aim = globals->get_subsystem<FGAIManager>();
+    auto eggd = FGAirport::findByIdent("EGGD");
+    CPPUNIT_ASSERT(eggd);
+
+    const int aircraft = 200;
+    for (int i = 0; i < aircraft; ++i) {
+        SGPropertyNode_ptr definition(new SGPropertyNode);
+        definition->setStringValue("type", "aircraft");
+        definition->setStringValue("callsign", "PERF" + std::to_string(i));
+        definition->setDoubleValue("heading", (i * 37) % 360);
+        definition->setDoubleValue("latitude", eggd->geod().getLatitudeDeg() + (i % 20 - 10) * 0.05);
+        definition->setDoubleValue("longitude", eggd->geod().getLongitudeDeg() + (i / 20 - 5) * 0.08);
+        definition->setDoubleValue("altitude", 3000.0 + (i % 10) * 1000.0);
+        definition->setDoubleValue("speed", 200.0 + (i % 5) * 20.0);
+        CPPUNIT_ASSERT(aim->addObject(definition));
+    }
+
+    // Each timed run is one second at 60 Hz.
+    const int frames = 60;
+    const double dt = 1.0 / frames;
+    PerfResults::get().measure("AI::ManagerUpdate", [aim, dt]() {
+        for (int i = 0; i < frames; ++i) {
+            globals->inc_sim_time_sec(dt);
+            aim->update(dt);
+        }
+    }, frames);
+}
@@ -0,0 +1,70 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_replayPerf.hxx"
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+#include "test_suite/perfResults.hxx"
+
+#include <Aircraft/flightrecorder.hxx>
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+#include <MultiPlayer/multiplaymgr.hxx>
+
+
+// Set up function for each test.
+void ReplayPerfTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("replay-perf");
+
+    // The default flight recorder configuration.
+    fgLoadProps("defaults.xml", globals->get_props());
+
+    // The recorder takes the recent multiplayer messages.
+    globals->add_new_subsystem<FGMultiplayMgr>(SGSubsystemMgr::POST_FDM);
+}
+
+
+// Clean up after each test.
+void ReplayPerfTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+// Capture of a replay frame with the generic recorder configuration, as
+// done for every frame while recording.
+void ReplayPerfTests::testRecord()
+{
+    FGFlightRecorder recorder("replay-config");
+    recorder.reinit();
+    CPPUNIT_ASSERT(recorder.getRecordSize() > 0);
+
+    const int frames = 1000;
+    double simTime = 0.0;
+    FGReplayData* buffer = nullptr;
+    PerfResults::get().measure("Replay::Record", [&]() {
+        for (int i = 0; i < frames; ++i) {
+            simTime += 1.0 / 60;
+            buffer = recorder.capture(simTime, buffer);
+        }
+    }, frames);
+
+    CPPUNIT_ASSERT(buffer);
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(recorder.getRecordSize()), buffer->raw_data.size());
+    delete buffer;
+}
@@ -0,0 +1,206 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_FDMPerf.hxx"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <osg/Matrixd>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+#include "test_suite/perfResults.hxx"
+
+#include <simgear/bvh/BVHLineSegmentVisitor.hxx>
+#include <simgear/bvh/BVHStaticGeometryBuilder.hxx>
+#include <simgear/bvh/BVHSubTreeCollector.hxx>
+#include <simgear/bvh/BVHTransform.hxx>
+#include <simgear/scene/util/OsgMath.hxx>
+
+#include <FDM/JSBSim/FGFDMExec.h>
+#include <FDM/JSBSim/initialization/FGInitialCondition.h>
+#include <Main/globals.hxx>
+
+namespace {
+
+// The synthetic terrain: a grid of GRID_SIZE x GRID_SIZE cells of
+// GRID_STEP_DEG, with rolling hills.
+const int GRID_SIZE = 200;
+const double GRID_STEP_DEG = 0.001;
+const SGGeod TERRAIN_ORIGIN = SGGeod::fromDeg(-2.72, 51.38);
+
+double terrainElevationM(int i, int j)
+{
+    return 60.0 + 30.0 * std::sin(i * 0.07) * std::cos(j * 0.05);
+}
+
+SGGeod gridGeod(int i, int j, double elevationM)
+{
+    return SGGeod::fromDegM(TERRAIN_ORIGIN.getLongitudeDeg() + i * GRID_STEP_DEG,
+                            TERRAIN_ORIGIN.getLatitudeDeg() + j * GRID_STEP_DEG,
+                            elevationM);
+}
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void FDMPerfTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("fdm-perf");
+}
+
+
+// Clean up after each test.
+void FDMPerfTests::tearDown()
+{
+    _terrain.clear();
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+// Build the terrain as the BVH tree the scenery would provide, with the
+// triangles relative to the centre of the grid as in a scenery tile.
+void FDMPerfTests::buildTerrain()
+{
+    _center = SGVec3d::fromGeod(gridGeod(GRID_SIZE / 2, GRID_SIZE / 2, 0.0));
+
+    std::vector<SGVec3f> vertices;
+    vertices.reserve((GRID_SIZE + 1) * (GRID_SIZE + 1));
+    for (int j = 0; j <= GRID_SIZE; ++j) {
+        for (int i = 0; i <= GRID_SIZE; ++i) {
+            const SGVec3d cart = SGVec3d::fromGeod(gridGeod(i, j, terrainElevationM(i, j)));
+            vertices.push_back(toVec3f(cart - _center));
+        }
+    }
+
+    SGSharedPtr<simgear::BVHStaticGeometryBuilder> builder = new simgear::BVHStaticGeometryBuilder;
+    auto vertex = [&vertices](int i, int j) { return vertices[j * (GRID_SIZE + 1) + i]; };
+    for (int j = 0; j < GRID_SIZE; ++j) {
+        for (int i = 0; i < GRID_SIZE; ++i) {
+            builder->addTriangle(vertex(i, j), vertex(i + 1, j), vertex(i + 1, j + 1));
+            builder->addTriangle(vertex(i, j), vertex(i + 1, j + 1), vertex(i, j + 1));
+        }
+    }
+
+    simgear::BVHTransform* transform = new simgear::BVHTransform;
+    transform->setToWorldTransform(SGMatrixd(osg::Matrixd::translate(toOsg(_center)).ptr()));
+    transform->addChild(builder->buildTree());
+    _terrain = transform;
+}
+
+
+// One second of c172p flight, at the default FDM rate.
+void FDMPerfTests::testJSBSimStep()
+{
+    const SGPath aircraftDir = globals->get_fg_root() / "Aircraft" / "c172p";
+    const SGPath enginesDir = globals->get_fg_root() / "Aircraft" / "Generic" / "JSBSim" / "Engines";
+    const SGPath systemsDir = globals->get_fg_root() / "Aircraft" / "Generic" / "JSBSim" / "Systems";
+
+    // Keep JSBSim quiet.
+    JSBSim::FGJSBBase::debug_lvl = 0;
+
+    const int steps = 120;
+    JSBSim::FGFDMExec fdm;
+    fdm.Setdt(1.0 / steps);
+    CPPUNIT_ASSERT_MESSAGE("Cannot load the c172p from FGData",
+                           fdm.LoadModel(aircraftDir, enginesDir, systemsDir, "c172p", false));
+
+    auto ic = fdm.GetIC();
+    ic->SetAltitudeASLFtIC(3000.0);
+    ic->SetVcalibratedKtsIC(100.0);
+    CPPUNIT_ASSERT(fdm.RunIC());
+
+    PerfResults::get().measure("FDM::JSBSimStep", [&fdm]() {
+        for (int i = 0; i < steps; ++i) {
+            fdm.Run();
+        }
+    }, steps);
+}
+
+
+// Collect the terrain around a moving aircraft, as done for each FDM
+// iteration by FGGroundCache::prepare_ground_cache().
+void FDMPerfTests::testGroundCacheFill()
+{
+    buildTerrain();
+
+    const int positions = 100;
+    std::vector<SGVec3d> track;
+    for (int k = 0; k < positions; ++k) {
+        const int i = 20 + k * (GRID_SIZE - 40) / positions;
+        const int j = GRID_SIZE / 3 + k / 4;
+        track.push_back(SGVec3d::fromGeod(gridGeod(i, j, terrainElevationM(i, j) + 30.0)));
+    }
+
+    size_t hits = 0;
+    PerfResults::get().measure("FDM::GroundCacheFill", [this, &track, &hits]() {
+        for (const auto& pt : track) {
+            const SGVec3d down = -normalize(pt);
+
+            // the coarse ground below, then the local tree
+            SGLineSegmentd line(pt, pt + 1000.0 * down);
+            simgear::BVHLineSegmentVisitor lineSegmentVisitor(line, 0.0);
+            _terrain->accept(lineSegmentVisitor);
+
+            simgear::BVHSubTreeCollector collector(SGSphered(pt, 100.0));
+            _terrain->accept(collector);
+            if (!lineSegmentVisitor.empty() && collector.getNode())
+                ++hits;
+        }
+    }, positions);
+
+    CPPUNIT_ASSERT(hits > 0);
+}
+
+
+// Height above ground queries on a prepared cache, as done for each gear
+// and contact point by FGGroundCache::get_agl().
+void FDMPerfTests::testGroundCacheAGL()
+{
+    buildTerrain();
+
+    const SGVec3d cacheCenter = SGVec3d::fromGeod(gridGeod(GRID_SIZE / 2, GRID_SIZE / 2, 100.0));
+    simgear::BVHSubTreeCollector collector(SGSphered(cacheCenter, 2000.0));
+    _terrain->accept(collector);
+    SGSharedPtr<simgear::BVHNode> cache = collector.getNode();
+    CPPUNIT_ASSERT(cache);
+
+    // contact points scattered over the cache
+    const int queries = 1000;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> cell(GRID_SIZE / 2 - 10, GRID_SIZE / 2 + 10);
+    std::vector<SGVec3d> points;
+    for (int k = 0; k < queries; ++k) {
+        const int i = cell(rng), j = cell(rng);
+        points.push_back(SGVec3d::fromGeod(gridGeod(i, j, terrainElevationM(i, j) + 2.0)));
+    }
+
+    size_t hits = 0;
+    PerfResults::get().measure("FDM::GroundCacheAGL", [&cache, &points, &hits]() {
+        for (const auto& pt : points) {
+            SGLineSegmentd line(pt, pt - 200.0 * normalize(pt));
+            simgear::BVHLineSegmentVisitor lineSegmentVisitor(line, 0.0);
+            cache->accept(lineSegmentVisitor);
+            if (!lineSegmentVisitor.empty())
+                ++hits;
+        }
+    }, queries);
+
+    CPPUNIT_ASSERT(hits > 0);
+}
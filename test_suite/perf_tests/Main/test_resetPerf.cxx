@@ -0,0 +1,94 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_resetPerf.hxx"
+
+#include "test_suite/FGTestApi/NavDataCache.hxx"
+#include "test_suite/FGTestApi/testGlobals.hxx"
+#include "test_suite/perfResults.hxx"
+
+#include <simgear/props/props_io.hxx>
+
+#include <AIModel/AIManager.hxx>
+#include <AIModel/performancedb.hxx>
+#include <ATC/atc_mgr.hxx>
+#include <Airports/airportdynamicsmanager.hxx>
+#include <Main/fg_init.hxx>
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+#include <Main/options.hxx>
+#include <Main/positioninit.hxx>
+
+
+// Set up function for each test.
+void ResetPerfTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("reset-perf");
+    FGTestApi::setUp::initNavDataCache();
+    flightgear::Options::reset();
+    fgLoadProps("defaults.xml", globals->get_props());
+
+    globals->add_new_subsystem<flightgear::AirportDynamicsManager>();
+    globals->add_new_subsystem<PerformanceDB>();
+    globals->add_new_subsystem<FGATCManager>();
+    globals->add_new_subsystem<FGAIManager>(SGSubsystemMgr::POST_FDM);
+
+    {
+        flightgear::Options* opts = flightgear::Options::sharedInstance();
+        opts->setShouldLoadDefaultConfig(false);
+
+        const char* args[] = {"dummypath", "--airport=EGGD"};
+        opts->init(2, (char**) args, SGPath());
+        opts->processOptions();
+    }
+
+    auto props = globals->get_props();
+    props->setStringValue("sim/aircraft", "test-suite-aircraft");
+    props->setBoolValue("sim/startup/fast-reset", true);
+
+    globals->get_subsystem_mgr()->bind();
+    globals->get_subsystem_mgr()->init();
+    globals->get_subsystem_mgr()->postinit();
+    flightgear::initPosition();
+
+    fgSaveInitialState();
+}
+
+
+// Clean up after each test.
+void ResetPerfTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+// A fast reset, alternating between two airports as a training session
+// would, with the subsystems the headless test environment provides.
+// There is no FDM: it needs loaded scenery for its ground cache, which the
+// test environment does not have. The time spent re-initialising the FDM
+// is therefore not included, and neither is the wait for scenery in the
+// main loop; this measures the property tree restore and the reposition
+// of the other subsystems only.
+void ResetPerfTests::testFastReset()
+{
+    const char* airports[] = {"EGGD", "EGLL"};
+    int count = 0;
+    PerfResults::get().measure("Main::FastResetNoFDM", [&airports, &count]() {
+        fgSetString("/sim/presets/airport-id", airports[count++ % 2]);
+        CPPUNIT_ASSERT(fgStartFastReset());
+    });
+}
@@ -0,0 +1,150 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_navCachePerf.hxx"
+
+#include <thread>
+#include <vector>
+
+#include "test_suite/FGTestApi/NavDataCache.hxx"
+#include "test_suite/FGTestApi/testGlobals.hxx"
+#include "test_suite/perfResults.hxx"
+
+#include <Navaids/NavDataCache.hxx>
+#include <Navaids/navlist.hxx>
+#include <Navaids/navrecord.hxx>
+#include <Navaids/positioned.hxx>
+
+using namespace flightgear;
+
+namespace {
+
+// Query positions spread over Europe and North America.
+const std::vector<SGGeod> queryPositions = {
+    SGGeod::fromDeg(-2.27, 53.35),
+    SGGeod::fromDeg(-0.45, 51.47),
+    SGGeod::fromDeg(8.57, 50.03),
+    SGGeod::fromDeg(2.55, 49.01),
+    SGGeod::fromDeg(-122.37, 37.62),
+    SGGeod::fromDeg(-73.78, 40.64),
+    SGGeod::fromDeg(-87.90, 41.98),
+    SGGeod::fromDeg(-21.94, 63.98),
+};
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void NavDataCachePerfTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("navcache-perf");
+    FGTestApi::setUp::initNavDataCache();
+}
+
+
+// Clean up after each test.
+void NavDataCachePerfTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void NavDataCachePerfTests::testFindClosestWithIdent()
+{
+    const std::vector<std::string> idents = {"TNT", "LON", "BIG", "FFM", "SFO", "JFK", "ORD", "KEF"};
+    FGPositioned::TypeFilter filter({FGPositioned::VOR, FGPositioned::NDB});
+
+    size_t found = 0;
+    PerfResults::get().measure("NavDataCache::FindClosestWithIdent", [&]() {
+        for (const auto& pos : queryPositions) {
+            for (const auto& ident : idents) {
+                if (FGPositioned::findClosestWithIdent(ident, pos, &filter))
+                    ++found;
+            }
+        }
+    }, static_cast<int>(queryPositions.size() * idents.size()));
+
+    CPPUNIT_ASSERT(found > 0);
+}
+
+
+void NavDataCachePerfTests::testFindWithinRange()
+{
+    FGPositioned::TypeFilter filter({FGPositioned::AIRPORT, FGPositioned::VOR, FGPositioned::NDB});
+
+    size_t found = 0;
+    PerfResults::get().measure("NavDataCache::FindWithinRange", [&]() {
+        for (const auto& pos : queryPositions) {
+            found += FGPositioned::findWithinRange(pos, 50.0, &filter).size();
+        }
+    }, static_cast<int>(queryPositions.size()));
+
+    CPPUNIT_ASSERT(found > 0);
+}
+
+
+void NavDataCachePerfTests::testFindByFreq()
+{
+    const std::vector<double> frequencies = {115.7, 113.6, 115.1, 114.2, 115.8, 115.4, 113.9, 112.0};
+
+    size_t found = 0;
+    PerfResults::get().measure("NavDataCache::FindByFreq", [&]() {
+        for (const auto& pos : queryPositions) {
+            for (const auto freq : frequencies) {
+                if (FGNavList::findByFreq(freq, pos))
+                    ++found;
+            }
+        }
+    }, static_cast<int>(queryPositions.size() * frequencies.size()));
+
+    CPPUNIT_ASSERT(found > 0);
+}
+
+
+void NavDataCachePerfTests::testFindAllWithName()
+{
+    const std::vector<std::string> names = {"Manchester", "Heathrow", "Frankfurt", "Kennedy", "San Francisco"};
+
+    size_t found = 0;
+    PerfResults::get().measure("NavDataCache::FindAllWithName", [&]() {
+        for (const auto& name : names) {
+            found += FGPositioned::findAllWithName(name, nullptr, false).size();
+        }
+    }, static_cast<int>(names.size()));
+
+    CPPUNIT_ASSERT(found > 0);
+}
+
+
+// The airport search of the launcher and of the GUI dialogs.
+void NavDataCachePerfTests::testGUISearch()
+{
+    const std::vector<std::string> terms = {"EGCC", "Manchester", "inter", "san", "KSFO"};
+
+    size_t found = 0;
+    PerfResults::get().measure("NavDataCache::GUISearch", [&]() {
+        for (const auto& term : terms) {
+            NavDataCache::ThreadedGUISearch search(term, true);
+            while (!search.isComplete()) {
+                std::this_thread::yield();
+            }
+            found += search.results().size();
+        }
+    }, static_cast<int>(terms.size()));
+
+    CPPUNIT_ASSERT(found > 0);
+}
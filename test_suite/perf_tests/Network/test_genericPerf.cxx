@@ -0,0 +1,106 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_genericPerf.hxx"
+
+#include <memory>
+#include <sstream>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+#include "test_suite/perfResults.hxx"
+
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/io/sg_file.hxx>
+#include <simgear/misc/sg_dir.hxx>
+
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+#include <Network/generic.hxx>
+
+
+// Set up function for each test.
+void GenericProtocolPerfTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("generic-protocol-perf");
+
+    _dataDir = globals->get_fg_home() / "generic-protocol-perf";
+    simgear::Dir(_dataDir / "Protocol").create(0755);
+    globals->append_data_path(_dataDir);
+}
+
+
+// Clean up after each test.
+void GenericProtocolPerfTests::tearDown()
+{
+    simgear::Dir(_dataDir).remove(true);
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+// Encode a motion-platform sized message of a few hundred chunks.
+void GenericProtocolPerfTests::measureEncode(const std::string& name, const std::string& header,
+                                             bool formatted)
+{
+    const char* types[] = {"int", "float", "double", "bool"};
+    const char* formats[] = {"%d", "%.3f", "%f", "%d"};
+
+    std::ostringstream os;
+    os << "<?xml version=\"1.0\"?>\n<PropertyList>\n<generic>\n<output>\n" << header;
+    for (int i = 0; i < 240; ++i) {
+        const std::string node = "/perf/value[" + std::to_string(i) + "]";
+        os << "<chunk><node>" << node << "</node><type>" << types[i % 4] << "</type>";
+        if (formatted) {
+            os << "<format>" << formats[i % 4] << "</format>";
+        }
+        os << "</chunk>\n";
+        fgSetDouble(node, (i - 120) * 3.14159265);
+    }
+    os << "</output>\n</generic>\n</PropertyList>\n";
+
+    {
+        sg_ofstream f(_dataDir / "Protocol" / (name + ".xml"), std::ios::out | std::ios::trunc);
+        f << os.str();
+    }
+
+    const SGPath file = _dataDir / (name + ".out");
+    std::unique_ptr<FGGeneric> channel(new FGGeneric({"generic", "file", "out", "10", file.utf8Str(), name}));
+    CPPUNIT_ASSERT(channel->getInitOk());
+    channel->set_direction("out");
+    channel->set_io_channel(new SGFile(file));
+
+    const int messages = 1000;
+    PerfResults::get().measure("GenericProtocol::" + name, [&channel]() {
+        for (int i = 0; i < messages; ++i) {
+            channel->gen_message();
+        }
+    }, messages);
+}
+
+
+void GenericProtocolPerfTests::testAsciiEncode()
+{
+    measureEncode("AsciiEncode",
+                  "<line_separator>newline</line_separator>\n"
+                  "<var_separator>,</var_separator>\n",
+                  true);
+}
+
+
+void GenericProtocolPerfTests::testBinaryEncode()
+{
+    measureEncode("BinaryEncode", "<binary_mode>true</binary_mode>\n", false);
+}
@@ -0,0 +1,115 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_voiceSynthesizerPerf.hxx"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+#include "test_suite/perfResults.hxx"
+
+#include <simgear/debug/logstream.hxx>
+
+#include <Main/fg_props.hxx>
+#include <Sound/VoiceSynthesizer.hxx>
+
+
+namespace {
+
+// An ATIS of typical length, with the QNH varied so each text differs.
+std::string atisText(int qnh)
+{
+    char buf[512];
+    ::snprintf(buf, sizeof(buf),
+               "This is Bristol information alpha. Time 1350 zulu. "
+               "Runway in use 27, expect ILS approach. Transition level 70. "
+               "Wind 240 degrees, 12 knots, gusting 22 knots. Visibility 10 kilometers or more. "
+               "Light rain. Few clouds at 2000 feet, broken at 4500 feet. "
+               "Temperature 14, dewpoint 9. QNH %d hectopascals. "
+               "Advise on initial contact you have information alpha.",
+               qnh);
+    return buf;
+}
+
+// The synthesizer for the default ATIS voice, or null if the voice is not
+// part of the data the tests run with.
+std::unique_ptr<FLITEVoiceSynthesizer> makeSynthesizer()
+{
+    const std::string voice = FLITEVoiceSynthesizer::getVoicePath(FLITEVoiceSynthesizer::CMU_US_ARCTIC_SLT);
+    if (!SGPath::fromUtf8(voice).exists()) {
+        SG_LOG(SG_SOUND, SG_ALERT, "Voice " << voice << " not found, skipping the benchmark");
+        return {};
+    }
+    return std::unique_ptr<FLITEVoiceSynthesizer>(new FLITEVoiceSynthesizer(voice));
+}
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void VoiceSynthesizerPerfTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("voice-perf");
+    // the synchronous call is timed, the workers stay idle
+    fgSetInt("/sim/sound/voice-synthesizer/threads", 1);
+}
+
+
+// Clean up after each test.
+void VoiceSynthesizerPerfTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+// Synthesizing a complete ATIS, as for a station tuned for the first time.
+// The phrase cache is kept too small to hold any of it.
+void VoiceSynthesizerPerfTests::testATISSynthesis()
+{
+    fgSetInt("/sim/sound/voice-synthesizer/phrase-cache-kb", 0);
+    auto synthesizer = makeSynthesizer();
+    if (!synthesizer) {
+        return;
+    }
+
+    int qnh = 1000;
+    PerfResults::get().measure("Sound::ATISSynthesis", [&synthesizer, &qnh]() {
+        SGSharedPtr<SGSoundSample> sample = synthesizer->synthesize(atisText(qnh++), 1.0, 0.5, 0.5);
+        CPPUNIT_ASSERT(sample.valid());
+    });
+}
+
+
+// Synthesizing an ATIS updated for a new QNH, where all other phrases come
+// from the phrase cache.
+void VoiceSynthesizerPerfTests::testATISUpdate()
+{
+    auto synthesizer = makeSynthesizer();
+    if (!synthesizer) {
+        return;
+    }
+
+    int qnh = 1000;
+    SGSharedPtr<SGSoundSample> first = synthesizer->synthesize(atisText(qnh++), 1.0, 0.5, 0.5);
+    CPPUNIT_ASSERT(first.valid());
+    PerfResults::get().measure("Sound::ATISUpdate", [&synthesizer, &qnh]() {
+        SGSharedPtr<SGSoundSample> sample = synthesizer->synthesize(atisText(qnh++), 1.0, 0.5, 0.5);
+        CPPUNIT_ASSERT(sample.valid());
+    });
+}
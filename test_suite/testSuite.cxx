@@ -18,6 +18,7 @@
  */
 
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 
@@ -27,6 +28,7 @@
 #include "fgTestRunner.hxx"
 #include "formatting.hxx"
 #include "logging.hxx"
+#include "perfResults.hxx"
 
 using namespace std;
 
@@ -43,8 +45,10 @@ void helpPrintout(std::ostream &stream) {
     stream << "    -g, --gui-tests     execute the GUI tests." << std::endl;
     stream << "    -m, --simgear-tests execute the simgear tests." << std::endl;
     stream << "    -f, --fgdata-tests  execute the FGData tests." << std::endl;
+    stream << "    -p, --perf-tests    execute the performance tests.  These are not run by" << std::endl;
+    stream << "                        default." << std::endl;
     stream << std::endl;
-    stream << "    The -s, -u, -g, and -m options accept an optional argument to perform a" << std::endl;
+    stream << "    The -s, -u, -g, -m, and -p options accept an optional argument to perform a" << std::endl;
     stream << "    subset of all tests.  This argument should either be the name of a test" << std::endl;
     stream << "    suite, the full name of an individual test, or a comma separated list." << std::endl;
     stream << "    E.g. -u DigitalFilterTests\n";
@@ -53,6 +57,18 @@ void helpPrintout(std::ostream &stream) {
     stream << "    the individual test name.  The test names can revealed with the verbose" << std::endl;
     stream << "    option." << std::endl;
     stream << std::endl;
+    stream << "  Performance test options:" << std::endl;
+    stream << "    --perf-warm-up=N    the number of untimed runs of each benchmark (default 3)." << std::endl;
+    stream << "    --perf-repeats=N    the number of timed runs of each benchmark (default 20)." << std::endl;
+    stream << "    --perf-json=FILE    write the statistics of the benchmarks (median, 95th" << std::endl;
+    stream << "                        percentile, median absolute deviation) as JSON." << std::endl;
+    stream << "    --perf-baseline=FILE" << std::endl;
+    stream << "                        compare the benchmarks to the medians in a JSON file" << std::endl;
+    stream << "                        written by --perf-json, and fail on regressions." << std::endl;
+    stream << "    --perf-threshold=PERCENT" << std::endl;
+    stream << "                        the allowed slowdown relative to the baseline, unless" << std::endl;
+    stream << "                        the baseline gives a threshold (default 10)." << std::endl;
+    stream << std::endl;
     stream << "  Logging options:" << std::endl;
     stream << "    --log-level={bulk,debug,info,warn,alert,popup,dev_warn,dev_alert}" << std::endl;
     stream << "                        specify the minimum logging level to output" << std::endl;
@@ -214,7 +230,7 @@ sgDebugPriority processLogPriority(std::string logLevel, bool &failure) {
 
 
 // Print out a summary of the relax test suite.
-void summary(CppUnit::OStream &stream, int system_result, int unit_result, int gui_result, int simgear_result, int fgdata_result)
+void summary(CppUnit::OStream &stream, int system_result, int unit_result, int gui_result, int simgear_result, int fgdata_result, int perf_result)
 {
     int synopsis = 0;
 
@@ -261,6 +277,13 @@ void summary(CppUnit::OStream &stream, int system_result, int unit_result, int g
         synopsis += fgdata_result;
     }
 
+    // Performance test summary.
+    if (perf_result != -1) {
+        text = "Performance tests";
+        printSummaryLine(stream, text, perf_result);
+        synopsis += perf_result;
+    }
+
     // Synopsis.
     text ="Synopsis";
     printSummaryLine(stream, text, synopsis);
@@ -273,14 +296,14 @@ void summary(CppUnit::OStream &stream, int system_result, int unit_result, int g
 int main(int argc, char **argv)
 {
     // Declarations.
-    int         status_gui=-1, status_simgear=-1, status_system=-1, status_unit=-1, status_fgdata=-1;
-    bool        run_system=false, run_unit=false, run_gui=false, run_simgear=false, run_fgdata=false;
+    int         status_gui=-1, status_simgear=-1, status_system=-1, status_unit=-1, status_fgdata=-1, status_perf=-1;
+    bool        run_system=false, run_unit=false, run_gui=false, run_simgear=false, run_fgdata=false, run_perf=false;
     bool        logSplit=false;
     bool        timings=false, ctest_output=false, debug=false, printSummary=true, help=false;
-    char        *subset_system=NULL, *subset_unit=NULL, *subset_gui=NULL, *subset_simgear=NULL, *subset_fgdata=NULL;
+    char        *subset_system=NULL, *subset_unit=NULL, *subset_gui=NULL, *subset_simgear=NULL, *subset_fgdata=NULL, *subset_perf=NULL;
     bool        failure=false;
     char        firstchar;
-    std::string arg, delim, fgRoot, logClassVal, logLevel;
+    std::string arg, delim, fgRoot, logClassVal, logLevel, perfJSON, perfBaseline;
     size_t      delimPos;
 
     // The default logging class and priority to show.
@@ -339,6 +362,32 @@ int main(int argc, char **argv)
             if (firstchar != '-')
                 subset_fgdata = argv[i+1];
 
+        // Performance test.
+        } else if (arg == "-p" || arg == "--perf-tests") {
+            run_perf = true;
+            if (firstchar != '-')
+                subset_perf = argv[i+1];
+
+        // Performance test warm-up runs.
+        } else if (arg.find( "--perf-warm-up=" ) == 0) {
+            PerfResults::get().setWarmUp(std::max(atoi(arg.substr(arg.find('=') + 1).c_str()), 0));
+
+        // Performance test timed runs.
+        } else if (arg.find( "--perf-repeats=" ) == 0) {
+            PerfResults::get().setRepeats(std::max(atoi(arg.substr(arg.find('=') + 1).c_str()), 1));
+
+        // Performance test results.
+        } else if (arg.find( "--perf-json=" ) == 0) {
+            perfJSON = arg.substr(arg.find('=') + 1);
+
+        // Performance test baseline.
+        } else if (arg.find( "--perf-baseline=" ) == 0) {
+            perfBaseline = arg.substr(arg.find('=') + 1);
+
+        // Performance test regression threshold.
+        } else if (arg.find( "--perf-threshold=" ) == 0) {
+            PerfResults::get().setThreshold(atof(arg.substr(arg.find('=') + 1).c_str()) / 100.0);
+
         // Log class.
         } else if (arg.find( "--log-class" ) == 0) {
             // Process the command line.
@@ -395,8 +444,9 @@ int main(int argc, char **argv)
         return 0;
     }
 
-    // Turn on all tests if no subset was specified.
-    if (!run_system && !run_unit && !run_gui && !run_simgear && !run_fgdata) {
+    // Turn on all tests if no subset was specified.  The performance tests
+    // are only run on request.
+    if (!run_system && !run_unit && !run_gui && !run_simgear && !run_fgdata && !run_perf) {
         run_system = true;
         run_unit = true;
         run_gui = true;
@@ -413,6 +463,12 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    // The performance test baseline.
+    if (run_perf && !perfBaseline.empty()) {
+        if (PerfResults::get().loadBaseline(SGPath::fromUtf8(perfBaseline)) != 0)
+            return 1;
+    }
+
     // Set up logging.
     sglog().setDeveloperMode(true);
     if (debug)
@@ -431,10 +487,19 @@ int main(int argc, char **argv)
         status_simgear = testRunner("Simgear unit tests", "Simgear unit tests", subset_simgear, timings, ctest_output, debug);
     if (run_fgdata)
         status_fgdata = testRunner("FGData tests", "FGData tests", subset_fgdata, timings, ctest_output, debug);
+    if (run_perf) {
+        status_perf = testRunner("Performance tests", "Performance tests", subset_perf, timings, ctest_output, debug);
+
+        // The statistics, with benchmark regressions counted as failures.
+        PerfResults& perf = PerfResults::get();
+        status_perf += perf.report(cerr);
+        if (!perfJSON.empty())
+            status_perf += perf.writeJSON(SGPath::fromUtf8(perfJSON));
+    }
 
     // Summary printout.
     if (printSummary && !ctest_output)
-        summary(cerr, status_system, status_unit, status_gui, status_simgear, status_fgdata);
+        summary(cerr, status_system, status_unit, status_gui, status_simgear, status_fgdata, status_perf);
 
     // Deactivate the logging.
     if (!debug)
@@ -451,6 +516,8 @@ int main(int argc, char **argv)
         return 1;
     if (status_fgdata > 0)
         return 1;
+    if (status_perf > 0)
+        return 1;
 
     // Success.
     return 0;
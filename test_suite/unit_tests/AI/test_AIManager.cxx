@@ -21,6 +21,7 @@
 
 #include <cstring>
 #include <memory>
+#include <sstream>
 
 #include "test_suite/FGTestApi/NavDataCache.hxx"
 #include "test_suite/FGTestApi/TestDataLogger.hxx"
@@ -343,3 +344,49 @@ void AIManagerTests::testAircraftWaypoints()
     std::unique_ptr<FGAIFlightPlan> aiFP(new FGAIFlightPlan);
     ai->setFlightPlan(std::move(aiFP));
 }
+
+void AIManagerTests::testStateSnapshot()
+{
+    auto aim = globals->get_subsystem<FGAIManager>();
+    auto eggd = FGAirport::findByIdent("EGGD");
+
+    SGPropertyNode_ptr aircraftDefinition(new SGPropertyNode);
+    aircraftDefinition->setStringValue("type", "aircraft");
+    aircraftDefinition->setStringValue("callsign", "G-SNAP");
+    aircraftDefinition->setDoubleValue("heading", 90.0);
+    aircraftDefinition->setDoubleValue("latitude", eggd->geod().getLatitudeDeg());
+    aircraftDefinition->setDoubleValue("longitude", eggd->geod().getLongitudeDeg());
+    aircraftDefinition->setDoubleValue("altitude", 6000.0);
+    aircraftDefinition->setDoubleValue("speed", 250.0);
+
+    auto ai = aim->addObject(aircraftDefinition);
+    CPPUNIT_ASSERT(ai->getDefinition());
+    const double snapshotLat = eggd->geod().getLatitudeDeg() + 0.1;
+    ai->setLatitude(snapshotLat);
+    ai->setHeading(180.0);
+
+    std::ostringstream os;
+    aim->saveSnapshot(os);
+
+    ai->setHeading(270.0);
+    std::istringstream is(os.str());
+    CPPUNIT_ASSERT(aim->restoreSnapshot(is));
+
+    // the object is replaced by one where it was when saved
+    CPPUNIT_ASSERT(ai->getDie());
+    FGAIBasePtr restored;
+    for (const auto& o : aim->get_ai_list()) {
+        if (!o->getDie() && (o->getCallSign() == "G-SNAP")) {
+            CPPUNIT_ASSERT(!restored);
+            restored = o;
+        }
+    }
+
+    CPPUNIT_ASSERT(restored);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(snapshotLat, restored->getGeodPos().getLatitudeDeg(), 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(180.0, restored->getTrueHeadingDeg(), 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(250.0, restored->_getSpeed(), 1);
+
+    // objects without a definition, such as the user aircraft, are kept
+    CPPUNIT_ASSERT(!aim->getUserAircraft()->getDie());
+}
@@ -37,6 +37,7 @@ class AIManagerTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testAIFlightPlan);
     CPPUNIT_TEST(testAircraftWaypoints);
     CPPUNIT_TEST(testAIFlightPlanLoadXML);
+    CPPUNIT_TEST(testStateSnapshot);
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -53,4 +54,5 @@ public:
     void testAIFlightPlan();
     void testAircraftWaypoints();
     void testAIFlightPlanLoadXML();
+    void testStateSnapshot();
 };
@@ -23,17 +23,24 @@
 
 #include <cstring>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "test_suite/FGTestApi/NavDataCache.hxx"
 #include "test_suite/FGTestApi/TestDataLogger.hxx"
 #include "test_suite/FGTestApi/testGlobals.hxx"
 
+#include <simgear/timing/sg_time.hxx>
+
 #include <AIModel/AIAircraft.hxx>
 #include <AIModel/AIFlightPlan.hxx>
 #include <AIModel/AIManager.hxx>
 #include <AIModel/performancedb.hxx>
 #include <Airports/airport.hxx>
 #include <Airports/airportdynamicsmanager.hxx>
+#include <Airports/groundnetloader.hxx>
+#include <Airports/groundnetwork.hxx>
+#include <Airports/xmlloader.hxx>
 #include <Traffic/TrafficMgr.hxx>
 
 #include <ATC/atc_mgr.hxx>
@@ -41,6 +48,43 @@
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
 
+namespace {
+
+// Schedules for the traffic manager's scheduler, each flying a leg on the
+// other side of the world from the user.
+struct TestSchedules {
+    std::vector<std::unique_ptr<FGScheduledFlight>> flights;
+    std::vector<std::unique_ptr<FGAISchedule>> schedules;
+
+    FGAISchedule* add(const std::string& registration)
+    {
+        schedules.emplace_back(new FGAISchedule("", "", "YSSY", registration, registration, false,
+                                                "B737", "QFA", "jet_transport", "gate", 30, 0));
+        return schedules.back().get();
+    }
+
+    void assign(FGAISchedule* schedule, const std::string& dep, const std::string& arr,
+                const std::string& depTime, const std::string& arrTime, const std::string& repeat)
+    {
+        flights.emplace_back(new FGScheduledFlight(schedule->getRegistration(), "IFR", dep, arr, 350,
+                                                   depTime, arrTime, repeat, schedule->getRegistration()));
+        schedule->assign(flights.back().get());
+    }
+
+    ScheduleVector create(int count)
+    {
+        ScheduleVector result;
+        for (int i = 0; i < count; ++i) {
+            FGAISchedule* schedule = add("VH-T" + std::to_string(i));
+            assign(schedule, "YSSY", "YMML", "00:00:00", "23:00:00", "24Hr");
+            result.push_back(schedule);
+        }
+        return result;
+    }
+};
+
+} // of anonymous namespace
+
 /////////////////////////////////////////////////////////////////////////////
 
 // Set up function for each test.
@@ -126,6 +170,67 @@ void TrafficTests::testPushback()
     }
 }
 
+void TrafficTests::testGroundNetCache()
+{
+    using flightgear::GroundNetLoader;
+
+    FGAirportRef egph = FGAirport::getByIdent("EGPH");
+    const SGPath source = SGPath::fromUtf8(FG_TEST_SUITE_DATA) / "EGPH.groundnet.xml";
+    const SGPath cacheFile = globals->get_fg_home() / "EGPH.gnc";
+
+    FGGroundNetwork parsed(egph.ptr());
+    XMLLoader::loadFromPath(&parsed, source);
+    CPPUNIT_ASSERT(GroundNetLoader::writeCache(&parsed, cacheFile, source));
+    parsed.init();
+
+    FGGroundNetwork cached(egph.ptr());
+    CPPUNIT_ASSERT(GroundNetLoader::readCache(&cached, cacheFile, source));
+    cached.init();
+
+    CPPUNIT_ASSERT_EQUAL(parsed.getVersion(), cached.getVersion());
+    CPPUNIT_ASSERT(parsed.getTowerFrequencies() == cached.getTowerFrequencies());
+    CPPUNIT_ASSERT(parsed.getGroundFrequencies() == cached.getGroundFrequencies());
+
+    const FGParkingList& parkings = parsed.allParkings();
+    CPPUNIT_ASSERT(!parkings.empty());
+    CPPUNIT_ASSERT_EQUAL(parkings.size(), cached.allParkings().size());
+    for (size_t i = 0; i < parkings.size(); ++i) {
+        FGParkingRef a = parkings[i];
+        FGParkingRef b = cached.allParkings()[i];
+        CPPUNIT_ASSERT_EQUAL(a->getName(), b->getName());
+        CPPUNIT_ASSERT_EQUAL(a->getIndex(), b->getIndex());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(a->getHeading(), b->getHeading(), 1e-9);
+        CPPUNIT_ASSERT_EQUAL(a->getCodes(), b->getCodes());
+        CPPUNIT_ASSERT_EQUAL(a->getPushBackPoint().valid(), b->getPushBackPoint().valid());
+        if (a->getPushBackPoint()) {
+            CPPUNIT_ASSERT_EQUAL(a->getPushBackPoint()->getIndex(), b->getPushBackPoint()->getIndex());
+        }
+    }
+
+    // segments keep their order, and so their indices
+    for (unsigned int i = 1; parsed.findSegment(i); ++i) {
+        FGTaxiSegment* a = parsed.findSegment(i);
+        FGTaxiSegment* b = cached.findSegment(i);
+        CPPUNIT_ASSERT(b);
+        CPPUNIT_ASSERT_EQUAL(a->getStart()->getIndex(), b->getStart()->getIndex());
+        CPPUNIT_ASSERT_EQUAL(a->getEnd()->getIndex(), b->getEnd()->getIndex());
+        CPPUNIT_ASSERT_EQUAL(a->opposite() != nullptr, b->opposite() != nullptr);
+    }
+
+    // a cache for a different file is ignored
+    FGGroundNetwork other(egph.ptr());
+    CPPUNIT_ASSERT(!GroundNetLoader::readCache(&other, cacheFile, SGPath::fromUtf8(FG_TEST_SUITE_DATA) / "EDDF.groundnet.xml"));
+
+    // a background load returns an initialised network
+    auto load = GroundNetLoader::loadGroundNetwork(egph);
+    GroundNetLoader::GroundNetworkPtr net = load.get();
+    CPPUNIT_ASSERT(net);
+    CPPUNIT_ASSERT(net->exists());
+
+    SGPath(cacheFile).remove();
+    SGPath(GroundNetLoader::cachePathFor("EGPH")).remove();
+}
+
 void TrafficTests::testTrafficManager()
 {
     fgSetBool("/sim/traffic-manager/enabled", true);
@@ -143,3 +248,106 @@ void TrafficTests::testTrafficManager()
     tfc->bind();
     tfc->init();
 }
+
+void TrafficTests::testSchedulerBudget()
+{
+    auto tfc = globals->add_new_subsystem<FGTrafficManager>();
+    SGPropertyNode* scheduler = fgGetNode("/sim/traffic-manager/scheduler", true);
+    // no time at all: exactly one schedule per frame is processed
+    scheduler->setIntValue("budget-usec", 0);
+
+    const time_t now = globals->get_time_params()->get_cur_time();
+    const SGVec3d userCart = SGVec3d::fromGeod(FGAirport::getByIdent("EGLL")->geod());
+    TestSchedules schedules;
+    tfc->testSuiteSetSchedules(schedules.create(10), now, userCart);
+
+    tfc->testSuiteUpdateSchedules(now, userCart);
+    CPPUNIT_ASSERT_EQUAL(1, scheduler->getIntValue("processed"));
+    CPPUNIT_ASSERT_EQUAL(9, scheduler->getIntValue("backlog"));
+    CPPUNIT_ASSERT_EQUAL(0, scheduler->getIntValue("latency-sec"));
+    CPPUNIT_ASSERT_EQUAL(10, scheduler->getIntValue("queue-size"));
+
+    // the overdue ones are counted, and how late they are
+    tfc->testSuiteUpdateSchedules(now + 5, userCart);
+    CPPUNIT_ASSERT_EQUAL(1, scheduler->getIntValue("processed"));
+    CPPUNIT_ASSERT_EQUAL(8, scheduler->getIntValue("backlog"));
+    CPPUNIT_ASSERT_EQUAL(5, scheduler->getIntValue("latency-sec"));
+
+    // with enough time the backlog is cleared in one frame
+    scheduler->setIntValue("budget-usec", 1000000000);
+    tfc->testSuiteUpdateSchedules(now + 5, userCart);
+    CPPUNIT_ASSERT_EQUAL(8, scheduler->getIntValue("processed"));
+    CPPUNIT_ASSERT_EQUAL(0, scheduler->getIntValue("backlog"));
+
+    // far away traffic is not due again for a while
+    tfc->testSuiteUpdateSchedules(now + 6, userCart);
+    CPPUNIT_ASSERT_EQUAL(0, scheduler->getIntValue("processed"));
+    CPPUNIT_ASSERT_EQUAL(10, scheduler->getIntValue("queue-size"));
+}
+
+void TrafficTests::testSchedulerReschedule()
+{
+    auto tfc = globals->add_new_subsystem<FGTrafficManager>();
+    SGPropertyNode* scheduler = fgGetNode("/sim/traffic-manager/scheduler", true);
+    scheduler->setIntValue("budget-usec", 1000000000);
+
+    time_t now = globals->get_time_params()->get_cur_time();
+    SGVec3d userCart = SGVec3d::fromGeod(FGAirport::getByIdent("EGLL")->geod());
+    TestSchedules schedules;
+    tfc->testSuiteSetSchedules(schedules.create(10), now, userCart);
+
+    tfc->testSuiteUpdateSchedules(now, userCart);
+    CPPUNIT_ASSERT_EQUAL(10, scheduler->getIntValue("processed"));
+    tfc->testSuiteUpdateSchedules(++now, userCart);
+    CPPUNIT_ASSERT_EQUAL(0, scheduler->getIntValue("processed"));
+
+    // a relocation makes everything due at once
+    userCart = SGVec3d::fromGeod(FGAirport::getByIdent("KSFO")->geod());
+    tfc->testSuiteUpdateSchedules(++now, userCart);
+    CPPUNIT_ASSERT_EQUAL(10, scheduler->getIntValue("processed"));
+    tfc->testSuiteUpdateSchedules(++now, userCart);
+    CPPUNIT_ASSERT_EQUAL(0, scheduler->getIntValue("processed"));
+
+    // and so does a change of the time warp
+    fgSetInt("/sim/time/warp", 3600);
+    tfc->testSuiteUpdateSchedules(now + 3600, userCart);
+    CPPUNIT_ASSERT_EQUAL(10, scheduler->getIntValue("processed"));
+    now += 3600;
+    tfc->testSuiteUpdateSchedules(++now, userCart);
+    CPPUNIT_ASSERT_EQUAL(0, scheduler->getIntValue("processed"));
+
+    // or simulated time going back
+    tfc->testSuiteUpdateSchedules(now - 600, userCart);
+    CPPUNIT_ASSERT_EQUAL(10, scheduler->getIntValue("processed"));
+    CPPUNIT_ASSERT_EQUAL(0, scheduler->getIntValue("backlog"));
+}
+
+void TrafficTests::testNextUpdateTime()
+{
+    globals->add_new_subsystem<FGTrafficManager>();
+
+    // the first leg ends within a day, and is over two days from now; the
+    // next one departs from EGLL in three days
+    const time_t now = globals->get_time_params()->get_cur_time() + 2 * 24 * 3600;
+    const int weekday = (globals->get_time_params()->getGmt()->tm_wday + 3) % 7;
+    TestSchedules schedules;
+    FGAISchedule* schedule = schedules.add("G-NEXT");
+    schedules.assign(schedule, "YSSY", "YMML", "00:00:00", "23:00:00", "24Hr");
+    schedules.assign(schedule, "EGLL", "EDDF", std::to_string(weekday) + "/12:00:00",
+                     std::to_string(weekday) + "/14:00:00", "WEEK");
+
+    const SGVec3d userCart = SGVec3d::fromGeod(FGAirport::getByIdent("LEMD")->geod());
+    const double distanceNm = dist(userCart, SGVec3d::fromGeod(FGAirport::getByIdent("EGLL")->geod())) * SG_METER_TO_NM;
+
+    // update() moves on to the EGLL leg without computing the distance
+    CPPUNIT_ASSERT(schedule->update(now, userCart));
+    CPPUNIT_ASSERT_EQUAL(std::string("EGLL"), schedule->getDepartureAirport()->getId());
+
+    // the next update is due when the aircraft at EGLL could be in
+    // prefetch range of the user at LEMD, not when the leg ends
+    const time_t next = schedule->getNextUpdateTime(now, userCart, 1000000);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(distanceNm, schedule->getDistanceToUser(), 1.0);
+    const double expected = (distanceNm - TRAFFICTOAIDISTTOPREFETCH) / TRAFFICMAXCLOSINGSPEED * 3600.0;
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, (double) (next - now), 2.0);
+    CPPUNIT_ASSERT(next < schedule->getDepartureTime());
+}
@@ -35,6 +35,10 @@ class TrafficTests : public CppUnit::TestFixture
     CPPUNIT_TEST_SUITE(TrafficTests);
     CPPUNIT_TEST(testTrafficManager);
     CPPUNIT_TEST(testPushback);
+    CPPUNIT_TEST(testGroundNetCache);
+    CPPUNIT_TEST(testSchedulerBudget);
+    CPPUNIT_TEST(testSchedulerReschedule);
+    CPPUNIT_TEST(testNextUpdateTime);
     CPPUNIT_TEST_SUITE_END();
 
 
@@ -48,4 +52,8 @@ public:
     // The tests.
     void testTrafficManager();
     void testPushback();
+    void testGroundNetCache();
+    void testSchedulerBudget();
+    void testSchedulerReschedule();
+    void testNextUpdateTime();
 };
@@ -17,10 +17,12 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "testAutopilotPlan.hxx"
 #include "testDigitalFilter.hxx"
 #include "testPidController.hxx"
 
 
 // Set up the unit tests.
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(AutopilotPlanTests, "Unit tests");
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(DigitalFilterTests, "Unit tests");
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(PidControllerTests, "Unit tests");
@@ -0,0 +1,306 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testAutopilotPlan.hxx"
+
+#include <sstream>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <Autopilot/autopilot.hxx>
+#include <Autopilot/inputvalue.hxx>
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/props/props_io.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+namespace {
+
+const int CHAINS = 100;
+const int DEPTH = 5;
+
+std::string stageProp(int chain, int stage)
+{
+    std::ostringstream os;
+    os << "/test/chain[" << chain << "]/stage[" << stage << "]";
+    return os.str();
+}
+
+// CHAINS independent chains of DEPTH gain stages, each adding 2 to its
+// input. The stages are listed last first, so in file order a change
+// takes DEPTH frames to reach the end of a chain.
+std::string ruleSetXML(const std::string& order)
+{
+    std::ostringstream os;
+    os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<PropertyList>\n";
+    if (!order.empty()) {
+        os << "<evaluation-order>" << order << "</evaluation-order>\n";
+    }
+
+    for (int stage = DEPTH; stage > 0; --stage) {
+        for (int chain = 0; chain < CHAINS; ++chain) {
+            os << "<filter><name>chain" << chain << "-stage" << stage << "</name>"
+               << "<type>gain</type><gain>2.0</gain>"
+               << "<input><prop>" << stageProp(chain, stage - 1) << "</prop>"
+               << "<scale>0.5</scale><offset>1.0</offset>"
+               << "<min>-1000</min><max>1000</max></input>"
+               << "<output><prop>" << stageProp(chain, stage) << "</prop></output>"
+               << "</filter>\n";
+        }
+    }
+
+    os << "</PropertyList>\n";
+    return os.str();
+}
+
+FGXMLAutopilot::Autopilot* createAutopilot(SGPropertyNode_ptr config, const std::string& name)
+{
+    auto ap = new FGXMLAutopilot::Autopilot(globals->get_props(), config);
+    globals->add_subsystem(name.c_str(), ap);
+    ap->bind();
+    ap->init();
+    return ap;
+}
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void AutopilotPlanTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("ap-plan");
+}
+
+
+// Clean up after each test.
+void AutopilotPlanTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+SGPropertyNode_ptr AutopilotPlanTests::configFromString(const std::string& s)
+{
+    SGPropertyNode_ptr config = new SGPropertyNode;
+
+    std::istringstream iss(s);
+    readProperties(iss, config);
+    return config;
+}
+
+
+void AutopilotPlanTests::testInputValues()
+{
+    using FGXMLAutopilot::InputValue;
+    auto root = globals->get_props();
+
+    auto constant = configFromString(R"(<?xml version="1.0" encoding="UTF-8"?>
+        <PropertyList>
+          <value>-4.0</value>
+          <scale>3.0</scale>
+          <offset><value>2.0</value><scale>0.5</scale></offset>
+          <max>-5.0</max>
+          <abs>true</abs>
+        </PropertyList>
+        )");
+    InputValue c(*root, *constant);
+    CPPUNIT_ASSERT(c.is_constant());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(11.0, c.get_value(), 1e-12);
+
+    auto property = configFromString(R"(<?xml version="1.0" encoding="UTF-8"?>
+        <PropertyList>
+          <prop>/test/input</prop>
+          <scale>2.0</scale>
+          <offset>-1.0</offset>
+          <min>0.0</min>
+          <max>10.0</max>
+        </PropertyList>
+        )");
+    InputValue p(*root, *property);
+    CPPUNIT_ASSERT(!p.is_constant());
+
+    const double inputs[] = {-3.0, 0.25, 2.0, 4.0, 7.0};
+    const double expected[] = {0.0, 0.0, 3.0, 7.0, 10.0};
+    for (int i = 0; i < 5; ++i) {
+        fgSetDouble("/test/input", inputs[i]);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], p.get_value(), 1e-12);
+    }
+
+    // a scale read from a property must be re-read on every call
+    auto dynamic = configFromString(R"(<?xml version="1.0" encoding="UTF-8"?>
+        <PropertyList>
+          <prop>/test/input</prop>
+          <scale><prop>/test/scale</prop></scale>
+        </PropertyList>
+        )");
+    InputValue d(*root, *dynamic);
+    fgSetDouble("/test/input", 3.0);
+    fgSetDouble("/test/scale", 2.0);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0, d.get_value(), 1e-12);
+    fgSetDouble("/test/scale", -1.0);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(-3.0, d.get_value(), 1e-12);
+}
+
+
+void AutopilotPlanTests::testDependencyOrder()
+{
+    auto config = configFromString(R"(<?xml version="1.0" encoding="UTF-8"?>
+        <PropertyList>
+          <evaluation-order>dependency</evaluation-order>
+          <filter>
+            <name>c</name>
+            <type>gain</type>
+            <gain>1.0</gain>
+            <input>/test/b</input>
+            <output>/test/c</output>
+          </filter>
+          <filter>
+            <name>b</name>
+            <type>gain</type>
+            <gain>1.0</gain>
+            <input><prop>/test/a</prop><offset>1.0</offset></input>
+            <output>/test/b</output>
+          </filter>
+          <filter>
+            <name>unrelated</name>
+            <type>gain</type>
+            <gain>1.0</gain>
+            <input>/test/x</input>
+            <output>/test/y</output>
+          </filter>
+          <filter>
+            <name>a</name>
+            <type>gain</type>
+            <gain>2.0</gain>
+            <input>/test/in</input>
+            <output>/test/a</output>
+          </filter>
+        </PropertyList>
+        )");
+
+    auto ap = createAutopilot(config, "ap");
+
+    const string_list expected = {"unrelated", "a", "b", "c"};
+    CPPUNIT_ASSERT(expected == ap->get_evaluation_order());
+
+    fgSetDouble("/test/in", 3.0);
+    ap->update(0.1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(7.0, fgGetDouble("/test/c"), 1e-12);
+}
+
+
+void AutopilotPlanTests::testBarriers()
+{
+    // the filter with an enable condition must stay between the others,
+    // and the cycle keeps its file order
+    auto config = configFromString(R"(<?xml version="1.0" encoding="UTF-8"?>
+        <PropertyList>
+          <evaluation-order>dependency</evaluation-order>
+          <filter>
+            <name>second</name>
+            <type>gain</type>
+            <input>/test/a</input>
+            <output>/test/b</output>
+          </filter>
+          <filter>
+            <name>first</name>
+            <type>gain</type>
+            <input>/test/in</input>
+            <output>/test/a</output>
+          </filter>
+          <filter>
+            <name>barrier</name>
+            <type>gain</type>
+            <enable>
+              <condition><property>/test/enabled</property></condition>
+            </enable>
+            <input>/test/b</input>
+            <output>/test/in</output>
+          </filter>
+          <filter>
+            <name>ping</name>
+            <type>gain</type>
+            <input>/test/pong</input>
+            <output>/test/ping</output>
+          </filter>
+          <filter>
+            <name>pong</name>
+            <type>gain</type>
+            <input>/test/ping</input>
+            <output>/test/pong</output>
+          </filter>
+        </PropertyList>
+        )");
+
+    auto ap = createAutopilot(config, "ap");
+
+    const string_list expected = {"first", "second", "barrier", "ping", "pong"};
+    CPPUNIT_ASSERT(expected == ap->get_evaluation_order());
+}
+
+
+void AutopilotPlanTests::testLargeRuleSet()
+{
+    const int frames = 2000;
+    double elapsedMSec[2];
+    const char* orders[] = {"", "dependency"};
+
+    for (int run = 0; run < 2; ++run) {
+        const bool dependencyOrder = (run == 1);
+        auto ap = createAutopilot(configFromString(ruleSetXML(orders[run])),
+                                  dependencyOrder ? "ap-dependency" : "ap-file");
+
+        SGTimeStamp st;
+        elapsedMSec[run] = 0.0;
+        for (int frame = 0; frame < frames; ++frame) {
+            const double in = (frame % 50) * 0.1;
+            for (int chain = 0; chain < CHAINS; ++chain) {
+                fgSetDouble(stageProp(chain, 0), in + chain);
+            }
+
+            st.stamp();
+            ap->update(1.0 / 120);
+            elapsedMSec[run] += st.elapsedMSec();
+
+            // sorted, a change reaches the end of each chain in the same
+            // frame; in file order, only the first stage is current
+            const int chain = frame % CHAINS;
+            const double last = fgGetDouble(stageProp(chain, DEPTH));
+            if (dependencyOrder) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(in + chain + 2 * DEPTH, last, 1e-9);
+            } else {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(in + chain + 2, fgGetDouble(stageProp(chain, 1)), 1e-9);
+                if (frame % 50 >= DEPTH) {
+                    CPPUNIT_ASSERT_DOUBLES_EQUAL(in - (DEPTH - 1) * 0.1 + chain + 2 * DEPTH, last, 1e-9);
+                }
+            }
+        }
+
+        if (dependencyOrder) {
+            const auto order = ap->get_evaluation_order();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(CHAINS * DEPTH), order.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("chain0-stage1"), order.front());
+            CPPUNIT_ASSERT_EQUAL(std::string("chain99-stage5"), order.back());
+        }
+    }
+
+    SG_LOG(SG_AUTOPILOT, SG_INFO, "Autopilot with " << CHAINS * DEPTH << " components, "
+           << frames << " frames: " << elapsedMSec[0] << " msec in file order, "
+           << elapsedMSec[1] << " msec in dependency order");
+}
@@ -0,0 +1,121 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_metarStore.hxx"
+
+#include <cstdio>
+
+#include "test_suite/FGTestApi/NavDataCache.hxx"
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <simgear/timing/timestamp.hxx>
+
+#include <Environment/fgmetar.hxx>
+#include <Environment/metarstore.hxx>
+
+using namespace Environment;
+
+
+// Set up function for each test.
+void MetarStoreTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("metarstore");
+    FGTestApi::setUp::initNavDataCache();
+    MetarStore::instance()->clear();
+}
+
+
+// Clean up after each test.
+void MetarStoreTests::tearDown()
+{
+    MetarStore::instance()->clear();
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void MetarStoreTests::testDecode()
+{
+    MetarStore* store = MetarStore::instance();
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, store->insertBatch({"EDDM 121350Z 24012G22KT 9999 -RA FEW020 BKN045 14/09 Q1013 NOSIG"}));
+
+    const MetarReport* r = store->find("eddm");
+    CPPUNIT_ASSERT(r);
+    CPPUNIT_ASSERT_EQUAL(std::string("EDDM"), r->stationId);
+    CPPUNIT_ASSERT_EQUAL(13, r->hour);
+    CPPUNIT_ASSERT_EQUAL(50, r->minute);
+    CPPUNIT_ASSERT_EQUAL(240, r->windDeg);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(12.0, r->windSpeedKt, 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(22.0, r->gustSpeedKt, 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(14.0, r->temperatureDegC, 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(9.0, r->dewpointDegC, 1e-6);
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, r->clouds.size());
+    // cloud bases are stored above MSL
+    CPPUNIT_ASSERT(r->clouds.begin()->first > 2000);
+    CPPUNIT_ASSERT(!r->phenomena.empty());
+
+    CPPUNIT_ASSERT(!store->find("KSFO"));
+}
+
+
+void MetarStoreTests::testNewerReportWins()
+{
+    MetarStore* store = MetarStore::instance();
+    store->insertBatch({"EDDM 121350Z 24012KT 9999 FEW020 14/09 Q1013"});
+    store->insertBatch({"EDDM 121320Z 18005KT 9999 FEW020 13/09 Q1012"});
+
+    CPPUNIT_ASSERT_EQUAL(240, store->find("EDDM")->windDeg);
+
+    store->insertBatch({"EDDM 121420Z 30008KT 9999 FEW020 15/09 Q1014"});
+    CPPUNIT_ASSERT_EQUAL(300, store->find("EDDM")->windDeg);
+}
+
+
+void MetarStoreTests::testBatch()
+{
+    // a few thousand stations, as received by the real weather controller
+    // in one frame when many METARs are requested at once
+    const int stations = 5000;
+    std::vector<std::string> metars;
+    char buf[128];
+    for (int i = 0; i < stations; ++i) {
+        ::snprintf(buf, sizeof(buf), "2024/05/12 13:50 X%03d 121350Z %03d%02dKT 9999 SCT%03d BKN%03d %02d/%02d Q10%02d",
+                   i % 1000, (i * 10) % 360, i % 30, 10 + i % 50, 60 + i % 100, i % 30, i % 20, i % 30);
+        // station ids are only unique within the 3 digits, use a letter
+        // prefix per thousand
+        buf[17] = 'A' + i / 1000;
+        metars.push_back(buf);
+    }
+    metars.push_back("not a metar");
+
+    SGTimeStamp st;
+    st.stamp();
+    std::vector<SGSharedPtr<FGMetar> > decoded;
+    size_t count = MetarStore::instance()->insertBatch(metars, &decoded);
+    const double elapsedMs = st.elapsedMSec();
+
+    CPPUNIT_ASSERT_EQUAL((size_t) stations, count);
+    CPPUNIT_ASSERT_EQUAL((size_t) stations, MetarStore::instance()->size());
+    CPPUNIT_ASSERT(MetarStore::instance()->find("C042"));
+
+    // the decoded reports line up with the input, failures are null
+    CPPUNIT_ASSERT_EQUAL(metars.size(), decoded.size());
+    CPPUNIT_ASSERT(decoded[2042]);
+    CPPUNIT_ASSERT_EQUAL(std::string("C042"), std::string(decoded[2042]->getId()));
+    CPPUNIT_ASSERT(!decoded.back());
+
+    SG_LOG(SG_GENERAL, SG_INFO, "MetarStore: decoded " << stations << " reports in " << elapsedMs << "ms");
+}
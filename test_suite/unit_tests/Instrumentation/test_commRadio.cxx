@@ -4,14 +4,18 @@
 #include <memory>
 
 #include "test_suite/FGTestApi/NavDataCache.hxx"
+#include "test_suite/FGTestApi/scene_graph.hxx"
 #include "test_suite/FGTestApi/testGlobals.hxx"
 
+#include <simgear/timing/timestamp.hxx>
+
 #include <Airports/airport.hxx>
 #include <Navaids/NavDataCache.hxx>
 
 #include <Instrumentation/commradio.hxx>
 #include <Main/fg_props.hxx>
 #include <Main/locale.hxx>
+#include <Radio/radio.hxx>
 
 // Set up function for each test.
 void CommRadioTests::setUp()
@@ -205,3 +209,38 @@ void CommRadioTests::testEPLLTuning25()
     CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, n->getDoubleValue("signal-quality-norm"), 1e-6);
 #endif
 }
+
+void CommRadioTests::testITMTransmissionRate()
+{
+    FGTestApi::setUp::initScenery();
+    FGRadioTransmission::clearTerrainProfileCache();
+
+    FGAirportRef apt = FGAirport::getByIdent("EDDM");
+    FGTestApi::setPositionAndStabilise(SGGeodesy::direct(apt->geod(), 90.0, 20000.0));
+
+    // a handful of ground stations, repeatedly transmitting
+    std::vector<SGGeod> stations;
+    for (int i = 0; i < 8; ++i) {
+        stations.push_back(SGGeod::fromGeodM(SGGeodesy::direct(apt->geod(), i * 45.0, 5000.0), 500.0));
+    }
+
+    FGRadioTransmission radio;
+    const double firstSignal = radio.receiveNav(stations.front(), 118.0, 1);
+    CPPUNIT_ASSERT_EQUAL(1u, FGRadioTransmission::terrainProfileCacheMisses());
+
+    const int transmissions = 2000;
+    SGTimeStamp st;
+    st.stamp();
+    for (int i = 0; i < transmissions; ++i) {
+        radio.receiveNav(stations[i % stations.size()], 118.0, 1);
+    }
+    const double seconds = st.elapsedUSec() * 1e-6;
+
+    // every path was sampled once, all further transmissions reuse it
+    CPPUNIT_ASSERT_EQUAL((unsigned int) stations.size(), FGRadioTransmission::terrainProfileCacheMisses());
+    CPPUNIT_ASSERT_EQUAL((unsigned int) transmissions + 1 - (unsigned int) stations.size(),
+                         FGRadioTransmission::terrainProfileCacheHits());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(firstSignal, radio.receiveNav(stations.front(), 118.0, 1), 1e-9);
+
+    SG_LOG(SG_GENERAL, SG_INFO, "ITM: " << transmissions / seconds << " transmissions per second");
+}
@@ -17,12 +17,24 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "test_aircraftMetadataCache.hxx"
 #include "test_autosaveMigration.hxx"
+#include "test_fastReset.hxx"
+#include "test_frameProfiler.hxx"
+#include "test_logger.hxx"
 #include "test_posinit.hxx"
+#include "test_propertyTreeCache.hxx"
+#include "test_stateSnapshot.hxx"
 #include "test_timeManager.hxx"
 
 
 // Set up the unit tests.
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(AircraftMetadataCacheTests, "Unit tests");
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(AutosaveMigrationTests, "Unit tests");
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(FastResetTests, "Unit tests");
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(FrameProfilerTests, "Unit tests");
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(LoggerTests, "Unit tests");
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(PosInitTests, "Unit tests");
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(PropertyTreeCacheTests, "Unit tests");
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(StateSnapshotTests, "Unit tests");
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(TimeManagerTests, "Unit tests");
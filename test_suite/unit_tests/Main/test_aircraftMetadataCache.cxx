@@ -0,0 +1,177 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "test_aircraftMetadataCache.hxx"
+
+#include <algorithm>
+
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/misc/sg_dir.hxx>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <Main/AircraftMetadataCache.hxx>
+#include <Main/globals.hxx>
+
+using namespace flightgear;
+
+namespace {
+
+void writeSetFile(const SGPath& path, const std::string& simContents)
+{
+    SGPath dir = path.dirPath();
+    if (!dir.exists()) {
+        simgear::Dir(dir).create(0755);
+    }
+
+    sg_ofstream of(path);
+    of << "<?xml version=\"1.0\"?>"
+          "<PropertyList>"
+       << simContents
+       << "</PropertyList>";
+    of.close();
+}
+
+SGPath aircraftDir()
+{
+    return globals->get_fg_home() / "test_aircraft_metadata";
+}
+
+} // of anonymous namespace
+
+// Set up function for each test.
+void AircraftMetadataCacheTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("aircraftMetadataCache");
+
+    simgear::Dir d(aircraftDir());
+    if (d.exists()) {
+        d.remove(true);
+    }
+
+    writeSetFile(aircraftDir() / "Alpha" / "alpha-set.xml",
+                 "<sim><description>Alpha</description><status>beta</status>"
+                 "<tags><tag>jet</tag><tag>retractable-gear</tag></tags></sim>");
+    writeSetFile(aircraftDir() / "Alpha" / "alpha-variant-set.xml",
+                 "<sim><description>Alpha variant</description><variant-of>alpha</variant-of></sim>");
+    writeSetFile(aircraftDir() / "Bravo" / "bravo-set.xml",
+                 "<sim><description>Bravo</description><exclude-from-gui>true</exclude-from-gui></sim>");
+    writeSetFile(aircraftDir() / "Charlie" / "charlie-set.xml", "<nosim>1</nosim>");
+}
+
+
+// Clean up after each test.
+void AircraftMetadataCacheTests::tearDown()
+{
+    simgear::Dir(aircraftDir()).remove(true);
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void AircraftMetadataCacheTests::testScan()
+{
+    AircraftMetadataCache cache(globals->get_fg_home() / "test-scan.cache");
+    simgear::PathList setFiles = AircraftMetadataCache::findSetFiles({aircraftDir()});
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), setFiles.size());
+
+    std::sort(setFiles.begin(), setFiles.end(), [](const SGPath& a, const SGPath& b) {
+        return a.utf8Str() < b.utf8Str();
+    });
+    const auto metadata = cache.update(setFiles, 3);
+    CPPUNIT_ASSERT_EQUAL(setFiles.size(), metadata.size());
+
+    const AircraftMetadata& alpha = metadata.at(0);
+    CPPUNIT_ASSERT_EQUAL(std::string{"alpha-set.xml"}, alpha.path.file());
+    CPPUNIT_ASSERT(alpha.valid);
+    CPPUNIT_ASSERT(alpha.isPrimary);
+    CPPUNIT_ASSERT_EQUAL(std::string{"Alpha"}, alpha.description);
+    CPPUNIT_ASSERT_EQUAL(std::string{"beta"}, alpha.status);
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), alpha.tags.size());
+
+    const AircraftMetadata& variant = metadata.at(1);
+    CPPUNIT_ASSERT(!variant.isPrimary);
+    CPPUNIT_ASSERT_EQUAL(std::string{"alpha"}, variant.variantOf);
+
+    CPPUNIT_ASSERT(metadata.at(2).excluded);
+    CPPUNIT_ASSERT(metadata.at(3).parsed);
+    CPPUNIT_ASSERT(!metadata.at(3).valid);
+
+    // lookups only trust directories which were scanned completely
+    CPPUNIT_ASSERT(cache.findSetFile("alpha-set.xml", {aircraftDir()}).isNull());
+    cache.markScanned({aircraftDir()});
+    CPPUNIT_ASSERT_EQUAL(alpha.path, cache.findSetFile("ALPHA-set.xml", {aircraftDir()}));
+    CPPUNIT_ASSERT(cache.findSetFile("delta-set.xml", {aircraftDir()}).isNull());
+    CPPUNIT_ASSERT(cache.findSetFile("alpha-set.xml", {globals->get_fg_home() / "elsewhere"}).isNull());
+
+    // a changed file is no longer found, until it is parsed again
+    writeSetFile(alpha.path, "<sim><description>Alpha, modified</description></sim>");
+    CPPUNIT_ASSERT(cache.findSetFile("alpha-set.xml", {aircraftDir()}).isNull());
+    CPPUNIT_ASSERT_EQUAL(std::string{"Alpha, modified"}, cache.update({alpha.path}).front().description);
+    CPPUNIT_ASSERT_EQUAL(alpha.path, cache.findSetFile("alpha-set.xml", {aircraftDir()}));
+}
+
+
+void AircraftMetadataCacheTests::testPersistence()
+{
+    const SGPath cacheFile = globals->get_fg_home() / "test-persistence.cache";
+    SGPath(cacheFile).remove();
+
+    const simgear::PathList setFiles = AircraftMetadataCache::findSetFiles({aircraftDir()});
+    {
+        AircraftMetadataCache cache(cacheFile);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), cache.size());
+        cache.update(setFiles);
+        cache.markScanned({aircraftDir()});
+        CPPUNIT_ASSERT(cache.save());
+    }
+
+    AircraftMetadataCache cache(cacheFile);
+    CPPUNIT_ASSERT_EQUAL(setFiles.size(), cache.size());
+    CPPUNIT_ASSERT(!cache.findSetFile("bravo-set.xml", {aircraftDir()}).isNull());
+
+    // entries of removed files are dropped when updated
+    const SGPath bravo = aircraftDir() / "Bravo" / "bravo-set.xml";
+    SGPath(bravo).remove();
+    CPPUNIT_ASSERT(cache.findSetFile("bravo-set.xml", {aircraftDir()}).isNull());
+    cache.update({bravo});
+    CPPUNIT_ASSERT_EQUAL(setFiles.size() - 1, cache.size());
+}
+
+
+// a higher priority directory which was never scanned may hold the same
+// aircraft, so the cached one must not be used
+void AircraftMetadataCacheTests::testUnscannedDir()
+{
+    AircraftMetadataCache cache(globals->get_fg_home() / "test-unscanned.cache");
+    cache.update(AircraftMetadataCache::findSetFiles({aircraftDir()}));
+    cache.markScanned({aircraftDir()});
+
+    const SGPath devDir = globals->get_fg_home() / "test_aircraft_dev";
+    writeSetFile(devDir / "Alpha" / "alpha-set.xml", "<sim><description>Alpha dev</description></sim>");
+
+    CPPUNIT_ASSERT(!cache.findSetFile("alpha-set.xml", {aircraftDir()}).isNull());
+    CPPUNIT_ASSERT(cache.findSetFile("alpha-set.xml", {devDir, aircraftDir()}).isNull());
+
+    cache.update(AircraftMetadataCache::findSetFiles({devDir}));
+    cache.markScanned({devDir});
+    CPPUNIT_ASSERT_EQUAL(devDir / "Alpha" / "alpha-set.xml",
+                         cache.findSetFile("alpha-set.xml", {devDir, aircraftDir()}));
+
+    simgear::Dir(devDir).remove(true);
+}
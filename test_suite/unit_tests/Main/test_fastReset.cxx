@@ -0,0 +1,145 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "test_fastReset.hxx"
+
+#include "test_suite/FGTestApi/NavDataCache.hxx"
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <simgear/props/props_io.hxx>
+
+#include <AIModel/AIManager.hxx>
+#include <AIModel/performancedb.hxx>
+#include <ATC/atc_mgr.hxx>
+#include <Airports/airport.hxx>
+#include <Airports/airportdynamicsmanager.hxx>
+#include <Main/fg_init.hxx>
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+#include <Main/options.hxx>
+#include <Main/positioninit.hxx>
+
+using namespace flightgear;
+
+// Set up function for each test.
+void FastResetTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("fastReset");
+    FGTestApi::setUp::initNavDataCache();
+    Options::reset();
+    fgLoadProps("defaults.xml", globals->get_props());
+
+    globals->add_new_subsystem<flightgear::AirportDynamicsManager>();
+    globals->add_new_subsystem<PerformanceDB>();
+    globals->add_new_subsystem<FGATCManager>();
+    globals->add_new_subsystem<FGAIManager>();
+
+    {
+        Options* opts = Options::sharedInstance();
+        opts->setShouldLoadDefaultConfig(false);
+
+        const char* args[] = {"dummypath", "--airport=EDDF"};
+        opts->init(2, (char**) args, SGPath());
+        opts->processOptions();
+    }
+
+    fgSetString("/sim/aircraft", "test-suite-aircraft");
+    initPosition();
+}
+
+
+// Clean up after each test.
+void FastResetTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void FastResetTests::testFastReset()
+{
+    fgSetBool("/sim/startup/fast-reset", true);
+    fgSetDouble("/controls/flight/flaps", 0.0);
+    SGPropertyNode* archived = fgGetNode("/sim/test/archived", true);
+    archived->setStringValue("initial");
+    archived->setAttribute(SGPropertyNode::USERARCHIVE, true);
+    fgSaveInitialState();
+
+    // fly somewhere else, and pick a new position to reset to
+    fgSetDouble("/controls/flight/flaps", 0.5);
+    fgSetBool("/sim/crashed", true);
+    archived->setStringValue("changed");
+    fgSetString("/sim/presets/airport-id", "EGLL");
+
+    CPPUNIT_ASSERT(fgStartFastReset());
+
+    // the state is restored, except for user-archived values
+    CPPUNIT_ASSERT_EQUAL(0.0, fgGetDouble("/controls/flight/flaps"));
+    CPPUNIT_ASSERT(!fgGetBool("/sim/crashed"));
+    CPPUNIT_ASSERT(!fgGetBool("/sim/signals/reinit"));
+    CPPUNIT_ASSERT_EQUAL(std::string{"changed"}, std::string{fgGetString("/sim/test/archived")});
+
+    // at the new position
+    CPPUNIT_ASSERT_EQUAL(std::string{"EGLL"}, std::string{fgGetString("/sim/presets/airport-id")});
+    const double dist = SGGeodesy::distanceM(globals->get_aircraft_position(),
+                                             FGAirport::getByIdent("EGLL")->geod());
+    CPPUNIT_ASSERT(dist < 10000.0);
+    CPPUNIT_ASSERT(fgGetDouble("/sim/startup/last-reset-msec") >= 0.0);
+}
+
+
+void FastResetTests::testDisabled()
+{
+    // with no saved state, a full reset is needed
+    fgSaveInitialState();
+    CPPUNIT_ASSERT(!fgStartFastReset());
+
+    // and it is only saved when enabled
+    fgSetBool("/sim/startup/fast-reset", true);
+    CPPUNIT_ASSERT(!fgStartFastReset());
+    fgSaveInitialState();
+    CPPUNIT_ASSERT(fgStartFastReset());
+}
+
+
+void FastResetTests::testAircraftChanged()
+{
+    fgSetBool("/sim/startup/fast-reset", true);
+    fgSaveInitialState();
+
+    fgSetString("/sim/aircraft", "ufo");
+    CPPUNIT_ASSERT(!fgStartFastReset());
+}
+
+
+void FastResetTests::testNoGhostNodes()
+{
+    // nodes owned by AI models and canvases which go away after the state
+    // was saved must not come back with the reset
+    fgSetBool("/sim/startup/fast-reset", true);
+    fgSetString("/ai/models/aircraft[7]/callsign", "GHOST");
+    fgSetInt("/canvas/by-index/texture[5]/size", 256);
+    fgSaveInitialState();
+
+    fgGetNode("/ai/models")->removeChild("aircraft", 7);
+    fgGetNode("/canvas/by-index")->removeChild("texture", 5);
+
+    CPPUNIT_ASSERT(fgStartFastReset());
+    CPPUNIT_ASSERT(!fgGetNode("/ai/models/aircraft[7]"));
+    CPPUNIT_ASSERT(!fgGetNode("/canvas/by-index/texture[5]"));
+}
@@ -0,0 +1,320 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_frameProfiler.hxx"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/misc/sg_path.hxx>
+#include <simgear/structure/subsystem_mgr.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Main/FrameProfiler.hxx>
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+
+using flightgear::FrameProfiler;
+
+namespace {
+
+void spin(double usec)
+{
+    SGTimeStamp st;
+    st.stamp();
+    while (st.elapsedUSec() < usec) {
+    }
+}
+
+class BusySubsystem : public SGSubsystem
+{
+public:
+    void update(double) override { spin(500); }
+};
+
+std::string readFile(const SGPath& path)
+{
+    std::ifstream in(path.utf8Str().c_str());
+    std::ostringstream os;
+    os << in.rdbuf();
+    return os.str();
+}
+
+} // of anonymous namespace
+
+// Set up function for each test.
+void FrameProfilerTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("FrameProfiler");
+    FrameProfiler::clear();
+    FrameProfiler::setEnabled(true);
+}
+
+// Clean up after each test.
+void FrameProfilerTests::tearDown()
+{
+    FrameProfiler::setEnabled(false);
+    FrameProfiler::setPropertyRoot(nullptr);
+    FrameProfiler::clear();
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+void FrameProfilerTests::testPercentiles()
+{
+    const int id = FrameProfiler::scopeId("percentiles");
+    FrameProfiler::beginFrame();
+    for (int i = 1; i <= 1000; ++i) {
+        FrameProfiler::addSample(id, i);
+    }
+    FrameProfiler::endFrame();
+
+    FrameProfiler::Stats stats;
+    CPPUNIT_ASSERT(FrameProfiler::getStats("frame/percentiles", stats));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1000), stats.samples);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5005, stats.meanMSec, 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, stats.maxMSec, 1e-9);
+
+    // within the resolution of the histogram: a quarter octave
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.50, stats.p50MSec, 0.50 * 0.2);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.95, stats.p95MSec, 0.95 * 0.2);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.99, stats.p99MSec, 0.99 * 0.2);
+    CPPUNIT_ASSERT(stats.p50MSec <= stats.p95MSec);
+    CPPUNIT_ASSERT(stats.p95MSec <= stats.p99MSec);
+    CPPUNIT_ASSERT(stats.p99MSec <= stats.maxMSec);
+
+    CPPUNIT_ASSERT(!FrameProfiler::getStats("frame/no-such-scope", stats));
+}
+
+void FrameProfilerTests::testHierarchy()
+{
+    const int outerId = FrameProfiler::scopeId("outer");
+    const int innerId = FrameProfiler::scopeId("inner");
+    const int nestedId = FrameProfiler::scopeId("flight/fdm");
+
+    for (int frame = 0; frame < 3; ++frame) {
+        FrameProfiler::beginFrame();
+        CPPUNIT_ASSERT(FrameProfiler::isActive());
+        {
+            FrameProfiler::Scope outer(outerId);
+            spin(200);
+            {
+                FrameProfiler::Scope inner(innerId);
+                spin(500);
+            }
+        }
+        {
+            FrameProfiler::Scope fdm(nestedId);
+        }
+
+        // other threads are not profiled
+        std::thread t([innerId] { FrameProfiler::Scope ignored(innerId); });
+        t.join();
+
+        FrameProfiler::endFrame();
+    }
+
+    // outside of a frame, nothing is recorded
+    CPPUNIT_ASSERT(!FrameProfiler::isActive());
+    {
+        FrameProfiler::Scope ignored(FrameProfiler::scopeId("between-frames"));
+    }
+
+    FrameProfiler::Stats frame, outer, inner, fdm, interval, stats;
+    CPPUNIT_ASSERT(FrameProfiler::getStats("frame", frame));
+    CPPUNIT_ASSERT(FrameProfiler::getStats("frame/outer", outer));
+    CPPUNIT_ASSERT(FrameProfiler::getStats("frame/outer/inner", inner));
+    CPPUNIT_ASSERT(FrameProfiler::getStats("frame/flight/fdm", fdm));
+    CPPUNIT_ASSERT(FrameProfiler::getStats("frame-interval", interval));
+    CPPUNIT_ASSERT(!FrameProfiler::getStats("frame/inner", stats));
+    CPPUNIT_ASSERT(!FrameProfiler::getStats("between-frames", stats));
+    CPPUNIT_ASSERT(!FrameProfiler::getStats("frame/between-frames", stats));
+
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), frame.samples);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), outer.samples);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), inner.samples);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), fdm.samples);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), interval.samples);
+
+    CPPUNIT_ASSERT(inner.meanMSec >= 0.5);
+    CPPUNIT_ASSERT(outer.meanMSec >= inner.meanMSec + 0.2);
+    CPPUNIT_ASSERT(frame.meanMSec >= outer.meanMSec);
+}
+
+void FrameProfilerTests::testRollingWindow()
+{
+    const int id = FrameProfiler::scopeId("rolling");
+    FrameProfiler::beginFrame();
+    FrameProfiler::addSample(id, 100.0);
+    FrameProfiler::endFrame();
+
+    FrameProfiler::Stats stats;
+    for (int i = 1; i < FrameProfiler::WINDOW_SLICES; ++i) {
+        FrameProfiler::advanceWindow();
+        CPPUNIT_ASSERT(FrameProfiler::getStats("frame/rolling", stats));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), stats.samples);
+    }
+
+    // the slice holding the sample is reused
+    FrameProfiler::advanceWindow();
+    CPPUNIT_ASSERT(FrameProfiler::getStats("frame/rolling", stats));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), stats.samples);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, stats.maxMSec, 1e-9);
+}
+
+void FrameProfilerTests::testPublish()
+{
+    FrameProfiler::setPropertyRoot(fgGetNode("/sim/performance/profile", true));
+
+    const int id = FrameProfiler::scopeId("published/with space");
+    FrameProfiler::beginFrame();
+    FrameProfiler::addSample(id, 2000.0);
+    FrameProfiler::addSample(id, 4000.0);
+    FrameProfiler::endFrame();
+    FrameProfiler::advanceWindow();
+
+    const std::string path = "/sim/performance/profile/frame/published/with-space/";
+    CPPUNIT_ASSERT_EQUAL(10, fgGetInt("/sim/performance/profile/window-sec"));
+    CPPUNIT_ASSERT_EQUAL(2L, fgGetLong(path + "samples"));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, fgGetDouble(path + "mean-ms"), 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, fgGetDouble(path + "max-ms"), 1e-9);
+    CPPUNIT_ASSERT(fgGetDouble(path + "p50-ms") > 1.5);
+    CPPUNIT_ASSERT_EQUAL(1L, fgGetLong("/sim/performance/profile/frame/samples"));
+
+    std::ostringstream json;
+    FrameProfiler::writeJSON(json);
+    const std::string s = json.str();
+    CPPUNIT_ASSERT(s.find("\"enabled\":true") != std::string::npos);
+    CPPUNIT_ASSERT(s.find("\"path\":\"frame/published/with-space\",\"samples\":2,") != std::string::npos);
+    CPPUNIT_ASSERT_EQUAL('{', s.front());
+    CPPUNIT_ASSERT_EQUAL('}', s.back());
+}
+
+void FrameProfilerTests::testSubsystems()
+{
+    auto mgr = globals->get_subsystem_mgr();
+    globals->add_subsystem("busy", new BusySubsystem, SGSubsystemMgr::GENERAL);
+
+    // the manager only times subsystems once the hook is installed, so the
+    // first frame has nothing to report
+    const int subsystemsId = FrameProfiler::scopeId("subsystems");
+    for (int frame = 0; frame < 3; ++frame) {
+        FrameProfiler::beginFrame();
+        {
+            FrameProfiler::Scope profile(subsystemsId);
+            mgr->update(0.01);
+            FrameProfiler::collectSubsystemTimes(mgr, true);
+        }
+        FrameProfiler::endFrame();
+    }
+
+    FrameProfiler::Stats busy, subsystems;
+    CPPUNIT_ASSERT(FrameProfiler::getStats("frame/subsystems", subsystems));
+    CPPUNIT_ASSERT(FrameProfiler::getStats("frame/subsystems/busy", busy));
+    CPPUNIT_ASSERT(busy.samples >= 2);
+    CPPUNIT_ASSERT(busy.maxMSec > 0.0);
+    CPPUNIT_ASSERT(busy.maxMSec <= subsystems.maxMSec);
+
+    // disabling releases the hook
+    FrameProfiler::setEnabled(false);
+    FrameProfiler::beginFrame();
+    mgr->update(0.01);
+    FrameProfiler::collectSubsystemTimes(mgr, true);
+    FrameProfiler::endFrame();
+
+    FrameProfiler::Stats after;
+    CPPUNIT_ASSERT(FrameProfiler::getStats("frame/subsystems/busy", after));
+    CPPUNIT_ASSERT_EQUAL(busy.samples, after.samples);
+}
+
+void FrameProfilerTests::testTrace()
+{
+    // tracing works with the profiler otherwise disabled
+    FrameProfiler::setEnabled(false);
+
+    SGPath path = globals->get_fg_home() / "frame-trace.json";
+    path.remove();
+
+    const int id = FrameProfiler::scopeId("traced/step");
+    FrameProfiler::requestTrace(path, 3);
+    CPPUNIT_ASSERT(FrameProfiler::isTracing());
+
+    for (int frame = 0; frame < 4; ++frame) {
+        FrameProfiler::beginFrame();
+        CPPUNIT_ASSERT_EQUAL(frame < 3, FrameProfiler::isActive());
+        {
+            FrameProfiler::Scope profile(id);
+            spin(100);
+        }
+        FrameProfiler::endFrame();
+    }
+
+    CPPUNIT_ASSERT(!FrameProfiler::isTracing());
+    CPPUNIT_ASSERT(path.exists());
+
+    const std::string trace = readFile(path);
+    CPPUNIT_ASSERT(trace.find("\"traceEvents\":[") != std::string::npos);
+    CPPUNIT_ASSERT(trace.find("\"args\":{\"name\":\"main loop\"}") != std::string::npos);
+
+    // three frames, with one nested scope each
+    size_t steps = 0, frames = 0;
+    for (size_t pos = 0; (pos = trace.find("\"name\":\"step\"", pos)) != std::string::npos; ++pos) {
+        ++steps;
+    }
+    for (size_t pos = 0; (pos = trace.find("\"path\":\"frame\"", pos)) != std::string::npos; ++pos) {
+        ++frames;
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(3), steps);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), frames);
+    CPPUNIT_ASSERT(trace.find("\"path\":\"frame/traced/step\"") != std::string::npos);
+}
+
+void FrameProfilerTests::testOverhead()
+{
+    const int id = FrameProfiler::scopeId("overhead");
+    const int iterations = 1000000;
+
+    FrameProfiler::setEnabled(false);
+    FrameProfiler::beginFrame();
+    SGTimeStamp st;
+    st.stamp();
+    for (int i = 0; i < iterations; ++i) {
+        FrameProfiler::Scope profile(id);
+    }
+    const double disabledNSec = st.elapsedUSec() * 1000.0 / iterations;
+    FrameProfiler::endFrame();
+
+    FrameProfiler::setEnabled(true);
+    FrameProfiler::beginFrame();
+    st.stamp();
+    for (int i = 0; i < iterations; ++i) {
+        FrameProfiler::Scope profile(id);
+    }
+    const double enabledNSec = st.elapsedUSec() * 1000.0 / iterations;
+    FrameProfiler::endFrame();
+
+    FrameProfiler::Stats stats;
+    CPPUNIT_ASSERT(FrameProfiler::getStats("frame/overhead", stats));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(iterations), stats.samples);
+
+    SG_LOG(SG_GENERAL, SG_INFO, "FrameProfiler scope overhead: " << disabledNSec
+           << "ns disabled, " << enabledNSec << "ns enabled");
+}
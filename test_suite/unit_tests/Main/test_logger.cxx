@@ -0,0 +1,321 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_logger.hxx"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/misc/sg_path.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+#include <Main/LogWriter.hxx>
+#include <Main/logger.hxx>
+#include <Main/util.hxx>
+
+namespace {
+
+SGPath exportPath(const std::string& name)
+{
+    return globals->get_fg_home() / "Export" / name;
+}
+
+std::string readFile(const SGPath& path)
+{
+    std::ifstream in(path.utf8Str().c_str(), std::ios::in | std::ios::binary);
+    std::ostringstream os;
+    os << in.rdbuf();
+    return os.str();
+}
+
+// add /logging/log[index] for the test properties
+SGPropertyNode* addLog(int index, const std::string& file, long intervalMSec)
+{
+    SGPropertyNode* log = fgGetNode("/logging/log", index, true);
+    log->setBoolValue("enabled", true);
+    log->setStringValue("filename", exportPath(file).utf8Str());
+    log->setLongValue("interval-ms", intervalMSec);
+
+    const char* props[] = {"/test/double", "/test/int", "/test/bool", "/test/string", "/test/float"};
+    for (int i = 0; i < 5; ++i) {
+        SGPropertyNode* entry = log->getChild("entry", i, true);
+        entry->setBoolValue("enabled", true);
+        entry->setStringValue("property", props[i]);
+    }
+    return log;
+}
+
+void setTestValues(int frame)
+{
+    fgSetDouble("/test/double", frame * 0.123456789);
+    fgSetInt("/test/int", frame * 7);
+    fgSetBool("/test/bool", (frame % 2) == 0);
+    fgSetString("/test/string", "frame " + std::to_string(frame));
+    fgSetFloat("/test/float", frame * 0.1f);
+}
+
+void runFrames(FGLogger& logger, int frames)
+{
+    const double dt = 1.0 / 60.0;
+    for (int f = 0; f < frames; ++f) {
+        setTestValues(f);
+        globals->inc_sim_time_sec(dt);
+        logger.update(dt);
+    }
+}
+
+uint32_t readU32(const std::string& s, size_t& pos)
+{
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) {
+        v = (v << 8) | static_cast<uint8_t>(s[pos + i]);
+    }
+    pos += 4;
+    return v;
+}
+
+double readDouble(const std::string& s, size_t& pos)
+{
+    uint64_t bits = 0;
+    for (int i = 7; i >= 0; --i) {
+        bits = (bits << 8) | static_cast<uint8_t>(s[pos + i]);
+    }
+    pos += 8;
+
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+std::string readString(const std::string& s, size_t& pos)
+{
+    const uint32_t len = readU32(s, pos);
+    const std::string result = s.substr(pos, len);
+    pos += len;
+    return result;
+}
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void LoggerTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("logger");
+    fgInitAllowedPaths();
+
+    SGPath exportDir = globals->get_fg_home() / "Export";
+    if (!exportDir.exists()) {
+        (exportDir / "dummyFile").create_dir(0755);
+    }
+}
+
+
+// Clean up after each test.
+void LoggerTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+// The writer thread produces exactly what the synchronous logger does
+void LoggerTests::testAsyncCSV()
+{
+    addLog(0, "logger-sync.csv", 50);
+    SGPropertyNode* async = addLog(1, "logger-async.csv", 50);
+    async->setBoolValue("async", true);
+    async->setIntValue("flush-interval-ms", 5);
+
+    FGLogger logger;
+    logger.init();
+    runFrames(logger, 300);
+    logger.shutdown();
+
+    const std::string expected = readFile(exportPath("logger-sync.csv"));
+    const std::string actual = readFile(exportPath("logger-async.csv"));
+    CPPUNIT_ASSERT(expected.size() > 1000);
+    CPPUNIT_ASSERT_EQUAL(expected, actual);
+
+    CPPUNIT_ASSERT(async->getLongValue("written-records") > 0);
+    CPPUNIT_ASSERT_EQUAL(0L, async->getLongValue("dropped-records"));
+}
+
+
+void LoggerTests::testBinary()
+{
+    SGPropertyNode* log = addLog(0, "logger.bin", 100);
+    log->setStringValue("format", "binary");
+
+    FGLogger logger;
+    logger.init();
+    runFrames(logger, 600); // 10 seconds, 100 records
+    logger.shutdown();
+
+    const std::string data = readFile(exportPath("logger.bin"));
+    CPPUNIT_ASSERT_EQUAL(std::string("FGLOGBIN"), data.substr(0, 8));
+
+    size_t pos = 8;
+    CPPUNIT_ASSERT_EQUAL(1u, readU32(data, pos));
+    CPPUNIT_ASSERT_EQUAL(6u, readU32(data, pos));
+    CPPUNIT_ASSERT_EQUAL(std::string("Time"), readString(data, pos));
+    CPPUNIT_ASSERT_EQUAL(std::string("/test/double"), readString(data, pos));
+    for (int c = 2; c < 6; ++c) {
+        readString(data, pos);
+    }
+
+    // decode the blocks into rows
+    std::vector<std::vector<double>> numbers(6);
+    std::vector<std::string> strings;
+    while (pos < data.size()) {
+        const uint32_t rows = readU32(data, pos);
+        CPPUNIT_ASSERT(rows > 0);
+        for (int c = 0; c < 6; ++c) {
+            const uint8_t encoding = static_cast<uint8_t>(data[pos++]);
+            CPPUNIT_ASSERT_EQUAL(c == 4 ? 1 : 0, static_cast<int>(encoding));
+            for (uint32_t r = 0; r < rows; ++r) {
+                if (encoding == 0) {
+                    numbers[c].push_back(readDouble(data, pos));
+                } else {
+                    strings.push_back(readString(data, pos));
+                }
+            }
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(data.size(), pos);
+
+    // allowing for the rounding of the accumulated sim time
+    const size_t records = numbers[0].size();
+    CPPUNIT_ASSERT(records >= 99 && records <= 100);
+    CPPUNIT_ASSERT_EQUAL(records, strings.size());
+    CPPUNIT_ASSERT_EQUAL(records, static_cast<size_t>(log->getLongValue("written-records")));
+
+    for (size_t r = 0; r < records; ++r) {
+        // each record has the values set in the frame it was taken in
+        const int frame = static_cast<int>(std::lround(numbers[2][r] / 7.0));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(frame * 0.123456789, numbers[1][r], 1e-12);
+        CPPUNIT_ASSERT_EQUAL((frame % 2) == 0 ? 1.0 : 0.0, numbers[3][r]);
+        CPPUNIT_ASSERT_EQUAL("frame " + std::to_string(frame), strings[r]);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(frame * 0.1, numbers[5][r], 1e-4);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL((frame + 1) / 60.0, numbers[0][r], 1e-9);
+    }
+}
+
+
+// A writer which can't keep up drops records, and counts them
+void LoggerTests::testDrops()
+{
+    std::unique_ptr<sg_ofstream> output(new sg_ofstream(exportPath("logger-drops.csv"), std::ios_base::out));
+    std::vector<SGPropertyNode_ptr> nodes = {fgGetNode("/test/double", true)};
+
+    // the writer won't wake up by itself during the test
+    FGLogWriter writer(std::move(output), FGLogWriter::FORMAT_CSV, ',', {"value"}, 3, 100000);
+    CPPUNIT_ASSERT_EQUAL(size_t(4), writer.capacity());
+
+    int accepted = 0;
+    for (int i = 0; i < 100; ++i) {
+        fgSetDouble("/test/double", i);
+        if (writer.append(i, nodes)) {
+            ++accepted;
+        }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(4, accepted);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(96), writer.dropped());
+    CPPUNIT_ASSERT_EQUAL(size_t(4), writer.buffered());
+
+    writer.sync();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4), writer.written());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), writer.buffered());
+
+    // and there's room again
+    CPPUNIT_ASSERT(writer.append(100, nodes));
+    writer.sync();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(5), writer.written());
+
+    CPPUNIT_ASSERT_EQUAL(std::string("Time,value\n0,0\n1,1\n2,2\n3,3\n100,100\n"),
+                         readFile(exportPath("logger-drops.csv")));
+}
+
+
+// Main thread cost of logging many channels at a high rate
+void LoggerTests::testBenchmark()
+{
+    const int channels = 200;
+    const int frames = 2000;
+
+    auto configure = [](int index, const std::string& file) {
+        SGPropertyNode* log = fgGetNode("/logging/log", index, true);
+        log->setBoolValue("enabled", true);
+        log->setStringValue("filename", exportPath(file).utf8Str());
+        log->setLongValue("interval-ms", 16); // about every frame
+        for (int i = 0; i < channels; ++i) {
+            SGPropertyNode* entry = log->getChild("entry", i, true);
+            entry->setBoolValue("enabled", true);
+            entry->setStringValue("property", "/test/bench/value[" + std::to_string(i) + "]");
+        }
+        return log;
+    };
+
+    auto run = [&](const char* name) {
+        FGLogger logger;
+        logger.init();
+
+        double updateUSec = 0.0;
+        const double dt = 1.0 / 60.0;
+        for (int f = 0; f < frames; ++f) {
+            for (int i = 0; i < channels; ++i) {
+                fgSetDouble("/test/bench/value[" + std::to_string(i) + "]", f * 0.001 + i);
+            }
+            globals->inc_sim_time_sec(dt);
+
+            SGTimeStamp st;
+            st.stamp();
+            logger.update(dt);
+            updateUSec += st.elapsedUSec();
+        }
+
+        SGTimeStamp st;
+        st.stamp();
+        logger.shutdown();
+
+        SG_LOG(SG_GENERAL, SG_INFO, "Logger benchmark, " << name << ": " << frames << " frames of "
+               << channels << " channels, update() took " << updateUSec / frames
+               << "us per frame; shutdown " << st.elapsedMSec() << "ms");
+    };
+
+    configure(0, "logger-bench-sync.csv");
+    run("synchronous csv");
+
+    SGPropertyNode* log = configure(0, "logger-bench-async.csv");
+    log->setBoolValue("async", true);
+    run("async csv");
+
+    log->setStringValue("filename", exportPath("logger-bench.bin").utf8Str());
+    log->setStringValue("format", "binary");
+    run("binary");
+
+    CPPUNIT_ASSERT_EQUAL(0L, log->getLongValue("dropped-records"));
+}
@@ -0,0 +1,199 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "test_propertyTreeCache.hxx"
+
+#include <sstream>
+
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/misc/sg_dir.hxx>
+#include <simgear/props/props.hxx>
+#include <simgear/props/props_io.hxx>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <Main/PropertyTreeCache.hxx>
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+
+using namespace flightgear;
+
+namespace {
+
+SGPath testDir()
+{
+    return globals->get_fg_home() / "test_property_cache";
+}
+
+void writeFile(const SGPath& path, const std::string& contents)
+{
+    sg_ofstream of(path);
+    of << "<?xml version=\"1.0\"?>"
+          "<PropertyList>"
+       << contents
+       << "</PropertyList>";
+    of.close();
+}
+
+} // of anonymous namespace
+
+// Set up function for each test.
+void PropertyTreeCacheTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("propertyTreeCache");
+
+    simgear::Dir(PropertyTreeCache::cacheDir()).remove(true);
+    simgear::Dir d(testDir());
+    if (d.exists()) {
+        d.remove(true);
+    }
+    d.create(0755);
+
+    writeFile(testDir() / "systems.xml",
+              "<electrical include=\"electrical.xml\"/>"
+              "<pitot><name>pitot</name><number type=\"int\">0</number></pitot>"
+              "<pitot><name>pitot</name><number type=\"int\">1</number></pitot>");
+    writeFile(testDir() / "electrical.xml",
+              "<path>Aircraft/Generic/generic-electrical.xml</path>");
+}
+
+
+// Clean up after each test.
+void PropertyTreeCacheTests::tearDown()
+{
+    simgear::Dir(testDir()).remove(true);
+    simgear::Dir(PropertyTreeCache::cacheDir()).remove(true);
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void PropertyTreeCacheTests::testRoundTrip()
+{
+    SGPropertyNode_ptr source = new SGPropertyNode;
+    source->setBoolValue("a/bool", true);
+    source->setIntValue("a/int[2]", -42);
+    source->setLongValue("a/long", 1L << 40);
+    source->setDoubleValue("b/double", 0.125);
+    source->setFloatValue("b/float", 2.5f);
+    source->setStringValue("b/string", "hello world");
+    source->getNode("b/unspecified", true)->setUnspecifiedValue("12");
+    source->getNode("c/alias", true)->alias(source->getNode("a/int[2]"));
+    source->getNode("a/bool")->setAttribute(SGPropertyNode::ARCHIVE, true);
+    source->getNode("b/string")->setAttribute(SGPropertyNode::WRITE, false);
+    source->setStringValue("b/protected", "changed");
+
+    std::ostringstream os;
+    CPPUNIT_ASSERT(PropertyTreeCache::write(os, source.ptr()));
+    const std::string data = os.str();
+
+    // write-protected nodes are left alone, as by readProperties
+    SGPropertyNode_ptr dest = new SGPropertyNode;
+    dest->setStringValue("b/protected", "original");
+    dest->getNode("b/protected")->setAttribute(SGPropertyNode::WRITE, false);
+
+    std::istringstream is(data);
+    CPPUNIT_ASSERT(PropertyTreeCache::read(is, dest.ptr()));
+
+    CPPUNIT_ASSERT_EQUAL(true, dest->getBoolValue("a/bool"));
+    CPPUNIT_ASSERT(dest->getNode("a/bool")->getAttribute(SGPropertyNode::ARCHIVE));
+    CPPUNIT_ASSERT_EQUAL(-42, dest->getIntValue("a/int[2]"));
+    CPPUNIT_ASSERT_EQUAL(2, dest->getNode("a/int[2]")->getIndex());
+    CPPUNIT_ASSERT_EQUAL(1L << 40, dest->getLongValue("a/long"));
+    CPPUNIT_ASSERT_EQUAL(0.125, dest->getDoubleValue("b/double"));
+    CPPUNIT_ASSERT_EQUAL(2.5f, dest->getFloatValue("b/float"));
+    CPPUNIT_ASSERT_EQUAL(std::string{"hello world"}, dest->getStringValue("b/string"));
+    CPPUNIT_ASSERT(!dest->getNode("b/string")->getAttribute(SGPropertyNode::WRITE));
+    CPPUNIT_ASSERT_EQUAL(simgear::props::UNSPECIFIED, dest->getNode("b/unspecified")->getType());
+    CPPUNIT_ASSERT_EQUAL(std::string{"original"}, dest->getStringValue("b/protected"));
+
+    CPPUNIT_ASSERT(dest->getNode("c/alias")->isAlias());
+    dest->setIntValue("a/int[2]", 7);
+    CPPUNIT_ASSERT_EQUAL(7, dest->getIntValue("c/alias"));
+
+    // truncated data is rejected, without touching the tree
+    std::istringstream truncated(data.substr(0, data.size() - 4));
+    SGPropertyNode_ptr untouched = new SGPropertyNode;
+    CPPUNIT_ASSERT(!PropertyTreeCache::read(truncated, untouched.ptr()));
+    CPPUNIT_ASSERT_EQUAL(0, untouched->nChildren());
+}
+
+
+void PropertyTreeCacheTests::testReadProperties()
+{
+    const SGPath systems = testDir() / "systems.xml";
+    SGPropertyNode_ptr expected = new SGPropertyNode;
+    readProperties(systems, expected.ptr());
+
+    fgSetBool("/sim/startup/property-cache/enabled", true);
+    for (int i = 0; i < 2; ++i) {
+        SGPropertyNode_ptr config = new SGPropertyNode;
+        PropertyTreeCache::readProperties(systems, config.ptr());
+
+        CPPUNIT_ASSERT_EQUAL(expected->getStringValue("electrical/path"),
+                             config->getStringValue("electrical/path"));
+        CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(config->getChildren("pitot").size()));
+        CPPUNIT_ASSERT_EQUAL(1, config->getIntValue("pitot[1]/number"));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(1, fgGetInt("/sim/startup/property-cache/misses"));
+    CPPUNIT_ASSERT_EQUAL(1, fgGetInt("/sim/startup/property-cache/hits"));
+}
+
+
+void PropertyTreeCacheTests::testIncludeChanged()
+{
+    const SGPath systems = testDir() / "systems.xml";
+    const std::string key = PropertyTreeCache::keyFor(systems, 0);
+    CPPUNIT_ASSERT_EQUAL(key, PropertyTreeCache::keyFor(systems, 0));
+    CPPUNIT_ASSERT(key != PropertyTreeCache::keyFor(systems, SGPropertyNode::READ));
+
+    writeFile(testDir() / "electrical.xml",
+              "<path>Aircraft/Generic/other-electrical.xml</path>");
+    CPPUNIT_ASSERT(key != PropertyTreeCache::keyFor(systems, 0));
+
+    fgSetBool("/sim/startup/property-cache/enabled", true);
+    SGPropertyNode_ptr config = new SGPropertyNode;
+    PropertyTreeCache::readProperties(systems, config.ptr());
+    CPPUNIT_ASSERT_EQUAL(std::string{"Aircraft/Generic/other-electrical.xml"},
+                         config->getStringValue("electrical/path"));
+}
+
+
+// alias targets are relative to the node the file is read into
+void PropertyTreeCacheTests::testRelativeAlias()
+{
+    const SGPath instrument = testDir() / "instrument.xml";
+    writeFile(instrument,
+              "<readings><value type=\"double\">1.5</value></readings>"
+              "<display alias=\"readings/value\"/>");
+
+    fgSetBool("/sim/startup/property-cache/enabled", true);
+    for (int i = 0; i < 2; ++i) {
+        SGPropertyNode* node = fgGetNode("/test/instrument", i, true);
+        PropertyTreeCache::readProperties(instrument, node);
+
+        SGPropertyNode* display = node->getNode("display");
+        CPPUNIT_ASSERT(display && display->isAlias());
+        CPPUNIT_ASSERT_EQUAL(node->getNode("readings/value")->getPath(),
+                             display->getAliasTarget()->getPath());
+        CPPUNIT_ASSERT(!fgHasNode("/readings"));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(1, fgGetInt("/sim/startup/property-cache/hits"));
+}
@@ -0,0 +1,233 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "test_stateSnapshot.hxx"
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/structure/commands.hxx>
+
+#include <Main/StateSnapshot.hxx>
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+
+using namespace flightgear;
+
+namespace {
+
+// an integrator, standing in for subsystem state outside the property tree
+class TestIntegrator : public StateSnapshotParticipant
+{
+public:
+    void saveSnapshot(std::ostream& os) override
+    {
+        snapshot::writeValue(os, sum);
+        snapshot::writeString(os, label);
+    }
+
+    bool restoreSnapshot(std::istream& is) override
+    {
+        sum = snapshot::readValue<double>(is);
+        label = snapshot::readString(is);
+        return !is.fail();
+    }
+
+    double sum = 0.0;
+    std::string label;
+};
+
+StateSnapshotManager* manager()
+{
+    return globals->get_subsystem<StateSnapshotManager>();
+}
+
+} // of anonymous namespace
+
+// Set up function for each test.
+void StateSnapshotTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("stateSnapshot");
+    fgSetString("/sim/aircraft", "c172p");
+
+    globals->add_new_subsystem<StateSnapshotManager>();
+    globals->get_subsystem_mgr()->bind();
+    globals->get_subsystem_mgr()->init();
+}
+
+
+// Clean up after each test.
+void StateSnapshotTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void StateSnapshotTests::testProperties()
+{
+    fgSetDouble("/position/altitude-ft", 3500.0);
+    fgSetInt("/controls/gear/gear-down", 1);
+    fgSetString("/autopilot/locks/heading", "dg-heading-hold");
+    fgSetString("/sim/rendering/shaders/quality", "high");
+    fgSetString("/test/excluded/value", "before");
+    fgSetString("/sim/snapshot/exclude", "/test/excluded");
+    fgSetString("/ai/models/aircraft/callsign", "AI001");
+
+    globals->set_sim_time_sec(120.0);
+    auto snapshot = manager()->take();
+    CPPUNIT_ASSERT(snapshot);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(120.0, snapshot->simTimeSec(), 1e-9);
+
+    fgSetDouble("/position/altitude-ft", 9000.0);
+    fgSetInt("/controls/gear/gear-down", 0);
+    fgSetString("/autopilot/locks/heading", "");
+    fgSetString("/sim/rendering/shaders/quality", "low");
+    fgSetString("/test/excluded/value", "after");
+    fgGetNode("/ai/models")->removeChild("aircraft", 0);
+    globals->set_sim_time_sec(300.0);
+
+    CPPUNIT_ASSERT(manager()->restore(snapshot));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3500.0, fgGetDouble("/position/altitude-ft"), 1e-9);
+    CPPUNIT_ASSERT_EQUAL(1, fgGetInt("/controls/gear/gear-down"));
+    CPPUNIT_ASSERT_EQUAL(std::string("dg-heading-hold"), std::string(fgGetString("/autopilot/locks/heading")));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(120.0, globals->get_sim_time_sec(), 1e-9);
+
+    // session state and excluded subtrees are left alone
+    CPPUNIT_ASSERT_EQUAL(std::string("low"), std::string(fgGetString("/sim/rendering/shaders/quality")));
+    CPPUNIT_ASSERT_EQUAL(std::string("after"), std::string(fgGetString("/test/excluded/value")));
+
+    // AI objects are not restored, not even as properties
+    CPPUNIT_ASSERT(!fgHasNode("/ai/models/aircraft"));
+}
+
+
+void StateSnapshotTests::testParticipant()
+{
+    TestIntegrator integrator;
+    integrator.sum = 42.5;
+    integrator.label = "pitch";
+    manager()->addParticipant("integrator", &integrator);
+
+    auto snapshot = manager()->take();
+    CPPUNIT_ASSERT(snapshot->section("integrator"));
+
+    integrator.sum = -1.0;
+    integrator.label = "roll";
+    CPPUNIT_ASSERT(manager()->restore(snapshot));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(42.5, integrator.sum, 1e-12);
+    CPPUNIT_ASSERT_EQUAL(std::string("pitch"), integrator.label);
+
+    manager()->removeParticipant("integrator");
+    CPPUNIT_ASSERT(!manager()->take()->section("integrator"));
+}
+
+
+void StateSnapshotTests::testSharedSections()
+{
+    TestIntegrator integrator;
+    manager()->addParticipant("integrator", &integrator);
+
+    fgSetDouble("/position/altitude-ft", 3500.0);
+    fgSetInt("/controls/gear/gear-down", 1);
+    auto first = manager()->take();
+    auto second = manager()->take();
+
+    // nothing changed, so the snapshots share all their data
+    CPPUNIT_ASSERT(first->section("properties:position"));
+    CPPUNIT_ASSERT(first->section("properties:position") == second->section("properties:position"));
+    CPPUNIT_ASSERT(first->section("properties:controls") == second->section("properties:controls"));
+    CPPUNIT_ASSERT(first->section("integrator") == second->section("integrator"));
+
+    integrator.sum = 1.0;
+    auto third = manager()->take();
+    CPPUNIT_ASSERT(second->section("properties:position") == third->section("properties:position"));
+    CPPUNIT_ASSERT(second->section("integrator") != third->section("integrator"));
+
+    // only the top-level subtree which changed is stored again
+    fgSetDouble("/position/altitude-ft", 4000.0);
+    auto fourth = manager()->take();
+    CPPUNIT_ASSERT(third->section("properties:position") != fourth->section("properties:position"));
+    CPPUNIT_ASSERT(third->section("properties:controls") == fourth->section("properties:controls"));
+
+    CPPUNIT_ASSERT(manager()->restore(third));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3500.0, fgGetDouble("/position/altitude-ft"), 1e-9);
+
+    manager()->removeParticipant("integrator");
+}
+
+
+void StateSnapshotTests::testSaveLoad()
+{
+    TestIntegrator integrator;
+    integrator.sum = 7.25;
+    manager()->addParticipant("integrator", &integrator);
+
+    fgSetDouble("/orientation/heading-deg", 270.0);
+    globals->set_sim_time_sec(60.0);
+    auto snapshot = manager()->take();
+
+    SGPath compressed = globals->get_fg_home() / "test_snapshot.gz";
+    SGPath plain = globals->get_fg_home() / "test_snapshot.bin";
+    CPPUNIT_ASSERT(StateSnapshotManager::save(snapshot, compressed));
+    CPPUNIT_ASSERT(StateSnapshotManager::save(snapshot, plain, false));
+
+    for (const SGPath& path : {compressed, plain}) {
+        auto loaded = StateSnapshotManager::load(path);
+        CPPUNIT_ASSERT(loaded);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(60.0, loaded->simTimeSec(), 1e-9);
+        CPPUNIT_ASSERT_EQUAL(snapshot->sizeInBytes(), loaded->sizeInBytes());
+
+        fgSetDouble("/orientation/heading-deg", 90.0);
+        integrator.sum = 0.0;
+        CPPUNIT_ASSERT(manager()->restore(loaded));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(270.0, fgGetDouble("/orientation/heading-deg"), 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(7.25, integrator.sum, 1e-12);
+    }
+
+    // through the commands
+    SGPropertyNode_ptr args(new SGPropertyNode);
+    args->setStringValue("name", "before-approach");
+    CPPUNIT_ASSERT(globals->get_commands()->execute("snapshot-take", args));
+    CPPUNIT_ASSERT(manager()->find("before-approach"));
+    CPPUNIT_ASSERT(globals->get_commands()->execute("snapshot-delete", args));
+    CPPUNIT_ASSERT(!manager()->find("before-approach"));
+
+    // a truncated file is refused
+    {
+        sg_ofstream of(plain, std::ios::out | std::ios::trunc | std::ios::binary);
+        of << "FGSNAPSH";
+    }
+    CPPUNIT_ASSERT(!StateSnapshotManager::load(plain));
+
+    compressed.remove();
+    plain.remove();
+    manager()->removeParticipant("integrator");
+}
+
+
+void StateSnapshotTests::testAircraftChanged()
+{
+    fgSetDouble("/position/altitude-ft", 3500.0);
+    auto snapshot = manager()->take();
+
+    fgSetString("/sim/aircraft", "ufo");
+    fgSetDouble("/position/altitude-ft", 100.0);
+    CPPUNIT_ASSERT(!manager()->restore(snapshot));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, fgGetDouble("/position/altitude-ft"), 1e-9);
+}
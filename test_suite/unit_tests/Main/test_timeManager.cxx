@@ -26,14 +26,18 @@
 
 #include <simgear/io/iostreams/sgstream.hxx>
 #include <simgear/misc/sg_dir.hxx>
+#include <simgear/math/sg_random.h>
 #include <simgear/props/props_io.hxx>
 #include <simgear/timing/sg_time.hxx>
 
 #include "Main/fg_props.hxx"
 #include "Main/globals.hxx"
+#include "Main/util.hxx"
 #include <Airports/airport.hxx>
 #include <Time/TimeManager.hxx>
 
+#include <vector>
+
 using namespace flightgear;
 
 
@@ -244,3 +248,80 @@ void TimeManagerTests::testSpecifyTimeOffset()
 
     CPPUNIT_ASSERT_EQUAL((time_t) 0, localTime);
 }
+
+void TimeManagerTests::testLockStep()
+{
+    auto timeManager = new TimeManager;
+
+    fgSetBool("/sim/freeze/clock", false);
+    fgSetBool("/sim/sceneryloaded", false);
+    fgSetDouble("/sim/model-hz", 120.0);
+    fgSetBool("/sim/time/lock-step/enabled", true);
+    fgSetBool("/sim/time/lock-step/as-fast-as-possible", true);
+    fgSetInt("/sim/time/lock-step/frames-per-update", 4);
+    fgSetLong("/sim/time/lock-step/start-time-utc", 314611200L);
+
+    timeManager->bind();
+    timeManager->init();
+    timeManager->postinit();
+
+    // nothing advances while the scenery loads
+    double simDt, realDt;
+    const double startSimTime = globals->get_sim_time_sec();
+    timeManager->computeTimeDeltas(simDt, realDt);
+    CPPUNIT_ASSERT_EQUAL(0.0, simDt);
+    CPPUNIT_ASSERT_EQUAL(0.0, realDt);
+
+    // then every frame is the same number of model steps, however long
+    // it really took
+    fgSetBool("/sim/sceneryloaded", true);
+    const double frameDt = 4 / 120.0;
+    double expectedSimTime = startSimTime;
+    for (int i = 0; i < 3; ++i) {
+        timeManager->_lastStamp = SGTimeStamp::now() - SGTimeStamp::fromMSec(25 * i);
+        timeManager->computeTimeDeltas(simDt, realDt);
+        CPPUNIT_ASSERT_EQUAL(frameDt, simDt);
+        CPPUNIT_ASSERT_EQUAL(frameDt, realDt);
+        expectedSimTime += frameDt;
+    }
+
+    CPPUNIT_ASSERT_EQUAL(expectedSimTime, globals->get_sim_time_sec());
+    CPPUNIT_ASSERT_EQUAL(0.0, timeManager->_dtRemainder);
+
+    fgSetBool("/sim/freeze/clock", true);
+    timeManager->computeTimeDeltas(simDt, realDt);
+    CPPUNIT_ASSERT_EQUAL(0.0, simDt);
+    CPPUNIT_ASSERT_EQUAL(frameDt, realDt);
+    fgSetBool("/sim/freeze/clock", false);
+
+    // the calendar follows the simulation time, not the system clock
+    globals->set_sim_time_sec(3600.0);
+    timeManager->update(0.0);
+    CPPUNIT_ASSERT_EQUAL((time_t)(314611200L + 3600), globals->get_time_params()->get_cur_time());
+}
+
+void TimeManagerTests::testLockStepSeed()
+{
+    fgSetBool("/sim/time/lock-step/enabled", true);
+    fgSetInt("/sim/time/lock-step/seed", 42);
+    fgSetLong("/sim/time/lock-step/start-time-utc", 314611200L);
+
+    auto timeManager = new TimeManager;
+    timeManager->bind();
+    timeManager->init();
+
+    std::vector<double> first;
+    for (int i = 0; i < 4; ++i) {
+        first.push_back(sg_random());
+    }
+
+    // re-seeding from the clock is suppressed in lock-step mode
+    fgSeedRandom();
+    const double next = sg_random();
+
+    timeManager->reinit();
+    for (int i = 0; i < 4; ++i) {
+        CPPUNIT_ASSERT_EQUAL(first[i], sg_random());
+    }
+    CPPUNIT_ASSERT_EQUAL(next, sg_random());
+}
@@ -34,6 +34,8 @@ class TimeManagerTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testFreezeUnfreeze);
     CPPUNIT_TEST(testSpecifyTimeOffset);
     CPPUNIT_TEST(testETCTimeZones);
+    CPPUNIT_TEST(testLockStep);
+    CPPUNIT_TEST(testLockStepSeed);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -49,4 +51,6 @@ public:
     void testFreezeUnfreeze();
     void testSpecifyTimeOffset();
     void testETCTimeZones();
+    void testLockStep();
+    void testLockStepSeed();
 };
@@ -9,6 +9,7 @@
 #include <simgear/misc/sg_dir.hxx>
 #include <simgear/io/iostreams/sgstream.hxx>
 #include <simgear/structure/exception.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <Navaids/FlightPlan.hxx>
 #include <Navaids/routePath.hxx>
@@ -20,6 +21,7 @@
 #include <Navaids/fix.hxx>
 
 #include <Airports/airport.hxx>
+#include <Main/fg_props.hxx>
 
 using namespace std::string_literals;
 using namespace flightgear;
@@ -466,6 +468,49 @@ void FlightplanTests::testAirwayNetworkRoute()
     CPPUNIT_ASSERT_EQUAL(static_cast<int>(route.size()), 18);
 }
 
+void FlightplanTests::testAirwayNetworkRouteBenchmark()
+{
+    const std::vector<std::pair<std::string, std::string>> pairs = {
+        {"KJFK", "KLAX"}, {"KBOS", "KSEA"}, {"KMIA", "KSFO"}, {"EGLL", "LTBA"}
+    };
+
+    auto highLevelNet = Airway::highLevel();
+    std::vector<size_t> routeSizes;
+
+    SGTimeStamp st;
+    st.stamp();
+    for (const auto& p : pairs) {
+        WayptRef from = new NavaidWaypoint(FGAirport::findByIdent(p.first), nullptr);
+        WayptRef to = new NavaidWaypoint(FGAirport::findByIdent(p.second), nullptr);
+
+        WayptVec route;
+        CPPUNIT_ASSERT(highLevelNet->route(from, to, route));
+        CPPUNIT_ASSERT(route.size() > 10);
+        routeSizes.push_back(route.size());
+    }
+    const auto coldMsec = st.elapsedMSec();
+
+    // repeated searches are answered from the per-network result cache
+    const int iterations = 50;
+    st.stamp();
+    for (int i = 0; i < iterations; ++i) {
+        for (size_t r = 0; r < pairs.size(); ++r) {
+            WayptRef from = new NavaidWaypoint(FGAirport::findByIdent(pairs[r].first), nullptr);
+            WayptRef to = new NavaidWaypoint(FGAirport::findByIdent(pairs[r].second), nullptr);
+
+            WayptVec route;
+            CPPUNIT_ASSERT(highLevelNet->route(from, to, route));
+            CPPUNIT_ASSERT_EQUAL(routeSizes.at(r), route.size());
+        }
+    }
+    const auto warmMsec = st.elapsedMSec();
+
+    SG_LOG(SG_GENERAL, SG_INFO, "Transcontinental airway routing: " << pairs.size()
+           << " routes in " << coldMsec << "msec including graph build, "
+           << (warmMsec / static_cast<double>(iterations * pairs.size()))
+           << "msec per cached route");
+}
+
 void FlightplanTests::testParseICAORoute()
 {
     FGAirportRef kord = FGAirport::findByIdent("KORD"s);
@@ -1103,3 +1148,159 @@ void FlightplanTests::testCloningProcedures() {
     CPPUNIT_ASSERT_EQUAL(fp2->star()->ident(), "EEL1A"s);
     CPPUNIT_ASSERT_EQUAL(fp2->starTransition()->ident(), "BEDUM"s);
 }
+
+// a long plan using the procedure leg types: a climb to altitude and a
+// radial intercept after departure, enroute points, a hold in the
+// arrival, and a missed approach climb after the destination runway.
+static FlightPlanRef makeProcedureTestFP(int enrouteLegs)
+{
+    FlightPlanRef f = makeTestFP("EGCC"s, "23L"s, "EHAM"s, "24"s, ""s);
+    const SGGeod from = f->departureRunway()->end();
+    const SGGeod to = f->destinationRunway()->threshold();
+
+    auto climb = new HeadingToAltitude(f, "CLIMB"s, 230);
+    climb->setAltitude(3000, RESTRICT_AT);
+    climb->setFlag(WPT_DEPARTURE);
+    f->insertWayptAtIndex(climb, 1);
+
+    auto intercept = new RadialIntercept(f, "INTC"s, SGGeodesy::direct(from, 180, 20 * SG_NM_TO_METER), 270, 330);
+    intercept->setFlag(WPT_DEPARTURE);
+    f->insertWayptAtIndex(intercept, 2);
+
+    // zig-zag towards the destination
+    const double course = SGGeodesy::courseDeg(from, to);
+    const double distanceM = SGGeodesy::distanceM(from, to);
+    for (int i = 0; i < enrouteLegs; ++i) {
+        const double along = distanceM * (i + 1) / (enrouteLegs + 2);
+        const SGGeod p = SGGeodesy::direct(SGGeodesy::direct(from, course, along),
+                                           course + 90, ((i % 2) ? 1.0 : -1.0) * SG_NM_TO_METER);
+        auto wp = new BasicWaypt(p, "WP" + std::to_string(i), f);
+        if (i >= enrouteLegs - 10) {
+            wp->setFlag(WPT_ARRIVAL);
+            wp->setAltitude(10000 - (i - enrouteLegs + 10) * 500, RESTRICT_AT);
+        }
+        f->insertWayptAtIndex(wp, f->numLegs() - 2);
+    }
+
+    CPPUNIT_ASSERT(f->legAtIndex(f->numLegs() - 5)->setHoldCount(1));
+    f->legAtIndex(f->numLegs() - 2)->waypoint()->setFlag(WPT_APPROACH);
+
+    auto missed = new HeadingToAltitude(f, "MISSED"s, 240);
+    missed->setAltitude(2000, RESTRICT_AT);
+    missed->setFlag(WPT_APPROACH);
+    missed->setFlag(WPT_MISS);
+    f->insertWayptAtIndex(missed, -1);
+    return f;
+}
+
+// the cached route path must match one computed from scratch
+static void checkCachedRoutePath(FlightPlanRef f)
+{
+    const RoutePath& cached = f->routePath();
+    RoutePath fresh(f);
+    for (int l = 0; l < f->numLegs(); ++l) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(fresh.positionForIndex(l).getLatitudeDeg(),
+                                     cached.positionForIndex(l).getLatitudeDeg(), 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(fresh.positionForIndex(l).getLongitudeDeg(),
+                                     cached.positionForIndex(l).getLongitudeDeg(), 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(fresh.trackForIndex(l), cached.trackForIndex(l), 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(fresh.distanceForIndex(l), cached.distanceForIndex(l), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(fresh.distanceForIndex(l) * SG_METER_TO_NM,
+                                     f->legAtIndex(l)->distanceNm(), 1e-9);
+        CPPUNIT_ASSERT_EQUAL(fresh.pathForIndex(l).size(), cached.pathForIndex(l).size());
+    }
+}
+
+void FlightplanTests::testRoutePathCache()
+{
+    FlightPlanRef f = makeProcedureTestFP(30);
+    checkCachedRoutePath(f);
+
+    const SGGeod mid = f->legAtIndex(15)->waypoint()->position();
+    f->insertWayptAtIndex(new BasicWaypt(SGGeodesy::direct(mid, 0, 5 * SG_NM_TO_METER), "EXTRA"s, f), 16);
+    checkCachedRoutePath(f);
+
+    // several changes before the path is used again
+    f->deleteIndex(3);
+    f->deleteIndex(20);
+    f->insertWayptAtIndex(new BasicWaypt(mid, "EXTRA2"s, f), 10);
+    checkCachedRoutePath(f);
+
+    // in place changes
+    auto leg = f->legAtIndex(12);
+    leg->waypoint()->setFlag(WPT_OVERFLIGHT);
+    leg->markWaypointDirty();
+    checkCachedRoutePath(f);
+
+    CPPUNIT_ASSERT(f->legAtIndex(25)->setHoldCount(2));
+    checkCachedRoutePath(f);
+
+    // changes near the start and end of the plan
+    f->deleteIndex(1);
+    checkCachedRoutePath(f);
+    f->deleteIndex(-3);
+    checkCachedRoutePath(f);
+
+    f->setFollowLegTrackToFixes(false);
+    checkCachedRoutePath(f);
+
+    // a different category has different turn radii and climb rates
+    fgSetString("/aircraft/performance/icao-category", "A");
+    f->setIcaoAircraftCategory("A");
+    checkCachedRoutePath(f);
+    f->setCruiseSpeedKnots(120);
+    checkCachedRoutePath(f);
+
+    f->clearLegs();
+    CPPUNIT_ASSERT_EQUAL(0, f->numLegs());
+    f->insertWayptAtIndex(new BasicWaypt(mid, "EXTRA3"s, f), 0);
+    checkCachedRoutePath(f);
+}
+
+void FlightplanTests::testRoutePathCacheBenchmark()
+{
+    FlightPlanRef f = makeProcedureTestFP(140);
+    const int legCount = f->numLegs();
+    CPPUNIT_ASSERT(legCount >= 150);
+
+    // what the route manager, a map and Nasal leg accessors need each frame
+    auto frameWork = [legCount](const RoutePath& path) {
+        size_t points = path.positionForIndex(legCount / 2).isValid() ? 1 : 0;
+        for (int l = 0; l < legCount; ++l) {
+            points += path.pathForIndex(l).size();
+        }
+        return points;
+    };
+
+    const int iterations = 100;
+    SGTimeStamp st;
+    st.stamp();
+    size_t freshPoints = 0;
+    for (int i = 0; i < iterations; ++i) {
+        RoutePath path(f);
+        freshPoints = frameWork(path);
+    }
+    const auto freshMsec = st.elapsedMSec();
+
+    st.stamp();
+    for (int i = 0; i < iterations; ++i) {
+        CPPUNIT_ASSERT_EQUAL(freshPoints, frameWork(f->routePath()));
+    }
+    const auto cachedMsec = st.elapsedMSec();
+
+    // modify a leg in the middle of the plan each time
+    auto leg = f->legAtIndex(legCount / 2);
+    st.stamp();
+    for (int i = 0; i < iterations; ++i) {
+        leg->waypoint()->setFlag(WPT_OVERFLIGHT, (i % 2) == 0);
+        leg->markWaypointDirty();
+        frameWork(f->routePath());
+    }
+    const auto modifiedMsec = st.elapsedMSec();
+    checkCachedRoutePath(f);
+
+    SG_LOG(SG_GENERAL, SG_INFO, "Route path for " << legCount << " legs: "
+           << (freshMsec / static_cast<double>(iterations)) << "msec computed each time, "
+           << (cachedMsec / static_cast<double>(iterations)) << "msec cached, "
+           << (modifiedMsec / static_cast<double>(iterations)) << "msec after changing a leg");
+}
@@ -37,6 +37,7 @@ class FlightplanTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testRoutePathTrivialFlightPlan);
     CPPUNIT_TEST(testBasicAirways);
     CPPUNIT_TEST(testAirwayNetworkRoute);
+    CPPUNIT_TEST(testAirwayNetworkRouteBenchmark);
     CPPUNIT_TEST(testBug1814);
     CPPUNIT_TEST(testRoutPathWpt0Midflight);
     CPPUNIT_TEST(testRoutePathVec);
@@ -53,6 +54,8 @@ class FlightplanTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testCloningBasic);
     CPPUNIT_TEST(testCloningFGFP);
     CPPUNIT_TEST(testCloningProcedures);
+    CPPUNIT_TEST(testRoutePathCache);
+    CPPUNIT_TEST(testRoutePathCacheBenchmark);
     
   //  CPPUNIT_TEST(testParseICAORoute);
    // CPPUNIT_TEST(testParseICANLowLevelRoute);
@@ -72,6 +75,7 @@ public:
     void testRoutePathTrivialFlightPlan();
     void testBasicAirways();
     void testAirwayNetworkRoute();
+    void testAirwayNetworkRouteBenchmark();
     void testParseICAORoute();
     void testParseICANLowLevelRoute();
     void testBug1814();
@@ -90,6 +94,8 @@ public:
     void testCloningBasic();
     void testCloningFGFP();
     void testCloningProcedures();
+    void testRoutePathCache();
+    void testRoutePathCacheBenchmark();
 };
 
 #endif  // FG_FLIGHTPLAN_UNIT_TESTS_HXX
@@ -1,12 +1,23 @@
 #include "test_navaids2.hxx"
 
+#include <algorithm>
+#include <cstdlib>
+
 #include "test_suite/FGTestApi/testGlobals.hxx"
 #include "test_suite/FGTestApi/NavDataCache.hxx"
 
+#include <simgear/misc/strutils.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Airports/airport.hxx>
+#include <Airports/runways.hxx>
+#include <Main/fg_props.hxx>
 #include <Navaids/NavDataCache.hxx>
 #include <Navaids/navrecord.hxx>
 #include <Navaids/navlist.hxx>
 
+using flightgear::NavDataCache;
+
 
 // Set up function for each test.
 void NavaidsTests::setUp()
@@ -34,3 +45,116 @@ void NavaidsTests::testBasic()
     CPPUNIT_ASSERT_EQUAL(tla->get_freq(), 11570);
     CPPUNIT_ASSERT_EQUAL(tla->get_range(), 130);
 }
+
+
+static PositionedIDVec runGUISearch(const std::string& term, bool onlyAirports)
+{
+    NavDataCache::ThreadedGUISearch search(term, onlyAirports);
+    while (!search.isComplete()) {
+        SGTimeStamp::sleepForMSec(1);
+    }
+    return search.results();
+}
+
+static bool startsWith(const std::string& s, const std::string& prefix)
+{
+    return simgear::strutils::starts_with(simgear::strutils::lowercase(s),
+                                          simgear::strutils::lowercase(prefix));
+}
+
+void NavaidsTests::testNameSearch()
+{
+    FGNavRecordRef tnt = FGNavList::findByFreq(115.7, SGGeod::fromDeg(-2.27, 53.35));
+    CPPUNIT_ASSERT(tnt);
+
+    // matches anywhere in the name, ignoring case
+    for (const auto& term : {"TRENT", "rent vor"}) {
+        auto results = runGUISearch(term, false);
+        CPPUNIT_ASSERT(std::find(results.begin(), results.end(), tnt->guid()) != results.end());
+    }
+
+    CPPUNIT_ASSERT(runGUISearch("TRENT", true).empty());
+
+    // names starting with the term come first
+    FGAirportRef egcc = FGAirport::findByIdent("EGCC");
+    auto results = runGUISearch(egcc->name(), true);
+    CPPUNIT_ASSERT(std::find(results.begin(), results.end(), egcc->guid()) != results.end());
+    FGPositionedRef best = NavDataCache::instance()->loadById(results.front());
+    CPPUNIT_ASSERT(startsWith(best->name(), egcc->name()));
+
+    // a quote in the term is not special
+    CPPUNIT_ASSERT(runGUISearch("\"EGCC", false).empty());
+
+    char** airports = NavDataCache::instance()->searchAirportNamesAndIdents("EGC");
+    bool foundEGCC = false;
+    for (char** a = airports; *a; ++a) {
+        foundEGCC |= (std::string(*a).find("(EGCC)") != std::string::npos);
+        free(*a);
+    }
+    free(airports);
+    CPPUNIT_ASSERT(foundEGCC);
+}
+
+void NavaidsTests::testNameSearchBenchmark()
+{
+    // as typed into the launcher location search
+    const std::string name = "HEATHROW";
+    SGTimeStamp st;
+    for (size_t length = 1; length <= name.size(); ++length) {
+        const std::string term = name.substr(0, length);
+        st.stamp();
+        auto results = runGUISearch(term, false);
+        SG_LOG(SG_NAVAID, SG_INFO, "Name search for '" << term << "' found "
+               << results.size() << " in " << st.elapsedMSec() << "msec");
+    }
+
+    for (const std::string term : {"intl", "manchester", "EGLL", "london"}) {
+        st.stamp();
+        char** airports = NavDataCache::instance()->searchAirportNamesAndIdents(term);
+        int count = 0;
+        for (char** a = airports; *a; ++a, ++count) {
+            free(*a);
+        }
+        free(airports);
+        SG_LOG(SG_NAVAID, SG_INFO, "Airport search for '" << term << "' found "
+               << count << " in " << st.elapsedMSec() << "msec");
+    }
+}
+
+void NavaidsTests::testSnapshot()
+{
+    fgSetBool("/sim/navdb/snapshot/enabled", true);
+    NavDataCache* cache = NavDataCache::instance();
+    cache->openSnapshot();
+
+    FGNavRecordRef tnt = FGNavList::findByFreq(115.7, SGGeod::fromDeg(-2.27, 53.35));
+    CPPUNIT_ASSERT(tnt);
+    CPPUNIT_ASSERT(tnt->name() == "TRENT VOR-DME");
+    CPPUNIT_ASSERT_EQUAL(tnt->get_freq(), 11570);
+    CPPUNIT_ASSERT_EQUAL(tnt->get_range(), 130);
+
+    FGAirportRef egcc = FGAirport::findByIdent("EGCC");
+    CPPUNIT_ASSERT(egcc);
+    CPPUNIT_ASSERT(egcc->numRunways() > 0);
+    FGRunwayRef rwy = egcc->getRunwayByIndex(0);
+    CPPUNIT_ASSERT(rwy->reciprocalRunway());
+    CPPUNIT_ASSERT(rwy->reciprocalRunway()->reciprocalRunway() == rwy.ptr());
+
+    // idents match ignoring case, as in the database
+    FGPositioned::TypeFilter airports(FGPositioned::AIRPORT);
+    FGPositionedRef closest = FGPositioned::findClosestWithIdent("egcc", egcc->geod(), &airports);
+    CPPUNIT_ASSERT(closest);
+    CPPUNIT_ASSERT_EQUAL(egcc->guid(), closest->guid());
+
+    FGPositionedList prefixed = cache->findAllWithIdent("EGC", &airports, false);
+    CPPUNIT_ASSERT(std::any_of(prefixed.begin(), prefixed.end(),
+                               [&egcc](const FGPositionedRef& p) { return p->guid() == egcc->guid(); }));
+
+    // the spatial index
+    FGPositioned::TypeFilter vors(FGPositioned::VOR);
+    FGPositionedList nearby = FGPositioned::findClosestN(egcc->geod(), 10, 100.0, &vors);
+    CPPUNIT_ASSERT(!nearby.empty());
+    for (const auto& p : nearby) {
+        CPPUNIT_ASSERT_EQUAL(FGPositioned::VOR, p->type());
+    }
+}
@@ -0,0 +1,336 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_generic.hxx"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/io/sg_file.hxx>
+#include <simgear/misc/sg_dir.hxx>
+#include <simgear/misc/strutils.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+#include <Network/generic.hxx>
+
+namespace {
+
+struct Chunk {
+    std::string node;
+    std::string type;
+    std::string format;
+};
+
+std::string protocolXML(const std::vector<Chunk>& chunks, const std::string& section,
+                        const std::string& header)
+{
+    std::ostringstream os;
+    os << "<?xml version=\"1.0\"?>\n<PropertyList>\n<generic>\n<" << section << ">\n" << header;
+    for (const auto& c : chunks) {
+        os << "<chunk><node>" << c.node << "</node><type>" << c.type << "</type>";
+        if (!c.format.empty()) {
+            os << "<format>" << c.format << "</format>";
+        }
+        os << "</chunk>\n";
+    }
+    os << "</" << section << ">\n</generic>\n</PropertyList>\n";
+    return os.str();
+}
+
+// the per-message formatting FGGeneric used before protocols were compiled
+std::string legacyFormat(const std::vector<Chunk>& chunks)
+{
+    std::string sentence;
+    char tmp[255];
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (i > 0) {
+            sentence += ",";
+        }
+
+        SGPropertyNode* prop = fgGetNode(chunks[i].node, true);
+        const std::string format = simgear::strutils::sanitizePrintfFormat(chunks[i].format);
+        const std::string& type = chunks[i].type;
+        if (type == "int") {
+            snprintf(tmp, 255, format.c_str(), (int)prop->getFloatValue());
+        } else if (type == "bool") {
+            snprintf(tmp, 255, format.c_str(), prop->getBoolValue());
+        } else if (type == "float") {
+            snprintf(tmp, 255, format.c_str(), (float)prop->getFloatValue());
+        } else if (type == "double") {
+            snprintf(tmp, 255, format.c_str(), prop->getDoubleValue());
+        } else {
+            snprintf(tmp, 255, format.c_str(), prop->getStringValue());
+        }
+        sentence += tmp;
+    }
+    return sentence + "\n";
+}
+
+std::unique_ptr<FGGeneric> makeChannel(const std::string& protocol,
+                                       const std::string& direction,
+                                       const SGPath& file)
+{
+    std::unique_ptr<FGGeneric> g(new FGGeneric({"generic", "file", direction, "10", file.utf8Str(), protocol}));
+    CPPUNIT_ASSERT(g->getInitOk());
+    g->set_direction(direction);
+    g->set_io_channel(new SGFile(file));
+    return g;
+}
+
+const std::string asciiHeader = "<line_separator>newline</line_separator>\n"
+                                "<var_separator>,</var_separator>\n";
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void GenericProtocolTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("generic-protocol");
+
+    _dataDir = globals->get_fg_home() / "generic-protocol-test";
+    simgear::Dir(_dataDir / "Protocol").create(0755);
+    globals->append_data_path(_dataDir);
+}
+
+
+// Clean up after each test.
+void GenericProtocolTests::tearDown()
+{
+    simgear::Dir(_dataDir).remove(true);
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void GenericProtocolTests::writeProtocol(const std::string& name, const std::string& contents)
+{
+    sg_ofstream f(_dataDir / "Protocol" / (name + ".xml"), std::ios::out | std::ios::trunc);
+    f << contents;
+}
+
+
+void GenericProtocolTests::testAsciiFormatting()
+{
+    const std::vector<Chunk> chunks = {
+        {"/test/int", "int", "%d"},
+        {"/test/double", "double", "%.3f"},
+        {"/test/float", "float", "%f"},
+        {"/test/bool", "bool", "%d"},
+        {"/test/string", "string", "%s"},
+        {"/test/double", "double", "alt=%08.2f"},
+        {"/test/int", "int", "%5d"},
+        {"/test/float", "float", "%.1f"},
+    };
+    writeProtocol("fmt-test", protocolXML(chunks, "output", asciiHeader));
+
+    const SGPath outFile = _dataDir / "fmt-test.out";
+    auto channel = makeChannel("fmt-test", "out", outFile);
+    CPPUNIT_ASSERT(channel->open());
+
+    std::vector<std::string> expected;
+    for (int i = 0; i < 2000; ++i) {
+        // includes exact binary ties (multiples of 1/16), negative values
+        // rounding to zero and large magnitudes
+        const double d = (i % 3 == 0) ? (i - 1000) / 16.0 : (i - 1000) * 1234.56789e-4;
+        fgSetInt("/test/int", (i * 7919) - 50000);
+        fgSetDouble("/test/double", (i % 97 == 0) ? d * 1e9 : d);
+        fgSetFloat("/test/float", static_cast<float>(-d / 7.0));
+        fgSetBool("/test/bool", (i % 2) == 0);
+        fgSetString("/test/string", "wpt" + std::to_string(i));
+
+        expected.push_back(legacyFormat(chunks));
+        CPPUNIT_ASSERT(channel->process());
+    }
+
+    CPPUNIT_ASSERT(channel->close());
+
+    sg_ifstream f(outFile);
+    std::string line;
+    size_t n = 0;
+    while (std::getline(f, line)) {
+        CPPUNIT_ASSERT(n < expected.size());
+        CPPUNIT_ASSERT_EQUAL(expected[n], line + "\n");
+        ++n;
+    }
+    CPPUNIT_ASSERT_EQUAL(expected.size(), n);
+}
+
+
+void GenericProtocolTests::testAsciiRoundTrip()
+{
+    std::vector<Chunk> out = {
+        {"/test/int", "int", "%d"},
+        {"/test/double", "double", "%.6f"},
+        {"/test/bool", "bool", "%d"},
+        {"/test/string", "string", "%s"},
+    };
+    writeProtocol("rt-out", protocolXML(out, "output", asciiHeader));
+
+    std::vector<Chunk> in = {
+        {"/rt/int", "int", ""},
+        {"/rt/double", "double", ""},
+        {"/rt/bool", "bool", ""},
+        {"/rt/string", "string", ""},
+    };
+    writeProtocol("rt-in", protocolXML(in, "input", asciiHeader));
+
+    fgSetInt("/test/int", -4711);
+    fgSetDouble("/test/double", 51.4706);
+    fgSetBool("/test/bool", true);
+    fgSetString("/test/string", "EGLL");
+
+    const SGPath file = _dataDir / "rt.txt";
+    auto writer = makeChannel("rt-out", "out", file);
+    CPPUNIT_ASSERT(writer->open());
+    CPPUNIT_ASSERT(writer->process());
+    CPPUNIT_ASSERT(writer->close());
+
+    auto reader = makeChannel("rt-in", "in", file);
+    CPPUNIT_ASSERT(reader->open());
+    CPPUNIT_ASSERT(reader->process());
+    reader->close();
+
+    CPPUNIT_ASSERT_EQUAL(-4711, fgGetInt("/rt/int"));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(51.4706, fgGetDouble("/rt/double"), 1e-9);
+    CPPUNIT_ASSERT_EQUAL(true, fgGetBool("/rt/bool"));
+    CPPUNIT_ASSERT_EQUAL(std::string("EGLL"), std::string(fgGetString("/rt/string")));
+}
+
+
+void GenericProtocolTests::testBinaryRoundTrip()
+{
+    // int + float + double + bool + byte + word + (length + 4 chars)
+    const std::string header = "<binary_mode>true</binary_mode>\n"
+                               "<record_length>28</record_length>\n"
+                               "<word_byte_order>byte_order</word_byte_order>\n";
+    std::vector<Chunk> out = {
+        {"/test/int", "int", ""},
+        {"/test/float", "float", ""},
+        {"/test/double", "double", ""},
+        {"/test/bool", "bool", ""},
+        {"/test/byte", "byte", ""},
+        {"/test/word", "word", ""},
+        {"/test/string", "string", ""},
+    };
+    writeProtocol("bin-out", protocolXML(out, "output", header));
+
+    std::vector<Chunk> in = {
+        {"/bin/int", "int", ""},
+        {"/bin/float", "float", ""},
+        {"/bin/double", "double", ""},
+        {"/bin/bool", "bool", ""},
+        {"/bin/byte", "byte", ""},
+        {"/bin/word", "word", ""},
+        {"/bin/string", "string", ""},
+    };
+    writeProtocol("bin-in", protocolXML(in, "input", header));
+
+    fgSetInt("/test/int", 123456);
+    fgSetFloat("/test/float", -2.5f);
+    fgSetDouble("/test/double", 1234.0625);
+    fgSetBool("/test/bool", true);
+    fgSetInt("/test/byte", -12);
+    fgSetInt("/test/word", 3000);
+    fgSetString("/test/string", "KSFO");
+
+    const SGPath file = _dataDir / "bin.dat";
+    auto writer = makeChannel("bin-out", "out", file);
+    CPPUNIT_ASSERT(writer->open());
+    CPPUNIT_ASSERT(writer->process());
+    CPPUNIT_ASSERT(writer->close());
+
+    auto reader = makeChannel("bin-in", "in", file);
+    CPPUNIT_ASSERT(reader->open());
+    CPPUNIT_ASSERT(reader->process());
+    reader->close();
+
+    CPPUNIT_ASSERT_EQUAL(123456, fgGetInt("/bin/int"));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(-2.5, fgGetDouble("/bin/float"), 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1234.0625, fgGetDouble("/bin/double"), 1e-9);
+    CPPUNIT_ASSERT_EQUAL(true, fgGetBool("/bin/bool"));
+    CPPUNIT_ASSERT_EQUAL(-12, fgGetInt("/bin/byte"));
+    CPPUNIT_ASSERT_EQUAL(3000, fgGetInt("/bin/word"));
+    CPPUNIT_ASSERT_EQUAL(std::string("KSFO"), std::string(fgGetString("/bin/string")));
+
+    // by default words and string lengths are written in host byte order,
+    // as they always were
+    std::vector<Chunk> host = {
+        {"/test/word", "word", ""},
+        {"/test/string", "string", ""},
+    };
+    writeProtocol("bin-host", protocolXML(host, "output", "<binary_mode>true</binary_mode>\n"));
+
+    const SGPath hostFile = _dataDir / "bin-host.dat";
+    auto hostWriter = makeChannel("bin-host", "out", hostFile);
+    CPPUNIT_ASSERT(hostWriter->open());
+    CPPUNIT_ASSERT(hostWriter->process());
+    CPPUNIT_ASSERT(hostWriter->close());
+
+    sg_ifstream is(hostFile, std::ios::in | std::ios::binary);
+    int16_t word = 0;
+    int32_t strlength = 0;
+    is.read(reinterpret_cast<char*>(&word), sizeof(word));
+    is.read(reinterpret_cast<char*>(&strlength), sizeof(strlength));
+    CPPUNIT_ASSERT(is.good());
+    CPPUNIT_ASSERT_EQUAL(static_cast<int16_t>(3000), word);
+    CPPUNIT_ASSERT_EQUAL(static_cast<int32_t>(4), strlength);
+}
+
+
+void GenericProtocolTests::testAsciiThroughput()
+{
+    // a motion-platform sized message: a few hundred chunks
+    std::vector<Chunk> chunks;
+    const char* formats[] = {"%d", "%.3f", "%f", "%.6f"};
+    for (int i = 0; i < 240; ++i) {
+        const std::string node = "/bench/value[" + std::to_string(i) + "]";
+        const std::string type = (i % 4 == 0) ? "int" : ((i % 4 == 1) ? "float" : "double");
+        chunks.push_back({node, type, formats[i % 4]});
+        fgSetDouble(node, (i - 120) * 3.14159265);
+    }
+    writeProtocol("bench", protocolXML(chunks, "output", asciiHeader));
+
+    auto channel = makeChannel("bench", "out", _dataDir / "bench.out");
+
+    const int messages = 2000;
+    SGTimeStamp st;
+    st.stamp();
+    for (int i = 0; i < messages; ++i) {
+        channel->gen_message();
+    }
+    const double compiledSec = st.elapsedMSec() / 1000.0;
+
+    size_t legacyBytes = 0;
+    st.stamp();
+    for (int i = 0; i < messages; ++i) {
+        legacyBytes += legacyFormat(chunks).size();
+    }
+    const double legacySec = st.elapsedMSec() / 1000.0;
+    CPPUNIT_ASSERT(legacyBytes > 0);
+
+    SG_LOG(SG_GENERAL, SG_INFO, "Generic protocol, " << chunks.size() << " chunks: "
+           << (messages / std::max(compiledSec, 1e-6)) << " msg/sec compiled, "
+           << (messages / std::max(legacySec, 1e-6)) << " msg/sec per-message formatting");
+}
@@ -0,0 +1,340 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_propsServer.hxx"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/io/raw_socket.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Main/fg_props.hxx>
+#include <Network/props.hxx>
+
+namespace {
+
+// a client connected to an FGProps server, which is pumped by hand
+class PropsClient
+{
+public:
+    explicit PropsClient(int port) :
+        _server(new FGProps({"props", std::to_string(port)}))
+    {
+        CPPUNIT_ASSERT(_server->open());
+
+        CPPUNIT_ASSERT(_socket.open(true));
+        CPPUNIT_ASSERT_EQUAL(0, _socket.connect("127.0.0.1", port));
+        _socket.setBlocking(false);
+
+        // no prompts in the way
+        send("data");
+    }
+
+    ~PropsClient()
+    {
+        _socket.close();
+        _server->close();
+    }
+
+    void send(const std::string& line)
+    {
+        const std::string data = line + "\r\n";
+        size_t sent = 0;
+        SGTimeStamp st;
+        st.stamp();
+        while (sent < data.size()) {
+            const int n = _socket.send(data.c_str() + sent, static_cast<int>(data.size() - sent));
+            if (n > 0) {
+                sent += n;
+            } else {
+                // let the server catch up
+                CPPUNIT_ASSERT(st.elapsedMSec() < 5000);
+                pumpUntil([](const std::string&) { return false; }, 1);
+            }
+        }
+    }
+
+    // run the server and collect its output until pred is satisfied
+    template <typename Pred>
+    bool pumpUntil(Pred pred, int timeoutMSec = 5000)
+    {
+        SGTimeStamp st;
+        st.stamp();
+        char buf[8192];
+        while (!pred(_received)) {
+            if (st.elapsedMSec() > timeoutMSec) {
+                return false;
+            }
+
+            _server->process();
+            const int n = _socket.recv(buf, sizeof(buf));
+            if (n > 0) {
+                _received.append(buf, n);
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        return true;
+    }
+
+    // wait for text, returning (and consuming) everything up to its end
+    std::string expect(const std::string& text)
+    {
+        CPPUNIT_ASSERT(pumpUntil([&text](const std::string& r) {
+            return r.find(text) != std::string::npos;
+        }));
+
+        const size_t end = _received.find(text) + text.size();
+        const std::string result = _received.substr(0, end);
+        _received.erase(0, end);
+        return result;
+    }
+
+    // wait for one complete binary frame
+    std::string expectBinaryFrame()
+    {
+        CPPUNIT_ASSERT(pumpUntil([](const std::string& r) {
+            return (r.size() >= 8) && (r.size() >= 8 + readU32(r, 4));
+        }));
+
+        CPPUNIT_ASSERT_EQUAL(std::string("FGPS"), _received.substr(0, 4));
+        const size_t size = 8 + readU32(_received, 4);
+        const std::string frame = _received.substr(0, size);
+        _received.erase(0, size);
+        return frame;
+    }
+
+    // process for a while, and return whatever arrived
+    std::string drain()
+    {
+        pumpUntil([](const std::string&) { return false; }, 50);
+        std::string result;
+        result.swap(_received);
+        return result;
+    }
+
+    static uint32_t readU32(const std::string& s, size_t pos)
+    {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) {
+            v = (v << 8) | static_cast<uint8_t>(s[pos + i]);
+        }
+        return v;
+    }
+
+    static uint64_t readU64(const std::string& s, size_t pos)
+    {
+        return (static_cast<uint64_t>(readU32(s, pos)) << 32) | readU32(s, pos + 4);
+    }
+
+private:
+    std::unique_ptr<FGProps> _server;
+    simgear::Socket _socket;
+    std::string _received;
+};
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void PropsServerTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("props-server");
+}
+
+
+// Clean up after each test.
+void PropsServerTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+// The original protocol: path=value lines, one per changed property
+void PropsServerTests::testSubscribeLines()
+{
+    PropsClient client(15741);
+    fgSetInt("/test/a", 1);
+
+    client.send("subscribe /test/a");
+    client.expect("subscribe /test/a\r\n");
+
+    // changes are coalesced until the next publish
+    fgSetInt("/test/a", 2);
+    fgSetInt("/test/a", 3);
+    fgSetInt("/test/unrelated", 3);
+    CPPUNIT_ASSERT_EQUAL(std::string("/test/a=3\r\n"), client.expect("/test/a=3\r\n"));
+
+    client.send("unsubscribe /test/a");
+    fgSetInt("/test/a", 4);
+    CPPUNIT_ASSERT_EQUAL(std::string(), client.drain());
+}
+
+
+void PropsServerTests::testSubscribeBatch()
+{
+    PropsClient client(15742);
+    fgSetInt("/test/a", 1);
+    fgSetString("/test/b", "two\nlines");
+
+    client.send("subscribe-mode batch");
+    client.expect("subscribe-mode batch 0\r\n");
+
+    // ids in the reply, and the current values straight away
+    client.send("subscribe /test/a /test/b");
+    client.expect("subscribe /test/a 0\r\nsubscribe /test/b 1\r\n");
+    CPPUNIT_ASSERT_EQUAL(std::string("frame 0 2\r\n0=1\r\n1=two\\nlines\r\n"),
+                         client.expect("1=two\\nlines\r\n"));
+
+    // only what changed
+    fgSetInt("/test/a", 5);
+    CPPUNIT_ASSERT_EQUAL(std::string("frame 1 1\r\n0=5\r\n"), client.expect("0=5\r\n"));
+
+    // children of a subscribed node are declared the first time they change
+    client.send("subscribe /test/dir");
+    client.expect("subscribe /test/dir 2\r\n");
+    client.expect("frame 2 1\r\n2=\r\n");
+
+    fgSetInt("/test/dir/x", 7);
+    CPPUNIT_ASSERT_EQUAL(std::string("subscribe /test/dir/x 3\r\nframe 3 1\r\n3=7\r\n"),
+                         client.expect("3=7\r\n"));
+
+    fgSetInt("/test/dir/x", 8);
+    CPPUNIT_ASSERT_EQUAL(std::string("frame 4 1\r\n3=8\r\n"), client.expect("3=8\r\n"));
+
+    // ids stay valid after unsubscribing others
+    client.send("unsubscribe /test/a");
+    fgSetInt("/test/a", 6);
+    fgSetString("/test/b", "three");
+    CPPUNIT_ASSERT_EQUAL(std::string("frame 5 1\r\n1=three\r\n"), client.expect("1=three\r\n"));
+
+    // children go with the subscription which found them, and a frame
+    // left with nothing in it is not sent at all
+    fgSetInt("/test/dir/x", 9);
+    client.send("unsubscribe /test/dir");
+    CPPUNIT_ASSERT_EQUAL(std::string(), client.drain());
+    fgSetInt("/test/dir/x", 10);
+    fgSetString("/test/b", "four");
+    CPPUNIT_ASSERT_EQUAL(std::string("frame 6 1\r\n1=four\r\n"), client.expect("1=four\r\n"));
+}
+
+
+void PropsServerTests::testSubscribeBinary()
+{
+    PropsClient client(15743);
+    fgSetDouble("/test/d", 0.25);
+    fgSetInt("/test/i", -3);
+    fgSetBool("/test/flag", true);
+    fgSetString("/test/s", "text");
+
+    client.send("subscribe-mode binary");
+    client.expect("subscribe-mode binary 0\r\n");
+    client.send("subscribe /test/d /test/i /test/flag /test/s");
+    client.expect("subscribe /test/s 3\r\n");
+
+    std::string frame = client.expectBinaryFrame();
+    CPPUNIT_ASSERT_EQUAL(0u, PropsClient::readU32(frame, 8));  // sequence
+    CPPUNIT_ASSERT_EQUAL(4u, PropsClient::readU32(frame, 12)); // count
+
+    size_t pos = 16;
+    CPPUNIT_ASSERT_EQUAL(0u, PropsClient::readU32(frame, pos));
+    CPPUNIT_ASSERT_EQUAL(5, static_cast<int>(frame[pos + 4])); // double
+    const uint64_t bits = PropsClient::readU64(frame, pos + 5);
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    CPPUNIT_ASSERT_EQUAL(0.25, d);
+    pos += 13;
+
+    CPPUNIT_ASSERT_EQUAL(1u, PropsClient::readU32(frame, pos));
+    CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(frame[pos + 4])); // int
+    CPPUNIT_ASSERT_EQUAL(-3, static_cast<int32_t>(PropsClient::readU32(frame, pos + 5)));
+    pos += 9;
+
+    CPPUNIT_ASSERT_EQUAL(2u, PropsClient::readU32(frame, pos));
+    CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(frame[pos + 4])); // bool
+    CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(frame[pos + 5]));
+    pos += 6;
+
+    CPPUNIT_ASSERT_EQUAL(3u, PropsClient::readU32(frame, pos));
+    CPPUNIT_ASSERT_EQUAL(6, static_cast<int>(frame[pos + 4])); // string
+    CPPUNIT_ASSERT_EQUAL(4u, PropsClient::readU32(frame, pos + 5));
+    CPPUNIT_ASSERT_EQUAL(std::string("text"), frame.substr(pos + 9, 4));
+    pos += 13;
+    CPPUNIT_ASSERT_EQUAL(frame.size(), pos);
+
+    fgSetInt("/test/i", 42);
+    frame = client.expectBinaryFrame();
+    CPPUNIT_ASSERT_EQUAL(1u, PropsClient::readU32(frame, 8));
+    CPPUNIT_ASSERT_EQUAL(1u, PropsClient::readU32(frame, 12));
+    CPPUNIT_ASSERT_EQUAL(1u, PropsClient::readU32(frame, 16));
+    CPPUNIT_ASSERT_EQUAL(42u, PropsClient::readU32(frame, 21));
+}
+
+
+// A home cockpit sized set of subscriptions, of which some change each frame
+void PropsServerTests::testManySubscriptions()
+{
+    PropsClient client(15744);
+    const int count = 3000;
+    const int perCommand = 100;
+
+    for (int i = 0; i < count; ++i) {
+        fgSetDouble("/test/many/value[" + std::to_string(i) + "]", 0.0);
+    }
+
+    client.send("subscribe-mode batch");
+    for (int i = 0; i < count; i += perCommand) {
+        std::string command = "subscribe";
+        for (int j = i; j < i + perCommand; ++j) {
+            command += " /test/many/value[" + std::to_string(j) + "]";
+        }
+        client.send(command);
+    }
+
+    const std::string lastId = std::to_string(count - 1);
+    client.expect("subscribe /test/many/value[" + lastId + "] " + lastId + "\r\n");
+    client.expect(lastId + "=0\r\n");
+
+    SGTimeStamp st;
+    st.stamp();
+    const int frames = 50;
+    for (int f = 1; f <= frames; ++f) {
+        // every tenth property changes, several times
+        for (int k = 0; k < 3; ++k) {
+            for (int i = f % 10; i < count; i += 10) {
+                fgSetDouble("/test/many/value[" + std::to_string(i) + "]", f + k);
+            }
+        }
+
+        // the latest values, in one frame
+        const int last = count - 10 + (f % 10);
+        const std::string frame = client.expect(std::to_string(last) + "=" + std::to_string(f + 2) + "\r\n");
+        CPPUNIT_ASSERT(frame.find(" " + std::to_string(count / 10) + "\r\n") != std::string::npos);
+    }
+
+    SG_LOG(SG_IO, SG_INFO, "Props subscriptions: " << count << " subscribed, "
+           << frames << " frames of " << count / 10 << " changes in "
+           << st.elapsedMSec() << "ms");
+}
@@ -0,0 +1,291 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_threadedIO.hxx"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/io/raw_socket.hxx>
+#include <simgear/io/sg_socket.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Main/fg_props.hxx>
+#include <Network/ThreadedIOChannel.hxx>
+
+namespace {
+
+const int ECHO_PORT = 15731;
+const int REPLY_PORT = 15732;
+
+// a stand-in for a remote UDP peer: sends back every datagram received
+// on ECHO_PORT to REPLY_PORT
+class UdpEcho
+{
+public:
+    UdpEcho()
+    {
+        CPPUNIT_ASSERT(_socket.open(false));
+        _socket.setBlocking(false);
+        CPPUNIT_ASSERT_EQUAL(0, _socket.bind("127.0.0.1", ECHO_PORT));
+        _reply.set("127.0.0.1", REPLY_PORT);
+        _thread = std::thread(&UdpEcho::run, this);
+    }
+
+    ~UdpEcho()
+    {
+        _stop = true;
+        _thread.join();
+        _socket.close();
+    }
+
+    int echoed() const { return _echoed; }
+
+private:
+    void run()
+    {
+        char buf[2048];
+        while (!_stop) {
+            const int n = _socket.recv(buf, sizeof(buf), 0);
+            if (n > 0) {
+                _socket.sendto(buf, n, 0, &_reply);
+                ++_echoed;
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+    }
+
+    simgear::Socket _socket;
+    simgear::IPAddress _reply;
+    std::atomic<bool> _stop{false};
+    std::atomic<int> _echoed{0};
+    std::thread _thread;
+};
+
+// records writes, and returns scripted data from reads
+class ScriptedChannel : public SGIOChannel
+{
+public:
+    bool open(const SGProtocolDir) override { return true; }
+    bool close() override { return true; }
+
+    int write(const char* buf, const int length) override
+    {
+        std::lock_guard<std::mutex> g(lock);
+        written.emplace_back(buf, length);
+        return length;
+    }
+
+    int read(char* buf, int length) override
+    {
+        std::lock_guard<std::mutex> g(lock);
+        if (toRead.empty()) {
+            return 0;
+        }
+
+        const std::string s = toRead.front();
+        toRead.erase(toRead.begin());
+        memcpy(buf, s.data(), s.size());
+        ++readCount;
+        return static_cast<int>(s.size());
+    }
+
+    std::mutex lock;
+    std::vector<std::string> written;
+    std::vector<std::string> toRead;
+    std::atomic<int> readCount{0};
+};
+
+template <typename Pred>
+bool waitFor(Pred pred, int timeoutMSec = 5000)
+{
+    SGTimeStamp st;
+    st.stamp();
+    while (!pred()) {
+        if (st.elapsedMSec() > timeoutMSec) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void ThreadedIOTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("threaded-io");
+}
+
+
+// Clean up after each test.
+void ThreadedIOTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void ThreadedIOTests::testUdpEcho()
+{
+    UdpEcho echo;
+    FGIOExecutor executor;
+
+    FGThreadedIOChannel in(new SGSocket("127.0.0.1", std::to_string(REPLY_PORT), "udp"), &executor);
+    CPPUNIT_ASSERT(in.open(SG_IO_IN));
+
+    FGThreadedIOChannel out(new SGSocket("127.0.0.1", std::to_string(ECHO_PORT), "udp"), &executor);
+    CPPUNIT_ASSERT(out.open(SG_IO_OUT));
+
+    const int messages = 200;
+    std::vector<std::string> received;
+    char buf[256];
+    for (int i = 0; i < messages; ++i) {
+        const std::string line = "message," + std::to_string(i) + "\n";
+        CPPUNIT_ASSERT_EQUAL(static_cast<int>(line.size()), out.writestring(line.c_str()));
+
+        // pace like a protocol running at a high rate, collecting what's
+        // arrived so far, as FGIO::update would
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        while (in.readline(buf, sizeof(buf)) > 0) {
+            received.push_back(buf);
+        }
+    }
+
+    CPPUNIT_ASSERT(waitFor([&]() {
+        while (in.readline(buf, sizeof(buf)) > 0) {
+            received.push_back(buf);
+        }
+        return received.size() >= static_cast<size_t>(messages);
+    }));
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(messages), received.size());
+    for (int i = 0; i < messages; ++i) {
+        CPPUNIT_ASSERT_EQUAL("message," + std::to_string(i) + "\n", received[i]);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(messages, echo.echoed());
+    CPPUNIT_ASSERT(out.outboundLatencyMSec() > 0.0);
+    CPPUNIT_ASSERT(in.inboundLatencyMSec() > 0.0);
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), in.inboundQueueDepth());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), in.inboundDrops());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), out.outboundDrops());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), out.writeErrors());
+
+    SGPropertyNode* stats = fgGetNode("/io/channels/echo-in/threaded", true);
+    in.publishStats(stats);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(in.inboundLatencyMSec(), stats->getDoubleValue("latency-in-ms"), 1e-9);
+    CPPUNIT_ASSERT_EQUAL(0, stats->getIntValue("queue-depth-in"));
+    CPPUNIT_ASSERT_EQUAL(0L, stats->getLongValue("dropped-in"));
+
+    SG_LOG(SG_IO, SG_INFO, "Threaded UDP echo: outbound latency " << out.outboundLatencyMSec()
+           << " msec, inbound latency " << in.inboundLatencyMSec() << " msec");
+
+    CPPUNIT_ASSERT(out.close());
+    CPPUNIT_ASSERT(in.close());
+}
+
+
+void ThreadedIOTests::testOutboundDrops()
+{
+    FGIOExecutor executor;
+    auto scripted = new ScriptedChannel;
+    FGThreadedIOChannel channel(scripted, &executor, 4);
+
+    // not opened, so the executor never drains the queue
+    for (int i = 0; i < 10; ++i) {
+        const std::string s = "out" + std::to_string(i);
+        CPPUNIT_ASSERT_EQUAL(static_cast<int>(s.size()), channel.write(s.data(), static_cast<int>(s.size())));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), channel.outboundQueueDepth());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(6), channel.outboundDrops());
+
+    // closing delivers the queued data synchronously, oldest first
+    CPPUNIT_ASSERT(channel.close());
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), scripted->written.size());
+    for (int i = 0; i < 4; ++i) {
+        CPPUNIT_ASSERT_EQUAL("out" + std::to_string(i), scripted->written[i]);
+    }
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), channel.outboundQueueDepth());
+
+    SGPropertyNode* stats = fgGetNode("/io/channels/drops/threaded", true);
+    channel.publishStats(stats);
+    CPPUNIT_ASSERT_EQUAL(6L, stats->getLongValue("dropped-out"));
+}
+
+
+void ThreadedIOTests::testInboundDrops()
+{
+    FGIOExecutor executor;
+    auto scripted = new ScriptedChannel;
+    for (int i = 0; i < 10; ++i) {
+        scripted->toRead.push_back("in" + std::to_string(i) + "\n");
+    }
+
+    FGThreadedIOChannel channel(scripted, &executor, 4);
+    CPPUNIT_ASSERT(channel.open(SG_IO_IN));
+
+    // nothing is consumed until everything has been read, so only the
+    // first four lines fit in the queue
+    CPPUNIT_ASSERT(waitFor([scripted]() { return scripted->readCount == 10; }));
+    CPPUNIT_ASSERT(waitFor([&channel]() { return channel.inboundDrops() == 6; }));
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), channel.inboundQueueDepth());
+
+    char buf[64];
+    for (int i = 0; i < 4; ++i) {
+        CPPUNIT_ASSERT(channel.readline(buf, sizeof(buf)) > 0);
+        CPPUNIT_ASSERT_EQUAL("in" + std::to_string(i) + "\n", std::string(buf));
+    }
+    CPPUNIT_ASSERT_EQUAL(0, channel.readline(buf, sizeof(buf)));
+    CPPUNIT_ASSERT(channel.close());
+}
+
+
+void ThreadedIOTests::testDatagrams()
+{
+    FGIOExecutor executor;
+    auto scripted = new ScriptedChannel;
+    scripted->toRead = {"first", "second", "third-is-long"};
+
+    FGThreadedIOChannel channel(scripted, &executor, 8, true);
+    CPPUNIT_ASSERT(channel.open(SG_IO_IN));
+    CPPUNIT_ASSERT(waitFor([&channel]() { return channel.inboundQueueDepth() == 3; }));
+
+    // each read returns one datagram, even when the buffer could hold more
+    char buf[64];
+    CPPUNIT_ASSERT_EQUAL(5, channel.read(buf, sizeof(buf)));
+    CPPUNIT_ASSERT_EQUAL(std::string("first"), std::string(buf, 5));
+    CPPUNIT_ASSERT_EQUAL(6, channel.read(buf, sizeof(buf)));
+    CPPUNIT_ASSERT_EQUAL(std::string("second"), std::string(buf, 6));
+
+    // and the part of a datagram which doesn't fit is dropped
+    CPPUNIT_ASSERT_EQUAL(5, channel.read(buf, 5));
+    CPPUNIT_ASSERT_EQUAL(std::string("third"), std::string(buf, 5));
+    CPPUNIT_ASSERT_EQUAL(0, channel.read(buf, sizeof(buf)));
+    CPPUNIT_ASSERT(channel.close());
+}
@@ -19,7 +19,9 @@
 
 #include "testNasalSys.hxx"
 #include "testGC.hxx"
+#include "testTimerQueue.hxx"
 
 // Set up the unit tests.
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(NasalSysTests, "Unit tests");
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(NasalGCTests, "Unit tests");
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(TimerQueueTests, "Unit tests");
@@ -20,10 +20,14 @@
 
 #include "testNasalSys.hxx"
 
+#include <vector>
+
 #include "test_suite/FGTestApi/testGlobals.hxx"
 #include "test_suite/FGTestApi/NavDataCache.hxx"
 
+#include <simgear/debug/logstream.hxx>
 #include <simgear/structure/commands.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
@@ -203,3 +207,95 @@ void NasalSysTests::testCompileLarge()
 //    )");
 //    CPPUNIT_ASSERT(ok);
 }
+
+void NasalSysTests::testPropertyCache()
+{
+    bool ok = FGTestApi::executeNasal(R"(
+        setprop("/test/cache/a/b/c", 1);
+        unitTest.assert_equal(getprop("/test/cache/a/b/c"), 1);
+        unitTest.assert_equal(getprop("/test/cache/a", "b/c"), 1);
+
+        # a number after a name is an index
+        setprop("/test/cache/x", 3, "y", 4);
+        unitTest.assert_equal(getprop("/test/cache/x[3]/y"), 4);
+        unitTest.assert_equal(getprop("/test/cache/x", 3, "y"), 4);
+        unitTest.assert_equal(getprop("/test/cache/x", 2, "y"), nil);
+        unitTest.assert_equal(getprop("/test/cache/x3/y"), nil);
+    )");
+    CPPUNIT_ASSERT(ok);
+
+    // removing an ancestor must drop the cached nodes below it
+    fgGetNode("/test/cache")->removeChild("a", 0);
+    fgGetNode("/test/cache")->removeChild("x", 3);
+
+    ok = FGTestApi::executeNasal(R"(
+        unitTest.assert_equal(getprop("/test/cache/a/b/c"), nil);
+        unitTest.assert_equal(getprop("/test/cache/x", 3, "y"), nil);
+
+        setprop("/test/cache/a/b/c", 2);
+        unitTest.assert_equal(getprop("/test/cache/a/b/c"), 2);
+    )");
+    CPPUNIT_ASSERT(ok);
+
+    // setprop must have written to the node in the tree, not a stale one
+    CPPUNIT_ASSERT_EQUAL(2, fgGetInt("/test/cache/a/b/c"));
+    fgSetInt("/test/cache/a/b/c", 5);
+
+    ok = FGTestApi::executeNasal(R"(
+        unitTest.assert_equal(getprop("/test/cache/a/b/c"), 5);
+    )");
+    CPPUNIT_ASSERT(ok);
+}
+
+void NasalSysTests::testGetpropBenchmark()
+{
+    const int paths = 200;
+    const int passes = 500;
+
+    bool ok = FGTestApi::executeNasal(R"(
+        var paths = [];
+        for (var i = 0; i < 200; i += 1) {
+            var p = "/test/bench/systems[" ~ int(i / 20) ~ "]/bus/load[" ~ math.mod(i, 20) ~ "]/circuit/breaker/state/value";
+            setprop(p, i);
+            append(paths, p);
+        }
+        globals.benchPaths = paths;
+    )");
+    CPPUNIT_ASSERT(ok);
+
+    SGTimeStamp st;
+    st.stamp();
+    ok = FGTestApi::executeNasal(R"(
+        var paths = globals.benchPaths;
+        var sum = 0;
+        for (var pass = 0; pass < 500; pass += 1) {
+            foreach (var p; paths) {
+                sum += getprop(p);
+            }
+        }
+        unitTest.assert_equal(sum, 500 * 199 * 200 / 2);
+    )");
+    const double nasalMSec = st.elapsedMSec();
+    CPPUNIT_ASSERT(ok);
+
+    // the tree walk alone, for comparison
+    std::vector<std::string> names;
+    for (int i = 0; i < paths; ++i) {
+        names.push_back("/test/bench/systems[" + std::to_string(i / 20) + "]/bus/load[" +
+                        std::to_string(i % 20) + "]/circuit/breaker/state/value");
+    }
+
+    double sum = 0.0;
+    st.stamp();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (const auto& n : names) {
+            sum += globals->get_props()->getNode(n)->getDoubleValue();
+        }
+    }
+    const double walkMSec = st.elapsedMSec();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(passes * 199.0 * 200 / 2, sum, 1e-6);
+
+    const double calls = static_cast<double>(paths) * passes;
+    SG_LOG(SG_NASAL, SG_INFO, "getprop on deep paths: " << (calls / nasalMSec) * 1000.0
+           << " calls/sec from Nasal, " << (calls / walkMSec) * 1000.0 << " tree walks/sec from C++");
+}
@@ -35,6 +35,8 @@ class NasalSysTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testCommands);
     CPPUNIT_TEST(testAirportGhost);
     CPPUNIT_TEST(testCompileLarge);
+    CPPUNIT_TEST(testPropertyCache);
+    CPPUNIT_TEST(testGetpropBenchmark);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -49,6 +51,8 @@ public:
     void testCommands();
     void testAirportGhost();
     void testCompileLarge();
+    void testPropertyCache();
+    void testGetpropBenchmark();
 };
 
 #endif  // _FG_NASALSYS_UNIT_TESTS_HXX
@@ -0,0 +1,383 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testTimerQueue.hxx"
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/props/props.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Scripting/NasalTimerQueue.hxx>
+
+namespace {
+
+// records the clock time at which it fired
+class TestTimer : public NasalTimerQueue::Timer
+{
+public:
+    TestTimer(const std::string& location, const double& clock) :
+        NasalTimerQueue::Timer(location),
+        _clock(clock)
+    {
+    }
+
+    void expired() override
+    {
+        ++fired;
+        firedAt = _clock;
+        if (onExpired) {
+            onExpired(this);
+        }
+    }
+
+    void cancelled() override
+    {
+        ++cancels;
+    }
+
+    int fired = 0;
+    int cancels = 0;
+    double firedAt = -1.0;
+    std::function<void(TestTimer*)> onExpired;
+
+private:
+    const double& _clock;
+};
+
+typedef std::unique_ptr<TestTimer> TestTimerPtr;
+
+// busy-wait, so the stats have something to show
+void spin(double msec)
+{
+    SGTimeStamp st;
+    st.stamp();
+    while (st.elapsedUSec() < msec * 1000.0) {
+    }
+}
+
+} // of anonymous namespace
+
+
+// Random timers fire in the frame their due time falls in
+void TimerQueueTests::testOrdering()
+{
+    NasalTimerQueue queue;
+    double clock = 0.0;
+    const double dt = 1.0 / 60.0;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> delays(0.0, 30.0);
+
+    std::vector<TestTimerPtr> timers;
+    std::vector<double> due;
+    for (int i = 0; i < 2000; ++i) {
+        timers.emplace_back(new TestTimer("test:" + std::to_string(i % 7), clock));
+        due.push_back(delays(rng));
+        queue.schedule(timers.back().get(), due.back(), (i % 2) == 0);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(size_t(2000), queue.pending());
+
+    while (clock < 31.0) {
+        clock += dt;
+        queue.update(dt, dt);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(size_t(0), queue.pending());
+    for (size_t i = 0; i < timers.size(); ++i) {
+        CPPUNIT_ASSERT_EQUAL(1, timers[i]->fired);
+        // never early, and at most one frame late (allowing for the
+        // rounding of the accumulated clock)
+        CPPUNIT_ASSERT(timers[i]->firedAt >= due[i] - 1e-9);
+        CPPUNIT_ASSERT(timers[i]->firedAt < due[i] + dt + 1e-9);
+    }
+}
+
+// Timers ready in the same frame, or sharing a slot, fire in order of
+// their due time rather than the order they were scheduled in
+void TimerQueueTests::testDueOrder()
+{
+    NasalTimerQueue queue;
+    double clock = 0.0;
+
+    // the same millisecond, scheduled latest first
+    const std::vector<double> delays = {0.0509, 0.0507, 0.0505, 0.0503, 0.0501,
+                                        // and spread over the frame
+                                        0.09, 0.02, 0.07, 0.04};
+    std::vector<TestTimerPtr> timers;
+    std::vector<double> fired;
+    for (double delay : delays) {
+        timers.emplace_back(new TestTimer("test:order", clock));
+        timers.back()->onExpired = [&fired, delay](TestTimer*) { fired.push_back(delay); };
+        queue.schedule(timers.back().get(), delay, true);
+    }
+
+    clock += 0.1;
+    queue.update(0.1, 0.1);
+
+    CPPUNIT_ASSERT_EQUAL(delays.size(), fired.size());
+    for (size_t i = 1; i < fired.size(); ++i) {
+        CPPUNIT_ASSERT(fired[i - 1] <= fired[i]);
+    }
+}
+
+// Delays which have to cascade down the levels, or wait in the overflow list
+void TimerQueueTests::testLongDelays()
+{
+    NasalTimerQueue queue;
+    double clock = 0.0;
+
+    const std::vector<double> delays = {0.07, 4.2, 300.0, 3600.0 * 3, 3600.0 * 10, 3600.0 * 30};
+    std::vector<TestTimerPtr> timers;
+    for (auto d : delays) {
+        timers.emplace_back(new TestTimer("long", clock));
+        queue.schedule(timers.back().get(), d, true);
+    }
+
+    // big steps, as when running at high time acceleration
+    const double dt = 0.5;
+    while (clock < 3600.0 * 31) {
+        clock += dt;
+        queue.update(dt, 0.0);
+    }
+
+    for (size_t i = 0; i < delays.size(); ++i) {
+        CPPUNIT_ASSERT_EQUAL(1, timers[i]->fired);
+        CPPUNIT_ASSERT(timers[i]->firedAt >= delays[i]);
+        CPPUNIT_ASSERT(timers[i]->firedAt < delays[i] + dt + 1e-6);
+    }
+
+    // real time timers don't advance with simulated time
+    TestTimer realTimer("real", clock);
+    queue.schedule(&realTimer, 1.0, false);
+    for (int i = 0; i < 100; ++i) {
+        queue.update(1.0, 0.0);
+    }
+    CPPUNIT_ASSERT_EQUAL(0, realTimer.fired);
+    queue.update(0.0, 1.0);
+    CPPUNIT_ASSERT_EQUAL(1, realTimer.fired);
+}
+
+void TimerQueueTests::testCancel()
+{
+    NasalTimerQueue queue;
+    double clock = 0.0;
+
+    TestTimer a("a", clock), b("b", clock);
+    queue.schedule(&a, 1.0, true);
+    queue.schedule(&b, 1.0, true);
+    CPPUNIT_ASSERT(a.isScheduled());
+
+    queue.cancel(&a);
+    CPPUNIT_ASSERT(!a.isScheduled());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), queue.pending());
+
+    // cancelling twice is harmless
+    queue.cancel(&a);
+
+    // destroying a scheduled timer removes it
+    {
+        TestTimer c("c", clock);
+        queue.schedule(&c, 0.5, true);
+        CPPUNIT_ASSERT_EQUAL(size_t(2), queue.pending());
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(1), queue.pending());
+
+    // re-scheduling moves the timer
+    queue.schedule(&b, 5.0, true);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), queue.pending());
+
+    clock = 2.0;
+    queue.update(2.0, 2.0);
+    CPPUNIT_ASSERT_EQUAL(0, a.fired);
+    CPPUNIT_ASSERT_EQUAL(0, b.fired);
+
+    clock = 5.0;
+    queue.update(3.0, 3.0);
+    CPPUNIT_ASSERT_EQUAL(1, b.fired);
+
+    // clear() notifies the remaining timers
+    queue.schedule(&a, 1.0, false);
+    queue.clear();
+    CPPUNIT_ASSERT_EQUAL(1, a.cancels);
+    CPPUNIT_ASSERT(!a.isScheduled());
+}
+
+// Zero-delay timers added from a callback wait for the next frame, so a
+// callback re-arming itself can't starve the frame
+void TimerQueueTests::testRescheduleDuringDispatch()
+{
+    NasalTimerQueue queue;
+    double clock = 0.0;
+
+    TestTimer t("loop", clock);
+    t.onExpired = [&queue](TestTimer* self) {
+        queue.schedule(self, 0.0, true);
+    };
+
+    queue.schedule(&t, 0.0, true);
+    for (int i = 1; i <= 10; ++i) {
+        queue.update(0.01, 0.01);
+        CPPUNIT_ASSERT_EQUAL(i, t.fired);
+    }
+
+    // including when the clock is stopped (paused)
+    queue.update(0.0, 0.0);
+    CPPUNIT_ASSERT_EQUAL(11, t.fired);
+
+    queue.cancel(&t);
+}
+
+void TimerQueueTests::testBudget()
+{
+    NasalTimerQueue queue;
+    double clock = 0.0;
+
+    std::vector<TestTimerPtr> timers;
+    for (int i = 0; i < 10; ++i) {
+        timers.emplace_back(new TestTimer("slow", clock));
+        timers.back()->onExpired = [](TestTimer*) { spin(2.0); };
+        queue.schedule(timers.back().get(), 0.0, true);
+    }
+
+    queue.setBudgetMSec(5.0);
+    queue.update(0.01, 0.01);
+
+    const size_t first = queue.dispatchedLastFrame();
+    CPPUNIT_ASSERT(first >= 1);
+    CPPUNIT_ASSERT(first < 10);
+    CPPUNIT_ASSERT_EQUAL(10 - first, queue.deferredLastFrame());
+    CPPUNIT_ASSERT_EQUAL(1ul, queue.overrunFrames());
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned long>(10 - first), queue.deferredTotal());
+
+    // deferred timers go first, in their original order
+    for (size_t i = 0; i < first; ++i) {
+        CPPUNIT_ASSERT_EQUAL(1, timers[i]->fired);
+    }
+    CPPUNIT_ASSERT_EQUAL(0, timers[first]->fired);
+
+    // even a tiny budget makes progress
+    queue.setBudgetMSec(0.001);
+    queue.update(0.01, 0.01);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), queue.dispatchedLastFrame());
+    CPPUNIT_ASSERT_EQUAL(1, timers[first]->fired);
+
+    // and no budget runs everything
+    queue.setBudgetMSec(0.0);
+    queue.update(0.01, 0.01);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), queue.deferredLastFrame());
+    for (const auto& t : timers) {
+        CPPUNIT_ASSERT_EQUAL(1, t->fired);
+    }
+}
+
+void TimerQueueTests::testStats()
+{
+    NasalTimerQueue queue;
+    double clock = 0.0;
+
+    TestTimer fast("fast.nas:10", clock), slow("slow.nas:20", clock);
+    slow.onExpired = [](TestTimer*) { spin(3.0); };
+
+    for (int i = 0; i < 3; ++i) {
+        queue.schedule(&fast, 0.0, true);
+        queue.schedule(&slow, 0.0, true);
+        queue.update(0.01, 0.01);
+    }
+
+    auto worst = queue.slowest(10);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), worst.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("slow.nas:20"), worst[0]->location);
+    CPPUNIT_ASSERT_EQUAL(3ul, worst[0]->calls);
+    CPPUNIT_ASSERT(worst[0]->maxMSec >= 3.0);
+    CPPUNIT_ASSERT_EQUAL(std::string("fast.nas:10"), worst[1]->location);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), queue.slowest(1).size());
+
+    SGPropertyNode_ptr root(new SGPropertyNode);
+    queue.publishStats(root, 10);
+    CPPUNIT_ASSERT_EQUAL(0, root->getIntValue("pending"));
+    CPPUNIT_ASSERT_EQUAL(2, root->getIntValue("dispatched"));
+    CPPUNIT_ASSERT_EQUAL(std::string("slow.nas:20"),
+                         std::string(root->getStringValue("slowest[0]/location")));
+    CPPUNIT_ASSERT_EQUAL(3, root->getIntValue("slowest[0]/calls"));
+    CPPUNIT_ASSERT(root->getDoubleValue("slowest[0]/mean-ms") >= 3.0);
+    CPPUNIT_ASSERT_EQUAL(std::string("fast.nas:10"),
+                         std::string(root->getStringValue("slowest[1]/location")));
+}
+
+// Many repeating timers, as a large aircraft creates with maketimer()
+void TimerQueueTests::testBenchmark()
+{
+    NasalTimerQueue queue;
+    double clock = 0.0;
+    const double dt = 1.0 / 60.0;
+    const int count = 5000;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> intervals(0.0, 2.0);
+
+    std::vector<TestTimerPtr> timers;
+    std::vector<double> interval;
+    for (int i = 0; i < count; ++i) {
+        timers.emplace_back(new TestTimer("bench:" + std::to_string(i % 50), clock));
+        interval.push_back(intervals(rng));
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const double iv = interval[i];
+        timers[i]->onExpired = [&queue, iv](TestTimer* t) { queue.schedule(t, iv, (t->fired % 2) == 0); };
+    }
+
+    SGTimeStamp st;
+    st.stamp();
+    for (int i = 0; i < count; ++i) {
+        queue.schedule(timers[i].get(), interval[i], true);
+    }
+    const double scheduleUSec = st.elapsedUSec();
+
+    st.stamp();
+    const int frames = 600;
+    for (int f = 0; f < frames; ++f) {
+        clock += dt;
+        queue.update(dt, dt);
+    }
+    const double updateUSec = st.elapsedUSec();
+
+    long fired = 0;
+    for (const auto& t : timers) {
+        fired += t->fired;
+    }
+
+    st.stamp();
+    for (const auto& t : timers) {
+        queue.cancel(t.get());
+    }
+    const double cancelUSec = st.elapsedUSec();
+
+    SG_LOG(SG_NASAL, SG_INFO, "Timer queue: " << count << " timers, scheduled in "
+           << scheduleUSec << "us, " << fired << " callbacks over " << frames << " frames in "
+           << updateUSec / 1000.0 << "ms (" << updateUSec / frames << "us/frame), cancelled in "
+           << cancelUSec << "us");
+
+    CPPUNIT_ASSERT(fired > count);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), queue.pending());
+}
@@ -0,0 +1,60 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_voiceSynthesizer.hxx"
+
+#include <Sound/VoiceSynthesizer.hxx>
+
+using Phrases = std::vector<std::string>;
+
+
+void VoiceSynthesizerTests::testSplitPhrases()
+{
+    const Phrases phrases = FLITEVoiceSynthesizer::splitPhrases(
+        "This is Bristol information alpha. Wind 240 degrees, 12 knots; QNH 1013: advise on contact!  Roger?");
+
+    const Phrases expected = {"This is Bristol information alpha.", "Wind 240 degrees,", "12 knots;",
+                              "QNH 1013:", "advise on contact!", "Roger?"};
+    CPPUNIT_ASSERT(expected == phrases);
+}
+
+
+void VoiceSynthesizerTests::testSplitKeepsDecimals()
+{
+    // punctuation without following whitespace is not a boundary, so
+    // frequencies stay in one phrase, and so does trailing text
+    const Phrases phrases = FLITEVoiceSynthesizer::splitPhrases("Contact tower on 133.85, good day");
+
+    const Phrases expected = {"Contact tower on 133.85,", "good day"};
+    CPPUNIT_ASSERT(expected == phrases);
+}
+
+
+void VoiceSynthesizerTests::testSplitLineBreaks()
+{
+    const Phrases phrases = FLITEVoiceSynthesizer::splitPhrases("Runway 27 in use\nTransition level 70\n\n");
+
+    const Phrases expected = {"Runway 27 in use", "Transition level 70"};
+    CPPUNIT_ASSERT(expected == phrases);
+}
+
+
+void VoiceSynthesizerTests::testSplitEmpty()
+{
+    CPPUNIT_ASSERT(FLITEVoiceSynthesizer::splitPhrases("").empty());
+    CPPUNIT_ASSERT(FLITEVoiceSynthesizer::splitPhrases(" \t \n ").empty());
+}
@@ -0,0 +1,211 @@
+// fglogdecode.cxx - convert binary FGLogger files to CSV
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+// The format is described in src/Main/LogWriter.hxx.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[8] = {'F', 'G', 'L', 'O', 'G', 'B', 'I', 'N'};
+const uint32_t VERSION = 1;
+
+enum Encoding {
+    ENCODING_DOUBLE = 0,
+    ENCODING_STRING = 1
+};
+
+bool readU8(istream& in, uint8_t& v)
+{
+    char c;
+    if (!in.get(c)) {
+        return false;
+    }
+    v = static_cast<uint8_t>(c);
+    return true;
+}
+
+bool readU32(istream& in, uint32_t& v)
+{
+    unsigned char b[4];
+    if (!in.read(reinterpret_cast<char*>(b), 4)) {
+        return false;
+    }
+    v = b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<uint32_t>(b[3]) << 24);
+    return true;
+}
+
+bool readDouble(istream& in, double& d)
+{
+    unsigned char b[8];
+    if (!in.read(reinterpret_cast<char*>(b), 8)) {
+        return false;
+    }
+
+    uint64_t bits = 0;
+    for (int i = 7; i >= 0; --i) {
+        bits = (bits << 8) | b[i];
+    }
+    memcpy(&d, &bits, sizeof(d));
+    return true;
+}
+
+bool readString(istream& in, string& s)
+{
+    uint32_t len;
+    if (!readU32(in, len)) {
+        return false;
+    }
+    s.resize(len);
+    return len == 0 || static_cast<bool>(in.read(&s[0], len));
+}
+
+string formatDouble(double d)
+{
+    if (std::isnan(d)) {
+        return string(); // no value
+    }
+
+    ostringstream os;
+    os.precision(10);
+    os << d;
+    return os.str();
+}
+
+void usage()
+{
+    cerr << "Usage:  fglogdecode [-d <delimiter>] [-o <outfile>] <infile>" << endl;
+}
+
+} // of anonymous namespace
+
+
+int main(int argc, char *argv[])
+{
+    char delimiter = ',';
+    string infile, outfile;
+
+    for (int i = 1; i < argc; i++) {
+        const string arg = argv[i];
+        if ((arg == "-d") && (i + 1 < argc)) {
+            delimiter = argv[++i][0];
+        } else if ((arg == "-o") && (i + 1 < argc)) {
+            outfile = argv[++i];
+        } else if (infile.empty() && (arg[0] != '-')) {
+            infile = arg;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (infile.empty()) {
+        usage();
+        return 1;
+    }
+
+    ifstream in(infile.c_str(), ios::in | ios::binary);
+    if (!in) {
+        cerr << "Cannot open " << infile << endl;
+        return 1;
+    }
+
+    ofstream file;
+    if (!outfile.empty()) {
+        file.open(outfile.c_str(), ios::out);
+        if (!file) {
+            cerr << "Cannot write " << outfile << endl;
+            return 1;
+        }
+    }
+    ostream& out = outfile.empty() ? cout : file;
+
+    char magic[8];
+    uint32_t version, columns;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) ||
+        !readU32(in, version) || !readU32(in, columns)) {
+        cerr << infile << " is not a binary FlightGear log" << endl;
+        return 1;
+    }
+
+    if (version != VERSION) {
+        cerr << infile << ": unsupported version " << version << endl;
+        return 1;
+    }
+
+    for (uint32_t c = 0; c < columns; ++c) {
+        string title;
+        if (!readString(in, title)) {
+            cerr << infile << ": truncated header" << endl;
+            return 1;
+        }
+        out << (c > 0 ? string(1, delimiter) : string()) << title;
+    }
+    out << '\n';
+
+    // blocks are stored by column, but written out by row
+    uint32_t rows;
+    vector<vector<string>> block(columns);
+    unsigned long total = 0;
+    while (readU32(in, rows)) {
+        for (uint32_t c = 0; c < columns; ++c) {
+            uint8_t encoding;
+            if (!readU8(in, encoding)) {
+                cerr << infile << ": truncated block after " << total << " records" << endl;
+                return 1;
+            }
+
+            block[c].resize(rows);
+            for (uint32_t r = 0; r < rows; ++r) {
+                bool ok = false;
+                if (encoding == ENCODING_DOUBLE) {
+                    double d;
+                    ok = readDouble(in, d);
+                    block[c][r] = formatDouble(d);
+                } else if (encoding == ENCODING_STRING) {
+                    ok = readString(in, block[c][r]);
+                }
+
+                if (!ok) {
+                    cerr << infile << ": bad or truncated block after " << total << " records" << endl;
+                    return 1;
+                }
+            }
+        }
+
+        for (uint32_t r = 0; r < rows; ++r) {
+            for (uint32_t c = 0; c < columns; ++c) {
+                if (c > 0) {
+                    out << delimiter;
+                }
+                out << block[c][r];
+            }
+            out << '\n';
+        }
+        total += rows;
+    }
+
+    return 0;
+}